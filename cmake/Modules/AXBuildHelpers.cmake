@@ -64,6 +64,28 @@ function(ax_def_sync_resource_target ax_target sync_target_name)
 endfunction()
 
 
+# generate a file manifest of `CONTENT_DIR` to `OUTPUT` every time the target is built,
+# load it at runtime with FileUtils::loadFileManifest to answer file existence queries without filesystem access
+function(ax_gen_file_manifest ax_target)
+    set(oneValueArgs CONTENT_DIR OUTPUT)
+    cmake_parse_arguments(opt "" "${oneValueArgs}" "" ${ARGN})
+
+    if(NOT opt_CONTENT_DIR OR NOT opt_OUTPUT)
+        message(FATAL_ERROR "ax_gen_file_manifest: CONTENT_DIR and OUTPUT are required")
+    endif()
+
+    set(manifest_target GEN_MANIFEST-${ax_target})
+    add_custom_target(${manifest_target} ALL
+        COMMAND ${CMAKE_COMMAND} -DAX_MANIFEST_CONTENT_DIR=${opt_CONTENT_DIR} -DAX_MANIFEST_OUTPUT=${opt_OUTPUT}
+            -P ${_AX_ROOT}/cmake/Modules/AXGenFileManifest.cmake
+        COMMENT "Generating file manifest for ${ax_target} ..."
+    )
+    add_dependencies(${ax_target} ${manifest_target})
+    set_target_properties(${manifest_target} PROPERTIES
+        FOLDER Utils
+    )
+endfunction()
+
 function(ax_sync_lua_scripts ax_target src_dir dst_dir)
     set(luacompile_target COPY_LUA-${ax_target})
     if(NOT TARGET ${luacompile_target})
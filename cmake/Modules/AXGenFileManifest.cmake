@@ -0,0 +1,26 @@
+# Generate a file manifest for FileUtils::loadFileManifest
+# usage: cmake -DAX_MANIFEST_CONTENT_DIR=<dir> -DAX_MANIFEST_OUTPUT=<file> -P AXGenFileManifest.cmake
+# The manifest lists every file under content dir, one path per line, relative to content dir
+
+if(NOT AX_MANIFEST_CONTENT_DIR OR NOT AX_MANIFEST_OUTPUT)
+    message(FATAL_ERROR "AX_MANIFEST_CONTENT_DIR and AX_MANIFEST_OUTPUT are required")
+endif()
+
+file(GLOB_RECURSE manifest_files LIST_DIRECTORIES false RELATIVE "${AX_MANIFEST_CONTENT_DIR}" "${AX_MANIFEST_CONTENT_DIR}/*")
+list(SORT manifest_files)
+
+get_filename_component(manifest_name "${AX_MANIFEST_OUTPUT}" NAME)
+list(REMOVE_ITEM manifest_files "${manifest_name}")
+
+string(REPLACE ";" "\n" manifest_content "${manifest_files}")
+set(manifest_content "# axmol file manifest\n${manifest_content}\n")
+
+# don't touch the output when nothing changed, avoid triggering resource sync
+if(EXISTS "${AX_MANIFEST_OUTPUT}")
+    file(READ "${AX_MANIFEST_OUTPUT}" manifest_old)
+    if(manifest_old STREQUAL manifest_content)
+        return()
+    endif()
+endif()
+
+file(WRITE "${AX_MANIFEST_OUTPUT}" "${manifest_content}")
@@ -195,6 +195,11 @@ public:
      */
     bool isVisibleInFrustum(const AABB* aabb) const;
 
+    /**
+     * Get the frustum of the camera, updated for its current view projection matrix.
+     */
+    const Frustum& getFrustum() const;
+
     /**
      * Get object depth towards camera
      */
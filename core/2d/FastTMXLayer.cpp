@@ -49,6 +49,7 @@ THE SOFTWARE.
 #include "base/Director.h"
 #include "base/UTF8.h"
 #include "renderer/backend/ProgramState.h"
+#include "base/JobSystem.h"
 
 NS_AX_BEGIN
 
@@ -56,6 +57,38 @@ const int FastTMXLayer::FAST_TMX_ORIENTATION_ORTHO = 0;
 const int FastTMXLayer::FAST_TMX_ORIENTATION_HEX   = 1;
 const int FastTMXLayer::FAST_TMX_ORIENTATION_ISO   = 2;
 
+namespace
+{
+const int MAX_CHUNK_UPLOADS_PER_FRAME = 4;
+
+int vertexZForTile(bool automatic, int vertexZ, int orientation, const Vec2& layerSize, float x, float y)
+{
+    if (!automatic)
+        return vertexZ;
+
+    int ret = 0;
+    switch (orientation)
+    {
+    case FastTMXLayer::FAST_TMX_ORIENTATION_ISO:
+    {
+        int maxVal = static_cast<int>(layerSize.width + layerSize.height);
+        ret        = static_cast<int>(-(maxVal - (x + y)));
+        break;
+    }
+    case FastTMXLayer::FAST_TMX_ORIENTATION_ORTHO:
+        ret = static_cast<int>(-(layerSize.height - y));
+        break;
+    case FastTMXLayer::FAST_TMX_ORIENTATION_HEX:
+        AXASSERT(0, "TMX Hexa vertexZ not supported");
+        break;
+    default:
+        AXASSERT(0, "TMX invalid value");
+        break;
+    }
+    return ret;
+}
+}  // namespace
+
 // FastTMXLayer - init & alloc & dealloc
 FastTMXLayer* FastTMXLayer::create(TMXTilesetInfo* tilesetInfo, TMXLayerInfo* layerInfo, TMXMapInfo* mapInfo)
 {
@@ -81,7 +114,9 @@ bool FastTMXLayer::initWithTilesetInfo(TMXTilesetInfo* tilesetInfo, TMXLayerInfo
     // layerInfo
     _layerName  = layerInfo->_name;
     _layerSize  = layerInfo->_layerSize;
-    _tiles      = layerInfo->_tiles;
+    _tiles       = layerInfo->_tiles;
+    _tilesSource = layerInfo->_tilesSource;
+    AX_SAFE_RETAIN(_tilesSource);
     _quadsDirty = true;
     setOpacity(layerInfo->_opacity);
     setProperties(layerInfo->getProperties());
@@ -117,7 +152,9 @@ FastTMXLayer::~FastTMXLayer()
 {
     AX_SAFE_RELEASE(_tileSet);
     AX_SAFE_RELEASE(_texture);
-    AX_SAFE_FREE(_tiles);
+    if (!_tilesSource)
+        AX_SAFE_FREE(_tiles);
+    AX_SAFE_RELEASE(_tilesSource);
     AX_SAFE_RELEASE(_vertexBuffer);
     AX_SAFE_RELEASE(_indexBuffer);
 
@@ -126,10 +163,45 @@ FastTMXLayer::~FastTMXLayer()
         AX_SAFE_RELEASE(e.second->getPipelineDescriptor().programState);
         delete e.second;
     }
+
+    releaseChunks();
+    AX_SAFE_RELEASE(_chunkIndexBuffer);
+    AX_SAFE_RELEASE(_chunkProgramState);
+}
+
+FastTMXLayer::Chunk::~Chunk()
+{
+    AX_SAFE_RELEASE(_vertexBuffer);
+}
+
+Rect FastTMXLayer::calculateCulledRect(const Mat4& transform)
+{
+    auto cam           = Camera::getVisitingCamera();
+    auto zoom          = cam->getZoom();
+    Vec2 s             = _director->getVisibleSize();
+    const Vec2& anchor = getAnchorPoint();
+    auto rect          = Rect(cam->getPositionX() - s.width * zoom * (anchor.x == 0.0f ? 0.5f : anchor.x),
+                              cam->getPositionY() - s.height * zoom * (anchor.y == 0.0f ? 0.5f : anchor.y),
+                              s.width * zoom, s.height * zoom);
+
+    rect.origin.x -= _tileSet->_tileSize.x;
+    rect.origin.y -= _tileSet->_tileSize.y;
+    rect.size.x += s.x * (zoom / 2) / 2 + _tileSet->_tileSize.x * zoom;
+    rect.size.y += s.y * (zoom / 2) / 2 + _tileSet->_tileSize.y * zoom;
+
+    Mat4 inv = transform;
+    inv.inverse();
+    return RectApplyTransform(rect, inv);
 }
 
 void FastTMXLayer::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
 {
+    if (_chunked)
+    {
+        drawChunks(renderer, transform);
+        return;
+    }
+
     updateTotalQuads();
 
     auto cam = Camera::getVisitingCamera();
@@ -137,23 +209,9 @@ void FastTMXLayer::draw(Renderer* renderer, const Mat4& transform, uint32_t flag
         _cameraZoomDirty != cam->getZoom())
     {
         _cameraPositionDirty = cam->getPosition();
-        auto zoom            = _cameraZoomDirty = cam->getZoom();
-        Vec2 s               = _director->getVisibleSize();
-        const Vec2& anchor   = getAnchorPoint();
-        auto rect            = Rect(cam->getPositionX() - s.width * zoom * (anchor.x == 0.0f ? 0.5f : anchor.x),
-                                    cam->getPositionY() - s.height * zoom * (anchor.y == 0.0f ? 0.5f : anchor.y),
-                                    s.width * zoom, s.height * zoom);
-
-        rect.origin.x -= _tileSet->_tileSize.x;
-        rect.origin.y -= _tileSet->_tileSize.y;
-        rect.size.x += s.x * (zoom / 2) / 2 + _tileSet->_tileSize.x * zoom;
-        rect.size.y += s.y * (zoom / 2) / 2 + _tileSet->_tileSize.y * zoom;
-
-        Mat4 inv = transform;
-        inv.inverse();
-        rect = RectApplyTransform(rect, inv);
-
-        updateTiles(rect);
+        _cameraZoomDirty     = cam->getZoom();
+
+        updateTiles(calculateCulledRect(transform));
         updateIndexBuffer();
         updatePrimitives();
         _dirty = false;
@@ -173,7 +231,7 @@ void FastTMXLayer::draw(Renderer* renderer, const Mat4& transform, uint32_t flag
     }
 }
 
-void FastTMXLayer::updateTiles(const Rect& culledRect)
+void FastTMXLayer::getVisibleTileRange(const Rect& culledRect, int& xBegin, int& xEnd, int& yBegin, int& yEnd)
 {
     Rect visibleTiles        = Rect(culledRect.origin, culledRect.size * _director->getContentScaleFactor());
     Vec2 mapTileSize         = AX_SIZE_PIXELS_TO_POINTS(_mapTileSize);
@@ -223,6 +281,17 @@ void FastTMXLayer::updateTiles(const Rect& culledRect)
         // AXASSERT(0, "TMX invalid value");
     }
 
+    yBegin = static_cast<int>(std::max(0.f, visibleTiles.origin.y - tilesOverY));
+    yEnd = static_cast<int>(std::min(_layerSize.height, visibleTiles.origin.y + visibleTiles.size.height + tilesOverY));
+    xBegin = static_cast<int>(std::max(0.f, visibleTiles.origin.x - tilesOverX));
+    xEnd = static_cast<int>(std::min(_layerSize.width, visibleTiles.origin.x + visibleTiles.size.width + tilesOverX));
+}
+
+void FastTMXLayer::updateTiles(const Rect& culledRect)
+{
+    int xBegin, xEnd, yBegin, yEnd;
+    getVisibleTileRange(culledRect, xBegin, xEnd, yBegin, yEnd);
+
     _indicesVertexZNumber.clear();
 
     for (const auto& iter : _indicesVertexZOffsets)
@@ -230,13 +299,6 @@ void FastTMXLayer::updateTiles(const Rect& culledRect)
         _indicesVertexZNumber[iter.first] = iter.second;
     }
 
-    int yBegin = static_cast<int>(std::max(0.f, visibleTiles.origin.y - tilesOverY));
-    int yEnd =
-        static_cast<int>(std::min(_layerSize.height, visibleTiles.origin.y + visibleTiles.size.height + tilesOverY));
-    int xBegin = static_cast<int>(std::max(0.f, visibleTiles.origin.x - tilesOverX));
-    int xEnd =
-        static_cast<int>(std::min(_layerSize.width, visibleTiles.origin.x + visibleTiles.size.width + tilesOverX));
-
     for (int y = yBegin; y < yEnd; ++y)
     {
         for (int x = xBegin; x < xEnd; ++x)
@@ -491,29 +553,144 @@ void FastTMXLayer::setOpacity(uint8_t opacity)
     _quadsDirty = true;
 }
 
+FastTMXLayer::TileQuadParams FastTMXLayer::getTileQuadParams() const
+{
+    TileQuadParams params;
+    params.tileToNode       = _tileToNodeTransform;
+    params.tileSize         = AX_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
+    params.tilesetTileSize  = _tileSet->_tileSize;
+    params.imageSize        = _tileSet->_imageSize;
+    params.firstGid         = _tileSet->_firstGid;
+    params.spacing          = _tileSet->_spacing;
+    params.margin           = _tileSet->_margin;
+    params.automaticVertexZ = _useAutomaticVertexZ;
+    params.vertexZ          = _vertexZvalue;
+    params.orientation      = _layerOrientation;
+    params.layerSize        = _layerSize;
+
+    auto color = Color4B::WHITE;
+    color.a    = getDisplayedOpacity();
+
+    if (_texture->hasPremultipliedAlpha())
+    {
+        auto alpha = color.a / 255.0f;
+        color.r    = static_cast<uint8_t>(color.r * alpha);
+        color.g    = static_cast<uint8_t>(color.g * alpha);
+        color.b    = static_cast<uint8_t>(color.b * alpha);
+    }
+    params.color = color;
+    return params;
+}
+
+void FastTMXLayer::setupTileQuad(V3F_C4B_T2F_Quad& quad,
+                                 const TileQuadParams& params,
+                                 int x,
+                                 int y,
+                                 uint32_t tileGID,
+                                 float z)
+{
+    const Vec2& tileSize = params.tileSize;
+    const Vec2& texSize  = params.imageSize;
+
+    Vec3 nodePos(float(x), float(y), 0);
+    params.tileToNode.transformPoint(&nodePos);
+
+    float left, right, top, bottom;
+
+    // vertices
+    if (tileGID & kTMXTileDiagonalFlag)
+    {
+        left   = nodePos.x;
+        right  = nodePos.x + tileSize.height;
+        bottom = nodePos.y + tileSize.width;
+        top    = nodePos.y;
+    }
+    else
+    {
+        left   = nodePos.x;
+        right  = nodePos.x + tileSize.width;
+        bottom = nodePos.y + tileSize.height;
+        top    = nodePos.y;
+    }
+
+    if (tileGID & kTMXTileVerticalFlag)
+        std::swap(top, bottom);
+    if (tileGID & kTMXTileHorizontalFlag)
+        std::swap(left, right);
+
+    if (tileGID & kTMXTileDiagonalFlag)
+    {
+        // FIXME: not working correctly
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = left;
+        quad.br.vertices.y = top;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = right;
+        quad.tl.vertices.y = bottom;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
+    else
+    {
+        quad.bl.vertices.x = left;
+        quad.bl.vertices.y = bottom;
+        quad.bl.vertices.z = z;
+        quad.br.vertices.x = right;
+        quad.br.vertices.y = bottom;
+        quad.br.vertices.z = z;
+        quad.tl.vertices.x = left;
+        quad.tl.vertices.y = top;
+        quad.tl.vertices.z = z;
+        quad.tr.vertices.x = right;
+        quad.tr.vertices.y = top;
+        quad.tr.vertices.z = z;
+    }
+
+    // texcoords, same rect as TMXTilesetInfo::getRectForGID, which can't be called from a worker
+    uint32_t gid = (tileGID & kTMXFlippedMask) - params.firstGid;
+    int max_x    = (int)((texSize.width - params.margin + params.spacing) / (params.tilesetTileSize.width + params.spacing));
+    Rect tileTexture((gid % max_x) * (params.tilesetTileSize.width + params.spacing) + params.margin,
+                     (gid / max_x) * (params.tilesetTileSize.height + params.spacing) + params.margin,
+                     params.tilesetTileSize.width, params.tilesetTileSize.height);
+    left   = (tileTexture.origin.x / texSize.width);
+    right  = left + (tileTexture.size.width / texSize.width);
+    bottom = (tileTexture.origin.y / texSize.height);
+    top    = bottom + (tileTexture.size.height / texSize.height);
+
+    // issue#1085 OpenGL sub-pixel horizontal-vertical lines pixel-tolerance fix.
+    float ptx = 1.0 / (texSize.x * tileSize.x);
+    float pty = 1.0 / (texSize.y * tileSize.y);
+
+    quad.bl.texCoords.u = left + ptx;
+    quad.bl.texCoords.v = bottom + pty;
+    quad.br.texCoords.u = right - ptx;
+    quad.br.texCoords.v = bottom + pty;
+    quad.tl.texCoords.u = left + ptx;
+    quad.tl.texCoords.v = top - pty;
+    quad.tr.texCoords.u = right - ptx;
+    quad.tr.texCoords.v = top - pty;
+
+    quad.bl.colors = params.color;
+    quad.br.colors = params.color;
+    quad.tl.colors = params.color;
+    quad.tr.colors = params.color;
+}
+
 void FastTMXLayer::updateTotalQuads()
 {
     if (_quadsDirty)
     {
-        Vec2 tileSize = AX_SIZE_PIXELS_TO_POINTS(_tileSet->_tileSize);
-        Vec2 texSize  = _tileSet->_imageSize;
+        auto params = getTileQuadParams();
         _tileToQuadIndex.clear();
         _totalQuads.resize(int(_layerSize.width * _layerSize.height));
         _indices.resize(6 * int(_layerSize.width * _layerSize.height));
         _tileToQuadIndex.resize(int(_layerSize.width * _layerSize.height), -1);
         _indicesVertexZOffsets.clear();
 
-        auto color = Color4B::WHITE;
-        color.a    = getDisplayedOpacity();
-
-        if (_texture->hasPremultipliedAlpha())
-        {
-            auto alpha = color.a / 255.0f;
-            color.r    = static_cast<uint8_t>(color.r * alpha);
-            color.g    = static_cast<uint8_t>(color.g * alpha);
-            color.b    = static_cast<uint8_t>(color.b * alpha);
-        }
-
         int quadIndex = 0;
         for (int y = 0; y < _layerSize.height; ++y)
         {
@@ -527,15 +704,7 @@ void FastTMXLayer::updateTotalQuads()
 
                 _tileToQuadIndex[tileIndex] = quadIndex;
 
-                auto& quad = _totalQuads[quadIndex];
-
-                Vec3 nodePos(float(x), float(y), 0);
-                _tileToNodeTransform.transformPoint(&nodePos);
-
-                float left, right, top, bottom, z;
-
                 int zPos  = getVertexZForPos(Vec2((float)x, (float)y));
-                z         = (float)zPos;
                 auto iter = _indicesVertexZOffsets.find(zPos);
                 if (iter == _indicesVertexZOffsets.end())
                 {
@@ -545,83 +714,8 @@ void FastTMXLayer::updateTotalQuads()
                 {
                     iter->second++;
                 }
-                // vertices
-                if (tileGID & kTMXTileDiagonalFlag)
-                {
-                    left   = nodePos.x;
-                    right  = nodePos.x + tileSize.height;
-                    bottom = nodePos.y + tileSize.width;
-                    top    = nodePos.y;
-                }
-                else
-                {
-                    left   = nodePos.x;
-                    right  = nodePos.x + tileSize.width;
-                    bottom = nodePos.y + tileSize.height;
-                    top    = nodePos.y;
-                }
-
-                if (tileGID & kTMXTileVerticalFlag)
-                    std::swap(top, bottom);
-                if (tileGID & kTMXTileHorizontalFlag)
-                    std::swap(left, right);
-
-                if (tileGID & kTMXTileDiagonalFlag)
-                {
-                    // FIXME: not working correctly
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = left;
-                    quad.br.vertices.y = top;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = right;
-                    quad.tl.vertices.y = bottom;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
-                else
-                {
-                    quad.bl.vertices.x = left;
-                    quad.bl.vertices.y = bottom;
-                    quad.bl.vertices.z = z;
-                    quad.br.vertices.x = right;
-                    quad.br.vertices.y = bottom;
-                    quad.br.vertices.z = z;
-                    quad.tl.vertices.x = left;
-                    quad.tl.vertices.y = top;
-                    quad.tl.vertices.z = z;
-                    quad.tr.vertices.x = right;
-                    quad.tr.vertices.y = top;
-                    quad.tr.vertices.z = z;
-                }
 
-                // texcoords
-                Rect tileTexture = _tileSet->getRectForGID(tileGID);
-                left             = (tileTexture.origin.x / texSize.width);
-                right            = left + (tileTexture.size.width / texSize.width);
-                bottom           = (tileTexture.origin.y / texSize.height);
-                top              = bottom + (tileTexture.size.height / texSize.height);
-
-                // issue#1085 OpenGL sub-pixel horizontal-vertical lines pixel-tolerance fix.
-                float ptx = 1.0 / (_tileSet->_imageSize.x * tileSize.x);
-                float pty = 1.0 / (_tileSet->_imageSize.y * tileSize.y);
-
-                quad.bl.texCoords.u = left + ptx;
-                quad.bl.texCoords.v = bottom + pty;
-                quad.br.texCoords.u = right - ptx;
-                quad.br.texCoords.v = bottom + pty;
-                quad.tl.texCoords.u = left + ptx;
-                quad.tl.texCoords.v = top - pty;
-                quad.tr.texCoords.u = right - ptx;
-                quad.tr.texCoords.v = top - pty;
-
-                quad.bl.colors = color;
-                quad.br.colors = color;
-                quad.tl.colors = color;
-                quad.tr.colors = color;
+                setupTileQuad(_totalQuads[quadIndex], params, x, y, tileGID, (float)zPos);
 
                 ++quadIndex;
             }
@@ -639,6 +733,348 @@ void FastTMXLayer::updateTotalQuads()
     }
 }
 
+void FastTMXLayer::setChunked(bool chunked)
+{
+    if (_chunked == chunked)
+        return;
+    _chunked = chunked;
+
+    if (_chunked)
+    {
+        // the whole layer quads aren't used anymore
+        _totalQuads.clear();
+        _totalQuads.shrink_to_fit();
+        _indices.clear();
+        _indices.shrink_to_fit();
+        _tileToQuadIndex.clear();
+        _tileToQuadIndex.shrink_to_fit();
+        _indicesVertexZOffsets.clear();
+        _indicesVertexZNumber.clear();
+        AX_SAFE_RELEASE_NULL(_vertexBuffer);
+        AX_SAFE_RELEASE_NULL(_indexBuffer);
+        for (auto&& e : _customCommands)
+        {
+            AX_SAFE_RELEASE(e.second->getPipelineDescriptor().programState);
+            delete e.second;
+        }
+        _customCommands.clear();
+        _chunkQueue = std::make_shared<ChunkQueue>();
+    }
+    else
+    {
+        releaseChunks();
+    }
+    _quadsDirty = true;
+    _dirty      = true;
+}
+
+int FastTMXLayer::getResidentChunkCount() const
+{
+    int count = 0;
+    for (auto&& e : _chunks)
+    {
+        if (e.second->_builtVersion != 0)
+            ++count;
+    }
+    return count;
+}
+
+int FastTMXLayer::getLoadingChunkCount() const
+{
+    int count = 0;
+    for (auto&& e : _chunks)
+    {
+        if (e.second->_pendingVersion != 0)
+            ++count;
+    }
+    return count;
+}
+
+void FastTMXLayer::releaseChunks()
+{
+    // builds in flight only hold the queue, their results are dropped with it
+    _chunks.clear();
+    _chunkQueue.reset();
+    _drawnChunkCount = 0;
+}
+
+void FastTMXLayer::buildChunk(const TileQuadParams& params, ChunkData& data)
+{
+    struct TileRef
+    {
+        int z;
+        int x;
+        int y;
+        uint32_t gid;
+    };
+    std::vector<TileRef> tiles;
+    tiles.reserve(data._gids.size());
+    for (int y = 0; y < data._height; ++y)
+    {
+        for (int x = 0; x < data._width; ++x)
+        {
+            uint32_t gid = data._gids[y * data._width + x];
+            if (gid == 0)
+                continue;
+
+            int tileX = data._tileX + x;
+            int tileY = data._tileY + y;
+            int z     = vertexZForTile(params.automaticVertexZ, params.vertexZ, params.orientation, params.layerSize,
+                                       (float)tileX, (float)tileY);
+            tiles.push_back(TileRef{z, tileX, tileY, gid});
+        }
+    }
+
+    // a chunk is a single draw, order the quads by vertexZ like the per vertexZ commands of the default mode
+    if (params.automaticVertexZ)
+        std::stable_sort(tiles.begin(), tiles.end(), [](const TileRef& a, const TileRef& b) { return a.z < b.z; });
+
+    data._quads.resize(tiles.size());
+    for (size_t i = 0; i < tiles.size(); ++i)
+    {
+        setupTileQuad(data._quads[i], params, tiles[i].x, tiles[i].y, tiles[i].gid, (float)tiles[i].z);
+        if (data._runs.empty() || data._runs.back().first != tiles[i].z)
+            data._runs.emplace_back(tiles[i].z, 0);
+        ++data._runs.back().second;
+    }
+}
+
+std::shared_ptr<FastTMXLayer::ChunkData> FastTMXLayer::snapshotChunk(int key, const Chunk& chunk) const
+{
+    auto data      = std::make_shared<ChunkData>();
+    int layerWidth = (int)_layerSize.width;
+    data->_key     = key;
+    data->_tileX   = (key % chunkCountX()) * CHUNK_SIZE;
+    data->_tileY   = (key / chunkCountX()) * CHUNK_SIZE;
+    data->_width   = std::min(CHUNK_SIZE, layerWidth - data->_tileX);
+    data->_height  = std::min(CHUNK_SIZE, (int)_layerSize.height - data->_tileY);
+    data->_version = chunk._version;
+
+    // copied on the game thread, setTileGID may change the tiles while the chunk is built
+    data->_gids.resize(data->_width * data->_height);
+    for (int y = 0; y < data->_height; ++y)
+    {
+        const uint32_t* row = _tiles + (data->_tileY + y) * layerWidth + data->_tileX;
+        std::copy(row, row + data->_width, data->_gids.begin() + y * data->_width);
+    }
+    return data;
+}
+
+void FastTMXLayer::installChunk(Chunk& chunk, const ChunkData& data)
+{
+    chunk._builtVersion = data._version;
+    chunk._quadCount    = static_cast<int>(data._quads.size());
+    if (chunk._quadCount != 0)
+    {
+        auto size = sizeof(V3F_C4B_T2F_Quad) * data._quads.size();
+        if (!chunk._vertexBuffer || chunk._vertexBuffer->getSize() < size)
+        {
+            AX_SAFE_RELEASE(chunk._vertexBuffer);
+            chunk._vertexBuffer = backend::Device::getInstance()->newBuffer(size, backend::BufferType::VERTEX,
+                                                                            backend::BufferUsage::STATIC);
+        }
+        chunk._vertexBuffer->updateData(data._quads.data(), size);
+    }
+
+    // one command per vertexZ, the quads are sorted by vertexZ so each draws a range of the shared indices
+    chunk._runs.resize(data._runs.size());
+    int offset = 0;
+    for (size_t i = 0; i < data._runs.size(); ++i)
+    {
+        auto& run = chunk._runs[i];
+        if (!run)
+        {
+            run = std::make_unique<ChunkRun>();
+            run->_command.setIndexBuffer(_chunkIndexBuffer, CustomCommand::IndexFormat::U_SHORT);
+            run->_command.getPipelineDescriptor().programState = _chunkProgramState;
+        }
+        run->_vertexZ = data._runs[i].first;
+        run->_command.setVertexBuffer(chunk._vertexBuffer);
+        run->_command.setIndexDrawInfo(offset * 6, data._runs[i].second * 6);
+        offset += data._runs[i].second;
+    }
+}
+
+void FastTMXLayer::uploadFinishedChunks()
+{
+    std::vector<std::shared_ptr<ChunkData>> finished;
+    {
+        std::lock_guard<std::mutex> lk(_chunkQueue->_mutex);
+        auto& queue = _chunkQueue->_finished;
+        auto count  = std::min(queue.size(), static_cast<size_t>(MAX_CHUNK_UPLOADS_PER_FRAME));
+        finished.assign(queue.begin(), queue.begin() + count);
+        queue.erase(queue.begin(), queue.begin() + count);
+    }
+
+    for (auto&& data : finished)
+    {
+        auto it = _chunks.find(data->_key);
+        // the chunk was evicted meanwhile
+        if (it == _chunks.end())
+            continue;
+
+        auto& chunk = *it->second;
+        if (chunk._pendingVersion == data->_version)
+            chunk._pendingVersion = 0;
+        // its tiles changed meanwhile, or it was built on the game thread already
+        if (data->_version != chunk._version || data->_version == chunk._builtVersion)
+            continue;
+        installChunk(chunk, *data);
+    }
+}
+
+void FastTMXLayer::drawChunks(Renderer* renderer, const Mat4& transform)
+{
+    _drawnChunkCount = 0;
+
+    if (!_chunkIndexBuffer)
+    {
+        // the quads of a chunk are all drawn, so one index buffer serves all the chunks
+        std::vector<unsigned short> indices(CHUNK_SIZE * CHUNK_SIZE * 6);
+        for (int i = 0; i < CHUNK_SIZE * CHUNK_SIZE; ++i)
+        {
+            indices[i * 6 + 0] = static_cast<unsigned short>(i * 4 + 0);
+            indices[i * 6 + 1] = static_cast<unsigned short>(i * 4 + 1);
+            indices[i * 6 + 2] = static_cast<unsigned short>(i * 4 + 2);
+            indices[i * 6 + 3] = static_cast<unsigned short>(i * 4 + 3);
+            indices[i * 6 + 4] = static_cast<unsigned short>(i * 4 + 2);
+            indices[i * 6 + 5] = static_cast<unsigned short>(i * 4 + 1);
+        }
+        auto size         = sizeof(unsigned short) * indices.size();
+        _chunkIndexBuffer = backend::Device::getInstance()->newBuffer(size, backend::BufferType::INDEX,
+                                                                      backend::BufferUsage::STATIC);
+        _chunkIndexBuffer->updateData(indices.data(), size);
+    }
+
+    if (!_chunkProgramState)
+    {
+        auto programType = _useAutomaticVertexZ ? backend::ProgramType::POSITION_TEXTURE_COLOR_ALPHA_TEST
+                                                : backend::ProgramType::POSITION_TEXTURE_COLOR;
+        _chunkProgramState = new backend::ProgramState(backend::Program::getBuiltinProgram(programType));
+        if (_useAutomaticVertexZ)
+        {
+            _alphaValueLocation = _chunkProgramState->getUniformLocation("u_alpha_value");
+            _chunkProgramState->setUniform(_alphaValueLocation, &_alphaFuncValue, sizeof(_alphaFuncValue));
+        }
+        _mvpMatrixLocaiton = _chunkProgramState->getUniformLocation("u_MVPMatrix");
+        _textureLocation   = _chunkProgramState->getUniformLocation("u_tex0");
+        _chunkProgramState->setTexture(_textureLocation, 0, _texture->getBackendTexture());
+    }
+
+    if (_quadsDirty)
+    {
+        // the opacity or the whole tiles changed
+        for (auto&& e : _chunks)
+            e.second->_version = ++_chunkVersion;
+        _quadsDirty = false;
+    }
+
+    uploadFinishedChunks();
+
+    int xBegin, xEnd, yBegin, yEnd;
+    getVisibleTileRange(calculateCulledRect(transform), xBegin, xEnd, yBegin, yEnd);
+    if (xBegin >= xEnd || yBegin >= yEnd)
+        return;
+
+    const int visibleX0 = xBegin / CHUNK_SIZE;
+    const int visibleX1 = (xEnd - 1) / CHUNK_SIZE;
+    const int visibleY0 = yBegin / CHUNK_SIZE;
+    const int visibleY1 = (yEnd - 1) / CHUNK_SIZE;
+    const int countX    = chunkCountX();
+    const int countY    = chunkCountY();
+    const int residentX0 = std::max(visibleX0 - _chunkMargin, 0);
+    const int residentX1 = std::min(visibleX1 + _chunkMargin, countX - 1);
+    const int residentY0 = std::max(visibleY0 - _chunkMargin, 0);
+    const int residentY1 = std::min(visibleY1 + _chunkMargin, countY - 1);
+
+    // evict with one more chunk of slack, so moving back and forth over a chunk border doesn't rebuild it
+    for (auto it = _chunks.begin(); it != _chunks.end();)
+    {
+        int cx = it->first % countX;
+        int cy = it->first / countX;
+        if (cx < residentX0 - 1 || cx > residentX1 + 1 || cy < residentY0 - 1 || cy > residentY1 + 1)
+            it = _chunks.erase(it);
+        else
+            ++it;
+    }
+
+    auto blendfunc =
+        _texture->hasPremultipliedAlpha() ? BlendFunc::ALPHA_PREMULTIPLIED : BlendFunc::ALPHA_NON_PREMULTIPLIED;
+    auto params = getTileQuadParams();
+    std::vector<std::pair<int, int>> requests;  // distance to the visible chunks, key
+    for (int cy = residentY0; cy <= residentY1; ++cy)
+    {
+        for (int cx = residentX0; cx <= residentX1; ++cx)
+        {
+            int key     = cy * countX + cx;
+            auto& chunk = _chunks[key];
+            if (!chunk)
+            {
+                chunk.reset(new Chunk());
+                chunk->_version = ++_chunkVersion;
+            }
+
+            if (chunk->_version == chunk->_builtVersion)
+                continue;
+
+            bool visible = cx >= visibleX0 && cx <= visibleX1 && cy >= visibleY0 && cy <= visibleY1;
+            if (visible && chunk->_builtVersion == 0)
+            {
+                // nothing to show in its place, build it right away
+                auto data = snapshotChunk(key, *chunk);
+                buildChunk(params, *data);
+                installChunk(*chunk, *data);
+                continue;
+            }
+            if (chunk->_version == chunk->_pendingVersion)
+                continue;
+
+            int distance = std::max({visibleX0 - cx, cx - visibleX1, visibleY0 - cy, cy - visibleY1, 0});
+            requests.emplace_back(distance, key);
+        }
+    }
+
+    std::sort(requests.begin(), requests.end());
+    for (auto&& request : requests)
+    {
+        auto& chunk           = *_chunks[request.second];
+        auto data             = snapshotChunk(request.second, chunk);
+        chunk._pendingVersion = chunk._version;
+        JobSystem::getInstance()->enqueue([queue = _chunkQueue, params, data]() {
+            buildChunk(params, *data);
+            std::lock_guard<std::mutex> lk(queue->_mutex);
+            queue->_finished.emplace_back(data);
+        });
+    }
+
+    const auto& projectionMat = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    Mat4 finalMat             = projectionMat * _modelViewTransform;
+    _chunkProgramState->setUniform(_mvpMatrixLocaiton, finalMat.m, sizeof(finalMat.m));
+
+    // the tiles of neighbor chunks overlap, so the runs are drawn in the vertexZ order of the whole layer rather
+    // than chunk by chunk, chunks keep the row-major order within a vertexZ
+    std::vector<ChunkRun*> runs;
+    for (int cy = visibleY0; cy <= visibleY1; ++cy)
+    {
+        for (int cx = visibleX0; cx <= visibleX1; ++cx)
+        {
+            auto& chunk = *_chunks[cy * countX + cx];
+            if (chunk._quadCount == 0)
+                continue;
+            for (auto&& run : chunk._runs)
+                runs.push_back(run.get());
+            ++_drawnChunkCount;
+        }
+    }
+    std::stable_sort(runs.begin(), runs.end(),
+                     [](const ChunkRun* a, const ChunkRun* b) { return a->_vertexZ < b->_vertexZ; });
+    for (auto&& run : runs)
+    {
+        run->_command.init(_globalZOrder, blendfunc);
+        renderer->addCommand(&run->_command);
+    }
+}
+
 // removing / getting tiles
 Sprite* FastTMXLayer::getTileAt(const Vec2& tileCoordinate)
 {
@@ -718,33 +1154,7 @@ Vec2 FastTMXLayer::getPositionAt(const Vec2& pos)
 
 int FastTMXLayer::getVertexZForPos(const Vec2& pos)
 {
-    int ret    = 0;
-    int maxVal = 0;
-    if (_useAutomaticVertexZ)
-    {
-        switch (_layerOrientation)
-        {
-        case FAST_TMX_ORIENTATION_ISO:
-            maxVal = static_cast<int>(_layerSize.width + _layerSize.height);
-            ret    = static_cast<int>(-(maxVal - (pos.x + pos.y)));
-            break;
-        case FAST_TMX_ORIENTATION_ORTHO:
-            ret = static_cast<int>(-(_layerSize.height - pos.y));
-            break;
-        case FAST_TMX_ORIENTATION_HEX:
-            AXASSERT(0, "TMX Hexa vertexZ not supported");
-            break;
-        default:
-            AXASSERT(0, "TMX invalid value");
-            break;
-        }
-    }
-    else
-    {
-        ret = _vertexZvalue;
-    }
-
-    return ret;
+    return vertexZForTile(_useAutomaticVertexZ, _vertexZvalue, _layerOrientation, _layerSize, pos.x, pos.y);
 }
 
 void FastTMXLayer::removeTileAt(const Vec2& tileCoordinate)
@@ -777,9 +1187,31 @@ void FastTMXLayer::setFlaggedTileGIDByIndex(int index, uint32_t gid)
 {
     if (gid == _tiles[index])
         return;
+
+    if (_tilesSource)
+    {
+        // the tiles are read only in place, the layer owns a copy from now on
+        size_t size = static_cast<size_t>(_layerSize.width * _layerSize.height) * sizeof(uint32_t);
+        auto tiles  = static_cast<uint32_t*>(malloc(size));
+        memcpy(tiles, _tiles, size);
+        _tiles = tiles;
+        AX_SAFE_RELEASE_NULL(_tilesSource);
+    }
     _tiles[index] = gid;
-    _quadsDirty   = true;
-    _dirty        = true;
+
+    if (_chunked)
+    {
+        // only the chunk holding the tile is rebuilt
+        int layerWidth = (int)_layerSize.width;
+        int key        = (index / layerWidth / CHUNK_SIZE) * chunkCountX() + (index % layerWidth) / CHUNK_SIZE;
+        auto it        = _chunks.find(key);
+        if (it != _chunks.end())
+            it->second->_version = ++_chunkVersion;
+        return;
+    }
+
+    _quadsDirty = true;
+    _dirty      = true;
 }
 
 void FastTMXLayer::removeChild(Node* node, bool cleanup)
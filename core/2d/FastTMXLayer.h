@@ -29,6 +29,8 @@ THE SOFTWARE.
 #pragma once
 
 #include <unordered_map>
+#include <memory>
+#include <mutex>
 #include "2d/Node.h"
 #include "2d/TMXXMLParser.h"
 #include "renderer/CustomCommand.h"
@@ -211,6 +213,7 @@ public:
      */
     void setTiles(uint32_t* tiles)
     {
+        AX_SAFE_RELEASE_NULL(_tilesSource);
         _tiles      = tiles;
         _quadsDirty = true;
     };
@@ -297,13 +300,102 @@ public:
 
     TMXTileAnimManager* getTileAnimManager() const { return _tileAnimManager; }
 
+    /** Tiles per side of a chunk in the chunked mode. */
+    static const int CHUNK_SIZE = 32;
+
+    /** Enables the chunked mode, meant for very large layers.
+     * The layer is split to CHUNK_SIZE x CHUNK_SIZE tile chunks with their own prebuilt vertex buffer, only the chunks
+     * around the viewport are kept resident and culling is done per chunk instead of rebuilding the index buffer of
+     * the whole layer when the camera moves. Chunks entering the margin are built on the JobSystem, a visible chunk
+     * without any data yet is built immediately. With the automatic vertexZ, a chunk draws once per vertexZ so the
+     * tiles overlapping the neighbor chunks keep the order of the whole layer.
+     *
+     * @param chunked Whether the chunked mode is enabled, false by default.
+     */
+    void setChunked(bool chunked);
+    bool isChunked() const { return _chunked; }
+
+    /** Sets how many chunks around the visible ones are kept resident and prefetched, 1 by default. */
+    void setChunkMargin(int margin) { _chunkMargin = std::max(margin, 0); }
+    int getChunkMargin() const { return _chunkMargin; }
+
+    /** Gets the number of chunks with data on the GPU in the chunked mode. */
+    int getResidentChunkCount() const;
+    /** Gets the number of chunks being built on a worker in the chunked mode. */
+    int getLoadingChunkCount() const;
+    /** Gets the number of chunks drawn in the last frame in the chunked mode. */
+    int getDrawnChunkCount() const { return _drawnChunkCount; }
+
     bool initWithTilesetInfo(TMXTilesetInfo* tilesetInfo,
                                                      TMXLayerInfo* layerInfo,
                                                      TMXMapInfo* mapInfo);
 
 protected:
+    /* what a worker needs to build the quads of tiles, copied from the layer and its tileset */
+    struct TileQuadParams
+    {
+        Mat4 tileToNode;
+        Vec2 tileSize;
+        Vec2 tilesetTileSize;
+        Vec2 imageSize;
+        int firstGid;
+        int spacing;
+        int margin;
+        Color4B color;
+        bool automaticVertexZ;
+        int vertexZ;
+        int orientation;
+        Vec2 layerSize;
+    };
+
+    /* the quads of a chunk sharing a vertexZ, the runs of all the chunks are drawn in vertexZ order */
+    struct ChunkRun
+    {
+        int _vertexZ = 0;
+        CustomCommand _command;
+    };
+
+    struct Chunk
+    {
+        Chunk() = default;
+        Chunk(const Chunk&) = delete;
+        ~Chunk();
+        backend::Buffer* _vertexBuffer = nullptr;
+        int _quadCount                 = 0;
+        /* taken from _chunkVersion on every change of its tiles, the data on the GPU is current when _builtVersion
+         * matches it */
+        uint32_t _version        = 0;
+        uint32_t _builtVersion   = 0;
+        uint32_t _pendingVersion = 0;
+        std::vector<std::unique_ptr<ChunkRun>> _runs;
+    };
+
+    /* the tiles of a chunk and the quads built from them on a worker */
+    struct ChunkData
+    {
+        int _key;
+        int _tileX;
+        int _tileY;
+        int _width;
+        int _height;
+        uint32_t _version;
+        std::vector<uint32_t> _gids;
+        std::vector<V3F_C4B_T2F_Quad> _quads;
+        /* vertexZ and quad count, in the order of the quads */
+        std::vector<std::pair<int, int>> _runs;
+    };
+
+    /* finished chunk builds, shared with the jobs so a build may outlive the layer */
+    struct ChunkQueue
+    {
+        std::mutex _mutex;
+        std::vector<std::shared_ptr<ChunkData>> _finished;
+    };
+
     virtual void setOpacity(uint8_t opacity) override;
 
+    Rect calculateCulledRect(const Mat4& transform);
+    void getVisibleTileRange(const Rect& culledRect, int& xBegin, int& xEnd, int& yBegin, int& yEnd);
     void updateTiles(const Rect& culledRect);
     Vec2 calculateLayerOffset(const Vec2& offset);
 
@@ -327,6 +419,18 @@ protected:
     void updateIndexBuffer();
     void updatePrimitives();
 
+    TileQuadParams getTileQuadParams() const;
+    static void setupTileQuad(V3F_C4B_T2F_Quad& quad, const TileQuadParams& params, int x, int y, uint32_t gid, float z);
+    static void buildChunk(const TileQuadParams& params, ChunkData& data);
+
+    void drawChunks(Renderer* renderer, const Mat4& transform);
+    std::shared_ptr<ChunkData> snapshotChunk(int key, const Chunk& chunk) const;
+    void installChunk(Chunk& chunk, const ChunkData& data);
+    void uploadFinishedChunks();
+    void releaseChunks();
+    int chunkCountX() const { return ((int)_layerSize.width + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+    int chunkCountY() const { return ((int)_layerSize.height + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+
     //! name of the layer
     std::string _layerName;
 
@@ -336,6 +440,8 @@ protected:
     Vec2 _mapTileSize;
     /** pointer to the map of tiles */
     uint32_t* _tiles = nullptr;
+    /** holds _tiles while they are read in place from a compiled map, they are copied on the first change */
+    Ref* _tilesSource = nullptr;
     /** Tileset information for the layer */
     TMXTilesetInfo* _tileSet = nullptr;
     /** Layer orientation, which is the same as the map orientation */
@@ -389,6 +495,16 @@ protected:
     backend::UniformLocation _mvpMatrixLocaiton;
     backend::UniformLocation _textureLocation;
     backend::UniformLocation _alphaValueLocation;
+
+    bool _chunked    = false;
+    int _chunkMargin = 1;
+    std::unordered_map<int, std::unique_ptr<Chunk>> _chunks;
+    /* layer wide, so a chunk evicted and created again never takes the builds of its previous instance */
+    uint32_t _chunkVersion = 0;
+    std::shared_ptr<ChunkQueue> _chunkQueue;
+    backend::Buffer* _chunkIndexBuffer        = nullptr;
+    backend::ProgramState* _chunkProgramState = nullptr;
+    int _drawnChunkCount                      = 0;
 };
 
 /** @brief TMXTileAnimTask represents the frame-tick task of an animated tile.
@@ -27,6 +27,7 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "2d/FastTMXTiledMap.h"
 #include "2d/FastTMXLayer.h"
+#include "2d/TMXBinaryMap.h"
 #include "base/UTF8.h"
 
 NS_AX_BEGIN
@@ -57,6 +58,18 @@ FastTMXTiledMap* FastTMXTiledMap::createWithXML(std::string_view tmxString, std:
     return nullptr;
 }
 
+FastTMXTiledMap* FastTMXTiledMap::createWithBinaryFile(std::string_view binaryFile, std::string_view resourcePath)
+{
+    FastTMXTiledMap* ret = new FastTMXTiledMap();
+    if (ret->initWithBinaryFile(binaryFile, resourcePath))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    AX_SAFE_DELETE(ret);
+    return nullptr;
+}
+
 bool FastTMXTiledMap::initWithTMXFile(std::string_view tmxFile)
 {
     AXASSERT(tmxFile.size() > 0, "FastTMXTiledMap: tmx file should not be empty");
@@ -89,9 +102,36 @@ bool FastTMXTiledMap::initWithXML(std::string_view tmxString, std::string_view r
     return true;
 }
 
+bool FastTMXTiledMap::initWithBinaryFile(std::string_view binaryFile, std::string_view resourcePath)
+{
+    AXASSERT(binaryFile.size() > 0, "FastTMXTiledMap: binary file should not be empty");
+
+    setContentSize(Vec2::ZERO);
+
+    auto binaryMap = TMXBinaryMap::create(binaryFile);
+    if (!binaryMap)
+    {
+        return false;
+    }
+    AX_SAFE_RELEASE(_binaryMap);
+    _binaryMap = binaryMap;
+    _binaryMap->retain();
+
+    TMXMapInfo* mapInfo = _binaryMap->createMapInfo(resourcePath);
+    AXASSERT(!mapInfo->getTilesets().empty(), "FastTMXTiledMap: Map has no tileset.");
+    buildWithMapInfo(mapInfo);
+
+    _tmxFile = binaryFile;
+
+    return true;
+}
+
 FastTMXTiledMap::FastTMXTiledMap() : _mapSize(Vec2::ZERO), _tileSize(Vec2::ZERO) {}
 
-FastTMXTiledMap::~FastTMXTiledMap() {}
+FastTMXTiledMap::~FastTMXTiledMap()
+{
+    AX_SAFE_RELEASE(_binaryMap);
+}
 
 // private
 FastTMXLayer* FastTMXTiledMap::parseLayer(TMXLayerInfo* layerInfo, TMXMapInfo* mapInfo)
@@ -114,6 +154,12 @@ TMXTilesetInfo* FastTMXTiledMap::tilesetForLayer(TMXLayerInfo* layerInfo, TMXMap
     Vec2 size      = layerInfo->_layerSize;
     auto& tilesets = mapInfo->getTilesets();
 
+    // resolved when the map was compiled
+    if (layerInfo->_tilesetIndex >= 0 && layerInfo->_tilesetIndex < static_cast<int>(tilesets.size()))
+    {
+        return tilesets.at(layerInfo->_tilesetIndex);
+    }
+
     for (auto iter = tilesets.crbegin(), iterCrend = tilesets.crend(); iter != iterCrend; ++iter)
     {
         TMXTilesetInfo* tilesetInfo = *iter;
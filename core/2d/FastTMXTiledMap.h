@@ -35,6 +35,7 @@ NS_AX_BEGIN
 class TMXLayerInfo;
 class TMXTilesetInfo;
 class TMXMapInfo;
+class TMXBinaryMap;
 class FastTMXLayer;
 /**
  * @addtogroup _2d
@@ -111,6 +112,15 @@ public:
      */
     static FastTMXTiledMap* createWithXML(std::string_view tmxString, std::string_view resourcePath);
 
+    /** Creates a TMX Tiled Map with a map compiled by TMXBinaryCompiler.
+     * The file is mapped in memory instead of parsed.
+     *
+     * @param binaryFile A .tmxb file.
+     * @param resourcePath A path to the tileset images, next to the .tmxb file if empty.
+     * @return An autorelease object.
+     */
+    static FastTMXTiledMap* createWithBinaryFile(std::string_view binaryFile, std::string_view resourcePath = "");
+
     /** Return the FastTMXLayer for the specific layer.
      *
      * @return Return the FastTMXLayer for the specific layer.
@@ -209,6 +219,9 @@ public:
 
     std::string_view getResourceFile() const { return _tmxFile; }
 
+    /** Gets the compiled map the map was created with, to read its tables in place, null for a TMX map. */
+    TMXBinaryMap* getBinaryMap() const { return _binaryMap; }
+
     /**
      * @js ctor
      */
@@ -225,6 +238,9 @@ public:
     /** initializes a TMX Tiled Map with a TMX formatted XML string and a path to TMX resources */
     bool initWithXML(std::string_view tmxString, std::string_view resourcePath);
 
+    /** initializes a TMX Tiled Map with a map compiled by TMXBinaryCompiler */
+    bool initWithBinaryFile(std::string_view binaryFile, std::string_view resourcePath = "");
+
 protected:
     FastTMXLayer* parseLayer(TMXLayerInfo* layerInfo, TMXMapInfo* mapInfo);
     TMXTilesetInfo* tilesetForLayer(TMXLayerInfo* layerInfo, TMXMapInfo* mapInfo);
@@ -248,6 +264,9 @@ protected:
 
     std::string _tmxFile;
 
+    /** the mapped compiled map, its layers and object groups read from it */
+    TMXBinaryMap* _binaryMap = nullptr;
+
 private:
     AX_DISALLOW_COPY_AND_ASSIGN(FastTMXTiledMap);
 };
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "2d/Scene.h"
 #include "base/Director.h"
 #include "2d/Camera.h"
+#include "3d/SceneBVH.h"
 #include "base/EventDispatcher.h"
 #include "base/EventListenerCustom.h"
 #include "base/UTF8.h"
@@ -73,6 +74,7 @@ Scene::~Scene()
 #endif
     _director->getEventDispatcher()->removeEventListener(_event);
     AX_SAFE_RELEASE(_event);
+    AX_SAFE_RELEASE(_sceneBVH);
 
 #if AX_USE_PHYSICS
     delete _physicsWorld;
@@ -213,8 +215,13 @@ void Scene::render(Renderer* renderer, const Mat4& eyeTransform, const Mat4* eye
         camera->apply();
         // clear background with max depth
         camera->clearBackground();
+        // cull the renderers of the scene for this camera, they check it while visited
+        if (_sceneBVH)
+            _sceneBVH->cull(camera);
+        SceneBVH::setVisitingTree(_sceneBVH);
         // visit the scene
         visit(renderer, transform, 0);
+        SceneBVH::setVisitingTree(nullptr);
 #if AX_USE_NAVMESH
         if (_navMesh && _navMeshDebugCamera == camera)
         {
@@ -258,6 +265,23 @@ void Scene::render(Renderer* renderer, const Mat4& eyeTransform, const Mat4* eye
     Camera::_visitingCamera = nullptr;
 }
 
+void Scene::setHierarchicalCulling(bool enabled)
+{
+    if (enabled == (_sceneBVH != nullptr))
+        return;
+
+    if (enabled)
+    {
+        // renderers insert themselves the next time they're visited
+        _sceneBVH = new SceneBVH();
+    }
+    else
+    {
+        // renderers still holding a proxy keep the tree alive until they're removed or visited again
+        AX_SAFE_RELEASE_NULL(_sceneBVH);
+    }
+}
+
 void Scene::removeAllChildren()
 {
     if (_defaultCamera)
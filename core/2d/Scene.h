@@ -40,6 +40,7 @@ class BaseLight;
 class Renderer;
 class EventListenerCustom;
 class EventCustom;
+class SceneBVH;
 #if AX_USE_PHYSICS
 class PhysicsWorld;
 #endif
@@ -126,6 +127,17 @@ public:
 
     void setCameraOrderDirty() { _cameraOrderDirty = true; }
 
+    /**
+     * Enables culling MeshRenderers and BillBoards with a BVH over their world AABBs, it's off by default.
+     * Each camera culls the tree before visiting the scene, so culled renderers skip their visit entirely
+     * unless they moved. Worth it for scenes with many 3d objects of which few are visible at once.
+     */
+    void setHierarchicalCulling(bool enabled);
+    bool isHierarchicalCulling() const { return _sceneBVH != nullptr; }
+
+    /** Gets the BVH used for hierarchical culling, nullptr if it's disabled. */
+    SceneBVH* getSceneBVH() const { return _sceneBVH; }
+
     void onProjectionChanged(EventCustom* event);
 
 private:
@@ -150,6 +162,8 @@ protected:
 
     std::vector<BaseLight*> _lights;
 
+    SceneBVH* _sceneBVH = nullptr;
+
 private:
     AX_DISALLOW_COPY_AND_ASSIGN(Scene);
 
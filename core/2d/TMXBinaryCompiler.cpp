@@ -0,0 +1,365 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/TMXBinaryCompiler.h"
+#include "2d/TMXBinaryMap.h"
+#include "2d/TMXXMLParser.h"
+#include "base/Director.h"
+#include "platform/FileUtils.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+NS_AX_BEGIN
+
+namespace
+{
+class TMXBinaryWriter
+{
+public:
+    TMXBinaryWriter() { _strings.push_back('\0'); }
+
+    uint32_t addString(std::string_view str)
+    {
+        auto it = _stringOffsets.find(std::string{str});
+        if (it != _stringOffsets.end())
+            return it->second;
+
+        auto offset = static_cast<uint32_t>(_strings.size());
+        _strings.append(str);
+        _strings.push_back('\0');
+        _stringOffsets.emplace(std::string{str}, offset);
+        return offset;
+    }
+
+    uint32_t addOptionalString(const Value& value) { return value.isNull() ? TMXB_NO_STRING : addString(value.asString()); }
+
+    TMXBinaryRange addProperties(const ValueMap& properties)
+    {
+        // sorted so compiling the same map gives the same file
+        std::vector<std::string_view> names;
+        names.reserve(properties.size());
+        for (auto&& property : properties)
+            names.emplace_back(property.first);
+        std::sort(names.begin(), names.end());
+
+        TMXBinaryRange range{static_cast<uint32_t>(_properties.size()), static_cast<uint32_t>(names.size())};
+        for (auto&& name : names)
+            _properties.push_back(TMXBinaryProperty{addString(name), addString(properties.at(name).asString())});
+        return range;
+    }
+
+    void addTileset(TMXTilesetInfo* info, std::string_view resourceDir)
+    {
+        std::string_view image = info->_sourceImage;
+        if (!resourceDir.empty() && image.starts_with(resourceDir))
+            image.remove_prefix(resourceDir.size());
+        else
+            AXLOG("warning: TMXBinaryCompiler: tileset image %s isn't under %s", info->_sourceImage.c_str(),
+                  resourceDir.data());
+
+        TMXBinaryTileset tileset{};
+        tileset.name        = addString(info->_name);
+        tileset.image       = addString(image);
+        tileset.originImage = addString(info->_originSourceImage);
+        tileset.firstGid    = info->_firstGid;
+        tileset.tileWidth   = info->_tileSize.width;
+        tileset.tileHeight  = info->_tileSize.height;
+        tileset.spacing     = info->_spacing;
+        tileset.margin      = info->_margin;
+        tileset.offsetX     = info->_tileOffset.x;
+        tileset.offsetY     = info->_tileOffset.y;
+
+        std::vector<uint32_t> gids;
+        for (auto&& animation : info->_animationInfo)
+            gids.push_back(animation.first);
+        std::sort(gids.begin(), gids.end());
+
+        tileset.animations = {static_cast<uint32_t>(_animations.size()), static_cast<uint32_t>(gids.size())};
+        for (auto gid : gids)
+        {
+            auto& frames = info->_animationInfo.at(gid)->_frames;
+            _animations.push_back(TMXBinaryAnimation{
+                gid, TMXBinaryRange{static_cast<uint32_t>(_frames.size()), static_cast<uint32_t>(frames.size())}});
+            for (auto&& frame : frames)
+                _frames.push_back(TMXBinaryFrame{frame._tileID, frame._duration});
+        }
+        _tilesets.push_back(tileset);
+    }
+
+    void addLayer(TMXLayerInfo* info, const Vector<TMXTilesetInfo*>& tilesets)
+    {
+        TMXBinaryLayer layer{};
+        layer.name       = addString(info->_name);
+        layer.width      = static_cast<uint32_t>(info->_layerSize.width);
+        layer.height     = static_cast<uint32_t>(info->_layerSize.height);
+        layer.offsetX    = info->_offset.x;
+        layer.offsetY    = info->_offset.y;
+        layer.opacity    = info->_opacity;
+        layer.visible    = info->_visible ? 1 : 0;
+        layer.properties = addProperties(info->getProperties());
+
+        // same choice as FastTMXTiledMap::tilesetForLayer: the last tileset starting at or below a gid of the layer
+        size_t count     = static_cast<size_t>(layer.width) * layer.height;
+        uint32_t maxGid  = 0;
+        for (size_t i = 0; i < count; ++i)
+            maxGid = std::max(maxGid, info->_tiles[i] & kTMXFlippedMask);
+        layer.tileset = -1;
+        for (int i = static_cast<int>(tilesets.size()) - 1; maxGid != 0 && i >= 0; --i)
+        {
+            if (maxGid >= static_cast<uint32_t>(tilesets.at(i)->_firstGid))
+            {
+                layer.tileset = i;
+                break;
+            }
+        }
+
+        _layers.push_back(layer);
+        _layerTiles.push_back(info->_tiles);
+    }
+
+    void addObjectGroup(TMXObjectGroup* objectGroup)
+    {
+        const float scale = AX_CONTENT_SCALE_FACTOR();
+
+        TMXBinaryObjectGroup group{};
+        group.name       = addString(objectGroup->getGroupName());
+        group.offsetX    = objectGroup->getPositionOffset().x;
+        group.offsetY    = objectGroup->getPositionOffset().y;
+        group.properties = addProperties(objectGroup->getProperties());
+
+        auto& values = objectGroup->getObjects();
+        group.objects = {static_cast<uint32_t>(_objects.size()), static_cast<uint32_t>(values.size())};
+        for (auto&& value : values)
+        {
+            auto& dict = value.asValueMap();
+            TMXBinaryObject object{};
+            object.name = TMXB_NO_STRING;
+            object.type = TMXB_NO_STRING;
+
+            // the keys set by the TMX parser become fields, anything else is a property
+            ValueMap properties;
+            for (auto&& entry : dict)
+            {
+                std::string_view key = entry.first;
+                const Value& v       = entry.second;
+                if (key == "name")
+                    object.name = addOptionalString(v);
+                else if (key == "type")
+                    object.type = addOptionalString(v);
+                else if (key == "id")
+                {
+                    if (!v.isNull())
+                    {
+                        object.id = v.asUnsignedInt();
+                        object.flags |= TMXBinaryObject::HAS_ID;
+                    }
+                }
+                else if (key == "gid")
+                {
+                    if (!v.isNull())
+                    {
+                        object.gid = v.asUnsignedInt();
+                        object.flags |= TMXBinaryObject::HAS_GID;
+                    }
+                }
+                // the parser converted these to points
+                else if (key == "x")
+                    object.x = v.asFloat() * scale;
+                else if (key == "y")
+                    object.y = v.asFloat() * scale;
+                else if (key == "width")
+                    object.width = v.asFloat() * scale;
+                else if (key == "height")
+                    object.height = v.asFloat() * scale;
+                else if (key == "rotation")
+                    object.rotation = v.asFloat();
+                else if ((key == "points" || key == "polylinePoints") && v.getType() == Value::Type::VECTOR)
+                {
+                    object.flags |= key == "points" ? TMXBinaryObject::POLYGON : TMXBinaryObject::POLYLINE;
+                    auto& points  = v.asValueVector();
+                    object.points = {static_cast<uint32_t>(_points.size()), static_cast<uint32_t>(points.size())};
+                    for (auto&& point : points)
+                    {
+                        auto& pointDict = point.asValueMap();
+                        auto x          = pointDict.find("x");
+                        auto y          = pointDict.find("y");
+                        _points.push_back(TMXBinaryPoint{x != pointDict.end() ? x->second.asInt() : 0,
+                                                         y != pointDict.end() ? y->second.asInt() : 0});
+                    }
+                }
+                else
+                    properties.emplace(key, v);
+            }
+            object.properties = addProperties(properties);
+            _objects.push_back(object);
+        }
+        _objectGroups.push_back(group);
+    }
+
+    void addTileProperties(const ValueMapIntKey& tileProperties)
+    {
+        std::vector<int> gids;
+        for (auto&& tile : tileProperties)
+        {
+            if (tile.second.getType() == Value::Type::MAP)
+                gids.push_back(tile.first);
+        }
+        std::sort(gids.begin(), gids.end());
+        for (auto gid : gids)
+        {
+            _tileProperties.push_back(
+                TMXBinaryTileProperties{static_cast<uint32_t>(gid), addProperties(tileProperties.at(gid).asValueMap())});
+        }
+    }
+
+    std::vector<uint8_t> finish(TMXMapInfo* mapInfo)
+    {
+        TMXBinaryHeader header{};
+        memcpy(header.magic, TMXB_MAGIC, sizeof(TMXB_MAGIC));
+        header.version       = TMXB_VERSION;
+        header.orientation   = mapInfo->getOrientation();
+        header.staggerAxis   = mapInfo->getStaggerAxis();
+        header.staggerIndex  = mapInfo->getStaggerIndex();
+        header.hexSideLength = mapInfo->getHexSideLength();
+        header.mapWidth      = mapInfo->getMapSize().width;
+        header.mapHeight     = mapInfo->getMapSize().height;
+        header.tileWidth     = mapInfo->getTileSize().width;
+        header.tileHeight    = mapInfo->getTileSize().height;
+        header.properties    = addProperties(mapInfo->getProperties());
+
+        // lay out the tables, then the strings and the gids of the layers
+        size_t offset = sizeof(TMXBinaryHeader);
+        auto place    = [&](TMXBinaryTable table, size_t count, size_t recordSize) {
+            header.tables[static_cast<size_t>(table)] = {static_cast<uint32_t>(offset), static_cast<uint32_t>(count)};
+            offset += count * recordSize;
+        };
+        place(TMXBinaryTable::TILESETS, _tilesets.size(), sizeof(TMXBinaryTileset));
+        place(TMXBinaryTable::ANIMATIONS, _animations.size(), sizeof(TMXBinaryAnimation));
+        place(TMXBinaryTable::FRAMES, _frames.size(), sizeof(TMXBinaryFrame));
+        place(TMXBinaryTable::LAYERS, _layers.size(), sizeof(TMXBinaryLayer));
+        place(TMXBinaryTable::OBJECT_GROUPS, _objectGroups.size(), sizeof(TMXBinaryObjectGroup));
+        place(TMXBinaryTable::OBJECTS, _objects.size(), sizeof(TMXBinaryObject));
+        place(TMXBinaryTable::POINTS, _points.size(), sizeof(TMXBinaryPoint));
+        place(TMXBinaryTable::PROPERTIES, _properties.size(), sizeof(TMXBinaryProperty));
+        place(TMXBinaryTable::TILE_PROPERTIES, _tileProperties.size(), sizeof(TMXBinaryTileProperties));
+
+        header.stringsOffset = static_cast<uint32_t>(offset);
+        header.stringsSize   = static_cast<uint32_t>(_strings.size());
+        offset += _strings.size();
+
+        for (auto&& layer : _layers)
+        {
+            offset            = (offset + 15) & ~size_t(15);
+            layer.tilesOffset = static_cast<uint32_t>(offset);
+            offset += static_cast<size_t>(layer.width) * layer.height * sizeof(uint32_t);
+        }
+        header.fileSize = static_cast<uint32_t>(offset);
+
+        std::vector<uint8_t> bytes(offset, 0);
+        auto write = [&](size_t at, const void* data, size_t size) {
+            if (size)
+                memcpy(bytes.data() + at, data, size);
+        };
+        auto writeTable = [&](TMXBinaryTable table, const auto& records) {
+            write(header.tables[static_cast<size_t>(table)].offset, records.data(),
+                  records.size() * sizeof(records[0]));
+        };
+        write(0, &header, sizeof(header));
+        writeTable(TMXBinaryTable::TILESETS, _tilesets);
+        writeTable(TMXBinaryTable::ANIMATIONS, _animations);
+        writeTable(TMXBinaryTable::FRAMES, _frames);
+        writeTable(TMXBinaryTable::LAYERS, _layers);
+        writeTable(TMXBinaryTable::OBJECT_GROUPS, _objectGroups);
+        writeTable(TMXBinaryTable::OBJECTS, _objects);
+        writeTable(TMXBinaryTable::POINTS, _points);
+        writeTable(TMXBinaryTable::PROPERTIES, _properties);
+        writeTable(TMXBinaryTable::TILE_PROPERTIES, _tileProperties);
+        write(header.stringsOffset, _strings.data(), _strings.size());
+        for (size_t i = 0; i < _layers.size(); ++i)
+        {
+            write(_layers[i].tilesOffset, _layerTiles[i],
+                  static_cast<size_t>(_layers[i].width) * _layers[i].height * sizeof(uint32_t));
+        }
+        return bytes;
+    }
+
+private:
+    std::vector<TMXBinaryTileset> _tilesets;
+    std::vector<TMXBinaryAnimation> _animations;
+    std::vector<TMXBinaryFrame> _frames;
+    std::vector<TMXBinaryLayer> _layers;
+    std::vector<const uint32_t*> _layerTiles;
+    std::vector<TMXBinaryObjectGroup> _objectGroups;
+    std::vector<TMXBinaryObject> _objects;
+    std::vector<TMXBinaryPoint> _points;
+    std::vector<TMXBinaryProperty> _properties;
+    std::vector<TMXBinaryTileProperties> _tileProperties;
+    std::string _strings;
+    std::unordered_map<std::string, uint32_t> _stringOffsets;
+};
+}  // namespace
+
+bool TMXBinaryCompiler::compile(std::string_view tmxFile, std::string_view outputFile)
+{
+    auto mapInfo = TMXMapInfo::create(tmxFile);
+    if (!mapInfo)
+    {
+        AXLOG("warning: TMXBinaryCompiler: failed to parse %s", tmxFile.data());
+        return false;
+    }
+
+    std::string_view fullPath = mapInfo->getTMXFileName();
+    return compile(mapInfo, fullPath.substr(0, fullPath.find_last_of('/') + 1), outputFile);
+}
+
+bool TMXBinaryCompiler::compile(TMXMapInfo* mapInfo, std::string_view resourceDir, std::string_view outputFile)
+{
+    TMXBinaryWriter writer;
+    for (auto&& tileset : mapInfo->getTilesets())
+        writer.addTileset(tileset, resourceDir);
+    for (auto&& layer : mapInfo->getLayers())
+    {
+        if (!layer->_tiles)
+        {
+            AXLOG("warning: TMXBinaryCompiler: layer %s has no tile data", layer->_name.c_str());
+            return false;
+        }
+        writer.addLayer(layer, mapInfo->getTilesets());
+    }
+    for (auto&& objectGroup : mapInfo->getObjectGroups())
+        writer.addObjectGroup(objectGroup);
+    writer.addTileProperties(mapInfo->getTileProperties());
+
+    auto bytes = writer.finish(mapInfo);
+    if (!FileUtils::writeBinaryToFile(bytes.data(), bytes.size(), outputFile))
+    {
+        AXLOG("warning: TMXBinaryCompiler: failed to write %s", outputFile.data());
+        return false;
+    }
+    return true;
+}
+
+NS_AX_END
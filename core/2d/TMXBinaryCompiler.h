@@ -0,0 +1,66 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <string_view>
+
+#include "platform/PlatformMacros.h"
+
+NS_AX_BEGIN
+
+class TMXMapInfo;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ * @class TMXBinaryCompiler
+ * @brief Compiles TMX maps to the .tmxb format loaded by FastTMXTiledMap::createWithBinaryFile.
+ *
+ * Meant to run offline, i.e. from a desktop build as an asset step: the map is parsed once with TMXMapInfo,
+ * external tilesets are inlined, the layer gids are stored decoded and the objects are flattened.
+ * Tileset images are stored relative to the TMX file, so the .tmxb is meant to be shipped next to the images.
+ */
+class AX_DLL TMXBinaryCompiler
+{
+public:
+    /** Compiles a TMX file, returns false if it can't be parsed or the output can't be written. */
+    static bool compile(std::string_view tmxFile, std::string_view outputFile);
+
+    /**
+     * Compiles a parsed map.
+     *
+     * @param mapInfo The parsed map.
+     * @param resourceDir The directory tileset images are made relative to, with a trailing slash.
+     * @param outputFile The full path of the .tmxb file to write.
+     */
+    static bool compile(TMXMapInfo* mapInfo, std::string_view resourceDir, std::string_view outputFile);
+};
+
+// end of _2d group
+/// @}
+
+NS_AX_END
@@ -0,0 +1,317 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/TMXBinaryMap.h"
+#include "2d/TMXXMLParser.h"
+#include "base/Director.h"
+#include "platform/FileUtils.h"
+#include "mio/mio.hpp"
+
+NS_AX_BEGIN
+
+namespace
+{
+const size_t TABLE_RECORD_SIZES[] = {
+    sizeof(TMXBinaryTileset), sizeof(TMXBinaryAnimation),   sizeof(TMXBinaryFrame),
+    sizeof(TMXBinaryLayer),   sizeof(TMXBinaryObjectGroup), sizeof(TMXBinaryObject),
+    sizeof(TMXBinaryPoint),   sizeof(TMXBinaryProperty),    sizeof(TMXBinaryTileProperties),
+};
+static_assert(sizeof(TABLE_RECORD_SIZES) / sizeof(TABLE_RECORD_SIZES[0]) == static_cast<size_t>(TMXBinaryTable::COUNT),
+              "a record size is missing");
+}  // namespace
+
+TMXBinaryMap* TMXBinaryMap::create(std::string_view file)
+{
+    auto ret = new TMXBinaryMap();
+    if (ret->initWithFile(file))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    AX_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+TMXBinaryMap::TMXBinaryMap() {}
+
+TMXBinaryMap::~TMXBinaryMap() {}
+
+bool TMXBinaryMap::initWithFile(std::string_view file)
+{
+    auto fileUtils = FileUtils::getInstance();
+    _fullPath      = fileUtils->fullPathForFilename(file);
+    if (_fullPath.empty())
+    {
+        AXLOG("warning: TMXBinaryMap: file not found: %s", file.data());
+        return false;
+    }
+
+    size_t size = 0;
+    if (fileUtils->isAbsolutePath(_fullPath))
+    {
+        std::error_code error;
+        auto mapping = std::make_shared<mio::mmap_source>();
+        mapping->map(_fullPath, error);
+        if (!error && mapping->size() > 0)
+        {
+            _bytes   = reinterpret_cast<const uint8_t*>(mapping->data());
+            size     = mapping->size();
+            _mapping = std::move(mapping);
+        }
+    }
+    if (!_mapping)
+    {
+        // i.e. inside an android apk
+        _data  = fileUtils->getDataFromFile(_fullPath);
+        _bytes = _data.getBytes();
+        size   = static_cast<size_t>(_data.getSize());
+    }
+
+    if (!validate(size))
+    {
+        AXLOG("warning: TMXBinaryMap: invalid or incompatible file: %s", _fullPath.c_str());
+        _mapping.reset();
+        _data.clear();
+        _bytes  = nullptr;
+        _header = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool TMXBinaryMap::validate(size_t size)
+{
+    if (!_bytes || size < sizeof(TMXBinaryHeader) || reinterpret_cast<uintptr_t>(_bytes) % alignof(TMXBinaryHeader))
+        return false;
+
+    _header = reinterpret_cast<const TMXBinaryHeader*>(_bytes);
+    if (memcmp(_header->magic, TMXB_MAGIC, sizeof(TMXB_MAGIC)) != 0 || _header->version != TMXB_VERSION ||
+        _header->fileSize > size)
+        return false;
+    size = _header->fileSize;
+
+    for (size_t i = 0; i < static_cast<size_t>(TMXBinaryTable::COUNT); ++i)
+    {
+        auto& section = _header->tables[i];
+        if (section.offset % 4 != 0 ||
+            section.offset + static_cast<uint64_t>(section.count) * TABLE_RECORD_SIZES[i] > size)
+            return false;
+    }
+    if (_header->stringsSize == 0 || _header->stringsOffset + static_cast<uint64_t>(_header->stringsSize) > size ||
+        _bytes[_header->stringsOffset + _header->stringsSize - 1] != '\0')
+        return false;
+    _strings = reinterpret_cast<const char*>(_bytes + _header->stringsOffset);
+
+    // every reference is checked here once, so the accessors don't have to
+    auto validRange = [this](TMXBinaryTable table, const TMXBinaryRange& range) {
+        return range.first + static_cast<uint64_t>(range.count) <= _header->tables[static_cast<size_t>(table)].count;
+    };
+    auto validString = [this](uint32_t offset) {
+        return offset == TMXB_NO_STRING || offset < _header->stringsSize;
+    };
+
+    for (auto&& property : getTable<TMXBinaryProperty>(TMXBinaryTable::PROPERTIES))
+    {
+        if (!validString(property.name) || !validString(property.value))
+            return false;
+    }
+    if (!validRange(TMXBinaryTable::PROPERTIES, _header->properties))
+        return false;
+    for (auto&& tileset : getTilesets())
+    {
+        if (!validString(tileset.name) || !validString(tileset.image) || !validString(tileset.originImage) ||
+            !validRange(TMXBinaryTable::ANIMATIONS, tileset.animations))
+            return false;
+    }
+    for (auto&& animation : getTable<TMXBinaryAnimation>(TMXBinaryTable::ANIMATIONS))
+    {
+        if (!validRange(TMXBinaryTable::FRAMES, animation.frames))
+            return false;
+    }
+    const auto tilesetCount = static_cast<int32_t>(getTilesets().size());
+    for (auto&& layer : getLayers())
+    {
+        if (!validString(layer.name) || !validRange(TMXBinaryTable::PROPERTIES, layer.properties) ||
+            layer.tileset >= tilesetCount || layer.tilesOffset % 4 != 0 ||
+            layer.tilesOffset + static_cast<uint64_t>(layer.width) * layer.height * sizeof(uint32_t) > size)
+            return false;
+    }
+    for (auto&& group : getObjectGroups())
+    {
+        if (!validString(group.name) || !validRange(TMXBinaryTable::PROPERTIES, group.properties) ||
+            !validRange(TMXBinaryTable::OBJECTS, group.objects))
+            return false;
+    }
+    for (auto&& object : getTable<TMXBinaryObject>(TMXBinaryTable::OBJECTS))
+    {
+        if (!validString(object.name) || !validString(object.type) ||
+            !validRange(TMXBinaryTable::PROPERTIES, object.properties) ||
+            !validRange(TMXBinaryTable::POINTS, object.points))
+            return false;
+    }
+    for (auto&& tile : getTileProperties())
+    {
+        if (!validRange(TMXBinaryTable::PROPERTIES, tile.properties))
+            return false;
+    }
+    return true;
+}
+
+void TMXBinaryMap::fillProperties(const TMXBinaryRange& range, ValueMap& properties) const
+{
+    for (auto&& property : getProperties(range))
+        properties[std::string{getString(property.name)}] = Value(std::string{getString(property.value)});
+}
+
+TMXMapInfo* TMXBinaryMap::createMapInfo(std::string_view resourcePath)
+{
+    auto mapInfo = new TMXMapInfo();
+    mapInfo->autorelease();
+    mapInfo->setTMXFileName(_fullPath);
+    mapInfo->setOrientation(_header->orientation);
+    mapInfo->setStaggerAxis(_header->staggerAxis);
+    mapInfo->setStaggerIndex(_header->staggerIndex);
+    mapInfo->setHexSideLength(_header->hexSideLength);
+    mapInfo->setMapSize(Vec2(_header->mapWidth, _header->mapHeight));
+    mapInfo->setTileSize(Vec2(_header->tileWidth, _header->tileHeight));
+    fillProperties(_header->properties, mapInfo->getProperties());
+
+    std::string dir = resourcePath.empty() ? _fullPath.substr(0, _fullPath.find_last_of('/') + 1)
+                                           : std::string{resourcePath} + "/";
+    for (auto&& tileset : getTilesets())
+    {
+        auto info                = new TMXTilesetInfo();
+        info->_name              = getString(tileset.name);
+        info->_firstGid          = tileset.firstGid;
+        info->_tileSize          = Vec2(tileset.tileWidth, tileset.tileHeight);
+        info->_spacing           = tileset.spacing;
+        info->_margin            = tileset.margin;
+        info->_tileOffset        = Vec2(tileset.offsetX, tileset.offsetY);
+        info->_sourceImage       = dir + std::string{getString(tileset.image)};
+        info->_originSourceImage = getString(tileset.originImage);
+
+        for (auto&& animation : getAnimations(tileset))
+        {
+            auto animInfo = TMXTileAnimInfo::create(animation.gid);
+            for (auto&& frame : getFrames(animation))
+                animInfo->_frames.emplace_back(TMXTileAnimFrame(frame.tileID, frame.duration));
+            info->_animationInfo.insert(animation.gid, animInfo);
+        }
+
+        mapInfo->getTilesets().pushBack(info);
+        info->release();
+    }
+
+    for (auto&& layer : getLayers())
+    {
+        auto info           = new TMXLayerInfo();
+        info->_name         = getString(layer.name);
+        info->_layerSize    = Vec2(static_cast<float>(layer.width), static_cast<float>(layer.height));
+        info->_visible      = layer.visible != 0;
+        info->_opacity      = layer.opacity;
+        info->_offset       = Vec2(layer.offsetX, layer.offsetY);
+        info->_tilesetIndex = layer.tileset;
+        fillProperties(layer.properties, info->getProperties());
+
+        // read in place, FastTMXLayer copies them before its first change since the mapping is read only
+        info->_tiles       = const_cast<uint32_t*>(getTiles(layer));
+        info->_ownTiles    = false;
+        info->_tilesSource = this;
+        retain();
+
+        mapInfo->getLayers().pushBack(info);
+        info->release();
+    }
+
+    auto& tileProperties = mapInfo->getTileProperties();
+    for (auto&& tile : getTileProperties())
+    {
+        ValueMap properties;
+        fillProperties(tile.properties, properties);
+        tileProperties[tile.gid] = Value(std::move(properties));
+    }
+
+    auto groups = getObjectGroups();
+    for (size_t i = 0; i < groups.size(); ++i)
+    {
+        auto objectGroup = new TMXObjectGroup();
+        objectGroup->setGroupName(getString(groups[i].name));
+        objectGroup->setPositionOffset(Vec2(groups[i].offsetX, groups[i].offsetY));
+        fillProperties(groups[i].properties, objectGroup->getProperties());
+
+        // the objects are built from the mapping when first used, see fillObjects
+        objectGroup->_binaryMap        = this;
+        objectGroup->_binaryGroupIndex = static_cast<uint32_t>(i);
+        retain();
+
+        mapInfo->getObjectGroups().pushBack(objectGroup);
+        objectGroup->release();
+    }
+
+    return mapInfo;
+}
+
+void TMXBinaryMap::fillObjects(const TMXBinaryObjectGroup& group, ValueVector& objects) const
+{
+    auto binaryObjects = getObjects(group);
+    objects.reserve(objects.size() + binaryObjects.size());
+    for (auto&& object : binaryObjects)
+    {
+        // the same keys the TMX parser sets, with its attributes kept as strings
+        ValueMap dict;
+        dict["name"] = object.name == TMXB_NO_STRING ? Value() : Value(std::string{getString(object.name)});
+        dict["type"] = object.type == TMXB_NO_STRING ? Value() : Value(std::string{getString(object.type)});
+        dict["id"]   = (object.flags & TMXBinaryObject::HAS_ID) ? Value(std::to_string(object.id)) : Value();
+        dict["gid"]  = (object.flags & TMXBinaryObject::HAS_GID) ? Value(std::to_string(object.gid)) : Value();
+
+        Vec2 p           = AX_POINT_PIXELS_TO_POINTS(Vec2(object.x, object.y));
+        Vec2 s           = AX_SIZE_PIXELS_TO_POINTS(Vec2(object.width, object.height));
+        dict["x"]        = Value(p.x);
+        dict["y"]        = Value(p.y);
+        dict["width"]    = Value(s.width);
+        dict["height"]   = Value(s.height);
+        dict["rotation"] = Value(static_cast<double>(object.rotation));
+
+        if (object.flags & (TMXBinaryObject::POLYGON | TMXBinaryObject::POLYLINE))
+        {
+            ValueVector pointsArray;
+            pointsArray.reserve(object.points.count);
+            for (auto&& point : getPoints(object))
+            {
+                ValueMap pointDict;
+                pointDict["x"] = Value(point.x);
+                pointDict["y"] = Value(point.y);
+                pointsArray.emplace_back(Value(std::move(pointDict)));
+            }
+            dict[(object.flags & TMXBinaryObject::POLYGON) ? "points" : "polylinePoints"] =
+                Value(std::move(pointsArray));
+        }
+
+        // properties last, they override the keys above like in the TMX parser
+        fillProperties(object.properties, dict);
+        objects.emplace_back(Value(std::move(dict)));
+    }
+}
+
+NS_AX_END
@@ -0,0 +1,301 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <span>
+#include <memory>
+
+#include "base/Ref.h"
+#include "base/Data.h"
+#include "base/Value.h"
+
+NS_AX_BEGIN
+
+class TMXMapInfo;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/*
+ * The compiled tilemap format (.tmxb), written by TMXBinaryCompiler and read by TMXBinaryMap.
+ *
+ * A header followed by tables of the flat structs below, all little endian and 4 bytes aligned, so a mapped
+ * file is used in place. Records refer to each other with TMXBinaryRange indices into the tables, and to strings
+ * with offsets into a blob of null terminated strings. The gids of a layer are a raw array, like a decoded TMX layer.
+ */
+static const char TMXB_MAGIC[4]      = {'T', 'M', 'X', 'B'};
+static const uint32_t TMXB_VERSION   = 1;
+static const uint32_t TMXB_NO_STRING = 0xffffffff;
+
+enum class TMXBinaryTable : uint32_t
+{
+    TILESETS,
+    ANIMATIONS,
+    FRAMES,
+    LAYERS,
+    OBJECT_GROUPS,
+    OBJECTS,
+    POINTS,
+    PROPERTIES,
+    TILE_PROPERTIES,
+    COUNT
+};
+
+struct TMXBinaryRange
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+struct TMXBinarySection
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+struct TMXBinaryHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t fileSize;
+    int32_t orientation;
+    int32_t staggerAxis;
+    int32_t staggerIndex;
+    int32_t hexSideLength;
+    float mapWidth;
+    float mapHeight;
+    float tileWidth;
+    float tileHeight;
+    TMXBinaryRange properties;
+    TMXBinarySection tables[static_cast<size_t>(TMXBinaryTable::COUNT)];
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+/* a property, values are kept as strings like in the TMX file */
+struct TMXBinaryProperty
+{
+    uint32_t name;
+    uint32_t value;
+};
+
+struct TMXBinaryTileProperties
+{
+    uint32_t gid;
+    TMXBinaryRange properties;
+};
+
+struct TMXBinaryFrame
+{
+    uint32_t tileID;
+    float duration;
+};
+
+struct TMXBinaryAnimation
+{
+    uint32_t gid;
+    TMXBinaryRange frames;
+};
+
+/* an embedded or external tileset, its image path is relative to the map file */
+struct TMXBinaryTileset
+{
+    uint32_t name;
+    uint32_t image;
+    uint32_t originImage;
+    int32_t firstGid;
+    float tileWidth;
+    float tileHeight;
+    int32_t spacing;
+    int32_t margin;
+    float offsetX;
+    float offsetY;
+    TMXBinaryRange animations;
+};
+
+struct TMXBinaryLayer
+{
+    uint32_t name;
+    uint32_t width;
+    uint32_t height;
+    uint32_t tilesOffset;  // file offset of width * height gids
+    int32_t tileset;       // index of the tileset the layer uses, -1 if it has no tiles
+    float offsetX;
+    float offsetY;
+    uint8_t opacity;
+    uint8_t visible;
+    uint8_t padding[2];
+    TMXBinaryRange properties;
+};
+
+struct TMXBinaryObjectGroup
+{
+    uint32_t name;
+    float offsetX;
+    float offsetY;
+    TMXBinaryRange properties;
+    TMXBinaryRange objects;
+};
+
+/* an object, positions and sizes are in pixels */
+struct TMXBinaryObject
+{
+    enum Flags : uint32_t
+    {
+        HAS_ID   = 1 << 0,
+        HAS_GID  = 1 << 1,
+        POLYGON  = 1 << 2,
+        POLYLINE = 1 << 3,
+    };
+
+    uint32_t name;
+    uint32_t type;
+    uint32_t id;
+    uint32_t gid;
+    uint32_t flags;
+    float x;
+    float y;
+    float width;
+    float height;
+    float rotation;
+    TMXBinaryRange properties;
+    TMXBinaryRange points;
+};
+
+struct TMXBinaryPoint
+{
+    int32_t x;
+    int32_t y;
+};
+
+/**
+ * @class TMXBinaryMap
+ * @brief A compiled tilemap, mapped in memory and validated once.
+ *
+ * The tables are read in place, so game code can walk the objects of a big map without building any Value.
+ * createMapInfo() builds the TMXMapInfo FastTMXTiledMap consumes, which keeps the map alive: the layers read their
+ * gids in place until they change one, the object groups build their objects on first use.
+ */
+class AX_DLL TMXBinaryMap : public Ref
+{
+public:
+    /** Maps and validates a .tmxb file, returns nullptr if it's missing, truncated or of another version. */
+    static TMXBinaryMap* create(std::string_view file);
+
+    TMXBinaryMap();
+    virtual ~TMXBinaryMap();
+
+    bool initWithFile(std::string_view file);
+
+    const TMXBinaryHeader& getHeader() const { return *_header; }
+
+    std::span<const TMXBinaryTileset> getTilesets() const { return getTable<TMXBinaryTileset>(TMXBinaryTable::TILESETS); }
+    std::span<const TMXBinaryLayer> getLayers() const { return getTable<TMXBinaryLayer>(TMXBinaryTable::LAYERS); }
+    std::span<const TMXBinaryObjectGroup> getObjectGroups() const
+    {
+        return getTable<TMXBinaryObjectGroup>(TMXBinaryTable::OBJECT_GROUPS);
+    }
+    std::span<const TMXBinaryTileProperties> getTileProperties() const
+    {
+        return getTable<TMXBinaryTileProperties>(TMXBinaryTable::TILE_PROPERTIES);
+    }
+
+    std::span<const TMXBinaryAnimation> getAnimations(const TMXBinaryTileset& tileset) const
+    {
+        return getRange<TMXBinaryAnimation>(TMXBinaryTable::ANIMATIONS, tileset.animations);
+    }
+    std::span<const TMXBinaryFrame> getFrames(const TMXBinaryAnimation& animation) const
+    {
+        return getRange<TMXBinaryFrame>(TMXBinaryTable::FRAMES, animation.frames);
+    }
+    std::span<const TMXBinaryObject> getObjects(const TMXBinaryObjectGroup& group) const
+    {
+        return getRange<TMXBinaryObject>(TMXBinaryTable::OBJECTS, group.objects);
+    }
+    std::span<const TMXBinaryPoint> getPoints(const TMXBinaryObject& object) const
+    {
+        return getRange<TMXBinaryPoint>(TMXBinaryTable::POINTS, object.points);
+    }
+    std::span<const TMXBinaryProperty> getProperties(const TMXBinaryRange& range) const
+    {
+        return getRange<TMXBinaryProperty>(TMXBinaryTable::PROPERTIES, range);
+    }
+
+    /** Gets the width * height gids of a layer, in place in the file. */
+    const uint32_t* getTiles(const TMXBinaryLayer& layer) const
+    {
+        return reinterpret_cast<const uint32_t*>(_bytes + layer.tilesOffset);
+    }
+
+    /** Gets a string by its offset, TMXB_NO_STRING gives an empty string. */
+    std::string_view getString(uint32_t offset) const
+    {
+        return offset == TMXB_NO_STRING ? std::string_view{} : std::string_view{_strings + offset};
+    }
+
+    /**
+     * Builds the map info of FastTMXTiledMap.
+     *
+     * @param resourcePath Where tileset images are looked up, next to the .tmxb file if empty.
+     */
+    TMXMapInfo* createMapInfo(std::string_view resourcePath = "");
+
+    /** Builds the objects of a group with the same keys and value types as the TMX parser. */
+    void fillObjects(const TMXBinaryObjectGroup& group, ValueVector& objects) const;
+
+    std::string_view getFilePath() const { return _fullPath; }
+
+private:
+    template <typename T>
+    std::span<const T> getTable(TMXBinaryTable table) const
+    {
+        auto& section = _header->tables[static_cast<size_t>(table)];
+        return {reinterpret_cast<const T*>(_bytes + section.offset), section.count};
+    }
+
+    template <typename T>
+    std::span<const T> getRange(TMXBinaryTable table, const TMXBinaryRange& range) const
+    {
+        return getTable<T>(table).subspan(range.first, range.count);
+    }
+
+    bool validate(size_t size);
+    void fillProperties(const TMXBinaryRange& range, ValueMap& properties) const;
+
+    std::string _fullPath;
+    std::shared_ptr<const void> _mapping;  // the mapped file, or _data where it can't be mapped
+    Data _data;
+    const uint8_t* _bytes          = nullptr;
+    const TMXBinaryHeader* _header = nullptr;
+    const char* _strings           = nullptr;
+};
+
+// end of _2d group
+/// @}
+
+NS_AX_END
@@ -27,6 +27,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 THE SOFTWARE.
 ****************************************************************************/
 #include "2d/TMXObjectGroup.h"
+#include "2d/TMXBinaryMap.h"
 #include "base/Macros.h"
 
 NS_AX_BEGIN
@@ -38,10 +39,27 @@ TMXObjectGroup::TMXObjectGroup() : _groupName("") {}
 TMXObjectGroup::~TMXObjectGroup()
 {
     AXLOGINFO("deallocing TMXObjectGroup: %p", this);
+    AX_SAFE_RELEASE(_binaryMap);
+}
+
+void TMXObjectGroup::setObjects(const ValueVector& objects)
+{
+    AX_SAFE_RELEASE_NULL(_binaryMap);
+    _objects = objects;
+}
+
+void TMXObjectGroup::loadObjects() const
+{
+    if (!_binaryMap)
+        return;
+
+    _binaryMap->fillObjects(_binaryMap->getObjectGroups()[_binaryGroupIndex], _objects);
+    AX_SAFE_RELEASE_NULL(_binaryMap);
 }
 
 ValueMap TMXObjectGroup::getObject(std::string_view objectName) const
 {
+    loadObjects();
     if (!_objects.empty())
     {
         for (const auto& v : _objects)
@@ -35,6 +35,8 @@ THE SOFTWARE.
 
 NS_AX_BEGIN
 
+class TMXBinaryMap;
+
 /**
  * @addtogroup _2d
  * @{
@@ -112,16 +114,30 @@ public:
      *
      * @return The array of the objects.
      */
-    const ValueVector& getObjects() const { return _objects; }
-    ValueVector& getObjects() { return _objects; }
+    const ValueVector& getObjects() const
+    {
+        loadObjects();
+        return _objects;
+    }
+    ValueVector& getObjects()
+    {
+        loadObjects();
+        return _objects;
+    }
 
     /** Sets the array of the objects.
      *
      * @param objects The array of the objects.
      */
-    void setObjects(const ValueVector& objects) { _objects = objects; }
+    void setObjects(const ValueVector& objects);
 
 protected:
+    friend class TMXBinaryMap;
+
+    /* builds the objects of a compiled map on first use */
+    void loadObjects() const;
+
+
     /** name of the group */
     std::string _groupName;
     /** offset position of child objects */
@@ -129,7 +145,10 @@ protected:
     /** list of properties stored in a dictionary */
     ValueMap _properties;
     /** array of the objects */
-    ValueVector _objects;
+    mutable ValueVector _objects;
+    /** the compiled map the objects are read from until they are first used */
+    mutable TMXBinaryMap* _binaryMap = nullptr;
+    uint32_t _binaryGroupIndex       = 0;
 };
 
 // end of tilemap_parallax_nodes group
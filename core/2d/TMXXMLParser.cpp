@@ -42,16 +42,19 @@ THE SOFTWARE.
 NS_AX_BEGIN
 
 // implementation TMXLayerInfo
-TMXLayerInfo::TMXLayerInfo() : _name(""), _tiles(nullptr), _ownTiles(true) {}
+TMXLayerInfo::TMXLayerInfo()
+    : _name(""), _tiles(nullptr), _ownTiles(true), _tilesetIndex(-1), _tilesSource(nullptr)
+{}
 
 TMXLayerInfo::~TMXLayerInfo()
 {
     AXLOGINFO("deallocing TMXLayerInfo: %p", this);
-    if (_ownTiles && _tiles)
+    if (_ownTiles && _tiles && !_tilesSource)
     {
         free(_tiles);
         _tiles = nullptr;
     }
+    AX_SAFE_RELEASE(_tilesSource);
 }
 
 ValueMap& TMXLayerInfo::getProperties()
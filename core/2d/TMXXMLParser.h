@@ -202,6 +202,10 @@ public:
     unsigned char _opacity;
     bool _ownTiles;
     Vec2 _offset;
+    /** index of the tileset used by the layer when known in advance, i.e. from a compiled map, -1 otherwise */
+    int _tilesetIndex;
+    /** retained holder of _tiles when they are read in place, i.e. a mapped compiled map, null otherwise */
+    Ref* _tilesSource;
 };
 
 /** @brief TMXTilesetInfo contains the information about the tilesets like:
@@ -25,6 +25,7 @@
 
 #include "3d/Animate3D.h"
 #include "3d/MeshRenderer.h"
+#include "3d/SkeletalAnimationStage.h"
 #include "3d/Skeleton3D.h"
 #include "platform/FileUtils.h"
 #include "base/Configuration.h"
@@ -226,8 +227,14 @@ void Animate3D::startWithTarget(Node* target)
         {
             AXLOG("warning: no animation found for the skeleton");
         }
+
+        buildBoneTracks();
     }
 
+    _clipCursor = -1;
+    for (auto&& track : _boneTracks)
+        track.cursors[0] = track.cursors[1] = track.cursors[2] = -1;
+
     auto runningAction = s_runningAnimates.find(target);
     if (runningAction != s_runningAnimates.end())
     {
@@ -270,6 +277,89 @@ void Animate3D::startWithTarget(Node* target)
     }
 }
 
+void Animate3D::buildBoneTracks()
+{
+    _boneTracks.clear();
+    _clipBones.clear();
+
+    auto clip = _animation ? _animation->getSharedKeyClip() : nullptr;
+    if (clip && !_boneCurves.empty())
+    {
+        std::unordered_map<const Animation3D::Curve*, Bone3D*> boneByCurve;
+        for (const auto& it : _boneCurves)
+            boneByCurve.emplace(it.second, it.first);
+
+        _clipBones.resize(clip->boneNames.size(), nullptr);
+        for (size_t i = 0; i < clip->boneNames.size(); ++i)
+        {
+            auto it = boneByCurve.find(_animation->getBoneCurveByName(clip->boneNames[i]));
+            if (it != boneByCurve.end())
+                _clipBones[i] = it->second;
+        }
+        return;
+    }
+
+    _boneTracks.reserve(_boneCurves.size());
+    for (const auto& it : _boneCurves)
+        _boneTracks.emplace_back(BoneTrack{it.first, it.second, {-1, -1, -1}});
+}
+
+void Animate3D::evaluateBones(float t, float weight)
+{
+    float transDst[3], rotDst[4], scaleDst[3];
+    float *trans = nullptr, *rot = nullptr, *scale = nullptr;
+
+    if (!_clipBones.empty())
+    {
+        // all bones share the key times, interpolate them together
+        auto clip           = _animation->getSharedKeyClip();
+        const size_t stride = clip->stride;
+        _clipValues.resize(10 * stride);
+        float* translations = _clipValues.data();
+        float* rotations    = translations + 3 * stride;
+        float* scales       = rotations + 4 * stride;
+        clip->evaluate(t, _clipCursor, _translateEvaluate, _roteEvaluate, _scaleEvaluate, translations,
+                       rotations, scales);
+
+        for (size_t i = 0, count = _clipBones.size(); i < count; ++i)
+        {
+            if (auto bone = _clipBones[i])
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    transDst[c] = translations[c * stride + i];
+                    scaleDst[c] = scales[c * stride + i];
+                }
+                for (int c = 0; c < 4; ++c)
+                    rotDst[c] = rotations[c * stride + i];
+                bone->setAnimationValue(transDst, rotDst, scaleDst, this, weight);
+            }
+        }
+    }
+
+    for (auto&& track : _boneTracks)
+    {
+        auto curve = track.curve;
+        trans = rot = scale = nullptr;
+        if (curve->translateCurve)
+        {
+            curve->translateCurve->evaluate(t, transDst, _translateEvaluate, track.cursors[0]);
+            trans = &transDst[0];
+        }
+        if (curve->rotCurve)
+        {
+            curve->rotCurve->evaluate(t, rotDst, _roteEvaluate, track.cursors[1]);
+            rot = &rotDst[0];
+        }
+        if (curve->scaleCurve)
+        {
+            curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate, track.cursors[2]);
+            scale = &scaleDst[0];
+        }
+        track.bone->setAnimationValue(trans, rot, scale, this, weight);
+    }
+}
+
 void Animate3D::stop()
 {
     removeFromMap();
@@ -334,7 +424,6 @@ void Animate3D::update(float t)
             if (_weight > 0.0f)
             {
                 float transDst[3], rotDst[4], scaleDst[3];
-                float *trans = nullptr, *rot = nullptr, *scale = nullptr;
                 if (_playReverse)
                 {
                     t        = 1 - t;
@@ -344,26 +433,13 @@ void Animate3D::update(float t)
                 t        = _start + t * _last;
                 lastTime = _start + lastTime * _last;
 
-                for (const auto& it : _boneCurves)
+                if (!_clipBones.empty() || !_boneTracks.empty())
                 {
-                    auto bone  = it.first;
-                    auto curve = it.second;
-                    if (curve->translateCurve)
-                    {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
-                        trans = &transDst[0];
-                    }
-                    if (curve->rotCurve)
-                    {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
-                        rot = &rotDst[0];
-                    }
-                    if (curve->scaleCurve)
-                    {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
-                        scale = &scaleDst[0];
-                    }
-                    bone->setAnimationValue(trans, rot, scale, this, _weight);
+                    auto stage = SkeletalAnimationStage::getInstance();
+                    if (stage->isEnabled())
+                        stage->defer(this, t, _weight);
+                    else
+                        evaluateBones(t, _weight);
                 }
 
                 for (const auto& it : _nodeCurves)
@@ -500,6 +576,7 @@ Animate3D::Animate3D()
     , _lastTime(0.0f)
     , _originInterval(0.0f)
     , _frameRate(30.0f)
+    , _clipCursor(-1)
 {
     setQuality(Animate3DQuality::QUALITY_HIGH);
 }
@@ -39,6 +39,7 @@ NS_AX_BEGIN
 class Bone3D;
 class MeshRenderer;
 class EventCustom;
+class SkeletalAnimationStage;
 
 enum class Animate3DQuality
 {
@@ -58,6 +59,8 @@ enum class Animate3DQuality
  */
 class AX_DLL Animate3D : public ActionInterval
 {
+    friend class SkeletalAnimationStage;
+
 public:
     /**create Animate3D using Animation.*/
     static Animate3D* create(Animation3D* animation);
@@ -147,6 +150,19 @@ protected:
         FadeOut,
         Running,
     };
+    struct BoneTrack
+    {
+        Bone3D* bone;
+        Animation3D::Curve* curve;
+        int cursors[3];  // keyframe index of the last translation, rotation and scale evaluation
+    };
+
+    // flattens _boneCurves for update, on the shared key clip of the animation if it has one
+    void buildBoneTracks();
+
+    // sets the bones to the animation at t (in the animation's time), SkeletalAnimationStage calls it from a job
+    void evaluateBones(float t, float weight);
+
     Animate3DState _state;    // animation state
     Animation3D* _animation;  // animation data
 
@@ -170,6 +186,11 @@ protected:
     std::unordered_map<Bone3D*, Animation3D::Curve*> _boneCurves;  // weak ref
     std::unordered_map<Node*, Animation3D::Curve*> _nodeCurves;
 
+    std::vector<BoneTrack> _boneTracks;
+    std::vector<Bone3D*> _clipBones;  // bone of each lane of the shared key clip, nullptr if not in the skeleton
+    std::vector<float> _clipValues;   // evaluated lanes of the shared key clip
+    int _clipCursor;
+
     std::unordered_map<int, ValueMap> _keyFrameUserInfos;
     std::unordered_map<int, EventCustom*> _keyFrameEvent;
     std::unordered_map<int, Animate3DDisplayedEventInfo> _displayedEventInfo;
@@ -29,8 +29,251 @@
 #include "platform/FileUtils.h"
 #include "base/axstd.h"
 
+#include <cstring>
+
+#if defined(AX_USE_SSE)
+#    include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define AX_ANIMATION_NEON 1
+#endif
+
 NS_AX_BEGIN
 
+namespace
+{
+// 4 float lanes, so the kernels below are written once for SSE, NEON and plain C++
+#if defined(AX_USE_SSE)
+struct float4
+{
+    __m128 v;
+};
+inline float4 load4(const float* p)
+{
+    return {_mm_loadu_ps(p)};
+}
+inline void store4(float* p, float4 a)
+{
+    _mm_storeu_ps(p, a.v);
+}
+inline float4 set4(float v)
+{
+    return {_mm_set1_ps(v)};
+}
+inline float4 operator+(float4 a, float4 b)
+{
+    return {_mm_add_ps(a.v, b.v)};
+}
+inline float4 operator-(float4 a, float4 b)
+{
+    return {_mm_sub_ps(a.v, b.v)};
+}
+inline float4 operator*(float4 a, float4 b)
+{
+    return {_mm_mul_ps(a.v, b.v)};
+}
+// a >= 0 ? 1 : -1
+inline float4 sign4(float4 a)
+{
+    const __m128 ge = _mm_cmpge_ps(a.v, _mm_setzero_ps());
+    return {_mm_or_ps(_mm_and_ps(ge, _mm_set1_ps(1.0f)), _mm_andnot_ps(ge, _mm_set1_ps(-1.0f)))};
+}
+#elif defined(AX_ANIMATION_NEON)
+struct float4
+{
+    float32x4_t v;
+};
+inline float4 load4(const float* p)
+{
+    return {vld1q_f32(p)};
+}
+inline void store4(float* p, float4 a)
+{
+    vst1q_f32(p, a.v);
+}
+inline float4 set4(float v)
+{
+    return {vdupq_n_f32(v)};
+}
+inline float4 operator+(float4 a, float4 b)
+{
+    return {vaddq_f32(a.v, b.v)};
+}
+inline float4 operator-(float4 a, float4 b)
+{
+    return {vsubq_f32(a.v, b.v)};
+}
+inline float4 operator*(float4 a, float4 b)
+{
+    return {vmulq_f32(a.v, b.v)};
+}
+inline float4 sign4(float4 a)
+{
+    return {vbslq_f32(vcgeq_f32(a.v, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f), vdupq_n_f32(-1.0f))};
+}
+#else
+struct float4
+{
+    float v[4];
+};
+inline float4 load4(const float* p)
+{
+    return {{p[0], p[1], p[2], p[3]}};
+}
+inline void store4(float* p, float4 a)
+{
+    memcpy(p, a.v, sizeof(a.v));
+}
+inline float4 set4(float v)
+{
+    return {{v, v, v, v}};
+}
+inline float4 operator+(float4 a, float4 b)
+{
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+}
+inline float4 operator-(float4 a, float4 b)
+{
+    return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+}
+inline float4 operator*(float4 a, float4 b)
+{
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+}
+inline float4 sign4(float4 a)
+{
+    return {{a.v[0] >= 0 ? 1.0f : -1.0f, a.v[1] >= 0 ? 1.0f : -1.0f, a.v[2] >= 0 ? 1.0f : -1.0f,
+             a.v[3] >= 0 ? 1.0f : -1.0f}};
+}
+#endif
+
+// dst = from + (to - from) * t, count is a multiple of 4
+void lerpLanes(const float* from, const float* to, float* dst, size_t count, float t)
+{
+    const float4 t4 = set4(t);
+    for (size_t i = 0; i < count; i += 4)
+    {
+        const float4 a = load4(from + i);
+        store4(dst + i, a + (load4(to + i) - a) * t4);
+    }
+}
+
+// Quaternion::slerp of stride quaternions stored as x, y, z and w rows, 4 at a time. Since all lanes share t,
+// the folding of t is done once.
+void slerpLanes(const float* from, const float* to, float* dst, size_t stride, float t)
+{
+    float f2b = t - 0.5f;
+    float u   = f2b >= 0 ? f2b : -f2b;
+    float f2a = u - f2b;
+    f2b += u;
+    u += u;
+    const float f1     = 1.0f - u;
+    const float sqNotU = f1 * f1;
+    const float sqU    = u * u;
+
+    const float4 one = set4(1.0f);
+    for (size_t i = 0; i < stride; i += 4)
+    {
+        const float4 x1 = load4(from + i), y1 = load4(from + stride + i);
+        const float4 z1 = load4(from + 2 * stride + i), w1 = load4(from + 3 * stride + i);
+        const float4 x2 = load4(to + i), y2 = load4(to + stride + i);
+        const float4 z2 = load4(to + 2 * stride + i), w2 = load4(to + 3 * stride + i);
+
+        const float4 cosTheta = w1 * w2 + x1 * x2 + y1 * y2 + z1 * z2;
+        const float4 alpha    = sign4(cosTheta);
+        const float4 halfY    = one + alpha * cosTheta;
+
+        float4 halfSecHalfTheta = set4(1.09f) - (set4(0.476537f) - set4(0.0903321f) * halfY) * halfY;
+        halfSecHalfTheta        = halfSecHalfTheta * (set4(1.5f) - halfY * halfSecHalfTheta * halfSecHalfTheta);
+        const float4 versHalfTheta = one - halfY * halfSecHalfTheta;
+
+        float4 ratio2 = set4(0.0000440917108f) * versHalfTheta;
+        float4 ratio1 = set4(-0.00158730159f) + set4(sqNotU - 16.0f) * ratio2;
+        ratio1        = set4(0.0333333333f) + ratio1 * set4(sqNotU - 9.0f) * versHalfTheta;
+        ratio1        = set4(-0.333333333f) + ratio1 * set4(sqNotU - 4.0f) * versHalfTheta;
+        ratio1        = one + ratio1 * set4(sqNotU - 1.0f) * versHalfTheta;
+
+        ratio2 = set4(-0.00158730159f) + set4(sqU - 16.0f) * ratio2;
+        ratio2 = set4(0.0333333333f) + ratio2 * set4(sqU - 9.0f) * versHalfTheta;
+        ratio2 = set4(-0.333333333f) + ratio2 * set4(sqU - 4.0f) * versHalfTheta;
+        ratio2 = one + ratio2 * set4(sqU - 1.0f) * versHalfTheta;
+
+        const float4 c1 = set4(f1) * ratio1 * halfSecHalfTheta;
+        const float4 a  = alpha * (c1 + set4(f2a) * ratio2);
+        const float4 b  = c1 + set4(f2b) * ratio2;
+
+        const float4 w = a * w1 + b * w2;
+        const float4 x = a * x1 + b * x2;
+        const float4 y = a * y1 + b * y2;
+        const float4 z = a * z1 + b * z2;
+
+        // corrects the length like Quaternion::slerp
+        const float4 fix = set4(1.5f) - set4(0.5f) * (w * w + x * x + y * y + z * z);
+        store4(dst + i, x * fix);
+        store4(dst + stride + i, y * fix);
+        store4(dst + 2 * stride + i, z * fix);
+        store4(dst + 3 * stride + i, w * fix);
+    }
+}
+}  // namespace
+
+void Animation3D::SharedKeyClip::evaluate(float time,
+                                          int& cursor,
+                                          EvaluateType translateType,
+                                          EvaluateType rotType,
+                                          EvaluateType scaleType,
+                                          float* translationsDst,
+                                          float* rotationsDst,
+                                          float* scalesDst) const
+{
+    const int count = static_cast<int>(keytimes.size());
+    int index       = 0;
+    float t         = 0.0f;
+    if (count > 1 && time > keytimes[0])
+    {
+        if (time >= keytimes[count - 1])
+            index = count - 1;
+        else
+        {
+            index = cursor = determineKeyframeIndex(keytimes.data(), count, time, cursor);
+            t              = (time - keytimes[index]) / (keytimes[index + 1] - keytimes[index]);
+        }
+    }
+
+    auto interpolate = [this, index, t](const std::vector<float>& values, size_t components, EvaluateType type,
+                                        float* dst) {
+        const size_t size = components * stride;
+        const float* from = values.data() + index * size;
+        const float* to   = from + size;
+        if (t <= 0.0f || t >= 1.0f)
+        {
+            memcpy(dst, t <= 0.0f ? from : to, size * sizeof(float));
+            return;
+        }
+
+        switch (type)
+        {
+        case EvaluateType::INT_NEAR:
+            memcpy(dst, t > 0.5f ? to : from, size * sizeof(float));
+            break;
+        case EvaluateType::INT_QUAT_SLERP:
+            if (components == 4)
+            {
+                slerpLanes(from, to, dst, stride, t);
+                break;
+            }
+            [[fallthrough]];
+        default:
+            lerpLanes(from, to, dst, size, t);
+            break;
+        }
+    };
+
+    interpolate(translations, 3, translateType, translationsDst);
+    interpolate(rotations, 4, rotType, rotationsDst);
+    interpolate(scales, 3, scaleType, scalesDst);
+}
+
 Animation3D* Animation3D::create(std::string_view fileName, std::string_view animationName)
 {
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(fileName);
@@ -185,9 +428,84 @@ bool Animation3D::init(const Animation3DData& data)
         }
     }
 
+    buildSharedKeyClip();
+
     return true;
 }
 
+void Animation3D::buildSharedKeyClip()
+{
+    _sharedKeyClip.reset();
+    if (_boneCurves.empty())
+        return;
+
+    // every curve with more than one key must have the key times of the first one
+    const float* keytimes = nullptr;
+    int keyCount          = 0;
+    auto isShared         = [&](auto* curve) {
+        if (curve == nullptr || curve->getKeyCount() <= 1)
+            return true;
+        if (keytimes == nullptr)
+        {
+            keytimes = curve->getKeytimes();
+            keyCount = curve->getKeyCount();
+            return true;
+        }
+        if (curve->getKeyCount() != keyCount)
+            return false;
+        for (int i = 0; i < keyCount; ++i)
+        {
+            if (std::abs(curve->getKeytimes()[i] - keytimes[i]) > 1e-6f)
+                return false;
+        }
+        return true;
+    };
+    for (auto&& iter : _boneCurves)
+    {
+        auto curve = iter.second;
+        if (!isShared(curve->translateCurve) || !isShared(curve->rotCurve) || !isShared(curve->scaleCurve))
+            return;
+    }
+
+    auto clip = std::make_unique<SharedKeyClip>();
+    if (keytimes)
+        clip->keytimes.assign(keytimes, keytimes + keyCount);
+    else
+        clip->keytimes.emplace_back(0.0f);
+
+    const size_t keys   = clip->keytimes.size();
+    const size_t stride = clip->stride = (static_cast<uint32_t>(_boneCurves.size()) + 3) & ~3u;
+    clip->translations.assign(keys * 3 * stride, 0.0f);
+    clip->rotations.assign(keys * 4 * stride, 0.0f);
+    clip->scales.assign(keys * 3 * stride, 1.0f);
+    for (size_t k = 0; k < keys; ++k)
+        std::fill_n(&clip->rotations[(k * 4 + 3) * stride], stride, 1.0f);
+
+    auto fill = [keys, stride](std::vector<float>& dst, size_t components, size_t lane, auto* curve) {
+        if (curve == nullptr)
+            return;
+        const float* values = curve->getValues();
+        const bool constant = curve->getKeyCount() == 1;
+        for (size_t k = 0; k < keys; ++k)
+        {
+            for (size_t c = 0; c < components; ++c)
+                dst[(k * components + c) * stride + lane] = values[(constant ? 0 : k) * components + c];
+        }
+    };
+
+    size_t lane = 0;
+    clip->boneNames.reserve(_boneCurves.size());
+    for (auto&& iter : _boneCurves)
+    {
+        clip->boneNames.emplace_back(iter.first);
+        fill(clip->translations, 3, lane, iter.second->translateCurve);
+        fill(clip->rotations, 4, lane, iter.second->rotCurve);
+        fill(clip->scales, 3, lane, iter.second->scaleCurve);
+        ++lane;
+    }
+    _sharedKeyClip = std::move(clip);
+}
+
 ////////////////////////////////////////////////////////////////
 Animation3DCache* Animation3DCache::_cacheInstance = nullptr;
 
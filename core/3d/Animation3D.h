@@ -27,6 +27,8 @@
 #define __CCANIMATION3D_H__
 
 #include <unordered_map>
+#include <vector>
+#include <memory>
 
 #include "3d/AnimationCurve.h"
 
@@ -68,6 +70,37 @@ public:
         ~Curve();
     };
 
+    /**
+     * All bone curves flattened to a structure of arrays, built when they share the same key times (constant
+     * curves aside), so a single keyframe lookup serves every bone and bones are interpolated 4 at a time.
+     * Channels a bone doesn't animate hold the rest values (0 translation, identity rotation, 1 scale).
+     */
+    struct AX_DLL SharedKeyClip
+    {
+        std::vector<float> keytimes;
+        std::vector<std::string> boneNames;  // bone of each lane
+        uint32_t stride = 0;                 // bone count rounded up to a multiple of 4
+
+        // component c of bone b at key k is at [(k * components + c) * stride + b]
+        std::vector<float> translations;
+        std::vector<float> rotations;
+        std::vector<float> scales;
+
+        /**
+         * evaluate all bones at time, the outputs have the layout of one key: 3 * stride floats of translations,
+         * 4 * stride of rotations and 3 * stride of scales.
+         * @param cursor Keyframe index found by the previous evaluation, -1 if none, it's updated
+         */
+        void evaluate(float time,
+                      int& cursor,
+                      EvaluateType translateType,
+                      EvaluateType rotType,
+                      EvaluateType scaleType,
+                      float* translationsDst,
+                      float* rotationsDst,
+                      float* scalesDst) const;
+    };
+
     /**read all animation or only the animation with given animationName? animationName == "" read the first.*/
     static Animation3D* create(std::string_view filename, std::string_view animationName = "");
 
@@ -84,6 +117,9 @@ public:
     /**get the bone Curves set*/
     const hlookup::string_map<Curve*>& getBoneCurves() const { return _boneCurves; }
 
+    /**get the flattened clip, nullptr if the bone curves don't share key times*/
+    const SharedKeyClip* getSharedKeyClip() const { return _sharedKeyClip.get(); }
+
     Animation3D();
     virtual ~Animation3D();
     /**init Animation3D from bundle data*/
@@ -93,7 +129,10 @@ public:
     bool initWithFile(std::string_view filename, std::string_view animationName);
 
 protected:
+    void buildSharedKeyClip();
+
     hlookup::string_map<Curve*> _boneCurves;  // bone curves map, key bone name, value AnimationCurve
+    std::unique_ptr<SharedKeyClip> _sharedKeyClip;
 
     float _duration;  // animation duration
 };
@@ -26,6 +26,7 @@
 #define __CCANIMATIONCURVE_H__
 
 #include <cmath>
+#include <algorithm>
 #include <functional>
 
 #include "platform/PlatformMacros.h"
@@ -50,6 +51,25 @@ enum class EvaluateType
     INT_USER_FUNCTION,
 };
 
+/**
+ * Finds the index i of the keyframe interval where keytime[i] <= time <= keytime[i + 1], time must be in
+ * (keytime[0], keytime[count - 1]). hint is the index found for the previous time, since animations nearly
+ * always move forward it's checked with the next interval before falling back to a binary search.
+ */
+inline int determineKeyframeIndex(const float* keytime, int count, float time, int hint)
+{
+    if (hint >= 0 && hint < count - 1 && time >= keytime[hint])
+    {
+        if (time <= keytime[hint + 1])
+            return hint;
+        if (hint + 2 < count && time <= keytime[hint + 2])
+            return hint + 1;
+    }
+
+    int index = static_cast<int>(std::upper_bound(keytime, keytime + count, time) - keytime) - 1;
+    return std::clamp(index, 0, count - 2);
+}
+
 /**
  * @brief curve of bone's position, rotation or scale
  *
@@ -70,6 +90,12 @@ public:
      */
     void evaluate(float time, float* dst, EvaluateType type) const;
 
+    /**
+     * evaluate value of time, starting the keyframe search from a cursor
+     * @param cursor Keyframe index found by the previous evaluation of this curve, -1 if none, it's updated
+     */
+    void evaluate(float time, float* dst, EvaluateType type, int& cursor) const;
+
     /**set evaluate function, allow the user use own function*/
     void setEvaluateFun(std::function<void(float time, float* dst)> fun);
 
@@ -87,6 +113,11 @@ public:
      */
     int determineIndex(float time) const;
 
+    /**get key count, key times and values, componentSize floats per key*/
+    int getKeyCount() const { return _count; }
+    const float* getKeytimes() const { return _keytime; }
+    const float* getValues() const { return _value; }
+
 protected:
     float* _value;    //
     float* _keytime;  // key time(0 - 1), start time _keytime[0], end time _keytime[_count - 1]
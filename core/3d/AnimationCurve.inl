@@ -3,6 +3,13 @@ NS_AX_BEGIN
 
 template <int componentSize>
 void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type) const
+{
+    int cursor = -1;
+    evaluate(time, dst, type, cursor);
+}
+
+template <int componentSize>
+void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type, int& cursor) const
 {
     if (_count == 1 || time <= _keytime[0])
     {
@@ -15,7 +22,7 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
         return;
     }
     
-    unsigned int index = determineIndex(time);
+    unsigned int index = cursor = determineKeyframeIndex(_keytime, _count, time, cursor);
     
     float scale = (_keytime[index + 1] - _keytime[index]);
     float t = (time - _keytime[index]) / scale;
@@ -29,6 +29,8 @@
 #include "2d/Camera.h"
 #include "renderer/Renderer.h"
 
+#include <algorithm>
+
 NS_AX_BEGIN
 
 BillBoard::BillBoard() : _mode(Mode::VIEW_POINT_ORIENTED), _modeDirty(false)
@@ -105,8 +107,15 @@ void BillBoard::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t
     {
         return;
     }
+    // quick return if the scene BVH culled it and it didn't move since
+    if (_children.empty() && _cullingProxy.isCulled() && !(parentFlags & FLAGS_DIRTY_MASK) && !_transformUpdated &&
+        !_contentSizeDirty)
+    {
+        return;
+    }
 
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
+    visibleByCamera = updateCullingProxy(flags) && visibleByCamera;
 
     // Add 3D flag so all the children will be rendered as 3D object
     flags |= FLAGS_RENDER_AS_3D;
@@ -151,6 +160,40 @@ void BillBoard::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+bool BillBoard::updateCullingProxy(uint32_t flags)
+{
+    if (_cullingProxy.needsUpdate() || (flags & FLAGS_DIRTY_MASK))
+    {
+        if (!SceneBVH::getVisitingTree())
+        {
+            _cullingProxy.detach();
+        }
+        else
+        {
+            // the billboard turns around its anchor point to face each camera, so bound all its orientations
+            const Mat4& m = _modelViewTransform;
+            Vec3 pivot(_anchorPointInPoints.x, _anchorPointInPoints.y, 0.0f);
+            m.transformPoint(&pivot);
+
+            const float scale = std::max({Vec3(m.m[0], m.m[1], m.m[2]).length(), Vec3(m.m[4], m.m[5], m.m[6]).length(),
+                                          Vec3(m.m[8], m.m[9], m.m[10]).length()});
+            const float w      = std::max(_anchorPointInPoints.x, _contentSize.width - _anchorPointInPoints.x);
+            const float h      = std::max(_anchorPointInPoints.y, _contentSize.height - _anchorPointInPoints.y);
+            const float radius = sqrtf(w * w + h * h) * scale;
+
+            _cullingProxy.update(AABB(pivot - Vec3(radius, radius, radius), pivot + Vec3(radius, radius, radius)),
+                                 this);
+        }
+    }
+    return !_cullingProxy.isCulled();
+}
+
+void BillBoard::onExit()
+{
+    _cullingProxy.detach();
+    Sprite::onExit();
+}
+
 bool BillBoard::calculateBillboardTransform()
 {
     // Get camera world position
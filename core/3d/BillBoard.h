@@ -26,6 +26,7 @@
 #pragma once
 
 #include "2d/Sprite.h"
+#include "3d/SceneBVH.h"
 
 NS_AX_BEGIN
 /**
@@ -102,6 +103,8 @@ public:
      */
     virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags) override;
 
+    virtual void onExit() override;
+
     BillBoard();
     virtual ~BillBoard();
 
@@ -111,12 +114,17 @@ protected:
      */
     bool calculateBillboardTransform();
 
+    /** Updates the entry of the billboard in the scene BVH, returns false if it's culled for the visiting camera. */
+    bool updateCullingProxy(uint32_t flags);
+
     Mat4 _camWorldMat;
     Mat4 _mvTransform;
 
     Mode _mode;
     bool _modeDirty;
 
+    SceneBVHProxy _cullingProxy;  // entry in the BVH of the scene when hierarchical culling is enabled
+
 private:
     AX_DISALLOW_COPY_AND_ASSIGN(BillBoard);
 };
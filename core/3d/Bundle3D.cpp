@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "platform/FileUtils.h"
 #include "3d/BundleReader.h"
 #include "base/Data.h"
+#include "mio/mio.hpp"
 
 #define BUNDLE_TYPE_SCENE 1
 #define BUNDLE_TYPE_NODE 2
@@ -161,6 +162,7 @@ void Bundle3D::clear()
     if (_isBinary)
     {
         _binaryBuffer.clear();
+        _mapping.reset();
         AX_SAFE_DELETE_ARRAY(_references);
     }
     else
@@ -434,11 +436,26 @@ bool Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
             goto FAILED;
         }
 
-        meshData->vertex.resize(vertexSizeInFloat);
-        if (_binaryReader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+        if (_mapping)
         {
-            AXLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
-            goto FAILED;
+            auto vertices = _binaryReader.view(vertexSizeInFloat * 4);
+            if (!vertices)
+            {
+                AXLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
+                goto FAILED;
+            }
+            meshData->vertexView        = vertices;
+            meshData->vertexSizeInFloat = vertexSizeInFloat;
+            meshData->mapping           = _mapping;
+        }
+        else
+        {
+            meshData->vertex.resize(vertexSizeInFloat);
+            if (_binaryReader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+            {
+                AXLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
+                goto FAILED;
+            }
         }
 
         // Read index data
@@ -447,7 +464,6 @@ bool Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
 
         for (unsigned int k = 0; k < meshPartCount; ++k)
         {
-            IndexArray indexArray{};
             std::string meshPartid = _binaryReader.readString();
             meshData->subMeshIds.emplace_back(meshPartid);
             unsigned int nIndexCount;
@@ -456,14 +472,29 @@ bool Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
                 AXLOG("warning: Failed to read meshdata: nIndexCount '%s'.", _path.c_str());
                 goto FAILED;
             }
-            indexArray.resize(nIndexCount);
-            if (_binaryReader.read(indexArray.data(), 2, nIndexCount) != nIndexCount)
+            if (_mapping)
             {
-                AXLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
-                goto FAILED;
+                auto indices = _binaryReader.view(nIndexCount * 2);
+                if (!indices)
+                {
+                    AXLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+                    goto FAILED;
+                }
+                meshData->subMeshIndexViews.emplace_back(indices, nIndexCount);
+                meshData->numIndex = (int)meshData->subMeshIndexViews.size();
+            }
+            else
+            {
+                IndexArray indexArray{};
+                indexArray.resize(nIndexCount);
+                if (_binaryReader.read(indexArray.data(), 2, nIndexCount) != nIndexCount)
+                {
+                    AXLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+                    goto FAILED;
+                }
+                meshData->subMeshIndices.emplace_back(std::move(indexArray));
+                meshData->numIndex = (int)meshData->subMeshIndices.size();
             }
-            auto& storedIndices = meshData->subMeshIndices.emplace_back(std::move(indexArray));
-            meshData->numIndex = (int)meshData->subMeshIndices.size();
             // meshData->subMeshAABB.emplace_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(),
             // indexArray));
             if (_version != "0.3" && _version != "0.4" && _version != "0.5")
@@ -477,10 +508,16 @@ bool Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
                 } 
                 meshData->subMeshAABB.emplace_back(AABB(Vec3(aabb[0], aabb[1], aabb[2]), Vec3(aabb[3], aabb[4], aabb[5])));
             }
+            else if (_mapping)
+            {
+                const auto& indices = meshData->subMeshIndexViews.back();
+                meshData->subMeshAABB.emplace_back(calculateAABB(meshData->vertexView, meshData->getPerVertexSize(),
+                                                                 indices.first, indices.second));
+            }
             else
             {
                 meshData->subMeshAABB.emplace_back(
-                    calculateAABB(meshData->vertex, meshData->getPerVertexSize(), storedIndices));
+                    calculateAABB(meshData->vertex, meshData->getPerVertexSize(), meshData->subMeshIndices.back()));
             }
         }
         meshdatas.meshDatas.emplace_back(meshData);
@@ -1087,18 +1124,35 @@ bool Bundle3D::loadBinary(std::string_view path)
 {
     clear();
 
-    // get file data
-    _binaryBuffer.clear();
-    _binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
-    if (_binaryBuffer.isNull())
+#if !AX_ENABLE_CACHE_TEXTURE_DATA  // the vertices must be copied anyway to restore the buffers on context loss
+    if (_zeroCopy && FileUtils::getInstance()->isAbsolutePath(path))
     {
-        clear();
-        AXLOG("warning: Failed to read file: %s", path.data());
-        return false;
+        std::error_code error;
+        auto mapping = std::make_shared<mio::mmap_source>();
+        mapping->map(std::string{path}, error);
+        if (!error && mapping->size() > 0)
+        {
+            _binaryReader.init(const_cast<char*>(mapping->data()), static_cast<ssize_t>(mapping->size()));
+            _mapping = std::move(mapping);
+        }
     }
+#endif
 
-    // Initialise bundle reader
-    _binaryReader.init((char*)_binaryBuffer.getBytes(), _binaryBuffer.getSize());
+    if (!_mapping)
+    {
+        // get file data
+        _binaryBuffer.clear();
+        _binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
+        if (_binaryBuffer.isNull())
+        {
+            clear();
+            AXLOG("warning: Failed to read file: %s", path.data());
+            return false;
+        }
+
+        // Initialise bundle reader
+        _binaryReader.init((char*)_binaryBuffer.getBytes(), _binaryBuffer.getSize());
+    }
 
     // Read identifier info
     char identifier[] = {'C', '3', 'B', '\0'};
@@ -2335,4 +2389,24 @@ ax::AABB Bundle3D::calculateAABB(const std::vector<float>& vertex,
     return aabb;
 }
 
+ax::AABB Bundle3D::calculateAABB(const void* vertex, int stride, const void* indices, unsigned int count)
+{
+    AABB aabb;
+
+    // the data may be unaligned when it's mapped from a file
+    auto vertexBytes = static_cast<const uint8_t*>(vertex);
+    auto indexBytes  = static_cast<const uint8_t*>(indices);
+    for (unsigned int k = 0; k < count; ++k)
+    {
+        uint16_t i;
+        memcpy(&i, indexBytes + k * sizeof(i), sizeof(i));
+        float position[3];
+        memcpy(position, vertexBytes + static_cast<size_t>(i) * stride, sizeof(position));
+        Vec3 point(position[0], position[1], position[2]);
+        aabb.updateMinMax(&point, 1);
+    }
+
+    return aabb;
+}
+
 NS_AX_END
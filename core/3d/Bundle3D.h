@@ -61,6 +61,14 @@ public:
 
     virtual void clear();
 
+    /**
+     * Enables mapping c3b files into memory instead of reading them, mesh datas loaded afterwards then point
+     * their vertices and indices straight into the mapping, see MeshData::vertexView. Off by default, files that
+     * can't be mapped, i.e. inside an android apk, are read as usual.
+     */
+    void setZeroCopy(bool zeroCopy) { _zeroCopy = zeroCopy; }
+    bool isZeroCopy() const { return _zeroCopy; }
+
     /**
      * get define data type
      * @param str The type in string
@@ -115,6 +123,8 @@ public:
     // calculate aabb
     static AABB calculateAABB(const std::vector<float>& vertex,
                               int stride, const IndexArray& indices);
+    // calculate aabb of U_SHORT indices, the data may be unaligned
+    static AABB calculateAABB(const void* vertex, int stride, const void* indices, unsigned int count);
 
     Bundle3D();
     virtual ~Bundle3D();
@@ -192,6 +202,8 @@ protected:
 
     // for binary reading
     Data _binaryBuffer;
+    std::shared_ptr<const void> _mapping;  // the mapped c3b file, shared with the mesh datas that view it
+    bool _zeroCopy = false;
     BundleReader _binaryReader;
     unsigned int _referenceCount;
     Reference* _references;
@@ -28,6 +28,7 @@
 #define __AX_BUNDLE_3D_DATA_H__
 
 #include "base/Ref.h"
+#include "base/RefPtr.h"
 #include "base/Types.h"
 #include "math/Math.h"
 #include "3d/AABB.h"
@@ -37,8 +38,10 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <memory>
 
 #include "3d/3DProgramInfo.h"
+#include "platform/Image.h"
 
 #include "yasio/byte_buffer.hpp"
 
@@ -226,6 +229,7 @@ struct AX_DLL MeshVertexAttrib
 {
     backend::VertexFormat type;
     shaderinfos::VertexKey vertexAttrib;
+    bool normalized = false;  // integer formats are read as [0, 1] floats, i.e. quantized texture coordinates
     int getAttribSizeBytes() const;
 };
 
@@ -321,7 +325,26 @@ struct MeshData
     std::vector<MeshVertexAttrib> attribs;
     int attribCount;
 
+    /**
+     * Vertex and U_SHORT index blobs pointing straight into a c3b file mapped by Bundle3D, used instead of
+     * vertex and subMeshIndices when vertexView is set. They aren't aligned, copy them out before reading them.
+     * mapping keeps the file mapped as long as the data lives.
+     */
+    const void* vertexView = nullptr;
+    std::vector<std::pair<const void*, unsigned int>> subMeshIndexViews;  // indices, index count
+    std::shared_ptr<const void> mapping;
+
 public:
+    /** Gets the vertex data, mapped or copied. */
+    const void* getVertexData() const { return vertexView ? vertexView : vertex.data(); }
+    /** Gets the vertex data size in bytes, mapped or copied. */
+    size_t getVertexDataSize() const
+    {
+        return (vertexView ? static_cast<size_t>(vertexSizeInFloat) : vertex.size()) * sizeof(float);
+    }
+    /** Gets the number of sub meshes, mapped or copied. */
+    size_t getSubMeshCount() const { return vertexView ? subMeshIndexViews.size() : subMeshIndices.size(); }
+
     /**
      * Get per vertex size
      * @return return the sum size of all vertex attributes.
@@ -345,6 +368,9 @@ public:
         subMeshIndices.clear();
         subMeshAABB.clear();
         attribs.clear();
+        vertexView = nullptr;
+        subMeshIndexViews.clear();
+        mapping.reset();
         vertexSizeInFloat = 0;
         numIndex          = 0;
         attribCount       = 0;
@@ -499,7 +525,13 @@ struct NMaterialData
 struct MaterialDatas
 {
     std::vector<NMaterialData> materials;
-    void resetData() { materials.clear(); }
+    // images embedded in the model file, i.e. glb, decoded by the loader, keyed like the texture filenames using them
+    std::vector<std::pair<std::string, RefPtr<Image>>> embeddedImages;
+    void resetData()
+    {
+        materials.clear();
+        embeddedImages.clear();
+    }
     const NMaterialData* getMaterialData(std::string_view materialid) const
     {
         for (const auto& it : materials)
@@ -509,6 +541,15 @@ struct MaterialDatas
         }
         return nullptr;
     }
+    bool isEmbeddedImage(std::string_view key) const
+    {
+        for (const auto& it : embeddedImages)
+        {
+            if (it.first == key)
+                return true;
+        }
+        return false;
+    }
 };
 /**animation data
  * @js NA
@@ -84,6 +84,19 @@ ssize_t BundleReader::read(void* ptr, ssize_t size, ssize_t count)
     return validCount;
 }
 
+const char* BundleReader::view(ssize_t size)
+{
+    if (!_buffer || size < 0 || _length - _position < size)
+    {
+        AXLOG("warning: bundle reader out of range");
+        return nullptr;
+    }
+
+    const char* ptr = _buffer + _position;
+    _position += size;
+    return ptr;
+}
+
 char* BundleReader::readLine(int num, char* line)
 {
     if (!_buffer)
@@ -107,6 +107,12 @@ public:
      */
     bool rewind();
 
+    /**
+     * Returns a pointer to the next size bytes in the buffer without copying them and skips them,
+     * nullptr if there are less than size bytes left.
+     */
+    const char* view(ssize_t size);
+
     /**
      * read binary typed value.
      */
@@ -80,6 +80,36 @@ bool Frustum::isOutOfFrustum(const OBB& obb) const
     return false;
 }
 
+Frustum::Intersection Frustum::intersectAABB(const AABB& aabb, unsigned int& planeMask) const
+{
+    if (!_initialized)
+        return Intersection::INTERSECTING;
+
+    Vec3 point;
+    for (int i = 0; i < 6; i++)
+    {
+        const unsigned int bit = 1u << i;
+        if (!(planeMask & bit))
+            continue;
+
+        // the corner deepest behind the plane decides if the box is outside
+        const Vec3& normal = _plane[i].getNormal();
+        point.x            = normal.x < 0 ? aabb._max.x : aabb._min.x;
+        point.y            = normal.y < 0 ? aabb._max.y : aabb._min.y;
+        point.z            = normal.z < 0 ? aabb._max.z : aabb._min.z;
+        if (_plane[i].dist2Plane(point) > 0)
+            return Intersection::OUTSIDE;
+
+        // and the opposite corner if it's fully inside
+        point.x = normal.x < 0 ? aabb._min.x : aabb._max.x;
+        point.y = normal.y < 0 ? aabb._min.y : aabb._max.y;
+        point.z = normal.z < 0 ? aabb._min.z : aabb._max.z;
+        if (_plane[i].dist2Plane(point) < 0)
+            planeMask &= ~bit;
+    }
+    return planeMask ? Intersection::INTERSECTING : Intersection::INSIDE;
+}
+
 void Frustum::createPlane(const Camera* camera)
 {
     const Mat4& mat = camera->getViewProjectionMatrix();
@@ -67,6 +67,22 @@ public:
      */
     bool isOutOfFrustum(const OBB& obb) const;
 
+    enum class Intersection
+    {
+        OUTSIDE,
+        INTERSECTING,
+        INSIDE
+    };
+
+    /**
+     * Classifies an aabb against the planes whose bits are set in planeMask, the bits of the planes it's fully
+     * inside of are cleared, so the children of a hierarchy only test the planes their parent intersects.
+     */
+    Intersection intersectAABB(const AABB& aabb, unsigned int& planeMask) const;
+
+    /** Gets the mask of all planes used, 4 or 6 of them depending on clipZ. */
+    unsigned int getPlaneMask() const { return _clipZ ? 0x3f : 0x0f; }
+
     /**
      * get & set z clip. if bclipZ == true use near and far plane
      */
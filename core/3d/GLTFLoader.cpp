@@ -0,0 +1,1038 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "3d/GLTFLoader.h"
+#include "3d/Bundle3D.h"
+#include "3d/MeshOptimizer.h"
+#include "platform/FileUtils.h"
+#include "base/Utils.h"
+#include "base/UTF8.h"
+#include "rapidjson/document-wrapper.h"
+#include "mio/mio.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <memory>
+
+NS_AX_BEGIN
+
+namespace
+{
+const uint32_t GLB_MAGIC          = 0x46546C67;  // "glTF"
+const uint32_t GLB_CHUNK_JSON     = 0x4E4F534A;  // "JSON"
+const uint32_t GLB_CHUNK_BIN      = 0x004E4942;  // "BIN\0"
+const size_t MAX_CHUNK_VERTICES   = 65535;       // addressable by 16 bits indices
+const int MAX_NODE_DEPTH          = 64;
+const uint32_t INVALID_INDEX      = 0xffffffff;
+
+enum ComponentType
+{
+    COMPONENT_BYTE           = 5120,
+    COMPONENT_UNSIGNED_BYTE  = 5121,
+    COMPONENT_SHORT          = 5122,
+    COMPONENT_UNSIGNED_SHORT = 5123,
+    COMPONENT_UNSIGNED_INT   = 5125,
+    COMPONENT_FLOAT          = 5126
+};
+
+enum PrimitiveMode
+{
+    MODE_TRIANGLES      = 4,
+    MODE_TRIANGLE_STRIP = 5,
+    MODE_TRIANGLE_FAN   = 6
+};
+
+size_t getComponentSize(int componentType)
+{
+    switch (componentType)
+    {
+    case COMPONENT_BYTE:
+    case COMPONENT_UNSIGNED_BYTE:
+        return 1;
+    case COMPONENT_SHORT:
+    case COMPONENT_UNSIGNED_SHORT:
+        return 2;
+    case COMPONENT_UNSIGNED_INT:
+    case COMPONENT_FLOAT:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+int getComponentCount(std::string_view type)
+{
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4")
+        return 4;
+    if (type == "MAT4")
+        return 16;
+    return 0;
+}
+
+backend::SamplerAddressMode parseWrapMode(unsigned int mode)
+{
+    switch (mode)
+    {
+    case 33071:
+        return backend::SamplerAddressMode::CLAMP_TO_EDGE;
+    case 33648:
+        return backend::SamplerAddressMode::MIRROR_REPEAT;
+    default:
+        return backend::SamplerAddressMode::REPEAT;
+    }
+}
+
+unsigned int getUint(const rapidjson::Value& object, const char* name, unsigned int defaultValue)
+{
+    auto it = object.FindMember(name);
+    return (it != object.MemberEnd() && it->value.IsUint()) ? it->value.GetUint() : defaultValue;
+}
+
+int getInt(const rapidjson::Value& object, const char* name, int defaultValue)
+{
+    auto it = object.FindMember(name);
+    return (it != object.MemberEnd() && it->value.IsInt()) ? it->value.GetInt() : defaultValue;
+}
+
+std::string_view getString(const rapidjson::Value& object, const char* name)
+{
+    auto it = object.FindMember(name);
+    if (it != object.MemberEnd() && it->value.IsString())
+        return std::string_view{it->value.GetString(), it->value.GetStringLength()};
+    return std::string_view{};
+}
+
+const rapidjson::Value* getObject(const rapidjson::Value& object, const char* name)
+{
+    auto it = object.FindMember(name);
+    return (it != object.MemberEnd() && it->value.IsObject()) ? &it->value : nullptr;
+}
+
+const rapidjson::Value* getArray(const rapidjson::Value& object, const char* name)
+{
+    auto it = object.FindMember(name);
+    return (it != object.MemberEnd() && it->value.IsArray()) ? &it->value : nullptr;
+}
+
+// reads a float array member of exactly count elements
+bool getFloats(const rapidjson::Value& object, const char* name, float* values, rapidjson::SizeType count)
+{
+    auto array = getArray(object, name);
+    if (!array || array->Size() != count)
+        return false;
+    for (rapidjson::SizeType i = 0; i < count; ++i)
+    {
+        if (!(*array)[i].IsNumber())
+            return false;
+        values[i] = (*array)[i].GetFloat();
+    }
+    return true;
+}
+
+/** A typed view of an accessor in a buffer. */
+struct Accessor
+{
+    const uint8_t* data = nullptr;
+    size_t count        = 0;
+    size_t stride       = 0;
+    int componentType   = 0;
+    int components      = 0;
+    bool normalized     = false;
+
+    float get(size_t index, int component) const
+    {
+        const uint8_t* p = data + index * stride + component * getComponentSize(componentType);
+        switch (componentType)
+        {
+        case COMPONENT_FLOAT:
+        {
+            float v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        case COMPONENT_UNSIGNED_BYTE:
+            return normalized ? p[0] / 255.0f : p[0];
+        case COMPONENT_BYTE:
+        {
+            auto v = static_cast<int8_t>(p[0]);
+            return normalized ? std::max(v / 127.0f, -1.0f) : v;
+        }
+        case COMPONENT_UNSIGNED_SHORT:
+        {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            return normalized ? v / 65535.0f : v;
+        }
+        case COMPONENT_SHORT:
+        {
+            int16_t v;
+            memcpy(&v, p, sizeof(v));
+            return normalized ? std::max(v / 32767.0f, -1.0f) : v;
+        }
+        case COMPONENT_UNSIGNED_INT:
+        {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return static_cast<float>(v);
+        }
+        default:
+            return 0.0f;
+        }
+    }
+
+    uint32_t getIndex(size_t index) const
+    {
+        const uint8_t* p = data + index * stride;
+        switch (componentType)
+        {
+        case COMPONENT_UNSIGNED_BYTE:
+            return p[0];
+        case COMPONENT_UNSIGNED_SHORT:
+        {
+            uint16_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        case COMPONENT_UNSIGNED_INT:
+        {
+            uint32_t v;
+            memcpy(&v, p, sizeof(v));
+            return v;
+        }
+        default:
+            return INVALID_INDEX;
+        }
+    }
+
+    // reads up to 4 components, the missing ones are filled from defaults
+    void get(size_t index, float* values, int count, const float* defaults) const
+    {
+        for (int c = 0; c < count; ++c)
+            values[c] = c < components ? get(index, c) : defaults[c];
+    }
+};
+
+/** A vertex attribute of a primitive and where it's read from. */
+struct Attribute
+{
+    shaderinfos::VertexKey key;
+    backend::VertexFormat format;
+    bool normalized;
+    int components;  // components of the float source
+    const Accessor* source;
+};
+
+class Importer
+{
+public:
+    Importer(std::string_view fullPath, const GLTFImportOptions& options, GLTFImportStats* stats)
+        : _path(fullPath), _options(options), _stats(stats)
+    {
+        auto slash = _path.find_last_of("\\/");
+        if (slash != std::string::npos)
+            _dir = _path.substr(0, slash + 1);
+    }
+
+    bool load(MeshDatas& meshdatas, MaterialDatas& materialdatas, NodeDatas& nodedatas);
+
+private:
+    bool loadFile();
+    bool loadBuffers();
+    bool getAccessor(const rapidjson::Value& index, Accessor& accessor, int components) const;
+    const rapidjson::Value* getElement(const char* name, unsigned int index) const;
+    std::string loadImage(unsigned int index, MaterialDatas& materialdatas);
+    void addTexture(const rapidjson::Value* textureInfo,
+                    NTextureData::Usage usage,
+                    NMaterialData& material,
+                    MaterialDatas& materialdatas);
+    void loadMaterials(MaterialDatas& materialdatas);
+    bool loadMeshes(MeshDatas& meshdatas);
+    bool loadPrimitive(const rapidjson::Value& primitive, std::string_view id, MeshDatas& meshdatas,
+                       std::vector<ModelData>& models);
+    void addChunk(const std::vector<uint8_t>& vertices,
+                  size_t stride,
+                  const std::vector<MeshVertexAttrib>& attribs,
+                  const uint32_t* indices,
+                  size_t indexCount,
+                  std::string_view id,
+                  MeshDatas& meshdatas);
+    NodeData* loadNode(unsigned int index, int depth);
+
+    std::string _path;
+    std::string _dir;
+    GLTFImportOptions _options;
+    GLTFImportStats* _stats;
+
+    // the glb file, mapped if possible, and the buffers
+    std::shared_ptr<mio::mmap_source> _mapping;
+    Data _fileData;
+    std::string _json;
+    const uint8_t* _binChunk = nullptr;
+    size_t _binChunkSize     = 0;
+    std::vector<Data> _externalBuffers;
+    std::vector<yasio::byte_buffer> _decodedBuffers;
+    std::vector<std::pair<const uint8_t*, size_t>> _buffers;
+
+    rapidjson::Document _document;
+    std::vector<std::vector<ModelData>> _meshModels;  // the sub meshes and materials of the primitives of a mesh
+    std::vector<std::string> _imageKeys;
+    bool _warnedSkin = false;
+};
+
+bool Importer::loadFile()
+{
+    auto fileUtils = FileUtils::getInstance();
+    if (fileUtils->getFileExtension(_path) != ".glb")
+    {
+        _json = fileUtils->getStringFromFile(_path);
+        if (_json.empty())
+            return false;
+        _document.Parse(_json.c_str(), _json.size());
+        return !_document.HasParseError() && _document.IsObject();
+    }
+
+    const uint8_t* bytes = nullptr;
+    size_t size          = 0;
+    if (fileUtils->isAbsolutePath(_path))
+    {
+        std::error_code error;
+        auto mapping = std::make_shared<mio::mmap_source>();
+        mapping->map(_path, error);
+        if (!error && mapping->size() > 0)
+        {
+            bytes    = reinterpret_cast<const uint8_t*>(mapping->data());
+            size     = mapping->size();
+            _mapping = std::move(mapping);
+        }
+    }
+    if (!_mapping)
+    {
+        // i.e. inside an android apk
+        _fileData = fileUtils->getDataFromFile(_path);
+        bytes     = _fileData.getBytes();
+        size      = static_cast<size_t>(_fileData.getSize());
+    }
+
+    uint32_t header[5];
+    if (!bytes || size < sizeof(header))
+        return false;
+    memcpy(header, bytes, sizeof(header));
+    if (header[0] != GLB_MAGIC || header[1] != 2 || header[2] > size || header[4] != GLB_CHUNK_JSON ||
+        20 + static_cast<size_t>(header[3]) > header[2])
+    {
+        AXLOG("warning: Invalid glb header: %s", _path.c_str());
+        return false;
+    }
+    size = header[2];
+
+    const char* json = reinterpret_cast<const char*>(bytes + 20);
+    size_t offset    = 20 + ((header[3] + 3) & ~3u);
+    if (offset + 8 <= size)
+    {
+        uint32_t chunk[2];
+        memcpy(chunk, bytes + offset, sizeof(chunk));
+        if (chunk[1] == GLB_CHUNK_BIN && offset + 8 + chunk[0] <= size)
+        {
+            _binChunk     = bytes + offset + 8;
+            _binChunkSize = chunk[0];
+        }
+    }
+
+    _document.Parse(json, header[3]);
+    return !_document.HasParseError() && _document.IsObject();
+}
+
+bool Importer::loadBuffers()
+{
+    auto buffers = getArray(_document, "buffers");
+    if (!buffers)
+        return true;
+
+    // reserved, so the pointers to the data stay valid
+    _externalBuffers.reserve(buffers->Size());
+    _decodedBuffers.reserve(buffers->Size());
+    for (rapidjson::SizeType i = 0; i < buffers->Size(); ++i)
+    {
+        const auto& buffer = (*buffers)[i];
+        auto uri           = buffer.IsObject() ? getString(buffer, "uri") : std::string_view{};
+        auto byteLength    = buffer.IsObject() ? getUint(buffer, "byteLength", 0) : 0;
+        if (uri.empty())
+        {
+            if (i != 0 || !_binChunk || _binChunkSize < byteLength)
+            {
+                AXLOG("warning: Missing glb buffer %u: %s", i, _path.c_str());
+                return false;
+            }
+            _buffers.emplace_back(_binChunk, _binChunkSize);
+        }
+        else if (uri.substr(0, 5) == "data:")
+        {
+            auto comma = uri.find(',');
+            if (comma == std::string_view::npos)
+                return false;
+            auto& decoded = _decodedBuffers.emplace_back(utils::base64Decode(uri.substr(comma + 1)));
+            _buffers.emplace_back(decoded.data(), decoded.size());
+        }
+        else
+        {
+            auto& data = _externalBuffers.emplace_back(
+                FileUtils::getInstance()->getDataFromFile(_dir + utils::urlDecode(uri)));
+            if (data.isNull())
+            {
+                AXLOG("warning: Failed to read buffer '%.*s' of %s", static_cast<int>(uri.size()), uri.data(),
+                      _path.c_str());
+                return false;
+            }
+            _buffers.emplace_back(data.getBytes(), static_cast<size_t>(data.getSize()));
+        }
+        if (_buffers.back().second < byteLength)
+            return false;
+    }
+    return true;
+}
+
+const rapidjson::Value* Importer::getElement(const char* name, unsigned int index) const
+{
+    auto array = getArray(_document, name);
+    if (!array || index >= array->Size() || !(*array)[index].IsObject())
+        return nullptr;
+    return &(*array)[index];
+}
+
+bool Importer::getAccessor(const rapidjson::Value& index, Accessor& accessor, int components) const
+{
+    if (!index.IsUint())
+        return false;
+    auto object = getElement("accessors", index.GetUint());
+    if (!object)
+        return false;
+
+    accessor.count         = getUint(*object, "count", 0);
+    accessor.componentType = getInt(*object, "componentType", 0);
+    accessor.components    = getComponentCount(getString(*object, "type"));
+    auto normalized        = object->FindMember("normalized");
+    accessor.normalized    = normalized != object->MemberEnd() && normalized->value.IsBool() && normalized->value.GetBool();
+    const auto elementSize = getComponentSize(accessor.componentType) * accessor.components;
+    if (elementSize == 0 || (components != 0 && accessor.components != components))
+        return false;
+    if (object->HasMember("sparse"))
+        AXLOG("warning: Sparse accessors are not supported: %s", _path.c_str());
+
+    auto view = getElement("bufferViews", getUint(*object, "bufferView", INVALID_INDEX));
+    if (!view)
+        return false;
+    auto buffer = getUint(*view, "buffer", INVALID_INDEX);
+    if (buffer >= _buffers.size())
+        return false;
+
+    const size_t viewOffset = getUint(*view, "byteOffset", 0);
+    const size_t viewLength = getUint(*view, "byteLength", 0);
+    const size_t offset     = getUint(*object, "byteOffset", 0);
+    accessor.stride         = getUint(*view, "byteStride", static_cast<unsigned int>(elementSize));
+    if (viewOffset + viewLength > _buffers[buffer].second ||
+        (accessor.count > 0 && offset + accessor.stride * (accessor.count - 1) + elementSize > viewLength))
+    {
+        AXLOG("warning: Accessor %u out of range: %s", index.GetUint(), _path.c_str());
+        return false;
+    }
+    accessor.data = _buffers[buffer].first + viewOffset + offset;
+    return true;
+}
+
+std::string Importer::loadImage(unsigned int index, MaterialDatas& materialdatas)
+{
+    if (index < _imageKeys.size() && !_imageKeys[index].empty())
+        return _imageKeys[index];
+
+    auto image = getElement("images", index);
+    if (!image)
+        return std::string{};
+
+    std::string key;
+    Data encoded;
+    auto uri = getString(*image, "uri");
+    if (!uri.empty() && uri.substr(0, 5) != "data:")
+    {
+        // external images are loaded by the texture cache as usual
+        key = _dir + utils::urlDecode(uri);
+    }
+    else
+    {
+        if (!uri.empty())
+        {
+            auto comma = uri.find(',');
+            if (comma != std::string_view::npos)
+            {
+                auto decoded = utils::base64Decode(uri.substr(comma + 1));
+                encoded.copy(decoded.data(), decoded.size());
+            }
+        }
+        else if (auto view = getElement("bufferViews", getUint(*image, "bufferView", INVALID_INDEX)))
+        {
+            auto buffer           = getUint(*view, "buffer", INVALID_INDEX);
+            const size_t offset   = getUint(*view, "byteOffset", 0);
+            const size_t length   = getUint(*view, "byteLength", 0);
+            if (buffer < _buffers.size() && offset + length <= _buffers[buffer].second)
+                encoded.copy(_buffers[buffer].first + offset, length);
+        }
+
+        // embedded images are decoded here, possibly off the main thread, and keyed by the file and the index
+        auto decoded = new Image();
+        if (!encoded.isNull() && decoded->initWithImageData(std::move(encoded)))
+        {
+            key = StringUtils::format("%s#image%u", _path.c_str(), index);
+            materialdatas.embeddedImages.emplace_back(key, RefPtr<Image>{ReferencedObject<Image>{decoded}});
+        }
+        else
+        {
+            AXLOG("warning: Failed to decode image %u of %s", index, _path.c_str());
+            decoded->release();
+        }
+    }
+
+    if (_imageKeys.size() <= index)
+        _imageKeys.resize(index + 1);
+    _imageKeys[index] = key;
+    return key;
+}
+
+void Importer::addTexture(const rapidjson::Value* textureInfo,
+                          NTextureData::Usage usage,
+                          NMaterialData& material,
+                          MaterialDatas& materialdatas)
+{
+    if (!textureInfo)
+        return;
+    auto texture = getElement("textures", getUint(*textureInfo, "index", INVALID_INDEX));
+    if (!texture)
+        return;
+
+    NTextureData textureData;
+    textureData.filename = loadImage(getUint(*texture, "source", INVALID_INDEX), materialdatas);
+    if (textureData.filename.empty())
+        return;
+    textureData.type = usage;
+    textureData.wrapS = backend::SamplerAddressMode::REPEAT;
+    textureData.wrapT = backend::SamplerAddressMode::REPEAT;
+    if (auto sampler = getElement("samplers", getUint(*texture, "sampler", INVALID_INDEX)))
+    {
+        textureData.wrapS = parseWrapMode(getUint(*sampler, "wrapS", 10497));
+        textureData.wrapT = parseWrapMode(getUint(*sampler, "wrapT", 10497));
+    }
+    material.textures.emplace_back(std::move(textureData));
+}
+
+void Importer::loadMaterials(MaterialDatas& materialdatas)
+{
+    auto materials = getArray(_document, "materials");
+    if (!materials)
+        return;
+
+    for (rapidjson::SizeType i = 0; i < materials->Size(); ++i)
+    {
+        const auto& object = (*materials)[i];
+        NMaterialData material;
+        material.id = StringUtils::format("material%u", i);
+        if (object.IsObject())
+        {
+            if (auto pbr = getObject(object, "pbrMetallicRoughness"))
+                addTexture(getObject(*pbr, "baseColorTexture"), NTextureData::Usage::Diffuse, material, materialdatas);
+            addTexture(getObject(object, "normalTexture"), NTextureData::Usage::Normal, material, materialdatas);
+            addTexture(getObject(object, "emissiveTexture"), NTextureData::Usage::Emissive, material, materialdatas);
+
+            // a transparency texture makes the renderer pick transparent materials, as for c3b
+            auto diffuse = material.getTextureData(NTextureData::Usage::Diffuse);
+            if (diffuse && getString(object, "alphaMode") == "BLEND")
+            {
+                NTextureData transparency = *diffuse;
+                transparency.type         = NTextureData::Usage::Transparency;
+                material.textures.emplace_back(std::move(transparency));
+            }
+        }
+        materialdatas.materials.emplace_back(std::move(material));
+    }
+}
+
+bool Importer::loadMeshes(MeshDatas& meshdatas)
+{
+    auto meshes = getArray(_document, "meshes");
+    if (!meshes)
+        return true;
+
+    _meshModels.resize(meshes->Size());
+    for (rapidjson::SizeType i = 0; i < meshes->Size(); ++i)
+    {
+        auto primitives = (*meshes)[i].IsObject() ? getArray((*meshes)[i], "primitives") : nullptr;
+        if (!primitives)
+            continue;
+        for (rapidjson::SizeType p = 0; p < primitives->Size(); ++p)
+        {
+            auto id = StringUtils::format("mesh%u_%u", i, p);
+            if (!(*primitives)[p].IsObject() || !loadPrimitive((*primitives)[p], id, meshdatas, _meshModels[i]))
+            {
+                AXLOG("warning: Failed to load primitive %u of mesh %u: %s", p, i, _path.c_str());
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool Importer::loadPrimitive(const rapidjson::Value& primitive,
+                             std::string_view id,
+                             MeshDatas& meshdatas,
+                             std::vector<ModelData>& models)
+{
+    const int mode = getInt(primitive, "mode", MODE_TRIANGLES);
+    if (mode != MODE_TRIANGLES && mode != MODE_TRIANGLE_STRIP && mode != MODE_TRIANGLE_FAN)
+    {
+        AXLOG("warning: Skipped primitive %.*s of mode %d: %s", static_cast<int>(id.size()), id.data(), mode,
+              _path.c_str());
+        return true;
+    }
+
+    auto attributes = getObject(primitive, "attributes");
+    if (!attributes)
+        return false;
+    auto getAttribute = [this, attributes](const char* name, Accessor& accessor, int components) {
+        auto it = attributes->FindMember(name);
+        return it != attributes->MemberEnd() && getAccessor(it->value, accessor, components);
+    };
+    if (!_warnedSkin && attributes->HasMember("JOINTS_0"))
+    {
+        AXLOG("warning: Skins are not imported: %s", _path.c_str());
+        _warnedSkin = true;
+    }
+
+    Accessor position, normal, tangent, texCoords[2], color;
+    if (!getAttribute("POSITION", position, 3))
+        return false;
+    const size_t sourceVertexCount = position.count;
+
+    // positions stay floats, other systems read them, i.e. physics and ray picking
+    std::vector<Attribute> layout;
+    layout.push_back({shaderinfos::VertexKey::VERTEX_ATTRIB_POSITION, backend::VertexFormat::FLOAT3, false, 3, &position});
+    const bool hasNormal = getAttribute("NORMAL", normal, 3) && normal.count == sourceVertexCount;
+    if (hasNormal)
+        layout.push_back({shaderinfos::VertexKey::VERTEX_ATTRIB_NORMAL, backend::VertexFormat::FLOAT3, false, 3, &normal});
+
+    const char* texCoordNames[] = {"TEXCOORD_0", "TEXCOORD_1"};
+    const shaderinfos::VertexKey texCoordKeys[] = {shaderinfos::VertexKey::VERTEX_ATTRIB_TEX_COORD,
+                                                   shaderinfos::VertexKey::VERTEX_ATTRIB_TEX_COORD1};
+    for (int t = 0; t < 2; ++t)
+    {
+        auto& source = texCoords[t];
+        if (!getAttribute(texCoordNames[t], source, 2) || source.count != sourceVertexCount)
+            continue;
+        bool quantize = _options.quantize;
+        for (size_t v = 0; quantize && v < source.count; ++v)
+        {
+            auto s  = source.get(v, 0);
+            auto tc = source.get(v, 1);
+            quantize = s >= 0.0f && s <= 1.0f && tc >= 0.0f && tc <= 1.0f;
+        }
+        layout.push_back({texCoordKeys[t], quantize ? backend::VertexFormat::USHORT2 : backend::VertexFormat::FLOAT2,
+                          quantize, 2, &source});
+    }
+
+    if (getAttribute("COLOR_0", color, 0) && (color.components == 3 || color.components == 4) &&
+        color.count == sourceVertexCount)
+    {
+        layout.push_back({shaderinfos::VertexKey::VERTEX_ATTRIB_COLOR,
+                          _options.quantize ? backend::VertexFormat::UBYTE4 : backend::VertexFormat::FLOAT4,
+                          _options.quantize, 4, &color});
+    }
+
+    // the normal mapped shaders take a binormal, computed from the handedness in the tangent w
+    if (hasNormal && getAttribute("TANGENT", tangent, 4) && tangent.count == sourceVertexCount)
+    {
+        layout.push_back({shaderinfos::VertexKey::VERTEX_ATTRIB_TANGENT, backend::VertexFormat::FLOAT3, false, 3, &tangent});
+        layout.push_back({shaderinfos::VertexKey::VERTEX_ATTRIB_BINORMAL, backend::VertexFormat::FLOAT3, false, 3, &tangent});
+    }
+
+    std::vector<MeshVertexAttrib> attribs;
+    size_t stride = 0, floatStride = 0;
+    for (const auto& attribute : layout)
+    {
+        MeshVertexAttrib attrib;
+        attrib.type         = attribute.format;
+        attrib.vertexAttrib = attribute.key;
+        attrib.normalized   = attribute.normalized;
+        attribs.emplace_back(attrib);
+        stride += attrib.getAttribSizeBytes();
+        floatStride += attribute.components * sizeof(float);
+    }
+
+    // interleave, converting to the layout formats
+    std::vector<uint8_t> vertices(sourceVertexCount * stride);
+    const float defaults[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    uint8_t* out            = vertices.data();
+    for (size_t v = 0; v < sourceVertexCount; ++v)
+    {
+        for (const auto& attribute : layout)
+        {
+            float values[4];
+            attribute.source->get(v, values, attribute.components == 4 ? 4 : attribute.components, defaults);
+            if (attribute.key == shaderinfos::VertexKey::VERTEX_ATTRIB_BINORMAL)
+            {
+                float n[3], t[4];
+                normal.get(v, n, 3, defaults);
+                tangent.get(v, t, 4, defaults);
+                Vec3 binormal;
+                Vec3::cross(Vec3(n[0], n[1], n[2]), Vec3(t[0], t[1], t[2]), &binormal);
+                binormal *= t[3] < 0.0f ? -1.0f : 1.0f;
+                values[0] = binormal.x;
+                values[1] = binormal.y;
+                values[2] = binormal.z;
+            }
+            else if (attribute.key == shaderinfos::VertexKey::VERTEX_ATTRIB_TEX_COORD ||
+                     attribute.key == shaderinfos::VertexKey::VERTEX_ATTRIB_TEX_COORD1)
+            {
+                // glTF puts the origin of the uvs at the top left, the 3d shaders flip v back themselves
+                values[1] = 1.0f - values[1];
+            }
+
+            switch (attribute.format)
+            {
+            case backend::VertexFormat::USHORT2:
+            {
+                uint16_t q[2] = {static_cast<uint16_t>(MeshOptimizer::quantizeUnorm(values[0], 16)),
+                                 static_cast<uint16_t>(MeshOptimizer::quantizeUnorm(values[1], 16))};
+                memcpy(out, q, sizeof(q));
+                out += sizeof(q);
+                break;
+            }
+            case backend::VertexFormat::UBYTE4:
+            {
+                for (int c = 0; c < 4; ++c)
+                    *out++ = static_cast<uint8_t>(MeshOptimizer::quantizeUnorm(values[c], 8));
+                break;
+            }
+            default:
+            {
+                const size_t size = attribute.components * sizeof(float);
+                memcpy(out, values, size);
+                out += size;
+                break;
+            }
+            }
+        }
+    }
+
+    // triangle lists, strips and fans all become lists
+    std::vector<uint32_t> source;
+    auto indicesIt = primitive.FindMember("indices");
+    if (indicesIt != primitive.MemberEnd())
+    {
+        Accessor indexAccessor;
+        if (!getAccessor(indicesIt->value, indexAccessor, 1))
+            return false;
+        source.resize(indexAccessor.count);
+        for (size_t i = 0; i < indexAccessor.count; ++i)
+        {
+            source[i] = indexAccessor.getIndex(i);
+            if (source[i] >= sourceVertexCount)
+                return false;
+        }
+    }
+    else
+    {
+        source.resize(sourceVertexCount);
+        for (size_t i = 0; i < sourceVertexCount; ++i)
+            source[i] = static_cast<uint32_t>(i);
+    }
+
+    std::vector<uint32_t> indices;
+    if (mode == MODE_TRIANGLES)
+    {
+        source.resize(source.size() / 3 * 3);
+        indices.swap(source);
+    }
+    else
+    {
+        for (size_t i = 0; i + 2 < source.size(); ++i)
+        {
+            if (mode == MODE_TRIANGLE_FAN)
+                indices.insert(indices.end(), {source[0], source[i + 1], source[i + 2]});
+            else if (i % 2 == 0)
+                indices.insert(indices.end(), {source[i], source[i + 1], source[i + 2]});
+            else
+                indices.insert(indices.end(), {source[i + 1], source[i], source[i + 2]});
+        }
+    }
+    if (indices.empty())
+        return true;
+
+    const size_t triangleCount = indices.size() / 3;
+    size_t vertexCount         = sourceVertexCount;
+    if (_stats)
+    {
+        _stats->sourceVertices += sourceVertexCount;
+        _stats->sourceBytes += sourceVertexCount * floatStride;
+        _stats->triangles += triangleCount;
+        _stats->sourceACMR += MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), vertexCount) * triangleCount;
+    }
+
+    if (_options.optimize)
+    {
+        vertexCount = MeshOptimizer::deduplicateVertices(vertices, stride, indices);
+        MeshOptimizer::optimizeVertexCache(indices.data(), indices.size(), vertexCount);
+        MeshOptimizer::optimizeOverdraw(indices.data(), indices.size(), vertices.data(), stride, vertexCount);
+        vertexCount = MeshOptimizer::optimizeVertexFetch(vertices.data(), stride, vertexCount, indices.data(),
+                                                         indices.size());
+        vertices.resize(vertexCount * stride);
+    }
+    if (_stats)
+        _stats->acmr += MeshOptimizer::analyzeVertexCache(indices.data(), indices.size(), vertexCount) * triangleCount;
+
+    // split in chunks addressable by 16 bits indices, in triangle order so the chunks keep the cache locality
+    auto materialIt = primitive.FindMember("material");
+    std::string materialId;
+    if (materialIt != primitive.MemberEnd() && materialIt->value.IsUint())
+        materialId = StringUtils::format("material%u", materialIt->value.GetUint());
+
+    std::vector<uint32_t> remap(vertexCount, INVALID_INDEX);
+    std::vector<uint32_t> chunkVertices;
+    std::vector<uint32_t> chunkIndices;
+    size_t triangle = 0;
+    for (int chunk = 0; triangle < triangleCount; ++chunk)
+    {
+        chunkVertices.clear();
+        chunkIndices.clear();
+        for (; triangle < triangleCount; ++triangle)
+        {
+            const uint32_t* tri = indices.data() + triangle * 3;
+            int added           = 0;
+            for (int k = 0; k < 3; ++k)
+                added += remap[tri[k]] == INVALID_INDEX ? 1 : 0;
+            if (chunkVertices.size() + added > MAX_CHUNK_VERTICES)
+                break;
+            for (int k = 0; k < 3; ++k)
+            {
+                if (remap[tri[k]] == INVALID_INDEX)
+                {
+                    remap[tri[k]] = static_cast<uint32_t>(chunkVertices.size());
+                    chunkVertices.emplace_back(tri[k]);
+                }
+                chunkIndices.emplace_back(remap[tri[k]]);
+            }
+        }
+
+        std::vector<uint8_t> chunkData(chunkVertices.size() * stride);
+        for (size_t v = 0; v < chunkVertices.size(); ++v)
+        {
+            memcpy(chunkData.data() + v * stride, vertices.data() + chunkVertices[v] * stride, stride);
+            remap[chunkVertices[v]] = INVALID_INDEX;
+        }
+
+        auto chunkId = StringUtils::format("%.*s_%d", static_cast<int>(id.size()), id.data(), chunk);
+        addChunk(chunkData, stride, attribs, chunkIndices.data(), chunkIndices.size(), chunkId, meshdatas);
+
+        ModelData model;
+        model.subMeshId  = chunkId;
+        model.materialId = materialId;
+        models.emplace_back(std::move(model));
+
+        if (_stats)
+        {
+            _stats->vertices += chunkVertices.size();
+            _stats->bytes += chunkData.size();
+        }
+    }
+    return true;
+}
+
+void Importer::addChunk(const std::vector<uint8_t>& vertices,
+                        size_t stride,
+                        const std::vector<MeshVertexAttrib>& attribs,
+                        const uint32_t* indices,
+                        size_t indexCount,
+                        std::string_view id,
+                        MeshDatas& meshdatas)
+{
+    auto meshData         = new MeshData();
+    meshData->attribs     = attribs;
+    meshData->attribCount = static_cast<int>(attribs.size());
+
+    // every format is a multiple of 4 bytes, so the packed vertices fit the float storage
+    meshData->vertexSizeInFloat = static_cast<int>(vertices.size() / sizeof(float));
+    meshData->vertex.resize(meshData->vertexSizeInFloat);
+    memcpy(meshData->vertex.data(), vertices.data(), vertices.size());
+
+    IndexArray indexArray;
+    indexArray.resize(indexCount);
+    auto out = reinterpret_cast<uint16_t*>(indexArray.data());
+    for (size_t i = 0; i < indexCount; ++i)
+        out[i] = static_cast<uint16_t>(indices[i]);
+
+    meshData->subMeshAABB.emplace_back(Bundle3D::calculateAABB(meshData->vertex.data(), static_cast<int>(stride),
+                                                               indexArray.data(), static_cast<unsigned int>(indexCount)));
+    meshData->subMeshIndices.emplace_back(std::move(indexArray));
+    meshData->subMeshIds.emplace_back(id);
+    meshData->numIndex = 1;
+    meshdatas.meshDatas.emplace_back(meshData);
+}
+
+NodeData* Importer::loadNode(unsigned int index, int depth)
+{
+    auto object = getElement("nodes", index);
+    if (!object || depth > MAX_NODE_DEPTH)
+        return nullptr;
+
+    auto node = new NodeData();
+    auto name = getString(*object, "name");
+    node->id  = name.empty() ? StringUtils::format("node%u", index) : std::string{name};
+
+    float matrix[16];
+    if (getFloats(*object, "matrix", matrix, 16))
+        node->transform.set(matrix);
+    else
+    {
+        float t[3] = {0.0f, 0.0f, 0.0f}, r[4] = {0.0f, 0.0f, 0.0f, 1.0f}, s[3] = {1.0f, 1.0f, 1.0f};
+        getFloats(*object, "translation", t, 3);
+        getFloats(*object, "rotation", r, 4);
+        getFloats(*object, "scale", s, 3);
+        Mat4 translation, rotation, scale;
+        Mat4::createTranslation(Vec3(t[0], t[1], t[2]), &translation);
+        Mat4::createRotation(Quaternion(r[0], r[1], r[2], r[3]), &rotation);
+        Mat4::createScale(Vec3(s[0], s[1], s[2]), &scale);
+        node->transform = translation * rotation * scale;
+    }
+
+    auto mesh = getUint(*object, "mesh", INVALID_INDEX);
+    if (mesh < _meshModels.size())
+    {
+        for (const auto& model : _meshModels[mesh])
+            node->modelNodeDatas.emplace_back(new ModelData(model));
+    }
+
+    if (auto children = getArray(*object, "children"))
+    {
+        for (const auto& child : children->GetArray())
+        {
+            if (!child.IsUint())
+                continue;
+            if (auto childNode = loadNode(child.GetUint(), depth + 1))
+                node->children.emplace_back(childNode);
+        }
+    }
+    return node;
+}
+
+bool Importer::load(MeshDatas& meshdatas, MaterialDatas& materialdatas, NodeDatas& nodedatas)
+{
+    if (!loadFile())
+    {
+        AXLOG("warning: Failed to parse glTF file: %s", _path.c_str());
+        return false;
+    }
+    auto asset = getObject(_document, "asset");
+    if (!asset || getString(*asset, "version").substr(0, 1) != "2")
+    {
+        AXLOG("warning: Only glTF 2.0 is supported: %s", _path.c_str());
+        return false;
+    }
+
+    if (!loadBuffers())
+        return false;
+    loadMaterials(materialdatas);
+    if (!loadMeshes(meshdatas))
+        return false;
+
+    // the nodes of the default scene, or all root nodes without scenes
+    std::vector<unsigned int> roots;
+    auto scene = getElement("scenes", getUint(_document, "scene", 0));
+    if (auto sceneNodes = scene ? getArray(*scene, "nodes") : nullptr)
+    {
+        for (const auto& node : sceneNodes->GetArray())
+        {
+            if (node.IsUint())
+                roots.emplace_back(node.GetUint());
+        }
+    }
+    else if (auto nodes = getArray(_document, "nodes"))
+    {
+        std::vector<bool> isChild(nodes->Size(), false);
+        for (const auto& node : nodes->GetArray())
+        {
+            auto children = node.IsObject() ? getArray(node, "children") : nullptr;
+            for (rapidjson::SizeType c = 0; children && c < children->Size(); ++c)
+            {
+                if ((*children)[c].IsUint() && (*children)[c].GetUint() < isChild.size())
+                    isChild[(*children)[c].GetUint()] = true;
+            }
+        }
+        for (unsigned int i = 0; i < nodes->Size(); ++i)
+        {
+            if (!isChild[i])
+                roots.emplace_back(i);
+        }
+    }
+
+    for (auto root : roots)
+    {
+        if (auto node = loadNode(root, 0))
+            nodedatas.nodes.emplace_back(node);
+    }
+    return true;
+}
+}  // namespace
+
+bool GLTFLoader::load(std::string_view fullPath,
+                      MeshDatas& meshdatas,
+                      MaterialDatas& materialdatas,
+                      NodeDatas& nodedatas,
+                      const GLTFImportOptions& options,
+                      GLTFImportStats* stats)
+{
+    meshdatas.resetData();
+    materialdatas.resetData();
+    nodedatas.resetData();
+    if (stats)
+        *stats = GLTFImportStats();
+
+    Importer importer(fullPath, options, stats);
+    if (!importer.load(meshdatas, materialdatas, nodedatas))
+    {
+        meshdatas.resetData();
+        materialdatas.resetData();
+        nodedatas.resetData();
+        return false;
+    }
+
+    if (stats && stats->triangles > 0)
+    {
+        stats->sourceACMR /= stats->triangles;
+        stats->acmr /= stats->triangles;
+    }
+    return true;
+}
+
+NS_AX_END
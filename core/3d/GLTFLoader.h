@@ -0,0 +1,82 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "3d/Bundle3DData.h"
+
+#include <string_view>
+
+NS_AX_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/** How GLTFLoader converts meshes. */
+struct GLTFImportOptions
+{
+    /** Deduplicates vertices, reorders triangles for the vertex cache and overdraw and vertices for fetching. */
+    bool optimize = true;
+    /** Stores texture coordinates in [0, 1] as normalized 16 bits and colors as normalized 8 bits. */
+    bool quantize = true;
+};
+
+/** What the optimizations of an import did, the ACMRs are averaged over all triangles. */
+struct GLTFImportStats
+{
+    size_t sourceVertices = 0;  // vertices of the primitives in the file
+    size_t vertices       = 0;  // vertices after deduplication
+    size_t triangles      = 0;
+    size_t sourceBytes    = 0;  // vertex bytes with 32 bits float attributes
+    size_t bytes          = 0;  // vertex bytes after quantization
+    float sourceACMR      = 0.0f;
+    float acmr            = 0.0f;
+};
+
+/**
+ * @class GLTFLoader
+ * @brief Imports glTF 2.0 files, .glb or .gltf with external or data uri buffers, to the data of a MeshRenderer.
+ *
+ * Each primitive becomes a MeshData, split in chunks of 65535 vertices for 16 bits indices, nodes keep their
+ * hierarchy and transforms. Materials map the base color, normal and emissive textures, images embedded in the
+ * file are decoded to MaterialDatas::embeddedImages. Skins, morph targets, animations and sparse accessors are
+ * ignored. A .glb file is mapped into memory if possible and accessors are read from it directly.
+ * It only touches the file system and the data it fills, so it's safe to call from a worker thread.
+ */
+class AX_DLL GLTFLoader
+{
+public:
+    static bool load(std::string_view fullPath,
+                     MeshDatas& meshdatas,
+                     MaterialDatas& materialdatas,
+                     NodeDatas& nodedatas,
+                     const GLTFImportOptions& options = GLTFImportOptions(),
+                     GLTFImportStats* stats           = nullptr);
+};
+
+// end of 3d group
+/// @}
+
+NS_AX_END
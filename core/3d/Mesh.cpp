@@ -25,7 +25,9 @@
 
 #include "3d/Mesh.h"
 #include "3d/MeshSkin.h"
+#include "3d/MeshMaterial.h"
 #include "3d/Skeleton3D.h"
+#include "3d/SkinningPaletteBuffer.h"
 #include "3d/MeshVertexIndexData.h"
 #include "3d/VertexAttribBinding.h"
 #include "2d/Light.h"
@@ -160,6 +162,11 @@ void Mesh::rebuildInstances()
     _instanceTransformDirty = true;
 }
 
+void Mesh::setInstancePalettes(std::vector<Vec4> palettes)
+{
+    _instancePalettes = std::move(palettes);
+}
+
 void Mesh::setDynamicInstancing(bool dynamic)
 {
     _dynamicInstancing = dynamic;
@@ -503,6 +510,45 @@ void Mesh::draw(Renderer* renderer,
     //                       transform,
     //                       flags);
 
+    // pack once for all passes, the palette programs only get where the bones of this draw start
+    auto paletteBuffer = SkinningPaletteBuffer::getInstance();
+    Vec4 paletteParams;
+    if (_skin && usesPaletteTexture())
+    {
+        const int boneCount = static_cast<int>(_skin->getBoneCount());
+        const int instances = static_cast<int>(_instances.size());
+        int paletteOffset   = -1;
+        if (_instancing && instances > 0 &&
+            _instancePalettes.size() >= static_cast<size_t>(boneCount * 3 * instances))
+        {
+            paletteOffset = paletteBuffer->pack(_instancePalettes.data(), boneCount * instances);
+            paletteParams.set(static_cast<float>(paletteOffset), static_cast<float>(boneCount), 0, 0);
+        }
+        if (paletteOffset < 0)
+        {
+            // all instances share the palette of the mesh when they don't have their own, or it doesn't fit
+            paletteOffset = paletteBuffer->pack(_skin->getMatrixPalette(), boneCount);
+            paletteParams.set(static_cast<float>(paletteOffset), 0, 0, 0);
+        }
+
+        if (paletteOffset >= 0)
+            paletteBuffer->queueUpload(renderer);
+        else
+        {
+            // the palette texture is full, skin this mesh with u_matrixPalette from now on
+            auto meshMaterial = dynamic_cast<MeshMaterial*>(_material);
+            auto material =
+                meshMaterial ? MeshMaterial::createUniformSkinMaterial(meshMaterial->getMaterialType()) : nullptr;
+            if (!material)
+            {
+                AXLOG("Mesh %s: the skinning palette is full and its material can't skin with u_matrixPalette",
+                      _name.c_str());
+                return;
+            }
+            setMaterial(material);
+        }
+    }
+
     if (isTransparent && !forceDepthWrite)
         _material->getStateBlock().setDepthWrite(false);
     else
@@ -516,7 +562,12 @@ void Mesh::draw(Renderer* renderer,
     {
         pass->setUniformColor(&color, sizeof(color));
 
-        if (_skin)
+        if (_skin && pass->hasUniformPaletteTexture())
+        {
+            pass->setUniformPaletteParams(&paletteParams, sizeof(paletteParams));
+            pass->setUniformPaletteTexture(SkinningPaletteBuffer::TEXTURE_SLOT, paletteBuffer->getTexture());
+        }
+        else if (_skin)
             pass->setUniformMatrixPalette(_skin->getMatrixPalette(), _skin->getMatrixPaletteSizeInBytes());
 
         if (scene && !scene->getLights().empty())
@@ -547,6 +598,16 @@ void Mesh::draw(Renderer* renderer,
                     static_cast<unsigned int>(getIndexCount()), transform);
 }
 
+bool Mesh::usesPaletteTexture() const
+{
+    for (auto&& pass : _material->_currentTechnique->_passes)
+    {
+        if (pass->hasUniformPaletteTexture())
+            return true;
+    }
+    return false;
+}
+
 void Mesh::setSkin(MeshSkin* skin)
 {
     if (_skin != skin)
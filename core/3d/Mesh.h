@@ -251,6 +251,8 @@ public:
      */
     void enableInstancing(bool instance, int count = 0);
 
+    bool isInstancing() const { return _instancing; }
+
     /** Set this to true and instancing objects within this mesh renderer
     will be recalculated each frame, use it when you plan to move objects,
     Otherwise, transforms will be built once for better performance.
@@ -273,6 +275,13 @@ public:
     /** rebuilds the instance transform buffer next frame. */
     void rebuildInstances();
 
+    /**
+     * Sets one matrix palette per instance child, in the order they were added, for instanced skinning
+     * with SkinningPaletteBuffer. Without them, all instances are skinned with the palette of the mesh.
+     */
+    void setInstancePalettes(std::vector<Vec4> palettes);
+    const std::vector<Vec4>& getInstancePalettes() const { return _instancePalettes; }
+
     Mesh();
     virtual ~Mesh();
 
@@ -280,6 +289,8 @@ protected:
     void resetLightUniformValues();
     void setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigned int lightmask);
     void bindMeshCommand();
+    // whether a pass of the current technique reads the bones from SkinningPaletteBuffer
+    bool usesPaletteTexture() const;
 
     std::map<NTextureData::Usage, Texture2D*> _textures;  // textures that submesh is using
     MeshSkin* _skin;                                      // skin
@@ -293,6 +304,7 @@ protected:
     std::vector<Node*> _instances;
     float* _instanceMatrixCache;
     bool _dynamicInstancing;
+    std::vector<Vec4> _instancePalettes;
 
     CustomCommand::IndexFormat meshIndexFormat;
 
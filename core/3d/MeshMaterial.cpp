@@ -25,6 +25,7 @@
 
 #include "3d/MeshMaterial.h"
 #include "3d/Mesh.h"
+#include "3d/SkinningPaletteBuffer.h"
 #include "platform/FileUtils.h"
 #include "renderer/Texture2D.h"
 #include "base/Director.h"
@@ -48,6 +49,8 @@ MeshMaterial* MeshMaterial::_diffuseNoTexMaterial  = nullptr;
 MeshMaterial* MeshMaterial::_bumpedDiffuseMaterial = nullptr;
 
 MeshMaterial* MeshMaterial::_unLitMaterialSkin         = nullptr;
+MeshMaterial* MeshMaterial::_unLitMaterialSkinPalette  = nullptr;
+MeshMaterial* MeshMaterial::_unLitInstanceMaterialSkin = nullptr;
 MeshMaterial* MeshMaterial::_vertexLitMaterialSkin     = nullptr;
 MeshMaterial* MeshMaterial::_diffuseMaterialSkin       = nullptr;
 MeshMaterial* MeshMaterial::_bumpedDiffuseMaterialSkin = nullptr;
@@ -64,6 +67,8 @@ backend::ProgramState* MeshMaterial::_diffuseNoTexMaterialProgState  = nullptr;
 backend::ProgramState* MeshMaterial::_bumpedDiffuseMaterialProgState = nullptr;
 
 backend::ProgramState* MeshMaterial::_unLitMaterialSkinProgState         = nullptr;
+backend::ProgramState* MeshMaterial::_unLitMaterialSkinPaletteProgState  = nullptr;
+backend::ProgramState* MeshMaterial::_unLitInstanceMaterialSkinProgState = nullptr;
 backend::ProgramState* MeshMaterial::_vertexLitMaterialSkinProgState     = nullptr;
 backend::ProgramState* MeshMaterial::_diffuseMaterialSkinProgState       = nullptr;
 backend::ProgramState* MeshMaterial::_bumpedDiffuseMaterialSkinProgState = nullptr;
@@ -81,6 +86,23 @@ void MeshMaterial::createBuiltInMaterial()
         _unLitMaterialSkin->_type = MeshMaterial::MaterialType::UNLIT;
     }
 
+    program = backend::Program::getBuiltinProgram(backend::ProgramType::SKINPOSITION_TEXTURE_3D_PALETTE);
+    _unLitMaterialSkinPaletteProgState = new backend::ProgramState(program);
+    _unLitMaterialSkinPalette          = new MeshMaterial();
+    if (_unLitMaterialSkinPalette && _unLitMaterialSkinPalette->initWithProgramState(_unLitMaterialSkinPaletteProgState))
+    {
+        _unLitMaterialSkinPalette->_type = MeshMaterial::MaterialType::UNLIT;
+    }
+
+    program = backend::Program::getBuiltinProgram(backend::ProgramType::SKINPOSITION_TEXTURE_3D_INSTANCE);
+    _unLitInstanceMaterialSkinProgState = new backend::ProgramState(program);
+    _unLitInstanceMaterialSkin          = new MeshMaterial();
+    if (_unLitInstanceMaterialSkin &&
+        _unLitInstanceMaterialSkin->initWithProgramState(_unLitInstanceMaterialSkinProgState))
+    {
+        _unLitInstanceMaterialSkin->_type = MeshMaterial::MaterialType::UNLIT_INSTANCE;
+    }
+
     program = backend::Program::getBuiltinProgram(backend::ProgramType::SKINPOSITION_NORMAL_TEXTURE_3D);
     _diffuseMaterialSkinProgState = new backend::ProgramState(program);
     _diffuseMaterialSkin          = new MeshMaterial();
@@ -167,6 +189,9 @@ void MeshMaterial::releaseBuiltInMaterial()
 {
     AX_SAFE_RELEASE_NULL(_unLitMaterial);
     AX_SAFE_RELEASE_NULL(_unLitMaterialSkin);
+    AX_SAFE_RELEASE_NULL(_unLitMaterialSkinPalette);
+    AX_SAFE_RELEASE_NULL(_unLitInstanceMaterial);
+    AX_SAFE_RELEASE_NULL(_unLitInstanceMaterialSkin);
 
     AX_SAFE_RELEASE_NULL(_unLitNoTexMaterial);
     AX_SAFE_RELEASE_NULL(_vertexLitMaterial);
@@ -186,6 +211,9 @@ void MeshMaterial::releaseBuiltInMaterial()
     AX_SAFE_RELEASE_NULL(_bumpedDiffuseMaterialProgState);
 
     AX_SAFE_RELEASE_NULL(_unLitMaterialSkinProgState);
+    AX_SAFE_RELEASE_NULL(_unLitMaterialSkinPaletteProgState);
+    AX_SAFE_RELEASE_NULL(_unLitInstanceMaterialProgState);
+    AX_SAFE_RELEASE_NULL(_unLitInstanceMaterialSkinProgState);
     AX_SAFE_RELEASE_NULL(_vertexLitMaterialSkinProgState);
     AX_SAFE_RELEASE_NULL(_diffuseMaterialSkinProgState);
     AX_SAFE_RELEASE_NULL(_bumpedDiffuseMaterialSkinProgState);
@@ -237,11 +265,18 @@ MeshMaterial* MeshMaterial::createBuiltInMaterial(MaterialType type, bool skinne
     switch (type)
     {
     case MeshMaterial::MaterialType::UNLIT:
-        material = skinned ? _unLitMaterialSkin : _unLitMaterial;
+        if (skinned)
+            material = SkinningPaletteBuffer::getInstance()->isEnabled() ? _unLitMaterialSkinPalette : _unLitMaterialSkin;
+        else
+            material = _unLitMaterial;
         break;
 
     case MeshMaterial::MaterialType::UNLIT_INSTANCE:
-        material = skinned ? /* TODO: implement instanced hardware skinning */ nullptr : _unLitInstanceMaterial;
+        // instanced skinning reads one palette per instance from the shared palette texture
+        if (skinned)
+            material = SkinningPaletteBuffer::getInstance()->isEnabled() ? _unLitInstanceMaterialSkin : nullptr;
+        else
+            material = _unLitInstanceMaterial;
         break;
 
     case MeshMaterial::MaterialType::UNLIT_NOTEX:
@@ -281,6 +316,19 @@ MeshMaterial* MeshMaterial::createBuiltInMaterial(MaterialType type, bool skinne
     return nullptr;
 }
 
+MeshMaterial* MeshMaterial::createUniformSkinMaterial(MaterialType type)
+{
+    if (_diffuseMaterial == nullptr)
+        createBuiltInMaterial();
+
+    // instanced skinning has no program reading one palette per instance from uniforms
+    if (type == MeshMaterial::MaterialType::UNLIT)
+        return (MeshMaterial*)_unLitMaterialSkin->clone();
+    if (type == MeshMaterial::MaterialType::UNLIT_INSTANCE)
+        return nullptr;
+    return createBuiltInMaterial(type, true);
+}
+
 MeshMaterial* MeshMaterial::createWithFilename(std::string_view path)
 {
     auto validfilename = FileUtils::getInstance()->fullPathForFilename(path);
@@ -97,6 +97,14 @@ public:
      */
     static MeshMaterial* createBuiltInMaterial(MaterialType type, bool skinned);
 
+    /**
+     * Create the built in skinned material of a type that reads the bones from u_matrixPalette even while
+     * SkinningPaletteBuffer is enabled, for the meshes that don't fit in the palette texture.
+     * @param type Material type
+     * @return An autorelease material object, nullptr if the type has no such program
+     */
+    static MeshMaterial* createUniformSkinMaterial(MaterialType type);
+
     /**
      * Create material with file name, it creates material from cache if it is previously loaded
      * @param path Path of material file
@@ -145,6 +153,8 @@ protected:
     static MeshMaterial* _bumpedDiffuseMaterial;
 
     static MeshMaterial* _unLitMaterialSkin;
+    static MeshMaterial* _unLitMaterialSkinPalette;
+    static MeshMaterial* _unLitInstanceMaterialSkin;
     static MeshMaterial* _vertexLitMaterialSkin;
     static MeshMaterial* _diffuseMaterialSkin;
     static MeshMaterial* _bumpedDiffuseMaterialSkin;
@@ -161,6 +171,8 @@ protected:
     static backend::ProgramState* _bumpedDiffuseMaterialProgState;
 
     static backend::ProgramState* _unLitMaterialSkinProgState;
+    static backend::ProgramState* _unLitMaterialSkinPaletteProgState;
+    static backend::ProgramState* _unLitInstanceMaterialSkinProgState;
     static backend::ProgramState* _vertexLitMaterialSkinProgState;
     static backend::ProgramState* _diffuseMaterialSkinProgState;
     static backend::ProgramState* _bumpedDiffuseMaterialSkinProgState;
@@ -0,0 +1,369 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "3d/MeshOptimizer.h"
+#include "math/Vec3.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+NS_AX_BEGIN
+
+namespace
+{
+// scoring of "Linear-Speed Vertex Cache Optimisation", Tom Forsyth
+const int FORSYTH_CACHE_SIZE       = 32;
+const float FORSYTH_DECAY_POWER    = 1.5f;
+const float FORSYTH_LAST_TRI_SCORE = 0.75f;
+const float FORSYTH_VALENCE_SCALE  = 2.0f;
+const float FORSYTH_VALENCE_POWER  = 0.5f;
+const uint32_t INVALID_INDEX       = 0xffffffff;
+
+float vertexScore(int cachePosition, uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // the vertices of the last triangle get a fixed score, so the next one isn't always a neighbor of it
+        if (cachePosition < 3)
+            score = FORSYTH_LAST_TRI_SCORE;
+        else
+            score = powf(1.0f - (cachePosition - 3) / float(FORSYTH_CACHE_SIZE - 3), FORSYTH_DECAY_POWER);
+    }
+    // favor vertices with few triangles left, to finish them off instead of leaving lone triangles behind
+    return score + FORSYTH_VALENCE_SCALE * powf(float(remainingTriangles), -FORSYTH_VALENCE_POWER);
+}
+
+Vec3 readPosition(const uint8_t* positions, size_t stride, uint32_t index)
+{
+    float p[3];
+    memcpy(p, positions + index * stride, sizeof(p));
+    return Vec3(p[0], p[1], p[2]);
+}
+}  // namespace
+
+size_t MeshOptimizer::deduplicateVertices(std::vector<uint8_t>& vertices, size_t stride, std::vector<uint32_t>& indices)
+{
+    const size_t vertexCount = vertices.size() / stride;
+    size_t tableSize         = 2;
+    while (tableSize < vertexCount * 2)
+        tableSize <<= 1;
+    std::vector<uint32_t> table(tableSize, INVALID_INDEX);
+    std::vector<uint32_t> remap(vertexCount);
+
+    uint8_t* data = vertices.data();
+    size_t unique = 0;
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const uint8_t* vertex = data + v * stride;
+
+        // FNV-1a over the bytes of the vertex, then linear probing
+        uint32_t hash = 2166136261u;
+        for (size_t b = 0; b < stride; ++b)
+            hash = (hash ^ vertex[b]) * 16777619u;
+
+        size_t slot = hash & (tableSize - 1);
+        while (table[slot] != INVALID_INDEX && memcmp(data + table[slot] * stride, vertex, stride) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+
+        if (table[slot] == INVALID_INDEX)
+        {
+            if (unique != v)
+                memmove(data + unique * stride, vertex, stride);
+            table[slot] = static_cast<uint32_t>(unique++);
+        }
+        remap[v] = table[slot];
+    }
+
+    vertices.resize(unique * stride);
+    for (auto& index : indices)
+        index = remap[index];
+    return unique;
+}
+
+void MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+        return;
+
+    // the triangles using each vertex, the first remaining[v] ones of a vertex are the ones not emitted yet
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+        ++offsets[indices[i] + 1];
+    for (size_t v = 0; v < vertexCount; ++v)
+        offsets[v + 1] += offsets[v];
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        for (int k = 0; k < 3; ++k)
+        {
+            auto v                                 = indices[t * 3 + k];
+            adjacency[offsets[v] + remaining[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (size_t v = 0; v < vertexCount; ++v)
+        scores[v] = vertexScore(-1, remaining[v]);
+
+    auto triangleScore = [&](uint32_t t) {
+        return scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+    };
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    int cacheCount = 0;
+
+    uint32_t best   = 0;
+    float bestScore = -1.0f;
+    for (uint32_t t = 0; t < triangleCount; ++t)
+    {
+        auto score = triangleScore(t);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best      = t;
+        }
+    }
+
+    size_t cursor = 0;
+    while (true)
+    {
+        emitted[best]       = true;
+        const uint32_t* tri = indices + best * 3;
+        output.insert(output.end(), tri, tri + 3);
+
+        for (int k = 0; k < 3; ++k)
+        {
+            auto v     = tri[k];
+            auto begin = adjacency.begin() + offsets[v];
+            auto it    = std::find(begin, begin + remaining[v], best);
+            if (it != begin + remaining[v])
+            {
+                *it = begin[remaining[v] - 1];
+                --remaining[v];
+            }
+        }
+
+        // the triangle goes to the front of the cache, the vertices pushed past its end lose their cache score
+        uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+        int newCount = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            if (std::find(newCache, newCache + newCount, tri[k]) == newCache + newCount)
+                newCache[newCount++] = tri[k];
+        }
+        for (int i = 0; i < cacheCount; ++i)
+        {
+            if (std::find(tri, tri + 3, cache[i]) == tri + 3)
+                newCache[newCount++] = cache[i];
+        }
+        for (int i = 0; i < newCount; ++i)
+        {
+            auto v           = newCache[i];
+            cachePosition[v] = i < FORSYTH_CACHE_SIZE ? i : -1;
+            scores[v]        = vertexScore(cachePosition[v], remaining[v]);
+        }
+        cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+        std::copy(newCache, newCache + cacheCount, cache);
+
+        // only the triangles around the cache changed their score
+        bestScore = -1.0f;
+        for (int i = 0; i < newCount; ++i)
+        {
+            auto v     = newCache[i];
+            auto begin = adjacency.data() + offsets[v];
+            for (uint32_t j = 0; j < remaining[v]; ++j)
+            {
+                auto score = triangleScore(begin[j]);
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    best      = begin[j];
+                }
+            }
+        }
+
+        if (bestScore < 0.0f)
+        {
+            // nothing left around the cache, continue with the next triangle not emitted yet
+            while (cursor < triangleCount && emitted[cursor])
+                ++cursor;
+            if (cursor == triangleCount)
+                break;
+            best = static_cast<uint32_t>(cursor);
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices);
+}
+
+void MeshOptimizer::optimizeOverdraw(uint32_t* indices,
+                                     size_t indexCount,
+                                     const uint8_t* positions,
+                                     size_t positionStride,
+                                     size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2)
+        return;
+
+    // a new cluster starts at each triangle missing all its vertices in the cache, so reordering the clusters
+    // costs almost no cache efficiency
+    std::vector<size_t> clusters;
+    std::vector<uint32_t> stamps(vertexCount, 0);
+    uint32_t time = DEFAULT_CACHE_SIZE + 1;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k)
+        {
+            auto v = indices[t * 3 + k];
+            if (time - stamps[v] > DEFAULT_CACHE_SIZE)
+            {
+                stamps[v] = time++;
+                ++misses;
+            }
+        }
+        if (t == 0 || misses == 3)
+            clusters.emplace_back(t);
+    }
+    if (clusters.size() < 2)
+        return;
+    clusters.emplace_back(triangleCount);
+
+    // area weighted centroids and normals of the clusters and the mesh
+    const size_t clusterCount = clusters.size() - 1;
+    std::vector<Vec3> centroids(clusterCount), normals(clusterCount);
+    std::vector<float> areas(clusterCount, 0.0f);
+    Vec3 meshCentroid;
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        for (size_t t = clusters[c]; t < clusters[c + 1]; ++t)
+        {
+            auto p0 = readPosition(positions, positionStride, indices[t * 3]);
+            auto p1 = readPosition(positions, positionStride, indices[t * 3 + 1]);
+            auto p2 = readPosition(positions, positionStride, indices[t * 3 + 2]);
+            Vec3 normal;
+            Vec3::cross(p1 - p0, p2 - p0, &normal);
+            auto area = normal.length();
+            centroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+            normals[c] += normal;
+            areas[c] += area;
+        }
+        meshCentroid += centroids[c];
+        meshArea += areas[c];
+        if (areas[c] > 0.0f)
+            centroids[c] *= 1.0f / areas[c];
+        normals[c].normalize();
+    }
+    if (meshArea > 0.0f)
+        meshCentroid *= 1.0f / meshArea;
+
+    // clusters facing away from the center are drawn first, they occlude the ones behind them from most views
+    std::vector<float> keys(clusterCount);
+    std::vector<size_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c)
+    {
+        keys[c]  = (centroids[c] - meshCentroid).dot(normals[c]);
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] > keys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    for (auto c : order)
+        output.insert(output.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+    std::copy(output.begin(), output.end(), indices);
+}
+
+size_t MeshOptimizer::optimizeVertexFetch(uint8_t* vertices,
+                                          size_t stride,
+                                          size_t vertexCount,
+                                          uint32_t* indices,
+                                          size_t indexCount)
+{
+    std::vector<uint32_t> remap(vertexCount, INVALID_INDEX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        auto& index = indices[i];
+        if (remap[index] == INVALID_INDEX)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    std::vector<uint8_t> source(vertices, vertices + vertexCount * stride);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        if (remap[v] != INVALID_INDEX)
+            memcpy(vertices + remap[v] * stride, source.data() + v * stride, stride);
+    }
+    return next;
+}
+
+float MeshOptimizer::analyzeVertexCache(const uint32_t* indices,
+                                        size_t indexCount,
+                                        size_t vertexCount,
+                                        unsigned int cacheSize)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return 0.0f;
+
+    std::vector<uint32_t> stamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    size_t misses = 0;
+    for (size_t i = 0; i < triangleCount * 3; ++i)
+    {
+        auto v = indices[i];
+        if (time - stamps[v] > cacheSize)
+        {
+            stamps[v] = time++;
+            ++misses;
+        }
+    }
+    return float(misses) / float(triangleCount);
+}
+
+uint32_t MeshOptimizer::quantizeUnorm(float v, int bits)
+{
+    const float scale = float((1u << bits) - 1);
+    v                 = std::min(std::max(v, 0.0f), 1.0f);
+    return static_cast<uint32_t>(v * scale + 0.5f);
+}
+
+NS_AX_END
@@ -0,0 +1,100 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "platform/PlatformMacros.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+NS_AX_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @class MeshOptimizer
+ * @brief Import time optimizations of indexed triangle lists, used by the glTF importer.
+ *
+ * The usual order is deduplicateVertices, optimizeVertexCache, optimizeOverdraw and optimizeVertexFetch last,
+ * since the later steps keep the improvements of the earlier ones.
+ */
+class AX_DLL MeshOptimizer
+{
+public:
+    /** The cache size of the FIFO used to estimate post transform cache efficiency. */
+    static const unsigned int DEFAULT_CACHE_SIZE = 16;
+
+    /**
+     * Merges vertices with identical bytes and remaps the indices, returns the unique vertex count.
+     * The unique vertices are moved to the front of vertices in order of first appearance.
+     */
+    static size_t deduplicateVertices(std::vector<uint8_t>& vertices, size_t stride, std::vector<uint32_t>& indices);
+
+    /**
+     * Reorders the triangles to maximize post transform cache hits, using Tom Forsyth's linear-speed algorithm.
+     */
+    static void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+    /**
+     * Reorders clusters of cache optimized triangles front to back from the outside, so the depth test rejects
+     * more fragments whatever the view direction. Clusters are split where the cache is flushed, so the cache
+     * efficiency is mostly kept. positions points to the first position, positionStride is in bytes.
+     */
+    static void optimizeOverdraw(uint32_t* indices,
+                                 size_t indexCount,
+                                 const uint8_t* positions,
+                                 size_t positionStride,
+                                 size_t vertexCount);
+
+    /**
+     * Reorders the vertices in order of first use by the indices, so the vertex fetch reads memory linearly,
+     * and remaps the indices. Unused vertices are dropped, returns the new vertex count.
+     */
+    static size_t optimizeVertexFetch(uint8_t* vertices,
+                                      size_t stride,
+                                      size_t vertexCount,
+                                      uint32_t* indices,
+                                      size_t indexCount);
+
+    /**
+     * Gets the average cache miss ratio, vertices transformed per triangle, of a FIFO cache.
+     * 3 is the worst, 0.5 the best for a regular grid.
+     */
+    static float analyzeVertexCache(const uint32_t* indices,
+                                    size_t indexCount,
+                                    size_t vertexCount,
+                                    unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+    /** Quantizes a value in [0, 1] to an unsigned normalized integer of bits bits. */
+    static uint32_t quantizeUnorm(float v, int bits);
+};
+
+// end of 3d group
+/// @}
+
+NS_AX_END
@@ -28,6 +28,7 @@
 #include "3d/ObjLoader.h"
 #include "3d/MeshSkin.h"
 #include "3d/Bundle3D.h"
+#include "3d/GLTFLoader.h"
 #include "3d/MeshMaterial.h"
 #include "3d/AttachNode.h"
 #include "3d/Mesh.h"
@@ -47,6 +48,8 @@
 #include "renderer/Technique.h"
 #include "renderer/Pass.h"
 
+#include <limits>
+
 NS_AX_BEGIN
 
 static MeshMaterial* getMeshRendererMaterialForAttribs(MeshVertexData* meshVertexData, bool usesLight);
@@ -125,6 +128,41 @@ void MeshRenderer::createAsync(std::string_view modelPath,
 void MeshRenderer::afterAsyncLoad(void* param)
 {
     MeshRenderer::AsyncLoadParam* asyncParam = (MeshRenderer::AsyncLoadParam*)param;
+    if (asyncParam && asyncParam->result)
+    {
+        // decode the textures on the texture cache loading thread too, so only the gpu uploads and the node
+        // creation are left to the main thread once they are all cached
+        std::vector<std::string> textures;
+        for (const auto& material : asyncParam->materialdatas->materials)
+        {
+            for (const auto& texture : material.textures)
+            {
+                if (!texture.filename.empty() && !asyncParam->materialdatas->isEmbeddedImage(texture.filename) &&
+                    std::find(textures.begin(), textures.end(), texture.filename) == textures.end())
+                    textures.emplace_back(texture.filename);
+            }
+        }
+        if (!asyncParam->texPath.empty())
+            textures.emplace_back(asyncParam->texPath);
+
+        // one extra count so cached textures, whose callbacks run right away, can't finish the load early
+        asyncParam->pendingTextures = static_cast<int>(textures.size()) + 1;
+        for (const auto& texture : textures)
+        {
+            _director->getTextureCache()->addImageAsync(texture, [this, asyncParam](Texture2D*) {
+                if (--asyncParam->pendingTextures == 0)
+                    finishAsyncLoad(asyncParam);
+            });
+        }
+        if (--asyncParam->pendingTextures == 0)
+            finishAsyncLoad(asyncParam);
+        return;
+    }
+    finishAsyncLoad(asyncParam);
+}
+
+void MeshRenderer::finishAsyncLoad(AsyncLoadParam* asyncParam)
+{
     autorelease();
     if (asyncParam)
     {
@@ -243,10 +281,16 @@ bool MeshRenderer::loadFromFile(std::string_view path,
     {
         return Bundle3D::loadObj(*meshdatas, *materialdatas, *nodedatas, fullPath);
     }
+    else if (ext == ".gltf" || ext == ".glb")
+    {
+        return GLTFLoader::load(fullPath, *meshdatas, *materialdatas, *nodedatas);
+    }
     else if (ext == ".c3b" || ext == ".c3t")
     {
         // load from .c3b or .c3t
         auto bundle = Bundle3D::createBundle();
+        // the mesh datas are uploaded and dropped right after, let them point into the mapped file
+        bundle->setZeroCopy(true);
         if (!bundle->load(fullPath))
         {
             Bundle3D::destroyBundle(bundle);
@@ -264,6 +308,7 @@ bool MeshRenderer::loadFromFile(std::string_view path,
 
 MeshRenderer::MeshRenderer()
     : _skeleton(nullptr)
+    , _skeletonFrame(std::numeric_limits<unsigned int>::max())
     , _blend(BlendFunc::ALPHA_NON_PREMULTIPLIED)
     , _lightMask(-1)
     , _aabbDirty(true)
@@ -335,6 +380,14 @@ bool MeshRenderer::initWithFile(std::string_view path)
 
 bool MeshRenderer::initFrom(const NodeDatas& nodeDatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas)
 {
+    // images decoded by the loader, i.e. embedded in a glb, are only uploaded here on the main thread
+    auto textureCache = _director->getTextureCache();
+    for (const auto& image : materialdatas.embeddedImages)
+    {
+        if (!textureCache->getTextureForKey(image.first))
+            textureCache->addImage(image.second.get(), image.first);
+    }
+
     for (const auto& it : meshdatas.meshDatas)
     {
         if (it)
@@ -384,7 +437,8 @@ MeshRenderer* MeshRenderer::createMeshRendererNode(NodeData* nodedata, ModelData
     if (modeldata->materialId.empty() && !materialdatas.materials.empty())
     {
         const NTextureData* textureData = materialdatas.materials[0].getTextureData(NTextureData::Usage::Diffuse);
-        setMeshTexture(mesh, textureData->filename);
+        if (textureData)
+            setMeshTexture(mesh, textureData->filename);
     }
     else
     {
@@ -549,7 +603,8 @@ void MeshRenderer::createNode(NodeData* nodedata, Node* root, const MaterialData
                     {
                         const NTextureData* textureData =
                             materialdatas.materials[0].getTextureData(NTextureData::Usage::Diffuse);
-                        setMeshTexture(mesh, textureData->filename);
+                        if (textureData)
+                            setMeshTexture(mesh, textureData->filename);
                     }
                     else
                     {
@@ -700,6 +755,14 @@ void MeshRenderer::enableInstancing(MeshMaterial::InstanceMaterialType instanceM
     {
         auto mat = MeshMaterial::createBuiltInMaterial(MeshMaterial::MaterialType::UNLIT_INSTANCE, false);
         enableInstancing(mat, count);
+
+        // skinned meshes need the instanced skinning program, which is only available with SkinningPaletteBuffer
+        auto skinMat = MeshMaterial::createBuiltInMaterial(MeshMaterial::MaterialType::UNLIT_INSTANCE, true);
+        for (auto&& mesh : _meshes)
+        {
+            if (mesh->getSkin() && skinMat)
+                mesh->setMaterial(skinMat->clone());
+        }
     }
     }
 }
@@ -810,6 +873,13 @@ void MeshRenderer::visit(ax::Renderer* renderer, const ax::Mat4& parentTransform
         return;
     }
 
+    // quick return if the scene BVH culled it and it didn't move since, there is nothing to update either
+    if (_children.empty() && _cullingProxy.isCulled() && !(parentFlags & FLAGS_DIRTY_MASK) && !_transformUpdated &&
+        !_contentSizeDirty && !_aabbDirty)
+    {
+        return;
+    }
+
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
     flags |= FLAGS_RENDER_AS_3D;
 
@@ -817,7 +887,8 @@ void MeshRenderer::visit(ax::Renderer* renderer, const ax::Mat4& parentTransform
     _director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
     _director->loadMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW, _modelViewTransform);
 
-    bool visibleByCamera = isVisitableByVisitingCamera();
+    // refit even if this camera skips it, the dirty flags are cleared now
+    bool visibleByCamera = updateCullingProxy(flags) && isVisitableByVisitingCamera();
 
     int i = 0;
 
@@ -849,6 +920,29 @@ void MeshRenderer::visit(ax::Renderer* renderer, const ax::Mat4& parentTransform
     _director->popMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
 }
 
+bool MeshRenderer::updateCullingProxy(uint32_t flags)
+{
+    if (_cullingProxy.needsUpdate() || (flags & FLAGS_DIRTY_MASK) || _aabbDirty)
+    {
+        // instances are spread out of the AABB of the renderer
+        bool instancing = false;
+        for (auto&& mesh : _meshes)
+            instancing = instancing || mesh->isInstancing();
+
+        if (instancing || !SceneBVH::getVisitingTree())
+            _cullingProxy.detach();
+        else
+            _cullingProxy.update(getAABB(), this);
+    }
+    return !_cullingProxy.isCulled();
+}
+
+void MeshRenderer::onExit()
+{
+    _cullingProxy.detach();
+    Node::onExit();
+}
+
 void MeshRenderer::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
 {
 #if AX_USE_CULLING
@@ -859,7 +953,7 @@ void MeshRenderer::draw(Renderer* renderer, const Mat4& transform, uint32_t flag
 //        return;
 #endif
 
-    if (_skeleton)
+    if (_skeleton && _skeletonFrame != _director->getTotalFrames())
         _skeleton->updateBoneMatrix();
 
     Color4F color(getDisplayedColor());
@@ -892,6 +986,20 @@ void MeshRenderer::draw(Renderer* renderer, const Mat4& transform, uint32_t flag
     }
 }
 
+void MeshRenderer::updateSkeleton(unsigned int frame)
+{
+    if (!_skeleton)
+        return;
+
+    _skeleton->updateBoneMatrix();
+    for (auto&& mesh : _meshes)
+    {
+        if (auto skin = mesh->getSkin())
+            skin->getMatrixPalette();
+    }
+    _skeletonFrame = frame;
+}
+
 bool MeshRenderer::setProgramState(backend::ProgramState* programState, bool ownPS/* = false*/)
 {
     if (Node::setProgramState(programState, ownPS))
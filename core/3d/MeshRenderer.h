@@ -39,6 +39,7 @@
 #include "3d/Bundle3DData.h"
 #include "3d/MeshVertexIndexData.h"
 #include "3d/MeshMaterial.h"
+#include "3d/SceneBVH.h"
 
 NS_AX_BEGIN
 
@@ -115,6 +116,12 @@ public:
 
     Skeleton3D* getSkeleton() const { return _skeleton; }
 
+    /**
+     * Refreshes the bone matrices and the matrix palettes of the skinned meshes, draw skips its own refresh
+     * during the given frame. It's used by SkeletalAnimationStage, only one thread may call it at a time.
+     */
+    void updateSkeleton(unsigned int frame);
+
     /** return an AttachNode by bone name. Otherwise, return nullptr if it doesn't exist */
     AttachNode* getAttachNode(std::string_view boneName);
 
@@ -233,6 +240,8 @@ public:
      */
     virtual void visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags) override;
 
+    virtual void onExit() override;
+
     /** generate default material. */
     void genMaterial(bool useLight = false);
 
@@ -247,6 +256,9 @@ public:
 
     void onAABBDirty() { _aabbDirty = true; }
 
+    /** Updates the entry of the renderer in the scene BVH, returns false if it's culled for the visiting camera. */
+    bool updateCullingProxy(uint32_t flags);
+
     void afterAsyncLoad(void* param);
 
     static AABB getAABBRecursivelyImp(Node* node);
@@ -307,6 +319,7 @@ protected:
     void setModelTexture(std::string_view modelPath, std::string_view texPath);
 
     Skeleton3D* _skeleton;
+    unsigned int _skeletonFrame;  // Director frame the skeleton was refreshed by updateSkeleton
 
     Vector<MeshVertexData*> _meshVertexDatas;
 
@@ -324,6 +337,7 @@ protected:
     bool _forceDepthWrite;   // Always write to depth buffer
     bool _wireframe;         // render in wireframe mode
     bool _usingAutogeneratedGLProgram;
+    SceneBVHProxy _cullingProxy;  // entry in the BVH of the scene when hierarchical culling is enabled
     bool _transparentMaterialHint; // Generate transparent materials when building from files
     unsigned short _meshTextureHint; // Whether model file has texture config
 
@@ -338,8 +352,11 @@ protected:
         MeshDatas* meshdatas;
         MaterialDatas* materialdatas;
         NodeDatas* nodeDatas;
+        int pendingTextures = 0;  // textures still decoding on the texture cache loading thread
     };
     AsyncLoadParam _asyncLoadParam;
+
+    void finishAsyncLoad(AsyncLoadParam* asyncParam);
 };
 
 ///////////////////////////////////////////////////////
@@ -100,9 +100,15 @@ int MeshSkin::getBoneIndex(Bone3D* bone) const
 // compute matrix palette used by gpu skin
 Vec4* MeshSkin::getMatrixPalette()
 {
+    // Mesh::draw asks for it once per pass, the bones only move when the skeleton is updated
+    auto updateCount = _skeleton ? _skeleton->getUpdateCount() : 0;
+    if (!_matrixPalette.empty() && _paletteUpdateCount == updateCount)
+        return _matrixPalette.data();
+    _paletteUpdateCount = updateCount;
+
     _matrixPalette.resize(_skinBones.size() * PALETTE_ROWS);
     int i = 0, paletteIndex = 0;
-    static Mat4 t;
+    Mat4 t;
     for (auto&& it : _skinBones)
     {
         Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
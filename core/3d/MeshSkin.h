@@ -70,7 +70,7 @@ public:
     /**get bone index*/
     int getBoneIndex(Bone3D* bone) const;
 
-    /**compute matrix palette used by gpu skin*/
+    /**compute matrix palette used by gpu skin, it's only recomputed when the skeleton was updated since the last call*/
     Vec4* getMatrixPalette();
 
     /**getSkinBoneCount() * 3*/
@@ -107,6 +107,7 @@ protected:
     // Each 4x3 row-wise matrix is represented as 3 Vec4's.
     // The number of Vec4's is (_skinBones.size() * 3).
     std::vector<Vec4> _matrixPalette;
+    unsigned int _paletteUpdateCount = 0;  // Skeleton3D::getUpdateCount() when _matrixPalette was computed
 };
 
 // end of 3d group
@@ -110,9 +110,11 @@ void MeshVertexData::setVertexData(const std::vector<float>& vertexData)
 
 MeshVertexData* MeshVertexData::create(const MeshData& meshdata, CustomCommand::IndexFormat format)
 {
+    // mapped c3b data is uploaded straight from the file mapping, there is no intermediate copy
+    const auto vertexDataSize = meshdata.getVertexDataSize();
     auto vertexdata           = new MeshVertexData();
-    vertexdata->_vertexBuffer = backend::Device::getInstance()->newBuffer(
-        meshdata.vertex.size() * sizeof(meshdata.vertex[0]), backend::BufferType::VERTEX, backend::BufferUsage::STATIC);
+    vertexdata->_vertexBuffer = backend::Device::getInstance()->newBuffer(vertexDataSize, backend::BufferType::VERTEX,
+                                                                          backend::BufferUsage::STATIC);
     // AX_SAFE_RETAIN(vertexdata->_vertexBuffer);
 
     vertexdata->_sizePerVertex = meshdata.getPerVertexSize();
@@ -122,36 +124,50 @@ MeshVertexData* MeshVertexData::create(const MeshData& meshdata, CustomCommand::
     if (vertexdata->_vertexBuffer)
     {
 #if AX_ENABLE_CACHE_TEXTURE_DATA
+        AXASSERT(!meshdata.vertexView, "mapped mesh data can't be cached for context recovery");
         vertexdata->setVertexData(meshdata.vertex);
         vertexdata->_vertexBuffer->usingDefaultStoredData(false);
 #endif
-        vertexdata->_vertexBuffer->updateData((void*)&meshdata.vertex[0],
-                                              meshdata.vertex.size() * sizeof(meshdata.vertex[0]));
+        vertexdata->_vertexBuffer->updateData((void*)meshdata.getVertexData(), vertexDataSize);
     }
 
-    bool needCalcAABB = (meshdata.subMeshAABB.size() != meshdata.subMeshIndices.size());
-    for (size_t i = 0, size = meshdata.subMeshIndices.size(); i < size; ++i)
+    const auto subMeshCount = meshdata.getSubMeshCount();
+    bool needCalcAABB       = (meshdata.subMeshAABB.size() != subMeshCount);
+    AXASSERT(!needCalcAABB || !meshdata.vertexView, "mapped mesh data must come with sub mesh AABBs");
+    for (size_t i = 0; i < subMeshCount; ++i)
     {
-        auto& indices = meshdata.subMeshIndices[i];
+        const void* indexData = nullptr;
+        size_t indexDataSize  = 0;
+        if (meshdata.vertexView)
+        {
+            indexData     = meshdata.subMeshIndexViews[i].first;
+            indexDataSize = meshdata.subMeshIndexViews[i].second * sizeof(uint16_t);
+        }
+        else
+        {
+            indexData     = meshdata.subMeshIndices[i].data();
+            indexDataSize = meshdata.subMeshIndices[i].bsize();
+        }
         auto indexBuffer = backend::Device::getInstance()->newBuffer(
-            indices.bsize(), backend::BufferType::INDEX, backend::BufferUsage::STATIC);
+            indexDataSize, backend::BufferType::INDEX, backend::BufferUsage::STATIC);
         indexBuffer->autorelease();
 #if AX_ENABLE_CACHE_TEXTURE_DATA
         indexBuffer->usingDefaultStoredData(false);
 #endif
-        indexBuffer->updateData((void*)indices.data(), indices.bsize());
+        indexBuffer->updateData((void*)indexData, indexDataSize);
 
         std::string id           = (i < meshdata.subMeshIds.size() ? meshdata.subMeshIds[i] : "");
         MeshIndexData* indexdata = nullptr;
         if (needCalcAABB)
         {
-            auto aabb = Bundle3D::calculateAABB(meshdata.vertex, meshdata.getPerVertexSize(), indices);
+            auto aabb =
+                Bundle3D::calculateAABB(meshdata.vertex, meshdata.getPerVertexSize(), meshdata.subMeshIndices[i]);
             indexdata = MeshIndexData::create(id, vertexdata, indexBuffer, aabb);
         }
         else
             indexdata = MeshIndexData::create(id, vertexdata, indexBuffer, meshdata.subMeshAABB[i]);
 #if AX_ENABLE_CACHE_TEXTURE_DATA
-        indexdata->setIndexData(indices);
+        indexdata->setIndexData(meshdata.subMeshIndices[i]);
 #endif
         vertexdata->_indices.pushBack(indexdata);
     }
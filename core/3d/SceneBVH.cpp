@@ -0,0 +1,405 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "3d/SceneBVH.h"
+#include "2d/Camera.h"
+
+#include <algorithm>
+
+NS_AX_BEGIN
+
+SceneBVH* SceneBVH::s_visitingTree = nullptr;
+
+static float surfaceArea(const AABB& box)
+{
+    const Vec3 d = box._max - box._min;
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+static AABB combine(const AABB& a, const AABB& b)
+{
+    return AABB(Vec3(std::min(a._min.x, b._min.x), std::min(a._min.y, b._min.y), std::min(a._min.z, b._min.z)),
+                Vec3(std::max(a._max.x, b._max.x), std::max(a._max.y, b._max.y), std::max(a._max.z, b._max.z)));
+}
+
+static bool contains(const AABB& outer, const AABB& inner)
+{
+    return outer._min.x <= inner._min.x && outer._min.y <= inner._min.y && outer._min.z <= inner._min.z &&
+           outer._max.x >= inner._max.x && outer._max.y >= inner._max.y && outer._max.z >= inner._max.z;
+}
+
+static AABB fatten(const AABB& box, float margin)
+{
+    const Vec3 d = (box._max - box._min) * margin;
+    return AABB(box._min - d, box._max + d);
+}
+
+SceneBVH* SceneBVH::create()
+{
+    auto tree = new SceneBVH();
+    tree->autorelease();
+    return tree;
+}
+
+SceneBVH::SceneBVH() {}
+
+SceneBVH::~SceneBVH()
+{
+    if (s_visitingTree == this)
+        s_visitingTree = nullptr;
+}
+
+int SceneBVH::allocateNode()
+{
+    if (_freeList == NULL_NODE)
+    {
+        _nodes.emplace_back();
+        _nodes.back().height = 0;
+        return static_cast<int>(_nodes.size()) - 1;
+    }
+
+    const int id = _freeList;
+    _freeList    = _nodes[id].parent;
+    _nodes[id]   = TreeNode();
+    _nodes[id].height = 0;
+    return id;
+}
+
+void SceneBVH::freeNode(int id)
+{
+    _nodes[id].parent   = _freeList;
+    _nodes[id].height   = -1;
+    _nodes[id].userData = nullptr;
+    _freeList           = id;
+}
+
+int SceneBVH::createProxy(const AABB& aabb, void* userData)
+{
+    const int id         = allocateNode();
+    _nodes[id].box       = fatten(aabb, _margin);
+    _nodes[id].userData  = userData;
+    insertLeaf(id);
+    ++_proxyCount;
+    return id;
+}
+
+void SceneBVH::destroyProxy(int proxy)
+{
+    AXASSERT(proxy >= 0 && proxy < static_cast<int>(_nodes.size()) && _nodes[proxy].isLeaf(), "invalid proxy");
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --_proxyCount;
+}
+
+bool SceneBVH::moveProxy(int proxy, const AABB& aabb)
+{
+    AXASSERT(proxy >= 0 && proxy < static_cast<int>(_nodes.size()) && _nodes[proxy].isLeaf(), "invalid proxy");
+
+    // keep the leaf while the box is inside it and the leaf isn't much larger than the box anymore
+    const AABB& fat = _nodes[proxy].box;
+    if (contains(fat, aabb) && contains(fatten(aabb, _margin * 4), fat))
+        return false;
+
+    removeLeaf(proxy);
+    _nodes[proxy].box = fatten(aabb, _margin);
+    insertLeaf(proxy);
+    return true;
+}
+
+void SceneBVH::insertLeaf(int leaf)
+{
+    if (_root == NULL_NODE)
+    {
+        _root                = leaf;
+        _nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // find the best sibling by the surface area heuristic
+    const AABB leafBox = _nodes[leaf].box;
+    int index          = _root;
+    while (!_nodes[index].isLeaf())
+    {
+        const auto& node = _nodes[index];
+        const float area = surfaceArea(node.box);
+
+        const float combinedArea = surfaceArea(combine(node.box, leafBox));
+        // cost of creating a new parent for this node and the new leaf
+        const float cost = 2.0f * combinedArea;
+        // minimum cost of pushing the leaf further down the tree
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child) {
+            const auto& c    = _nodes[child];
+            const float grow = surfaceArea(combine(leafBox, c.box));
+            return (c.isLeaf() ? grow : grow - surfaceArea(c.box)) + inheritanceCost;
+        };
+        const float cost1 = descendCost(node.child1);
+        const float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const int sibling   = index;
+    const int oldParent = _nodes[sibling].parent;
+    const int newParent = allocateNode();
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].box    = combine(leafBox, _nodes[sibling].box);
+    _nodes[newParent].height = _nodes[sibling].height + 1;
+    _nodes[newParent].child1 = sibling;
+    _nodes[newParent].child2 = leaf;
+    _nodes[sibling].parent   = newParent;
+    _nodes[leaf].parent      = newParent;
+
+    if (oldParent != NULL_NODE)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+        _root = newParent;
+
+    // refit and rebalance the ancestors
+    index = _nodes[leaf].parent;
+    while (index != NULL_NODE)
+    {
+        index = balance(index);
+
+        auto& node  = _nodes[index];
+        node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+        node.box    = combine(_nodes[node.child1].box, _nodes[node.child2].box);
+        index       = node.parent;
+    }
+}
+
+void SceneBVH::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NULL_NODE;
+        return;
+    }
+
+    const int parent      = _nodes[leaf].parent;
+    const int grandParent = _nodes[parent].parent;
+    const int sibling     = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    if (grandParent != NULL_NODE)
+    {
+        if (_nodes[grandParent].child1 == parent)
+            _nodes[grandParent].child1 = sibling;
+        else
+            _nodes[grandParent].child2 = sibling;
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != NULL_NODE)
+        {
+            index = balance(index);
+
+            auto& node  = _nodes[index];
+            node.box    = combine(_nodes[node.child1].box, _nodes[node.child2].box);
+            node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+            index       = node.parent;
+        }
+    }
+    else
+    {
+        _root                  = sibling;
+        _nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+}
+
+// rotates the taller grandchild up if the subtree at a is imbalanced, returns the new root of the subtree
+int SceneBVH::balance(int a)
+{
+    auto* A = &_nodes[a];
+    if (A->isLeaf() || A->height < 2)
+        return a;
+
+    const int b = A->child1;
+    const int c = A->child2;
+    auto* B     = &_nodes[b];
+    auto* C     = &_nodes[c];
+
+    const int diff = C->height - B->height;
+
+    auto rotate = [this](int a, int up, int other) {
+        // 'up' (a child of a) becomes the parent of a, its taller child stays under it
+        auto* A  = &_nodes[a];
+        auto* U  = &_nodes[up];
+        const int f = U->child1;
+        const int g = U->child2;
+        auto* F  = &_nodes[f];
+        auto* G  = &_nodes[g];
+
+        U->child1 = a;
+        U->parent = A->parent;
+        A->parent = up;
+
+        if (U->parent != NULL_NODE)
+        {
+            if (_nodes[U->parent].child1 == a)
+                _nodes[U->parent].child1 = up;
+            else
+                _nodes[U->parent].child2 = up;
+        }
+        else
+            _root = up;
+
+        const int keep = F->height > G->height ? f : g;
+        const int move = keep == f ? g : f;
+        U->child2      = keep;
+        if (A->child1 == up)
+            A->child1 = move;
+        else
+            A->child2 = move;
+        _nodes[move].parent = a;
+
+        const auto& O = _nodes[other];
+        const auto& M = _nodes[move];
+        const auto& K = _nodes[keep];
+        A->box        = combine(O.box, M.box);
+        A->height     = 1 + std::max(O.height, M.height);
+        U->box        = combine(A->box, K.box);
+        U->height     = 1 + std::max(A->height, K.height);
+        return up;
+    };
+
+    if (diff > 1)
+        return rotate(a, c, b);
+    if (diff < -1)
+        return rotate(a, b, c);
+    return a;
+}
+
+void SceneBVH::markVisible(int id)
+{
+    auto& stack = _stack;
+    stack.clear();
+    stack.push_back(id);
+    while (!stack.empty())
+    {
+        auto& node = _nodes[stack.back()];
+        stack.pop_back();
+        if (node.isLeaf())
+        {
+            node.visibleStamp = _stamp;
+            ++_lastVisibleCount;
+        }
+        else
+        {
+            stack.push_back(node.child1);
+            stack.push_back(node.child2);
+        }
+    }
+}
+
+int SceneBVH::cull(const Camera* camera)
+{
+    // 0 is the stamp of proxies never visible
+    if (++_stamp == 0)
+        _stamp = 1;
+    _cullingCamera    = camera;
+    _lastVisibleCount = 0;
+    _lastTestCount    = 0;
+
+    if (_root == NULL_NODE)
+        return 0;
+
+    const Frustum& frustum = camera->getFrustum();
+    std::vector<std::pair<int, unsigned int>> stack;
+    stack.reserve(64);
+    stack.emplace_back(_root, frustum.getPlaneMask());
+    while (!stack.empty())
+    {
+        auto [id, planeMask] = stack.back();
+        stack.pop_back();
+
+        ++_lastTestCount;
+        const auto& node = _nodes[id];
+        switch (frustum.intersectAABB(node.box, planeMask))
+        {
+        case Frustum::Intersection::OUTSIDE:
+            break;
+        case Frustum::Intersection::INSIDE:
+            markVisible(id);
+            break;
+        case Frustum::Intersection::INTERSECTING:
+            if (node.isLeaf())
+            {
+                _nodes[id].visibleStamp = _stamp;
+                ++_lastVisibleCount;
+            }
+            else
+            {
+                stack.emplace_back(node.child1, planeMask);
+                stack.emplace_back(node.child2, planeMask);
+            }
+            break;
+        }
+    }
+    return _lastVisibleCount;
+}
+
+void SceneBVHProxy::update(const AABB& worldAABB, void* userData)
+{
+    auto tree = SceneBVH::getVisitingTree();
+    if (tree != _tree || worldAABB.isEmpty())
+    {
+        detach();
+        if (!tree || worldAABB.isEmpty())
+            return;
+
+        _tree = tree;
+        _tree->retain();
+        _id = _tree->createProxy(worldAABB, userData);
+    }
+    else
+        _tree->moveProxy(_id, worldAABB);
+
+    // the tree was culled before the node moved, test the new box on its own
+    auto camera = _tree->getCullingCamera();
+    _tree->setVisible(_id, !camera || camera->isVisibleInFrustum(&worldAABB));
+}
+
+void SceneBVHProxy::detach()
+{
+    if (_tree)
+    {
+        _tree->destroyProxy(_id);
+        _tree->release();
+        _tree = nullptr;
+        _id   = SceneBVH::NULL_NODE;
+    }
+}
+
+NS_AX_END
@@ -0,0 +1,206 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "base/Ref.h"
+#include "3d/AABB.h"
+
+#include <vector>
+
+NS_AX_BEGIN
+
+class Camera;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @class SceneBVH
+ * @brief A dynamic AABB tree over the world bounds of the 3d renderers of a scene, used to frustum cull them.
+ *
+ * Leaves store a fattened box, so a moving object is only reinserted once it leaves it, the tree is kept balanced
+ * by rotations on insertion. cull() walks the tree once per camera: subtrees outside of the frustum are skipped
+ * and subtrees fully inside of it are accepted without further plane tests.
+ */
+class AX_DLL SceneBVH : public Ref
+{
+public:
+    static const int NULL_NODE = -1;
+
+    static SceneBVH* create();
+
+    SceneBVH();
+    virtual ~SceneBVH();
+
+    /** Inserts a box and returns the id of its proxy. */
+    int createProxy(const AABB& aabb, void* userData);
+
+    void destroyProxy(int proxy);
+
+    /**
+     * Updates the box of a proxy, it's only reinserted if the box left the fattened box of its leaf.
+     * Returns true if it was reinserted.
+     */
+    bool moveProxy(int proxy, const AABB& aabb);
+
+    const AABB& getFatAABB(int proxy) const { return _nodes[proxy].box; }
+    void* getUserData(int proxy) const { return _nodes[proxy].userData; }
+
+    /**
+     * How much a leaf box is grown on each side relatively to its size, 0.1 by default.
+     * Larger margins reinsert moving objects less often but cull less tightly.
+     */
+    void setMargin(float margin) { _margin = margin; }
+    float getMargin() const { return _margin; }
+
+    /**
+     * Marks the proxies in the frustum of the camera visible until the next cull, and returns how many are.
+     */
+    int cull(const Camera* camera);
+
+    /** Gets the camera of the last cull. */
+    const Camera* getCullingCamera() const { return _cullingCamera; }
+
+    bool isVisible(int proxy) const { return _nodes[proxy].visibleStamp == _stamp; }
+
+    /** Sets the visibility of a proxy for the last cull, i.e. after testing a proxy moved since. */
+    void setVisible(int proxy, bool visible) { _nodes[proxy].visibleStamp = visible ? _stamp : 0; }
+
+    /** Calls func(proxy) for each proxy whose fattened box intersects aabb. */
+    template <typename Func>
+    void query(const AABB& aabb, Func&& func) const
+    {
+        if (_root == NULL_NODE)
+            return;
+
+        auto& stack = _stack;
+        stack.clear();
+        stack.push_back(_root);
+        while (!stack.empty())
+        {
+            const int id = stack.back();
+            stack.pop_back();
+
+            auto& node = _nodes[id];
+            if (!node.box.intersects(aabb))
+                continue;
+
+            if (node.isLeaf())
+                func(id);
+            else
+            {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    int getProxyCount() const { return _proxyCount; }
+    int getHeight() const { return _root == NULL_NODE ? 0 : _nodes[_root].height; }
+
+    /** Gets how many proxies the last cull marked visible. */
+    int getLastVisibleCount() const { return _lastVisibleCount; }
+    /** Gets how many tree nodes the last cull tested against the frustum planes. */
+    int getLastTestCount() const { return _lastTestCount; }
+
+    /** Gets the tree of the scene being rendered, set by Scene::render while it visits its children. */
+    static SceneBVH* getVisitingTree() { return s_visitingTree; }
+    static void setVisitingTree(SceneBVH* tree) { s_visitingTree = tree; }
+
+private:
+    struct TreeNode
+    {
+        AABB box;
+        void* userData = nullptr;
+        int parent     = NULL_NODE;  // next free node when not in use
+        int child1     = NULL_NODE;
+        int child2     = NULL_NODE;
+        int height     = -1;  // 0 for leaves, -1 for free nodes
+        unsigned int visibleStamp = 0;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    int allocateNode();
+    void freeNode(int id);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int id);
+    void markVisible(int id);
+
+    std::vector<TreeNode> _nodes;
+    int _root         = NULL_NODE;
+    int _freeList     = NULL_NODE;
+    int _proxyCount   = 0;
+    float _margin     = 0.1f;
+    unsigned int _stamp = 1;
+    const Camera* _cullingCamera = nullptr;
+    int _lastVisibleCount = 0;
+    int _lastTestCount    = 0;
+    mutable std::vector<int> _stack;
+
+    static SceneBVH* s_visitingTree;
+};
+
+/**
+ * @class SceneBVHProxy
+ * @brief The entry of a node in the SceneBVH of the scene visiting it, kept by MeshRenderer and BillBoard.
+ */
+class AX_DLL SceneBVHProxy
+{
+public:
+    SceneBVHProxy() {}
+    ~SceneBVHProxy() { detach(); }
+
+    /** Returns true if the tree being visited culled the node for the visiting camera. */
+    bool isCulled() const
+    {
+        return _tree && _tree == SceneBVH::getVisitingTree() && !_tree->isVisible(_id);
+    }
+
+    /** Returns true if the node isn't in the tree being visited yet. */
+    bool needsUpdate() const { return _tree != SceneBVH::getVisitingTree(); }
+
+    /**
+     * Inserts or moves the node in the tree being visited and tests its new box against the visiting camera,
+     * call it when the world bounds of the node changed.
+     */
+    void update(const AABB& worldAABB, void* userData);
+
+    /** Removes the node from its tree, i.e. when it leaves the scene. */
+    void detach();
+
+private:
+    AX_DISALLOW_COPY_AND_ASSIGN(SceneBVHProxy);
+
+    SceneBVH* _tree = nullptr;
+    int _id         = SceneBVH::NULL_NODE;
+};
+
+// end of 3d group
+/// @}
+
+NS_AX_END
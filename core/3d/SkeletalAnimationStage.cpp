@@ -0,0 +1,135 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "3d/SkeletalAnimationStage.h"
+#include "3d/Animate3D.h"
+#include "3d/MeshRenderer.h"
+#include "base/Director.h"
+#include "base/EventDispatcher.h"
+#include "base/JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+
+NS_AX_BEGIN
+
+SkeletalAnimationStage* SkeletalAnimationStage::s_sharedStage = nullptr;
+
+SkeletalAnimationStage* SkeletalAnimationStage::getInstance()
+{
+    if (!s_sharedStage)
+        s_sharedStage = new SkeletalAnimationStage();
+    return s_sharedStage;
+}
+
+void SkeletalAnimationStage::destroyInstance()
+{
+    AX_SAFE_DELETE(s_sharedStage);
+}
+
+SkeletalAnimationStage::SkeletalAnimationStage() {}
+
+SkeletalAnimationStage::~SkeletalAnimationStage()
+{
+    setEnabled(false);
+}
+
+void SkeletalAnimationStage::setEnabled(bool enabled)
+{
+    if (_enabled == enabled)
+        return;
+
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    if (enabled)
+    {
+        _afterUpdateListener =
+            dispatcher->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom*) { run(); });
+    }
+    else
+    {
+        // don't drop animation values already recorded for this frame
+        run();
+        dispatcher->removeEventListener(_afterUpdateListener);
+        _afterUpdateListener = nullptr;
+        _lastRunTime         = 0.f;
+    }
+    _enabled = enabled;
+}
+
+void SkeletalAnimationStage::defer(Animate3D* animate, float t, float weight)
+{
+    // both are released by run, the action may be stopped and the renderer removed before it
+    auto target = static_cast<MeshRenderer*>(animate->getTarget());
+    animate->retain();
+    target->retain();
+    _entries.emplace_back(Entry{target, animate, t, weight});
+}
+
+void SkeletalAnimationStage::run()
+{
+    if (_entries.empty())
+    {
+        _lastRunTime       = 0.f;
+        _lastRendererCount = 0;
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    // group by renderer, keeping the order the animations were applied in
+    std::stable_sort(_entries.begin(), _entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.target < b.target; });
+    _groups.clear();
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        if (i == 0 || _entries[i].target != _entries[i - 1].target)
+            _groups.emplace_back(i);
+    }
+    const size_t rendererCount = _groups.size();
+    _groups.emplace_back(_entries.size());
+
+    const auto frame = Director::getInstance()->getTotalFrames();
+    auto jobSystem   = JobSystem::getInstance();
+    size_t grain     = std::max<size_t>(1, rendererCount / ((jobSystem->getThreadCount() + 1) * 4));
+    jobSystem->parallelFor(0, rendererCount, grain, [this, frame](size_t begin, size_t end) {
+        for (size_t g = begin; g < end; ++g)
+        {
+            for (size_t i = _groups[g], last = _groups[g + 1]; i < last; ++i)
+                _entries[i].animate->evaluateBones(_entries[i].time, _entries[i].weight);
+            _entries[_groups[g]].target->updateSkeleton(frame);
+        }
+    });
+
+    for (auto&& entry : _entries)
+    {
+        entry.animate->release();
+        entry.target->release();
+    }
+    _entries.clear();
+
+    _lastRendererCount = static_cast<int>(rendererCount);
+    _lastRunTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+NS_AX_END
@@ -0,0 +1,99 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "platform/PlatformMacros.h"
+
+#include <vector>
+
+NS_AX_BEGIN
+
+class Animate3D;
+class MeshRenderer;
+class EventListenerCustom;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @class SkeletalAnimationStage
+ * @brief Moves the skeletal animation work of a frame out of the action update and the draw to the job system.
+ *
+ * While enabled, Animate3D only records the time it's at and the stage, which runs once the scheduler updated,
+ * evaluates the bone curves, refreshes the skeleton and computes the matrix palettes of each animated
+ * MeshRenderer in parallel. MeshRenderer::draw then skips its own skeleton update for this frame.
+ * Work for one MeshRenderer always runs on a single job, so animations blending on the same skeleton don't race.
+ */
+class AX_DLL SkeletalAnimationStage
+{
+public:
+    static SkeletalAnimationStage* getInstance();
+    static void destroyInstance();
+
+    SkeletalAnimationStage();
+    ~SkeletalAnimationStage();
+
+    /** Enables or disables the stage, it's disabled by default. */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    /** Records the bone evaluation of an Animate3D at t, called by Animate3D::update while the stage is enabled. */
+    void defer(Animate3D* animate, float t, float weight);
+
+    /** Runs the deferred work, it's called automatically after the scheduler update. */
+    void run();
+
+    /** Gets how long the last run took, in milliseconds. */
+    float getLastRunTime() const { return _lastRunTime; }
+
+    /** Gets how many MeshRenderers the last run updated. */
+    int getLastRendererCount() const { return _lastRendererCount; }
+
+private:
+    struct Entry
+    {
+        MeshRenderer* target;
+        Animate3D* animate;
+        float time;
+        float weight;
+    };
+
+    bool _enabled = false;
+    EventListenerCustom* _afterUpdateListener = nullptr;
+
+    std::vector<Entry> _entries;
+    std::vector<size_t> _groups;  // first entry of each renderer in the sorted _entries, and _entries.size()
+
+    float _lastRunTime     = 0.f;
+    int _lastRendererCount = 0;
+
+    static SkeletalAnimationStage* s_sharedStage;
+};
+
+// end of 3d group
+/// @}
+
+NS_AX_END
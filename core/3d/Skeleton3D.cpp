@@ -146,7 +146,7 @@ Bone3D* Bone3D::create(std::string_view id)
 void Bone3D::updateJointMatrix(Vec4* matrixPalette)
 {
     {
-        static Mat4 t;
+        Mat4 t;
         Mat4::multiply(_world, getInverseBindPose(), &t);
 
         matrixPalette[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
@@ -170,22 +170,35 @@ Bone3D* Bone3D::getChildBoneByIndex(int index) const
 void Bone3D::addChildBone(Bone3D* bone)
 {
     if (_children.find(bone) == _children.end())
+    {
         _children.pushBack(bone);
+        if (_skeleton)
+        {
+            bone->_skeleton        = _skeleton;
+            _skeleton->_sortDirty = true;
+        }
+    }
 }
 void Bone3D::removeChildBoneByIndex(int index)
 {
     _children.erase(index);
+    if (_skeleton)
+        _skeleton->_sortDirty = true;
 }
 void Bone3D::removeChildBone(Bone3D* bone)
 {
     _children.eraseObject(bone);
+    if (_skeleton)
+        _skeleton->_sortDirty = true;
 }
 void Bone3D::removeAllChildBone()
 {
     _children.clear();
+    if (_skeleton)
+        _skeleton->_sortDirty = true;
 }
 
-Bone3D::Bone3D(std::string_view id) : _name(id), _parent(nullptr), _worldDirty(true) {}
+Bone3D::Bone3D(std::string_view id) : _name(id), _parent(nullptr), _skeleton(nullptr), _worldDirty(true) {}
 
 Bone3D::~Bone3D()
 {
@@ -262,6 +275,7 @@ Skeleton3D* Skeleton3D::create(const std::vector<NodeData*>& skeletondata)
         bone->resetPose();
         skeleton->_rootBones.pushBack(bone);
     }
+    skeleton->_sortDirty = true;
     skeleton->autorelease();
     return skeleton;
 }
@@ -315,27 +329,71 @@ int Skeleton3D::getBoneIndex(Bone3D* bone) const
 // refresh bone world matrix
 void Skeleton3D::updateBoneMatrix()
 {
-    for (const auto& it : _rootBones)
+    if (_sortDirty)
+        sortBones();
+
+    for (size_t i = 0, count = _sortedBones.size(); i < count; ++i)
     {
-        it->setWorldMatDirty(true);
-        it->updateWorldMat();
+        auto bone = _sortedBones[i];
+        bone->updateLocalMat();
+
+        int parent = _parentIndices[i];
+        if (parent >= 0)
+            Mat4::multiply(_sortedBones[parent]->_world, bone->_local, &bone->_world);
+        else
+            bone->_world = bone->_local;
+        bone->_worldDirty = false;
     }
+    ++_updateCount;
+}
+
+void Skeleton3D::sortBones()
+{
+    _sortedBones.clear();
+    _parentIndices.clear();
+    _sortedBones.reserve(_bones.size());
+    _parentIndices.reserve(_bones.size());
+
+    // breadth first from the roots, the parent of a bone is always visited before it
+    for (const auto& root : _rootBones)
+    {
+        _sortedBones.emplace_back(root);
+        _parentIndices.emplace_back(-1);
+    }
+    for (size_t i = 0; i < _sortedBones.size(); ++i)
+    {
+        for (const auto& child : _sortedBones[i]->_children)
+        {
+            _sortedBones.emplace_back(child);
+            _parentIndices.emplace_back(static_cast<int>(i));
+        }
+    }
+    _sortDirty = false;
 }
 
 void Skeleton3D::removeAllBones()
 {
+    for (auto&& bone : _bones)
+    {
+        if (bone->_skeleton == this)
+            bone->_skeleton = nullptr;
+    }
     _bones.clear();
     _rootBones.clear();
+    _sortDirty = true;
 }
 
 void Skeleton3D::addBone(Bone3D* bone)
 {
     _bones.pushBack(bone);
+    bone->_skeleton = this;
+    _sortDirty      = true;
 }
 
 Bone3D* Skeleton3D::createBone3D(const NodeData& nodedata)
 {
-    auto bone = Bone3D::create(nodedata.id);
+    auto bone       = Bone3D::create(nodedata.id);
+    bone->_skeleton = this;
     for (const auto& it : nodedata.children)
     {
         auto child = createBone3D(*it);
@@ -32,6 +32,8 @@
 
 NS_AX_BEGIN
 
+class Skeleton3D;
+
 /**
  * @addtogroup _3d
  * @{
@@ -164,6 +166,8 @@ protected:
 
     Bone3D* _parent;  // parent bone
 
+    Skeleton3D* _skeleton;  // weak ref, the skeleton sorting this bone, told when the children change
+
     Vector<Bone3D*> _children;
 
     bool _worldDirty;
@@ -179,6 +183,8 @@ protected:
  */
 class AX_DLL Skeleton3D : public Ref
 {
+    friend class Bone3D;
+
 public:
     /**
      * @lua NA
@@ -202,6 +208,9 @@ public:
     /**refresh bone world matrix*/
     void updateBoneMatrix();
 
+    /** Gets how many times the bone matrices were refreshed, to know whether data derived from them is stale. */
+    unsigned int getUpdateCount() const { return _updateCount; }
+
     Skeleton3D();
 
     ~Skeleton3D();
@@ -216,9 +225,18 @@ public:
     Bone3D* createBone3D(const NodeData& nodedata);
 
 protected:
+    // sorts the bones so that parents come before their children
+    void sortBones();
+
     Vector<Bone3D*> _bones;  // bones
 
     Vector<Bone3D*> _rootBones;
+
+    // the hierarchy flattened in topological order, updateBoneMatrix walks it instead of recursing the tree
+    std::vector<Bone3D*> _sortedBones;  // weak ref
+    std::vector<int> _parentIndices;     // index of the parent in _sortedBones, -1 for roots
+    bool _sortDirty            = true;
+    unsigned int _updateCount = 0;
 };
 
 // end of 3d group
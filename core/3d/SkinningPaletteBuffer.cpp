@@ -0,0 +1,194 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "3d/SkinningPaletteBuffer.h"
+#include "base/Director.h"
+#include "base/EventDispatcher.h"
+#include "renderer/Renderer.h"
+#include "renderer/CallbackCommand.h"
+#include "renderer/backend/Device.h"
+#include "renderer/backend/Texture.h"
+
+#include <algorithm>
+#include <float.h>
+
+NS_AX_BEGIN
+
+static const int MIN_ROW_CAPACITY = 16;
+
+SkinningPaletteBuffer* SkinningPaletteBuffer::s_sharedBuffer = nullptr;
+
+SkinningPaletteBuffer* SkinningPaletteBuffer::getInstance()
+{
+    if (!s_sharedBuffer)
+        s_sharedBuffer = new SkinningPaletteBuffer();
+    return s_sharedBuffer;
+}
+
+void SkinningPaletteBuffer::destroyInstance()
+{
+    AX_SAFE_DELETE(s_sharedBuffer);
+}
+
+SkinningPaletteBuffer::SkinningPaletteBuffer() {}
+
+SkinningPaletteBuffer::~SkinningPaletteBuffer()
+{
+    setEnabled(false);
+    for (auto&& texture : _textures)
+        AX_SAFE_RELEASE_NULL(texture);
+}
+
+void SkinningPaletteBuffer::setEnabled(bool enabled)
+{
+#if AX_GLES_PROFILE == 200
+    if (enabled)
+    {
+        AXLOG("SkinningPaletteBuffer needs texelFetch in vertex shaders, it's not supported on GLES2");
+        return;
+    }
+#endif
+    if (_enabled == enabled)
+        return;
+
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    if (enabled)
+    {
+        _beforeDrawListener =
+            dispatcher->addCustomEventListener(Director::EVENT_BEFORE_DRAW, [this](EventCustom*) { beginFrame(); });
+    }
+    else
+    {
+        dispatcher->removeEventListener(_beforeDrawListener);
+        _beforeDrawListener = nullptr;
+    }
+    _enabled = enabled;
+}
+
+void SkinningPaletteBuffer::reset()
+{
+    _boneCount = 0;
+}
+
+int SkinningPaletteBuffer::pack(const Vec4* palette, int boneCount)
+{
+    if (boneCount <= 0)
+        return -1;
+
+    const int first = _boneCount;
+    const int rows  = (first + boneCount + BONES_PER_ROW - 1) / BONES_PER_ROW;
+    if (rows > _maxRows)
+        return -1;
+
+    if (rows > _rowCapacity)
+    {
+        int capacity = std::max(_rowCapacity, MIN_ROW_CAPACITY);
+        while (capacity < rows)
+            capacity *= 2;
+        _rowCapacity = std::min(capacity, std::max(_maxRows, rows));
+        _data.resize(static_cast<size_t>(_rowCapacity) * TEXTURE_WIDTH);
+    }
+
+    // bones never straddle two rows, so one bone is always 3 consecutive texels
+    for (int i = 0; i < boneCount; ++i)
+        std::copy(palette + i * TEXELS_PER_BONE, palette + (i + 1) * TEXELS_PER_BONE,
+                  _data.begin() + getTexelIndex(first + i));
+
+    _boneCount += boneCount;
+    return first;
+}
+
+backend::Texture2DBackend* SkinningPaletteBuffer::getTexture()
+{
+    auto& texture = _textures[_ringIndex];
+    if (!texture)
+    {
+        backend::TextureDescriptor descriptor;
+        descriptor.textureType   = backend::TextureType::TEXTURE_2D;
+        descriptor.textureFormat = backend::PixelFormat::RGBA32F;
+        descriptor.width         = TEXTURE_WIDTH;
+        descriptor.height        = std::max(_rowCapacity, MIN_ROW_CAPACITY);
+        descriptor.samplerDescriptor =
+            backend::SamplerDescriptor(backend::SamplerFilter::NEAREST, backend::SamplerFilter::NEAREST,
+                                       backend::SamplerAddressMode::CLAMP_TO_EDGE,
+                                       backend::SamplerAddressMode::CLAMP_TO_EDGE);
+        texture = static_cast<backend::Texture2DBackend*>(backend::Device::getInstance()->newTexture(descriptor));
+        _textureRows[_ringIndex] = 0;
+    }
+    return texture;
+}
+
+void SkinningPaletteBuffer::beginFrame()
+{
+    _ringIndex = (_ringIndex + 1) % RING_SIZE;
+    reset();
+}
+
+void SkinningPaletteBuffer::queueUpload(Renderer* renderer)
+{
+    if (_uploadQueued)
+        return;
+
+    // the lowest global z of the first queue, every camera flushes it before the 3d queues and the render targets
+    auto command = renderer->nextCallbackCommand();
+    command->init(-FLT_MAX);
+    command->func = [this]() {
+        _uploadQueued = false;
+        upload();
+    };
+    renderer->addCommand(command, 0);
+    _uploadQueued = true;
+}
+
+void SkinningPaletteBuffer::upload()
+{
+    const int rows = getRowCount();
+    if (rows == 0)
+        return;
+
+    auto texture = getTexture();
+    auto& textureRows = _textureRows[_ringIndex];
+    if (textureRows < _rowCapacity)
+    {
+        // keep the texture object the draws of this frame refer to, only reallocate its storage
+        backend::TextureDescriptor descriptor;
+        descriptor.textureType   = backend::TextureType::TEXTURE_2D;
+        descriptor.textureFormat = backend::PixelFormat::RGBA32F;
+        descriptor.width         = TEXTURE_WIDTH;
+        descriptor.height        = _rowCapacity;
+        descriptor.samplerDescriptor =
+            backend::SamplerDescriptor(backend::SamplerFilter::NEAREST, backend::SamplerFilter::NEAREST,
+                                       backend::SamplerAddressMode::CLAMP_TO_EDGE,
+                                       backend::SamplerAddressMode::CLAMP_TO_EDGE);
+        texture->updateTextureDescriptor(descriptor);
+        texture->updateData(reinterpret_cast<uint8_t*>(_data.data()), TEXTURE_WIDTH, _rowCapacity, 0);
+        textureRows = _rowCapacity;
+    }
+    else
+    {
+        texture->updateSubData(0, 0, TEXTURE_WIDTH, rows, 0, reinterpret_cast<uint8_t*>(_data.data()));
+    }
+}
+
+NS_AX_END
@@ -0,0 +1,155 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "math/Vec4.h"
+#include "platform/PlatformMacros.h"
+
+#include <vector>
+
+NS_AX_BEGIN
+
+namespace backend
+{
+class Texture2DBackend;
+}
+class EventListenerCustom;
+class Renderer;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @class SkinningPaletteBuffer
+ * @brief Packs the matrix palettes of all skinned meshes drawn in a frame to one RGBA32F texture.
+ *
+ * Each bone takes 3 consecutive texels holding the rows of its 4x3 matrix, BONES_PER_ROW bones fit in a row of
+ * TEXTURE_WIDTH texels. Meshes drawn with the palette programs only pass the index of their first bone, so the
+ * bone count isn't capped by the uniform buffer size, and an instanced skinned mesh draws all of its instances
+ * with one palette per instance. Packing runs on the CPU during the visit and the texture is uploaded when the
+ * renderer flushes, before the draws reading it, the textures are used as a ring so the GPU never reads a texture
+ * being written.
+ *
+ * The packing itself doesn't touch the renderer, so it can be used without a device.
+ */
+class AX_DLL SkinningPaletteBuffer
+{
+public:
+    static const int TEXTURE_WIDTH   = 1024;
+    static const int TEXELS_PER_BONE = 3;
+    static const int BONES_PER_ROW   = TEXTURE_WIDTH / TEXELS_PER_BONE;
+    static const int RING_SIZE       = 3;
+    /** Texture slot of u_paletteTex, after the ones used by the fragment shaders of the 3d materials. */
+    static const int TEXTURE_SLOT = 4;
+
+    static SkinningPaletteBuffer* getInstance();
+    static void destroyInstance();
+
+    SkinningPaletteBuffer();
+    ~SkinningPaletteBuffer();
+
+    /**
+     * Enables the shared palette, it's disabled by default and not supported on GLES2.
+     * Skinned meshes created while it's enabled use the palette programs for their unlit material.
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    /** Limits the texture height, pack fails once all rows are used, 4096 by default. */
+    void setMaxRows(int rows) { _maxRows = rows; }
+    int getMaxRows() const { return _maxRows; }
+
+    /** Drops the palettes packed so far, the next pack starts at bone 0. */
+    void reset();
+
+    /**
+     * Copies boneCount bones (3 Vec4 rows each, as returned by MeshSkin::getMatrixPalette) after the bones packed
+     * so far, and returns the index of the first one, or -1 if the texture is full.
+     */
+    int pack(const Vec4* palette, int boneCount);
+
+    /** Gets the 3 rows of a packed bone. */
+    const Vec4* getBone(int bone) const { return &_data[getTexelIndex(bone)]; }
+
+    int getBoneCount() const { return _boneCount; }
+
+    /** Gets how many rows of the texture the packed bones use. */
+    int getRowCount() const { return (_boneCount + BONES_PER_ROW - 1) / BONES_PER_ROW; }
+
+    /** Gets how many rows the CPU copy and the textures have, it grows by powers of 2. */
+    int getRowCapacity() const { return _rowCapacity; }
+
+    /** Gets the texel a bone starts at, the shaders compute the same. */
+    static void getTexelOf(int bone, int& x, int& y)
+    {
+        y = bone / BONES_PER_ROW;
+        x = (bone - y * BONES_PER_ROW) * TEXELS_PER_BONE;
+    }
+
+    static int getTexelIndex(int bone)
+    {
+        int x, y;
+        getTexelOf(bone, x, y);
+        return y * TEXTURE_WIDTH + x;
+    }
+
+    /** Gets the texture the draws of this frame read, creating it if needed. */
+    backend::Texture2DBackend* getTexture();
+
+    /** Moves to the next texture of the ring and resets the packing, called before the visit. */
+    void beginFrame();
+
+    /**
+     * Queues the upload ahead of the commands of the renderer, so the draws packed since the last flush read their
+     * bones. Called by the meshes after packing, queued once per flush.
+     */
+    void queueUpload(Renderer* renderer);
+
+    /** Uploads the packed rows to the texture of this frame. */
+    void upload();
+
+private:
+    bool _enabled = false;
+    int _maxRows  = 4096;
+
+    std::vector<Vec4> _data;
+    int _boneCount   = 0;
+    int _rowCapacity = 0;
+
+    backend::Texture2DBackend* _textures[RING_SIZE]{};
+    int _textureRows[RING_SIZE]{};
+    int _ringIndex = 0;
+
+    EventListenerCustom* _beforeDrawListener = nullptr;
+    bool _uploadQueued = false;
+
+    static SkinningPaletteBuffer* s_sharedBuffer;
+};
+
+// end of 3d group
+/// @}
+
+NS_AX_END
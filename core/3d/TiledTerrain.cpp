@@ -0,0 +1,663 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "3d/TiledTerrain.h"
+
+#include <float.h>
+#include <stddef.h>  // offsetof
+#include <algorithm>
+#include "renderer/Renderer.h"
+#include "renderer/Texture2D.h"
+#include "renderer/backend/Device.h"
+#include "renderer/backend/Program.h"
+#include "renderer/backend/Buffer.h"
+#include "base/Director.h"
+#include "base/JobSystem.h"
+#include "base/UTF8.h"
+#include "base/Utils.h"
+#include "2d/Camera.h"
+#include "platform/Image.h"
+#include "platform/FileUtils.h"
+
+NS_AX_BEGIN
+
+namespace
+{
+// the share of each LOD distance over which the vertices blend to the coarser LOD
+const float MORPH_START_RATIO = 0.7f;
+// the loaded tiles uploaded per frame, to spread the buffer creation
+const int MAX_UPLOADS_PER_FRAME = 2;
+
+unsigned char white_2x2_image[] = {
+    // RGBA8888
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+}  // namespace
+
+TiledTerrain* TiledTerrain::create(const TiledTerrainData& data, const HeightTileLoader& loader)
+{
+    TiledTerrain* terrain = new TiledTerrain();
+    if (terrain->initWithTiledTerrainData(data, loader))
+    {
+        terrain->autorelease();
+        return terrain;
+    }
+    AX_SAFE_DELETE(terrain);
+    return terrain;
+}
+
+TiledTerrain::TiledTerrain()
+    : _detailMapTexture(nullptr)
+    , _dummyTexture(nullptr)
+    , _lightDir(-1.f, -1.f, 0.f)
+    , _isEnableFrustumCull(true)
+    , _streamedFrame(0)
+    , _drawnChunks(0)
+{
+    for (int i = 0; i < LOD_COUNT; ++i)
+    {
+        _lodIndices[i]       = nullptr;
+        _lodIndexCount[i]    = 0;
+        _lodProgramStates[i] = nullptr;
+    }
+}
+
+TiledTerrain::~TiledTerrain()
+{
+    // loads still running only hold the queue
+    _tiles.clear();
+    for (int i = 0; i < LOD_COUNT; ++i)
+    {
+        AX_SAFE_RELEASE(_lodIndices[i]);
+        AX_SAFE_RELEASE(_lodProgramStates[i]);
+    }
+    AX_SAFE_RELEASE(_detailMapTexture);
+    AX_SAFE_RELEASE(_dummyTexture);
+}
+
+bool TiledTerrain::initWithTiledTerrainData(const TiledTerrainData& data, const HeightTileLoader& loader)
+{
+    const int chunkSize = data._chunkSize;
+    if (!utils::isPOT(data._tileSize) || !utils::isPOT(chunkSize) || chunkSize < (2 << (LOD_COUNT - 1)) ||
+        chunkSize > 128 || chunkSize > data._tileSize)
+    {
+        AXLOG("warning: the tile size and chunk size of TiledTerrain must be POT, with 16 <= chunk size <= 128");
+        return false;
+    }
+
+    _terrainData = data;
+    _loader      = loader;
+    _loadQueue   = std::make_shared<LoadQueue>();
+
+    auto image = new Image();
+    if (image->initWithImageFile(data._detailMapSrc))
+    {
+        _detailMapTexture = new Texture2D();
+        _detailMapTexture->initWithImage(image);
+        _detailMapTexture->generateMipmap();
+        Texture2D::TexParams texParam;
+        texParam.sAddressMode = backend::SamplerAddressMode::REPEAT;
+        texParam.tAddressMode = backend::SamplerAddressMode::REPEAT;
+        texParam.minFilter    = backend::SamplerFilter::LINEAR;
+        texParam.magFilter    = backend::SamplerFilter::LINEAR;
+        _detailMapTexture->setTexParameters(texParam);
+    }
+    AX_SAFE_RELEASE(image);
+    if (!_detailMapTexture)
+        return false;
+
+    // bound as the light map, which isn't supported by the tiled mode
+    image = new Image();
+    image->initWithRawData(white_2x2_image, sizeof(white_2x2_image), 2, 2, 8);
+    _dummyTexture = new Texture2D();
+    _dummyTexture->initWithImage(image);
+    AX_SAFE_RELEASE(image);
+
+    initProgramStates();
+    initIndices();
+
+    const float chunkWorldSize = chunkSize * data._mapScale;
+    setLODDistance(4 * chunkWorldSize, 8 * chunkWorldSize, 16 * chunkWorldSize);
+    setAnchorPoint(Vec2(0, 0));
+    return true;
+}
+
+void TiledTerrain::initProgramStates()
+{
+    auto program = backend::Program::getBuiltinProgram(backend::ProgramType::TERRAIN_3D_TILED);
+
+    // one program state per LOD, the chunks of a LOD share the morph parameters
+    for (int i = 0; i < LOD_COUNT; ++i)
+    {
+        auto programState = new backend::ProgramState(program);
+        auto vertexLayout = programState->getMutableVertexLayout();
+        vertexLayout->setAttrib(backend::ATTRIBUTE_NAME_POSITION,
+                                programState->getAttributeLocation(backend::Attribute::POSITION),
+                                backend::VertexFormat::FLOAT3, offsetof(TileVertexData, _position), false);
+        vertexLayout->setAttrib(backend::ATTRIBUTE_NAME_TEXCOORD,
+                                programState->getAttributeLocation(backend::Attribute::TEXCOORD),
+                                backend::VertexFormat::FLOAT2, offsetof(TileVertexData, _texcoord), false);
+        vertexLayout->setAttrib(backend::ATTRIBUTE_NAME_NORMAL,
+                                programState->getAttributeLocation(backend::Attribute::NORMAL),
+                                backend::VertexFormat::FLOAT3, offsetof(TileVertexData, _normal), false);
+        vertexLayout->setAttrib(backend::ATTRIBUTE_NAME_TEXCOORD1,
+                                programState->getAttributeLocation(backend::ATTRIBUTE_NAME_TEXCOORD1),
+                                backend::VertexFormat::FLOAT2, offsetof(TileVertexData, _morph), false);
+        vertexLayout->setStride(sizeof(TileVertexData));
+        _lodProgramStates[i] = programState;
+    }
+
+    auto programState    = _lodProgramStates[0];
+    _mvpMatrixLocation   = programState->getUniformLocation("u_MVPMatrix");
+    _cameraPosLocation   = programState->getUniformLocation("u_cameraPos");
+    _morphParamsLocation = programState->getUniformLocation("u_morphParams");
+    _hasAlphaLocation    = programState->getUniformLocation("u_has_alpha");
+    _hasLightMapLocation = programState->getUniformLocation("u_has_light_map");
+    _lightDirLocation    = programState->getUniformLocation("u_lightDir");
+    _detailMapLocation   = programState->getUniformLocation("u_tex0");
+    _lightMapLocation    = programState->getUniformLocation("u_lightMap");
+}
+
+void TiledTerrain::initIndices()
+{
+    // all chunks have the same grid, so one index buffer per LOD serves the whole terrain
+    const int grid = _terrainData._chunkSize;
+    std::vector<uint16_t> indices;
+    for (int lod = 0; lod < LOD_COUNT; ++lod)
+    {
+        int step = 1 << lod;
+        indices.clear();
+        for (int i = 0; i < grid; i += step)
+        {
+            for (int j = 0; j < grid; j += step)
+            {
+                int nLocIndex = i * (grid + 1) + j;
+                indices.emplace_back(nLocIndex);
+                indices.emplace_back(nLocIndex + step * (grid + 1));
+                indices.emplace_back(nLocIndex + step);
+
+                indices.emplace_back(nLocIndex + step);
+                indices.emplace_back(nLocIndex + step * (grid + 1));
+                indices.emplace_back(nLocIndex + step * (grid + 1) + step);
+            }
+        }
+        _lodIndices[lod] = backend::Device::getInstance()->newBuffer(
+            sizeof(uint16_t) * indices.size(), backend::BufferType::INDEX, backend::BufferUsage::STATIC);
+        _lodIndices[lod]->updateData(indices.data(), sizeof(uint16_t) * indices.size());
+        _lodIndexCount[lod] = static_cast<unsigned int>(indices.size());
+    }
+}
+
+void TiledTerrain::setLODDistance(float lod1, float lod2, float lod3)
+{
+    _lodDistance[0] = lod1;
+    _lodDistance[1] = lod2;
+    _lodDistance[2] = lod3;
+}
+
+void TiledTerrain::setLightDir(const Vec3& lightDir)
+{
+    _lightDir = lightDir;
+}
+
+bool TiledTerrain::loadHeightMap(const TiledTerrainData& data, std::string_view fullPath, std::vector<float>& heights)
+{
+    // the same as the async loads of TextureCache, only the file read and the decoding run on the worker
+    Image image;
+    Data fileData = FileUtils::getInstance()->getDataFromFile(fullPath);
+    if (fileData.isNull() || !image.initWithImageData(std::move(fileData)))
+        return false;
+
+    const int side = data._tileSize + 3;
+    if (image.getWidth() != side || image.getHeight() != side)
+    {
+        AXLOG("warning: the height map %s isn't %d pixels square", fullPath.data(), side);
+        return false;
+    }
+
+    int byteStride = 1;
+    switch (image.getPixelFormat())
+    {
+    case backend::PixelFormat::RGBA8:
+    case backend::PixelFormat::BGRA8:
+        byteStride = 4;
+        break;
+    case backend::PixelFormat::RGB8:
+        byteStride = 3;
+        break;
+    default:
+        break;
+    }
+
+    const unsigned char* pixels = image.getData();
+    heights.resize(side * side);
+    for (int i = 0; i < side * side; ++i)
+    {
+        heights[i] = pixels[i * byteStride] * 1.0f / 255 * data._mapHeight - 0.5f * data._mapHeight;
+    }
+    return true;
+}
+
+void TiledTerrain::loadTile(const TiledTerrainData& data,
+                            const HeightTileLoader& loader,
+                            std::string_view fullPath,
+                            TileData& tile)
+{
+    const int side = data._tileSize + 1;
+    std::vector<float> heights;
+    bool loaded = loader ? loader(tile._tileX, tile._tileZ, heights) : loadHeightMap(data, fullPath, heights);
+    if (!loaded || static_cast<int>(heights.size()) != (side + 2) * (side + 2))
+        return;
+
+    // rows and columns in [-1, side], the border comes from the neighbor tiles so the edge normals are two-sided
+    auto heightAt = [&heights, side](int i, int j) { return heights[(i + 1) * (side + 2) + j + 1]; };
+
+    const float scale    = data._mapScale;
+    const int chunkSize  = data._chunkSize;
+    const int chunkCount = data._tileSize / chunkSize;
+    tile._chunkVertices.resize(chunkCount * chunkCount);
+    for (int m = 0; m < chunkCount; ++m)
+    {
+        for (int n = 0; n < chunkCount; ++n)
+        {
+            auto& vertices = tile._chunkVertices[m * chunkCount + n];
+            vertices.resize((chunkSize + 1) * (chunkSize + 1));
+            for (int i = 0; i <= chunkSize; ++i)
+            {
+                for (int j = 0; j <= chunkSize; ++j)
+                {
+                    // row and column in the tile, then in the whole terrain
+                    const int ti = m * chunkSize + i;
+                    const int tj = n * chunkSize + j;
+                    const float x = (tile._tileX * data._tileSize + tj) * scale;
+                    const float z = (tile._tileZ * data._tileSize + ti) * scale;
+
+                    auto& v     = vertices[i * (chunkSize + 1) + j];
+                    v._position = Vec3(x, heightAt(ti, tj), z);
+                    v._texcoord = Tex2F(x / data._detailMapSize, z / data._detailMapSize);
+                    v._normal   = Vec3(heightAt(ti, tj - 1) - heightAt(ti, tj + 1), 2 * scale,
+                                     heightAt(ti - 1, tj) - heightAt(ti + 1, tj));
+                    v._normal.normalize();
+
+                    // the vertex is dropped by the first LOD whose grid it isn't on, it blends to the height of
+                    // that coarser grid while drawn by the previous LOD. The coarsest grid never morphs.
+                    int level = LOD_COUNT - 1;
+                    for (int lod = 0; lod < LOD_COUNT - 1; ++lod)
+                    {
+                        if ((ti % (2 << lod)) || (tj % (2 << lod)))
+                        {
+                            level = lod;
+                            break;
+                        }
+                    }
+                    float coarseHeight = v._position.y;
+                    if (level < LOD_COUNT - 1)
+                    {
+                        const int step = 2 << level;
+                        const int i0   = ti - ti % step;
+                        const int j0   = tj - tj % step;
+                        if (ti % step && tj % step)
+                            // on the diagonal of the coarse quad, split like the indices
+                            coarseHeight = (heightAt(i0, j0 + step) + heightAt(i0 + step, j0)) * 0.5f;
+                        else if (ti % step)
+                            coarseHeight = (heightAt(i0, tj) + heightAt(i0 + step, tj)) * 0.5f;
+                        else
+                            coarseHeight = (heightAt(ti, j0) + heightAt(ti, j0 + step)) * 0.5f;
+                    }
+                    v._morph = Vec2(coarseHeight, static_cast<float>(level));
+                }
+            }
+        }
+    }
+
+    // the tile only keeps its own heights, for getHeight
+    tile._heights.resize(side * side);
+    for (int i = 0; i < side; ++i)
+    {
+        for (int j = 0; j < side; ++j)
+            tile._heights[i * side + j] = heightAt(i, j);
+    }
+    tile._succeed = true;
+}
+
+void TiledTerrain::installTile(TileData& data)
+{
+    auto& tile    = _tiles[tileKey(data._tileX, data._tileZ)];
+    tile->_loaded = true;
+    if (!data._succeed)
+    {
+        AXLOG("warning: failed to load the terrain tile %d,%d", data._tileX, data._tileZ);
+        return;
+    }
+
+    tile->_heights = std::move(data._heights);
+    for (auto&& vertices : data._chunkVertices)
+    {
+        auto chunk     = std::make_unique<Chunk>();
+        chunk->_buffer = backend::Device::getInstance()->newBuffer(
+            sizeof(TileVertexData) * vertices.size(), backend::BufferType::VERTEX, backend::BufferUsage::STATIC);
+        chunk->_buffer->updateData(vertices.data(), sizeof(TileVertexData) * vertices.size());
+
+        Vec3 minPos(FLT_MAX, FLT_MAX, FLT_MAX), maxPos(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+        for (auto&& v : vertices)
+        {
+            minPos.x = std::min(minPos.x, v._position.x);
+            minPos.y = std::min(minPos.y, v._position.y);
+            minPos.z = std::min(minPos.z, v._position.z);
+            maxPos.x = std::max(maxPos.x, v._position.x);
+            maxPos.y = std::max(maxPos.y, v._position.y);
+            maxPos.z = std::max(maxPos.z, v._position.z);
+        }
+        chunk->_aabb.set(minPos, maxPos);
+        chunk->_worldSpaceAABB = chunk->_aabb;
+        chunk->_worldSpaceAABB.transform(_terrainModelMatrix);
+
+        auto& command = chunk->_command;
+        command.init(_globalZOrder);
+        command.setTransparent(false);
+        command.set3D(true);
+        command.setPrimitiveType(MeshCommand::PrimitiveType::TRIANGLE);
+        command.setDrawType(MeshCommand::DrawType::ELEMENT);
+        command.setBeforeCallback(AX_CALLBACK_0(TiledTerrain::onBeforeDraw, this));
+        command.setAfterCallback(AX_CALLBACK_0(TiledTerrain::onAfterDraw, this));
+        command.getPipelineDescriptor().blendDescriptor.blendEnabled = false;
+        command.setVertexBuffer(chunk->_buffer);
+
+        tile->_chunks.emplace_back(std::move(chunk));
+    }
+}
+
+void TiledTerrain::updateStreaming(const Vec3& cameraPos)
+{
+    std::vector<std::shared_ptr<TileData>> finished;
+    {
+        std::lock_guard<std::mutex> lk(_loadQueue->_mutex);
+        auto& queue = _loadQueue->_finished;
+        // discard the tiles dropped while they were loading first, so they don't take the upload budget
+        queue.erase(std::remove_if(queue.begin(), queue.end(),
+                                   [this](const std::shared_ptr<TileData>& data) {
+                                       auto iter = _tiles.find(tileKey(data->_tileX, data->_tileZ));
+                                       return iter == _tiles.end() || iter->second->_loaded;
+                                   }),
+                    queue.end());
+        auto count = std::min(queue.size(), static_cast<size_t>(MAX_UPLOADS_PER_FRAME));
+        finished.assign(queue.begin(), queue.begin() + count);
+        queue.erase(queue.begin(), queue.begin() + count);
+    }
+    for (auto&& data : finished)
+        installTile(*data);
+
+    const float tileWorldSize = _terrainData._tileSize * _terrainData._mapScale;
+    const int cameraX         = static_cast<int>(floorf(cameraPos.x / tileWorldSize));
+    const int cameraZ         = static_cast<int>(floorf(cameraPos.z / tileWorldSize));
+    const int radius          = _terrainData._loadRadius;
+
+    // keep one more ring than loaded, so moving back and forth over a tile edge doesn't reload
+    for (auto iter = _tiles.begin(); iter != _tiles.end();)
+    {
+        auto& tile = iter->second;
+        if (std::max(std::abs(tile->_tileX - cameraX), std::abs(tile->_tileZ - cameraZ)) > radius + 1)
+            iter = _tiles.erase(iter);
+        else
+            ++iter;
+    }
+
+    std::vector<std::pair<int, int>> missing;
+    for (int z = std::max(cameraZ - radius, 0); z <= std::min(cameraZ + radius, _terrainData._tileCountZ - 1); ++z)
+    {
+        for (int x = std::max(cameraX - radius, 0); x <= std::min(cameraX + radius, _terrainData._tileCountX - 1);
+             ++x)
+        {
+            if (_tiles.find(tileKey(x, z)) == _tiles.end())
+                missing.emplace_back(x, z);
+        }
+    }
+    // the closest first
+    std::sort(missing.begin(), missing.end(), [cameraX, cameraZ](const auto& a, const auto& b) {
+        return std::max(std::abs(a.first - cameraX), std::abs(a.second - cameraZ)) <
+               std::max(std::abs(b.first - cameraX), std::abs(b.second - cameraZ));
+    });
+
+    for (auto&& coord : missing)
+    {
+        auto tile     = std::make_unique<Tile>();
+        tile->_tileX  = coord.first;
+        tile->_tileZ  = coord.second;
+        _tiles[tileKey(coord.first, coord.second)] = std::move(tile);
+
+        auto data    = std::make_shared<TileData>();
+        data->_tileX = coord.first;
+        data->_tileZ = coord.second;
+        std::string fullPath;
+        if (!_loader)
+            fullPath = FileUtils::getInstance()->fullPathForFilename(
+                StringUtils::format(_terrainData._heightMapPattern.c_str(), coord.first, coord.second));
+
+        JobSystem::getInstance()->enqueue(
+            [queue = _loadQueue, terrainData = _terrainData, loader = _loader, fullPath = std::move(fullPath), data]() {
+                loadTile(terrainData, loader, fullPath, *data);
+                std::lock_guard<std::mutex> lk(queue->_mutex);
+                queue->_finished.emplace_back(data);
+            });
+    }
+}
+
+void TiledTerrain::draw(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    auto modelMatrix = getNodeToWorldTransform();
+    if (memcmp(&modelMatrix, &_terrainModelMatrix, sizeof(Mat4)) != 0)
+    {
+        _terrainModelMatrix = modelMatrix;
+        for (auto&& iter : _tiles)
+        {
+            for (auto&& chunk : iter.second->_chunks)
+            {
+                chunk->_worldSpaceAABB = chunk->_aabb;
+                chunk->_worldSpaceAABB.transform(_terrainModelMatrix);
+            }
+        }
+    }
+
+    auto camera = Camera::getVisitingCamera();
+    auto m      = camera->getNodeToWorldTransform();
+    Vec3 cameraPos(m.m[12], m.m[13], m.m[14]);
+    getWorldToNodeTransform().transformPoint(&cameraPos);
+
+    // stream around the first camera drawing the terrain in a frame
+    if (_streamedFrame != _director->getTotalFrames())
+    {
+        _streamedFrame = _director->getTotalFrames();
+        _drawnChunks   = 0;
+        updateStreaming(cameraPos);
+    }
+
+    auto& projectionMatrix = _director->getMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_PROJECTION);
+    auto finalMatrix       = projectionMatrix * transform;
+    Vec4 cameraParam(cameraPos.x, cameraPos.y, cameraPos.z, 0.0f);
+    int hasAlphaMap = 0;
+    int hasLightMap = 0;
+    for (int lod = 0; lod < LOD_COUNT; ++lod)
+    {
+        // the last LOD has no coarser one to morph to
+        Vec4 morphParams(FLT_MAX * 0.25f, FLT_MAX * 0.5f, static_cast<float>(lod), 0.0f);
+        if (lod < LOD_COUNT - 1)
+        {
+            morphParams.x = _lodDistance[lod] * MORPH_START_RATIO;
+            morphParams.y = _lodDistance[lod];
+        }
+
+        auto programState = _lodProgramStates[lod];
+        programState->setUniform(_mvpMatrixLocation, &finalMatrix.m, sizeof(finalMatrix.m));
+        programState->setUniform(_cameraPosLocation, &cameraParam, sizeof(cameraParam));
+        programState->setUniform(_morphParamsLocation, &morphParams, sizeof(morphParams));
+        programState->setUniform(_lightDirLocation, &_lightDir, sizeof(_lightDir));
+        programState->setUniform(_hasAlphaLocation, &hasAlphaMap, sizeof(hasAlphaMap));
+        programState->setUniform(_hasLightMapLocation, &hasLightMap, sizeof(hasLightMap));
+        programState->setTexture(_detailMapLocation, 0, _detailMapTexture->getBackendTexture());
+        programState->setTexture(_lightMapLocation, 5, _dummyTexture->getBackendTexture());
+    }
+
+    for (auto&& iter : _tiles)
+    {
+        for (auto&& chunk : iter.second->_chunks)
+        {
+            if (_isEnableFrustumCull && !camera->isVisibleInFrustum(&chunk->_worldSpaceAABB))
+                continue;
+
+            // the LOD by the distance to the closest point of the chunk, so no vertex is closer than its range
+            const auto& aabb = chunk->_aabb;
+            float dx         = std::max(std::max(aabb._min.x - cameraPos.x, cameraPos.x - aabb._max.x), 0.0f);
+            float dz         = std::max(std::max(aabb._min.z - cameraPos.z, cameraPos.z - aabb._max.z), 0.0f);
+            float dist       = sqrtf(dx * dx + dz * dz);
+            int lod          = LOD_COUNT - 1;
+            for (int i = 0; i < LOD_COUNT - 1; ++i)
+            {
+                if (dist < _lodDistance[i])
+                {
+                    lod = i;
+                    break;
+                }
+            }
+            chunk->_currentLod = lod;
+
+            auto& command = chunk->_command;
+            command.getPipelineDescriptor().programState = _lodProgramStates[lod];
+            command.setIndexBuffer(_lodIndices[lod], backend::IndexFormat::U_SHORT);
+            command.setIndexDrawInfo(0, _lodIndexCount[lod]);
+            renderer->addCommand(&command);
+            AX_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, _lodIndexCount[lod]);
+            ++_drawnChunks;
+        }
+    }
+}
+
+float TiledTerrain::getHeight(float x, float z) const
+{
+    Vec3 pos(x, 0.0f, z);
+    getWorldToNodeTransform().transformPoint(&pos);
+
+    const float gridX = pos.x / _terrainData._mapScale;
+    const float gridZ = pos.z / _terrainData._mapScale;
+    if (gridX < 0 || gridZ < 0)
+        return 0;
+
+    const int tileSize = _terrainData._tileSize;
+    const int tileX    = static_cast<int>(gridX) / tileSize;
+    const int tileZ    = static_cast<int>(gridZ) / tileSize;
+    if (tileX >= _terrainData._tileCountX || tileZ >= _terrainData._tileCountZ)
+        return 0;
+
+    auto iter = _tiles.find(tileKey(tileX, tileZ));
+    if (iter == _tiles.end() || iter->second->_heights.empty())
+        return 0;
+
+    const auto& heights = iter->second->_heights;
+    const float localX  = gridX - tileX * tileSize;
+    const float localZ  = gridZ - tileZ * tileSize;
+    const int j         = std::min(static_cast<int>(localX), tileSize - 1);
+    const int i         = std::min(static_cast<int>(localZ), tileSize - 1);
+    const float u       = localX - j;
+    const float v       = localZ - i;
+    const int side      = tileSize + 1;
+    float result        = (1 - u) * (1 - v) * heights[i * side + j] + u * (1 - v) * heights[i * side + j + 1] +
+                   (1 - u) * v * heights[(i + 1) * side + j] + u * v * heights[(i + 1) * side + j + 1];
+    return result * getScaleY();
+}
+
+int TiledTerrain::getLoadedTileCount() const
+{
+    return static_cast<int>(
+        std::count_if(_tiles.begin(), _tiles.end(), [](const auto& iter) { return iter.second->_loaded; }));
+}
+
+int TiledTerrain::getLoadingTileCount() const
+{
+    return static_cast<int>(_tiles.size()) - getLoadedTileCount();
+}
+
+TiledTerrain::Chunk::~Chunk()
+{
+    AX_SAFE_RELEASE_NULL(_buffer);
+}
+
+TiledTerrain::TiledTerrainData::TiledTerrainData()
+    : _detailMapSize(10)
+    , _tileCountX(0)
+    , _tileCountZ(0)
+    , _tileSize(128)
+    , _chunkSize(32)
+    , _mapHeight(2)
+    , _mapScale(0.1f)
+    , _loadRadius(2)
+{}
+
+TiledTerrain::TiledTerrainData::TiledTerrainData(std::string_view heightMapPattern,
+                                                 std::string_view detailMapSrc,
+                                                 int tileCountX,
+                                                 int tileCountZ,
+                                                 int tileSize,
+                                                 float mapHeight,
+                                                 float mapScale)
+    : TiledTerrainData()
+{
+    _heightMapPattern = heightMapPattern;
+    _detailMapSrc     = detailMapSrc;
+    _tileCountX       = tileCountX;
+    _tileCountZ       = tileCountZ;
+    _tileSize         = tileSize;
+    _chunkSize        = std::min(32, tileSize);
+    _mapHeight        = mapHeight;
+    _mapScale         = mapScale;
+    _detailMapSize    = 100 * mapScale;
+}
+
+void TiledTerrain::onBeforeDraw()
+{
+    _stateBlockOld.save();
+    _stateBlock.apply();
+}
+
+void TiledTerrain::onAfterDraw()
+{
+    _stateBlockOld.apply();
+}
+
+void TiledTerrain::StateBlock::save()
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    depthWrite    = renderer->getDepthWrite();
+    depthTest     = renderer->getDepthTest();
+    cullFace      = renderer->getCullMode();
+    winding       = renderer->getWinding();
+}
+
+void TiledTerrain::StateBlock::apply()
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    renderer->setDepthTest(depthTest);
+    renderer->setDepthWrite(depthWrite);
+    renderer->setCullMode(cullFace);
+    renderer->setWinding(winding);
+}
+
+NS_AX_END
@@ -0,0 +1,259 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <mutex>
+
+#include "2d/Node.h"
+#include "renderer/MeshCommand.h"
+#include "renderer/backend/Types.h"
+#include "renderer/backend/ProgramState.h"
+#include "3d/AABB.h"
+
+NS_AX_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+class Texture2D;
+
+/**
+ * TiledTerrain
+ * The tiled mode of Terrain, for worlds too large to keep in memory.
+ *
+ * The world is a grid of heightmap tiles, only the tiles around the camera are kept. Missing tiles are decoded
+ * and turned to vertices on the JobSystem workers, the frame only uploads the finished ones, a few per frame.
+ *
+ * Each tile is divided in chunks of the same size, so all chunks draw with one of LOD_COUNT index buffers shared
+ * by the whole terrain. Instead of rebuilding vertices and indices when the camera moves like Terrain does, every
+ * vertex stores the height of the next coarser LOD and the vertex shader blends to it as the distance to the camera
+ * grows, chunks switch LOD once fully morphed, so there are neither cracks nor popping.
+ */
+class AX_DLL TiledTerrain : public Node
+{
+public:
+    static const int LOD_COUNT = 4;
+
+    /**
+     * Fills the (tileSize + 3) x (tileSize + 3) heights of a tile, row by row along z, starting one row and one
+     * column before the tile. This border overlaps the neighbor tiles so the normals of the edges match them, the
+     * tiles on the sides of the world repeat their edge. Called from worker threads, returns false if the tile
+     * can't be loaded.
+     */
+    typedef std::function<bool(int tileX, int tileZ, std::vector<float>& heights)> HeightTileLoader;
+
+    /**
+     *TiledTerrainData
+     *This struct wraps all parameters that TiledTerrain need to create
+     */
+    struct AX_DLL TiledTerrainData
+    {
+        TiledTerrainData();
+        /**
+         * @param heightMapPattern The heightmap of each tile, formatted with the tile x and z, i.e.
+         * "terrain/height_%d_%d.png", the images are (tileSize + 3) pixels square, with a one pixel border
+         * overlapping the neighbor tiles like the heights of HeightTileLoader.
+         */
+        TiledTerrainData(std::string_view heightMapPattern,
+                         std::string_view detailMapSrc,
+                         int tileCountX,
+                         int tileCountZ,
+                         int tileSize    = 128,
+                         float mapHeight = 2,
+                         float mapScale  = 0.1);
+
+        std::string _heightMapPattern;
+        /**the texture repeated over the terrain*/
+        std::string _detailMapSrc;
+        /**the size of one repeat of the detail map, in terrain space*/
+        float _detailMapSize;
+        /**the amount of tiles*/
+        int _tileCountX;
+        int _tileCountZ;
+        /**the quads along the side of a tile, power of two*/
+        int _tileSize;
+        /**the quads along the side of a chunk, power of two in [16, 128] dividing the tile size*/
+        int _chunkSize;
+        /**terrain Maximum height*/
+        float _mapHeight;
+        /**the size of a quad*/
+        float _mapScale;
+        /**how many tiles around the tile of the camera are kept loaded*/
+        int _loadRadius;
+    };
+
+    static TiledTerrain* create(const TiledTerrainData& data, const HeightTileLoader& loader = nullptr);
+
+    /**
+     * Set the distances where each LOD ends, in terrain space, the last LOD has no end.
+     * Each distance must exceed the previous one by twice the diagonal of a chunk, so neighbor chunks never differ
+     * by more than one LOD.
+     */
+    void setLODDistance(float lod1, float lod2, float lod3);
+
+    void setLightDir(const Vec3& lightDir);
+
+    void setIsEnableFrustumCull(bool value) { _isEnableFrustumCull = value; }
+
+    /**
+     * get the height of a world position (X,Z), bi-linear interpolated.
+     * @return 0 if the position is out of the terrain or its tile isn't loaded.
+     */
+    float getHeight(float x, float z) const;
+
+    /** get the amount of tiles uploaded. */
+    int getLoadedTileCount() const;
+
+    /** get the amount of tiles being loaded on the workers. */
+    int getLoadingTileCount() const;
+
+    /** get the amount of chunks drawn by the last frame. */
+    int getDrawnChunkCount() const { return _drawnChunks; }
+
+    // Overrides, internal use only
+    virtual void draw(Renderer* renderer, const Mat4& transform, uint32_t flags) override;
+
+    TiledTerrain();
+    virtual ~TiledTerrain();
+    bool initWithTiledTerrainData(const TiledTerrainData& data, const HeightTileLoader& loader);
+
+protected:
+    /*
+     * vertex format, position, texcoord and normal like Terrain, and the height of the coarser LOD and the LOD
+     * the vertex morphs in
+     */
+    struct TileVertexData
+    {
+        Vec3 _position;
+        Tex2F _texcoord;
+        Vec3 _normal;
+        Vec2 _morph;
+    };
+
+    struct Chunk
+    {
+        Chunk() = default;
+        Chunk(const Chunk&) = delete;
+        ~Chunk();
+        backend::Buffer* _buffer = nullptr;
+        /**AABB in local space*/
+        AABB _aabb;
+        /**AABB in world space*/
+        AABB _worldSpaceAABB;
+        int _currentLod = 0;
+        MeshCommand _command;
+    };
+
+    /* the result of a tile load, built on a worker */
+    struct TileData
+    {
+        int _tileX;
+        int _tileZ;
+        bool _succeed = false;
+        std::vector<float> _heights;
+        std::vector<std::vector<TileVertexData>> _chunkVertices;
+    };
+
+    struct Tile
+    {
+        int _tileX;
+        int _tileZ;
+        bool _loaded = false;
+        std::vector<float> _heights;
+        std::vector<std::unique_ptr<Chunk>> _chunks;
+    };
+
+    /* finished loads, shared with the jobs so a load may outlive the terrain */
+    struct LoadQueue
+    {
+        std::mutex _mutex;
+        std::vector<std::shared_ptr<TileData>> _finished;
+    };
+
+    static void loadTile(const TiledTerrainData& data,
+                         const HeightTileLoader& loader,
+                         std::string_view fullPath,
+                         TileData& tile);
+    static bool loadHeightMap(const TiledTerrainData& data, std::string_view fullPath, std::vector<float>& heights);
+
+    void updateStreaming(const Vec3& cameraPos);
+    void installTile(TileData& data);
+    void initIndices();
+    void initProgramStates();
+    void onBeforeDraw();
+    void onAfterDraw();
+
+    int tileKey(int tileX, int tileZ) const { return tileZ * _terrainData._tileCountX + tileX; }
+
+    TiledTerrainData _terrainData;
+    HeightTileLoader _loader;
+    std::unordered_map<int, std::unique_ptr<Tile>> _tiles;
+    std::shared_ptr<LoadQueue> _loadQueue;
+
+    backend::Buffer* _lodIndices[LOD_COUNT];
+    unsigned int _lodIndexCount[LOD_COUNT];
+    backend::ProgramState* _lodProgramStates[LOD_COUNT];
+    float _lodDistance[LOD_COUNT - 1];
+
+    Texture2D* _detailMapTexture;
+    Texture2D* _dummyTexture;
+    Vec3 _lightDir;
+    bool _isEnableFrustumCull;
+    Mat4 _terrainModelMatrix;
+    unsigned int _streamedFrame;
+    int _drawnChunks;
+
+    backend::UniformLocation _mvpMatrixLocation;
+    backend::UniformLocation _cameraPosLocation;
+    backend::UniformLocation _morphParamsLocation;
+    backend::UniformLocation _hasAlphaLocation;
+    backend::UniformLocation _hasLightMapLocation;
+    backend::UniformLocation _lightDirLocation;
+    backend::UniformLocation _detailMapLocation;
+    backend::UniformLocation _lightMapLocation;
+
+    struct StateBlock
+    {
+        bool depthWrite            = true;
+        bool depthTest             = true;
+        backend::CullMode cullFace = backend::CullMode::FRONT;
+        backend::Winding winding   = backend::Winding::CLOCK_WISE;
+        void apply();
+        void save();
+    };
+
+    StateBlock _stateBlock;
+    StateBlock _stateBlockOld;
+};
+
+// end of 3d group
+/// @}
+
+NS_AX_END
@@ -32,11 +32,14 @@
 
 #include "audio/AudioCache.h"
 #include <thread>
+#include <algorithm>
 #include "base/Director.h"
 #include "base/Scheduler.h"
+#include "platform/FileUtils.h"
 
 #include "audio/AudioDecoderManager.h"
 #include "audio/AudioDecoder.h"
+#include "xxhash/xxhash.h"
 
 #define VERY_VERY_VERBOSE_LOGGING
 #ifdef VERY_VERY_VERBOSE_LOGGING
@@ -51,8 +54,117 @@
 namespace
 {
 unsigned int __idIndex = 0;
+
+// samples per channel in an IMA4 block, the default of OpenAL Soft
+constexpr uint32_t IMA4_SAMPLES_PER_BLOCK = 65;
+
+constexpr char PCM_CACHE_MAGIC[4]    = {'A', 'X', 'P', 'C'};
+constexpr uint32_t PCM_CACHE_VERSION = 2;
+
+struct PcmCacheHeader
+{
+    char magic[4];
+    uint32_t version;
+    int64_t sourceSize;
+    uint64_t sourceHash;
+    uint32_t storage;
+    int32_t format;
+    uint32_t sampleRate;
+    uint32_t totalFrames;
+    uint32_t blockAlign;
+    uint32_t dataSize;
+};
+
+constexpr int IMA_STEP_SIZE[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+    544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+    9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22358, 24633, 27086, 29794, 32767};
+
+constexpr int IMA_INDEX_ADJUST[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+// hashes the content of a source file, a same-size edit must not reuse a stale disk cache
+uint64_t hashSourceFile(std::string_view path)
+{
+    auto stream = ax::FileUtils::getInstance()->openFileStream(path, ax::IFileStream::Mode::READ);
+    if (!stream)
+        return 0;
+
+    auto state = XXH64_createState();
+    XXH64_reset(state, 0);
+    char buffer[16384];
+    int bytes;
+    while ((bytes = stream->read(buffer, sizeof(buffer))) > 0)
+        XXH64_update(state, buffer, static_cast<size_t>(bytes));
+    auto hash = XXH64_digest(state);
+    XXH64_freeState(state);
+    return hash;
+}
+
+// converts float samples in [-1, 1] to 16 bits in place
+template <typename T>
+void convertToPcm16(std::vector<char>& pcmData)
+{
+    const size_t samples = pcmData.size() / sizeof(T);
+    for (size_t i = 0; i < samples; ++i)
+    {
+        T value;
+        memcpy(&value, pcmData.data() + i * sizeof(T), sizeof(T));
+        const auto sample = static_cast<int16_t>(std::clamp(value, T(-1), T(1)) * T(32767));
+        memcpy(pcmData.data() + i * sizeof(int16_t), &sample, sizeof(sample));
+    }
+    pcmData.resize(samples * sizeof(int16_t));
 }
 
+// Encodes interleaved 16 bits pcm to the IMA4 layout OpenAL Soft decodes: each block starts with the first sample
+// and the step index of each channel, followed by the nibbles of the other samples packed 8 per 4 bytes word,
+// words interleaved by channel. The last block is padded with silence.
+std::vector<char> encodeIma4(const int16_t* pcm, uint32_t frames, uint32_t channels)
+{
+    const uint32_t blocks     = (frames + IMA4_SAMPLES_PER_BLOCK - 1) / IMA4_SAMPLES_PER_BLOCK;
+    const uint32_t blockBytes = ((IMA4_SAMPLES_PER_BLOCK - 1) / 2 + 4) * channels;
+    std::vector<char> encoded(static_cast<size_t>(blocks) * blockBytes, 0);
+    int index[2] = {0, 0};
+
+    for (uint32_t block = 0; block < blocks; ++block)
+    {
+        auto dst             = reinterpret_cast<uint8_t*>(encoded.data()) + static_cast<size_t>(block) * blockBytes;
+        const uint32_t first = block * IMA4_SAMPLES_PER_BLOCK;
+        for (uint32_t c = 0; c < channels; ++c)
+        {
+            auto sourceSample = [=](uint32_t i) -> int {
+                return first + i < frames ? pcm[static_cast<size_t>(first + i) * channels + c] : 0;
+            };
+
+            int sample     = sourceSample(0);
+            dst[c * 4]     = static_cast<uint8_t>(sample & 0xff);
+            dst[c * 4 + 1] = static_cast<uint8_t>((sample >> 8) & 0xff);
+            dst[c * 4 + 2] = static_cast<uint8_t>(index[c]);
+            dst[c * 4 + 3] = 0;
+
+            uint8_t* nibbles = dst + (channels + c) * 4;
+            for (uint32_t n = 0; n < IMA4_SAMPLES_PER_BLOCK - 1; ++n)
+            {
+                // the decoder adds (2 * code + 1) * step / 8, negated when bit 3 is set
+                const int step = IMA_STEP_SIZE[index[c]];
+                const int diff = sourceSample(n + 1) - sample;
+                const int code = std::min(std::abs(diff) * 4 / step, 7);
+                const int delta = (2 * code + 1) * step / 8;
+
+                sample   = std::clamp(diff < 0 ? sample - delta : sample + delta, -32768, 32767);
+                index[c] = std::clamp(index[c] + IMA_INDEX_ADJUST[code], 0, 88);
+
+                const uint8_t nibble = static_cast<uint8_t>(code | (diff < 0 ? 8 : 0));
+                nibbles[(n >> 3) * 4 * channels + ((n >> 1) & 3)] |= nibble << ((n & 1) * 4);
+            }
+        }
+    }
+    return encoded;
+}
+}  // namespace
+
 #define INVALID_AL_BUFFER_ID 0xFFFFFFFF
 #define PCMDATA_CACHEMAXSIZE 1048576
 
@@ -67,6 +179,11 @@ AudioCache::AudioCache()
     , _queBufferFrames(0)
     , _state(State::INITIAL)
     , _isDestroyed(std::make_shared<bool>(false))
+    , _storage(AudioCacheStorage::NATIVE)
+    , _sourceHash(0)
+    , _memoryBytes(0)
+    , _lastUsed(0)
+    , _isFromDiskCache(false)
     , _id(++__idIndex)
     , _isLoadingFinished(false)
     , _isSkipReadDataTask(false)
@@ -129,9 +246,17 @@ void AudioCache::readDataTask(unsigned int selfId)
     _readDataTaskMutex.lock();
     _state = State::LOADING;
 
-    AudioDecoder* decoder = AudioDecoderManager::createDecoder(_fileFullPath);
+    AudioDecoder* decoder = nullptr;
     do
     {
+        if (loadFromDiskCache())
+        {
+            ALOGV("pcm data of %s was loaded from disk cache", _fileFullPath.c_str());
+            _state = State::READY;
+            break;
+        }
+
+        decoder = AudioDecoderManager::createDecoder(_fileFullPath);
         if (decoder == nullptr || !decoder->open(_fileFullPath))
             break;
 
@@ -235,9 +360,6 @@ void AudioCache::readDataTask(unsigned int selfId)
 #if AX_USE_ALSOFT
             ALOGV("pcm buffer was loaded successfully, total frames: %u, total read frames: %u, remainingFrames: %u",
                   totalFrames, _framesRead, remainingFrames);
-            if (sourceFormat == AUDIO_SOURCE_FORMAT::ADPCM || sourceFormat == AUDIO_SOURCE_FORMAT::IMA_ADPCM)
-                alBufferi(_alBufferId, AL_UNPACK_BLOCK_ALIGNMENT_SOFT, decoder->getSamplesPerBlock());
-            alBufferData(_alBufferId, _format, pcmData, (ALsizei)dataSize, (ALsizei)sampleRate);
 #else
 #    if !AX_USE_ALSOFT
             /// Apple OpenAL framework, try adjust frames
@@ -287,14 +409,9 @@ void AudioCache::readDataTask(unsigned int selfId)
                 "remainingFrames: %u",
                 totalFrames, _framesRead, adjustFrames, remainingFrames);
             _framesRead += adjustFrames;
-            alBufferData(_alBufferId, _format, pcmData, (ALsizei)dataSize, (ALsizei)sampleRate);
 #endif
-            alError = alGetError();
-            if (alError != AL_NO_ERROR)
-            {
-                ALOGE("%s:alBufferData error code:%x", __FUNCTION__, alError);
+            if (!uploadPcmData(decoder, pcmBuffer))
                 break;
-            }
 
             _state = State::READY;
         }
@@ -312,6 +429,7 @@ void AudioCache::readDataTask(unsigned int selfId)
 
                 decoder->readFixedFrames(_queBufferFrames, _queBuffers[index]);
             }
+            _memoryBytes = queBufferBytes * QUEUEBUFFER_NUM;
 
             _state = State::READY;
         }
@@ -342,6 +460,142 @@ void AudioCache::readDataTask(unsigned int selfId)
     ALOGVV("readDataTask end, cache id=%u", selfId);
 }
 
+bool AudioCache::uploadPcmData(AudioDecoder* decoder, std::vector<char>& pcmData)
+{
+    const auto sourceFormat     = decoder->getSourceFormat();
+    const uint32_t channelCount = decoder->getChannelCount();
+    uint32_t blockAlign         = 0;
+#if AX_USE_ALSOFT
+    if (sourceFormat == AUDIO_SOURCE_FORMAT::ADPCM || sourceFormat == AUDIO_SOURCE_FORMAT::IMA_ADPCM)
+        blockAlign = decoder->getSamplesPerBlock();
+#endif
+
+    if (_storage != AudioCacheStorage::NATIVE)
+    {
+        if (sourceFormat == AUDIO_SOURCE_FORMAT::PCM_FLT32 || sourceFormat == AUDIO_SOURCE_FORMAT::PCM_FLT64)
+        {
+            if (sourceFormat == AUDIO_SOURCE_FORMAT::PCM_FLT32)
+                convertToPcm16<float>(pcmData);
+            else
+                convertToPcm16<double>(pcmData);
+            _format = channelCount > 1 ? AL_FORMAT_STEREO16 : AL_FORMAT_MONO16;
+        }
+#if AX_USE_ALSOFT
+        if (_storage == AudioCacheStorage::ADPCM && (_format == AL_FORMAT_MONO16 || _format == AL_FORMAT_STEREO16))
+        {
+            const uint32_t frames = static_cast<uint32_t>(pcmData.size() / (sizeof(int16_t) * channelCount));
+            pcmData    = encodeIma4(reinterpret_cast<const int16_t*>(pcmData.data()), frames, channelCount);
+            _format    = channelCount > 1 ? AL_FORMAT_STEREO_IMA4 : AL_FORMAT_MONO_IMA4;
+            blockAlign = IMA4_SAMPLES_PER_BLOCK;
+        }
+#endif
+    }
+
+#if AX_USE_ALSOFT
+    if (blockAlign != 0)
+        alBufferi(_alBufferId, AL_UNPACK_BLOCK_ALIGNMENT_SOFT, blockAlign);
+#endif
+    alBufferData(_alBufferId, _format, pcmData.data(), (ALsizei)pcmData.size(), _sampleRate);
+    auto alError = alGetError();
+    if (alError != AL_NO_ERROR)
+    {
+        ALOGE("%s:alBufferData error code:%x", __FUNCTION__, alError);
+        return false;
+    }
+
+    _memoryBytes = static_cast<uint32_t>(pcmData.size());
+    if (!_diskCachePath.empty())
+        saveToDiskCache(pcmData, blockAlign);
+    return true;
+}
+
+bool AudioCache::loadFromDiskCache()
+{
+    if (_diskCachePath.empty())
+        return false;
+
+    // saveToDiskCache stores it when the cache is missing or stale
+    _sourceHash = hashSourceFile(_fileFullPath);
+
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(_diskCachePath))
+        return false;
+
+    std::vector<char> data;
+    if (fileUtils->getContents(_diskCachePath, &data) != FileUtils::Status::OK || data.size() < sizeof(PcmCacheHeader))
+        return false;
+
+    PcmCacheHeader header;
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, PCM_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != PCM_CACHE_VERSION ||
+        header.storage != static_cast<uint32_t>(_storage) || header.dataSize != data.size() - sizeof(header) ||
+        header.sampleRate == 0 || header.sourceSize != fileUtils->getFileSize(_fileFullPath) ||
+        header.sourceHash != _sourceHash)
+    {
+        ALOGV("disk cache %s is stale", _diskCachePath.c_str());
+        return false;
+    }
+
+    alGenBuffers(1, &_alBufferId);
+    if (alGetError() != AL_NO_ERROR)
+    {
+        _alBufferId = INVALID_AL_BUFFER_ID;
+        return false;
+    }
+#if AX_USE_ALSOFT
+    if (header.blockAlign != 0)
+        alBufferi(_alBufferId, AL_UNPACK_BLOCK_ALIGNMENT_SOFT, header.blockAlign);
+#endif
+    alBufferData(_alBufferId, header.format, data.data() + sizeof(header), (ALsizei)header.dataSize,
+                 (ALsizei)header.sampleRate);
+    auto alError = alGetError();
+    if (alError != AL_NO_ERROR)
+    {
+        ALOGE("%s:alBufferData error code:%x", __FUNCTION__, alError);
+        alDeleteBuffers(1, &_alBufferId);
+        _alBufferId = INVALID_AL_BUFFER_ID;
+        return false;
+    }
+
+    _format          = header.format;
+    _sampleRate      = (ALsizei)header.sampleRate;
+    _totalFrames     = header.totalFrames;
+    _framesRead      = header.totalFrames;
+    _duration        = 1.0f * header.totalFrames / header.sampleRate;
+    _memoryBytes     = header.dataSize;
+    _isFromDiskCache = true;
+    return true;
+}
+
+void AudioCache::saveToDiskCache(const std::vector<char>& pcmData, uint32_t blockAlign)
+{
+    auto fileUtils = FileUtils::getInstance();
+
+    PcmCacheHeader header;
+    memcpy(header.magic, PCM_CACHE_MAGIC, sizeof(header.magic));
+    header.version     = PCM_CACHE_VERSION;
+    header.sourceSize  = fileUtils->getFileSize(_fileFullPath);
+    header.sourceHash  = _sourceHash;
+    header.storage     = static_cast<uint32_t>(_storage);
+    header.format      = _format;
+    header.sampleRate  = static_cast<uint32_t>(_sampleRate);
+    header.totalFrames = _totalFrames;
+    header.blockAlign  = blockAlign;
+    header.dataSize    = static_cast<uint32_t>(pcmData.size());
+    if (header.sourceSize <= 0)
+        return;
+
+    std::vector<char> data(sizeof(header) + pcmData.size());
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), pcmData.data(), pcmData.size());
+
+    auto slash = _diskCachePath.find_last_of('/');
+    if (slash != std::string::npos)
+        fileUtils->createDirectory(_diskCachePath.substr(0, slash + 1));
+    if (!FileUtils::writeBinaryToFile(data.data(), data.size(), _diskCachePath))
+        ALOGW("Failed to write disk cache %s", _diskCachePath.c_str());
+}
+
 void AudioCache::addPlayCallback(const std::function<void()>& callback)
 {
     std::lock_guard<std::mutex> lk(_playCallbackMutex);
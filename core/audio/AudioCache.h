@@ -33,15 +33,18 @@
 #include <mutex>
 #include <vector>
 #include <memory>
+#include <atomic>
 
 #include "platform/PlatformMacros.h"
 #include "audio/AudioMacros.h"
+#include "audio/AudioEngine.h"
 #include "audio/alconfig.h"
 
 NS_AX_BEGIN
 
 class AudioEngineImpl;
 class AudioPlayer;
+class AudioDecoder;
 
 class AX_DLL AudioCache
 {
@@ -69,6 +72,11 @@ protected:
 
     void invokingLoadCallbacks();
 
+    // compacts the fully decoded pcm according to _storage and uploads it to _alBufferId
+    bool uploadPcmData(AudioDecoder* decoder, std::vector<char>& pcmData);
+    bool loadFromDiskCache();
+    void saveToDiskCache(const std::vector<char>& pcmData, uint32_t blockAlign);
+
     // pcm data related stuff
     ALenum _format;
     ALsizei _sampleRate;
@@ -100,6 +108,14 @@ protected:
 
     std::shared_ptr<bool> _isDestroyed;
     std::string _fileFullPath;
+
+    // memory budget stuff, set by AudioEngineImpl before readDataTask
+    AudioCacheStorage _storage;
+    std::string _diskCachePath;  // empty if the decoded pcm isn't saved
+    uint64_t _sourceHash;        // content hash of the source file, computed when the disk cache is checked
+    std::atomic<uint32_t> _memoryBytes;
+    uint64_t _lastUsed;
+    bool _isFromDiskCache;
     unsigned int _id;
     bool _isLoadingFinished;
     bool _isSkipReadDataTask;
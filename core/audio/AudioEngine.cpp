@@ -32,6 +32,7 @@
 #include <queue>
 #include "platform/FileUtils.h"
 #include "base/Utils.h"
+#include "base/Director.h"
 
 #include "audio/AudioEngineImpl.h"
 
@@ -52,6 +53,9 @@ hlookup::string_map<std::list<AUDIO_ID>> AudioEngine::_audioPathIDMap;
 hlookup::string_map<AudioEngine::ProfileHelper> AudioEngine::_audioPathProfileHelperMap;
 unsigned int AudioEngine::_maxInstances                        = MAX_AUDIOINSTANCES;
 AudioEngine::ProfileHelper* AudioEngine::_defaultProfileHelper = nullptr;
+size_t AudioEngine::_cacheBudget                               = 0;
+AudioCacheStorage AudioEngine::_cacheStorage                   = AudioCacheStorage::NATIVE;
+bool AudioEngine::_diskCacheEnabled                            = false;
 std::unordered_map<AUDIO_ID, AudioEngine::AudioInfo> AudioEngine::_audioIDInfoMap;
 AudioEngineImpl* AudioEngine::_audioEngineImpl = nullptr;
 
@@ -250,7 +254,8 @@ AUDIO_ID AudioEngine::play2d(std::string_view filePath, const AudioPlayerSetting
             volume = 1.0f;
         }
 
-        ret = _audioEngineImpl->play2d(filePath, settings.loop, volume, settings.time);
+        ret = _audioEngineImpl->play2d(filePath, settings.loop, volume, settings.time,
+                                       profileHelper ? &profileHelper->profile : nullptr);
         if (ret != INVALID_AUDIO_ID)
         {
             _audioPathIDMap[filePath.data()].emplace_back(ret);
@@ -592,6 +597,29 @@ void AudioEngine::preload(std::string_view filePath, std::function<void(bool isS
     }
 }
 
+int AudioEngine::preloadBatch(const std::vector<std::string>& filePaths,
+                              std::function<void(const AudioPreloadProgress&)> callback)
+{
+    if (isEnabled() && lazyInit() && _audioEngineImpl)
+        return _audioEngineImpl->preloadBatch(filePaths, std::move(callback));
+
+    if (callback)
+    {
+        AudioPreloadProgress progress;
+        progress.total  = static_cast<unsigned int>(filePaths.size());
+        progress.failed = progress.total;
+        Director::getInstance()->getScheduler()->runOnAxmolThread(
+            [callback = std::move(callback), progress]() { callback(progress); });
+    }
+    return INVALID_AUDIO_ID;
+}
+
+void AudioEngine::cancelPreloadBatch(int batchID)
+{
+    if (_audioEngineImpl)
+        _audioEngineImpl->cancelPreloadBatch(batchID);
+}
+
 void AudioEngine::addTask(const std::function<void()>& task)
 {
     lazyInit();
@@ -609,6 +637,35 @@ int AudioEngine::getPlayingAudioCount()
     return static_cast<int>(_audioIDInfoMap.size());
 }
 
+AudioMixer* AudioEngine::getMixer()
+{
+    if (!lazyInit())
+        return nullptr;
+    return _audioEngineImpl->getMixer();
+}
+
+AudioStreamStats AudioEngine::getStreamStats()
+{
+    return _audioEngineImpl ? _audioEngineImpl->getStreamStats() : AudioStreamStats{};
+}
+
+void AudioEngine::setCacheBudget(size_t bytes)
+{
+    _cacheBudget = bytes;
+    if (_audioEngineImpl)
+        _audioEngineImpl->enforceCacheBudget(nullptr);
+}
+
+size_t AudioEngine::getCacheMemoryUsage()
+{
+    return _audioEngineImpl ? _audioEngineImpl->getCacheMemoryUsage() : 0;
+}
+
+std::vector<AudioCacheInfo> AudioEngine::getCacheInfos()
+{
+    return _audioEngineImpl ? _audioEngineImpl->getCacheInfos() : std::vector<AudioCacheInfo>{};
+}
+
 void AudioEngine::setEnabled(bool isEnabled)
 {
     if (_isEnabled != isEnabled)
@@ -33,6 +33,7 @@
 #include <functional>
 #include <list>
 #include <string>
+#include <vector>
 #include <unordered_map>
 
 #ifdef ERROR
@@ -59,6 +60,67 @@ struct AX_DLL AudioPlayerSettings
     float time = 0.0f; // The initial time offset when play audio
 };
 
+/**
+ * @struct AudioStreamStats
+ *
+ * @brief Counters of the thread refilling the buffers of all streaming audio instances.
+ * @js NA
+ */
+struct AX_DLL AudioStreamStats
+{
+    unsigned int activeStreams = 0; // Streams currently serviced.
+    unsigned int underruns = 0; // Times a streaming source ran dry and had to be restarted.
+    uint64_t wakeups = 0; // Service passes, one per stream deadline reached.
+    uint64_t buffersQueued = 0; // Buffers decoded and queued.
+    float maxLatenessMs = 0.0f; // Worst delay between a stream deadline and its service pass.
+};
+
+/**
+ * @enum AudioCacheStorage
+ *
+ * @brief How the fully decoded PCM of short sounds is kept in memory, streamed sounds aren't affected.
+ * @js NA
+ */
+enum class AudioCacheStorage
+{
+    NATIVE, // The decoder output as is, i.e. 32 bits float for mp3 and ogg.
+    PCM16, // Float PCM is converted to 16 bits, half the memory of NATIVE for mp3 and ogg.
+    ADPCM, // 16 bits PCM is encoded to IMA4 ADPCM which OpenAL Soft decodes while mixing, about a quarter of PCM16
+           // but lossy and looping sounds get up to 64 frames of silence appended, same as PCM16 without OpenAL Soft.
+};
+
+/**
+ * @struct AudioCacheInfo
+ *
+ * @brief Memory held by the cache of one audio file.
+ * @js NA
+ */
+struct AX_DLL AudioCacheInfo
+{
+    std::string filePath;
+    size_t memoryBytes = 0; // Decoded PCM of a cached sound, or the first buffers of a streamed one.
+    float duration = 0.0f;
+    bool streaming = false; // Too long to be cached fully, decoded while playing.
+    bool inUse = false; // Played by at least one audio instance, so it can't be evicted.
+    bool fromDiskCache = false; // Loaded from the decoded PCM saved by a previous run.
+};
+
+/**
+ * @struct AudioPreloadProgress
+ *
+ * @brief Aggregate progress of AudioEngine::preloadBatch.
+ * @js NA
+ */
+struct AX_DLL AudioPreloadProgress
+{
+    unsigned int total = 0; // Number of files in the batch.
+    unsigned int loaded = 0; // Files decoded, or already cached, successfully.
+    unsigned int failed = 0; // Files missing, failing to decode or uncached before they were loaded.
+    bool cancelled = false; // Set in the last report of a cancelled batch.
+
+    bool isFinished() const { return cancelled || loaded + failed >= total; }
+};
+
 /**
  * @class AudioProfile
  *
@@ -76,15 +138,23 @@ public:
     /* Minimum delay in between sounds */
     double minDelay;
 
+    /* Duration in seconds of each buffer decoded for a streaming instance, 0 uses QUEUEBUFFER_TIME_STEP.
+     * Longer and more buffers mean fewer wakeups of the streaming thread at the cost of memory. */
+    float streamBufferTime;
+
+    /* Number of buffers queued for a streaming instance, values below QUEUEBUFFER_NUM use QUEUEBUFFER_NUM */
+    unsigned int streamBufferCount;
+
     /**
      * Default constructor
      *
      * @lua new
      */
-    AudioProfile() : maxInstances(0), minDelay(0.0) {}
+    AudioProfile() : maxInstances(0), minDelay(0.0), streamBufferTime(0.0f), streamBufferCount(0) {}
 };
 
 class AudioEngineImpl;
+class AudioMixer;
 
 /**
  * @class AudioEngine
@@ -317,11 +387,75 @@ public:
      */
     static void preload(std::string_view filePath, std::function<void(bool isSuccess)> callback);
 
+    /**
+     * Preloads many audio files at once, they are decoded in parallel on the workers of JobSystem.
+     *
+     * @param filePaths The file paths of the audios.
+     * @param callback Called on the cocos thread each time a file is loaded or failed, and once more with
+     * AudioPreloadProgress::cancelled set if the batch is cancelled. It's never called before preloadBatch
+     * returns, files cached already are reported on the next tick.
+     * @return An id to cancel the batch, INVALID_AUDIO_ID if the audio engine is disabled.
+     */
+    static int preloadBatch(const std::vector<std::string>& filePaths,
+                            std::function<void(const AudioPreloadProgress&)> callback);
+
+    /**
+     * Cancels the files of a batch which haven't started decoding, i.e. when leaving a scene. Files being decoded
+     * still finish, files which aren't played anymore are uncached.
+     * Batches are also cancelled by uncacheAll, without invoking their callbacks.
+     */
+    static void cancelPreloadBatch(int batchID);
+
     /**
      * Gets playing audio count.
      */
     static int getPlayingAudioCount();
 
+    /**
+     * Gets the software mixer, voices played through it are mixed on one thread and share a single
+     * OpenAL source, so they don't count against getMaxAudioInstance.
+     *
+     * @return The mixer, or nullptr if the audio device isn't available.
+     */
+    static AudioMixer* getMixer();
+
+    /**
+     * Gets the counters of the streaming thread, i.e. to detect buffer underruns.
+     */
+    static AudioStreamStats getStreamStats();
+
+    /**
+     * Limits the memory of all audio caches, when it's exceeded the least recently played caches which no
+     * audio instance uses are uncached. It's checked when an audio is preloaded or played and while audios play.
+     *
+     * @param bytes The budget, 0 means unlimited which is the default.
+     */
+    static void setCacheBudget(size_t bytes);
+    static size_t getCacheBudget() { return _cacheBudget; }
+
+    /**
+     * Gets the memory of all audio caches in bytes.
+     */
+    static size_t getCacheMemoryUsage();
+
+    /**
+     * Gets the memory of each audio cache.
+     */
+    static std::vector<AudioCacheInfo> getCacheInfos();
+
+    /**
+     * Sets how the PCM of sounds short enough to be cached fully is stored, it applies to sounds loaded later on.
+     */
+    static void setCacheStorage(AudioCacheStorage storage) { _cacheStorage = storage; }
+    static AudioCacheStorage getCacheStorage() { return _cacheStorage; }
+
+    /**
+     * Whether to save the decoded PCM of mp3 and ogg sounds which are cached fully to the writable path,
+     * so they load without decoding next time. A saved file is dropped when the size of its source changes.
+     */
+    static void setDiskCacheEnabled(bool isEnabled) { _diskCacheEnabled = isEnabled; }
+    static bool isDiskCacheEnabled() { return _diskCacheEnabled; }
+
     /**
      * Whether to enable playing audios
      * @note If it's disabled, current playing audios will be stopped and the later 'preload', 'play2d' methods will
@@ -379,6 +513,10 @@ protected:
 
     static unsigned int _maxInstances;
 
+    static size_t _cacheBudget;
+    static AudioCacheStorage _cacheStorage;
+    static bool _diskCacheEnabled;
+
     static ProfileHelper* _defaultProfileHelper;
 
     static AudioEngineImpl* _audioEngineImpl;
@@ -40,6 +40,9 @@
 #include "base/Director.h"
 #include "base/Scheduler.h"
 #include "base/Utils.h"
+#include "base/UTF8.h"
+#include "base/JobSystem.h"
+#include "xxhash/xxhash.h"
 
 #if AX_USE_ALSOFT
 #    include "alc/inprogext.h"
@@ -316,7 +319,7 @@ ALvoid ax::AudioEngineImpl::myAlSourceNotificationCallback(ALuint sid, ALuint no
         player = e.second;
         if (player->_alSource == sid && player->_streamingSource)
         {
-            player->wakeupRotateThread();
+            s_instance->_streamService->wakeup(player);
         }
     }
     s_instance->_threadMutex.unlock();
@@ -325,7 +328,8 @@ ALvoid ax::AudioEngineImpl::myAlSourceNotificationCallback(ALuint sid, ALuint no
 
 NS_AX_BEGIN
 
-AudioEngineImpl::AudioEngineImpl() : _scheduled(false), _currentAudioID(0), _scheduler(nullptr)
+AudioEngineImpl::AudioEngineImpl()
+    : _cacheUseCounter(0), _currentBatchID(0), _scheduled(false), _currentAudioID(0), _scheduler(nullptr)
 {
     s_instance = this;
 }
@@ -337,6 +341,15 @@ AudioEngineImpl::~AudioEngineImpl()
         _scheduler->unschedule(AX_SCHEDULE_SELECTOR(AudioEngineImpl::update), this);
     }
 
+    if (_mixer)
+    {
+        if (_scheduler)
+            _scheduler->unschedule("audio_mixer", this);
+        _mixer.reset();
+    }
+
+    _streamService.reset();
+
     if (s_ALContext)
     {
         alDeleteSources(MAX_AUDIOINSTANCES, _alSources);
@@ -457,6 +470,7 @@ bool AudioEngineImpl::init()
             // ================ Workaround end ================ //
 
             _scheduler          = Director::getInstance()->getScheduler();
+            _streamService      = std::make_unique<AudioStreamService>();
             ret                 = AudioDecoderManager::init();
             const char* vender  = alGetString(AL_VENDOR);
             const char* version = alGetString(AL_VERSION);
@@ -495,6 +509,57 @@ bool AudioEngineImpl::init()
     return ret;
 }
 
+AudioMixer* AudioEngineImpl::getMixer()
+{
+    if (!_mixer)
+    {
+        auto mixer = std::make_unique<AudioMixer>(std::make_unique<ALAudioMixerOutput>());
+        if (!mixer->start())
+            return nullptr;
+
+        _mixer = std::move(mixer);
+        _scheduler->schedule([this](float) { _mixer->update(); }, this, 0.0f, false, "audio_mixer");
+    }
+    return _mixer.get();
+}
+
+AudioCache* AudioEngineImpl::_createCache(std::string_view filePath)
+{
+    auto fileUtils  = FileUtils::getInstance();
+    auto audioCache = new AudioCache();  // hlookup_second(it);
+    _audioCaches.emplace(filePath, std::unique_ptr<AudioCache>(audioCache));
+    audioCache->_fileFullPath = fileUtils->fullPathForFilename(filePath);
+    audioCache->_storage      = AudioEngine::_cacheStorage;
+    audioCache->_lastUsed     = ++_cacheUseCounter;
+    if (AudioEngine::_diskCacheEnabled)
+    {
+        // only compressed formats are worth it, decoding wav costs less than reading it back
+        auto extension = fileUtils->getFileExtension(audioCache->_fileFullPath);
+        if (extension == ".mp3" || extension == ".ogg")
+        {
+            auto hash = XXH64(audioCache->_fileFullPath.data(), audioCache->_fileFullPath.size(), 0);
+            audioCache->_diskCachePath = StringUtils::format(
+                "%saudiocache/%016llx.pcm", fileUtils->getWritablePath().c_str(), static_cast<unsigned long long>(hash));
+        }
+    }
+    return audioCache;
+}
+
+void AudioEngineImpl::_launchReadDataTask(AudioCache* audioCache)
+{
+    unsigned int cacheId  = audioCache->_id;
+    auto isCacheDestroyed = audioCache->_isDestroyed;
+    AudioEngine::addTask([audioCache, cacheId, isCacheDestroyed]() {
+        if (*isCacheDestroyed)
+        {
+            ALOGV("AudioCache (id=%u) was destroyed, no need to launch readDataTask.", cacheId);
+            audioCache->setSkipReadDataTask(true);
+            return;
+        }
+        audioCache->readDataTask(cacheId);
+    });
+}
+
 AudioCache* AudioEngineImpl::preload(std::string_view filePath, std::function<void(bool)> callback)
 {
     AudioCache* audioCache = nullptr;
@@ -502,26 +567,17 @@ AudioCache* AudioEngineImpl::preload(std::string_view filePath, std::function<vo
     auto it = _audioCaches.find(filePath);
     if (it == _audioCaches.end())
     {
-        audioCache = new AudioCache();  // hlookup_second(it);
-        _audioCaches.emplace(filePath, std::unique_ptr<AudioCache>(audioCache));
-        audioCache->_fileFullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
-        unsigned int cacheId      = audioCache->_id;
-        auto isCacheDestroyed     = audioCache->_isDestroyed;
-        AudioEngine::addTask([audioCache, cacheId, isCacheDestroyed]() {
-            if (*isCacheDestroyed)
-            {
-                ALOGV("AudioCache (id=%u) was destroyed, no need to launch readDataTask.", cacheId);
-                audioCache->setSkipReadDataTask(true);
-                return;
-            }
-            audioCache->readDataTask(cacheId);
-        });
+        audioCache = _createCache(filePath);
+        _launchReadDataTask(audioCache);
     }
     else
     {
-        audioCache = it->second.get();
+        audioCache            = it->second.get();
+        audioCache->_lastUsed = ++_cacheUseCounter;
     }
 
+    enforceCacheBudget(audioCache);
+
     if (audioCache && callback)
     {
         audioCache->addLoadCallback(callback);
@@ -529,7 +585,219 @@ AudioCache* AudioEngineImpl::preload(std::string_view filePath, std::function<vo
     return audioCache;
 }
 
-AUDIO_ID AudioEngineImpl::play2d(std::string_view filePath, bool loop, float volume, float time)
+void AudioEngineImpl::PreloadBatch::decode()
+{
+    // Note: It's in sub thread
+    while (true)
+    {
+        AudioCache* cache = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            if (next >= decodeQueue.size())
+                return;
+            cache = decodeQueue[next++];
+        }
+        if (cache == nullptr)
+            continue;
+
+        // the cache can't be deleted before either flag is set, see ~AudioCache
+        if (*cache->_isDestroyed)
+            cache->setSkipReadDataTask(true);
+        else
+            cache->readDataTask(cache->_id);
+    }
+}
+
+int AudioEngineImpl::preloadBatch(const std::vector<std::string>& filePaths,
+                                  std::function<void(const AudioPreloadProgress&)> callback)
+{
+    auto batch            = std::make_shared<PreloadBatch>();
+    batch->id             = ++_currentBatchID;
+    batch->callback       = std::move(callback);
+    batch->progress.total = static_cast<unsigned int>(filePaths.size());
+    batch->items.reserve(filePaths.size());
+
+    auto fileUtils = FileUtils::getInstance();
+    for (auto&& filePath : filePaths)
+    {
+        AudioCache* cache = nullptr;
+        auto it           = _audioCaches.find(filePath);
+        if (it != _audioCaches.end())
+        {
+            cache            = it->second.get();
+            cache->_lastUsed = ++_cacheUseCounter;
+        }
+        else if (fileUtils->isFileExist(filePath))
+        {
+            cache = _createCache(filePath);
+            batch->decodeQueue.emplace_back(cache);
+        }
+        else
+        {
+            ++batch->progress.failed;
+        }
+        batch->items.emplace_back(PreloadBatch::Item{filePath, cache, cache == nullptr});
+    }
+
+    _preloadBatches.emplace(batch->id, batch);
+    // files cached already report back right away, hold that until the caller has the batch id
+    batch->deferred = true;
+    for (size_t index = 0; index < batch->items.size(); ++index)
+    {
+        if (auto cache = batch->items[index].cache)
+        {
+            cache->addLoadCallback(
+                [this, batch, index](bool isSuccess) { _onBatchItemDone(batch, index, isSuccess); });
+        }
+    }
+
+    // one job per worker, each claims the next file when it's done with one, so cancelling only has to
+    // empty the queue
+    if (!batch->decodeQueue.empty())
+    {
+        auto jobSystem = JobSystem::getInstance();
+        auto jobs      = std::min(batch->decodeQueue.size(),
+                                  static_cast<size_t>(std::max(jobSystem->getThreadCount(), 1)));
+        for (size_t i = 0; i < jobs; ++i)
+            jobSystem->enqueue([batch]() { batch->decode(); });
+    }
+
+    enforceCacheBudget(nullptr);
+
+    batch->deferred = false;
+    if (batch->progress.loaded + batch->progress.failed > 0)
+    {
+        // the engine may be gone by the next tick, and a cancelled batch already got its last callback
+        _scheduler->runOnAxmolThread([batch]() {
+            if (s_instance == nullptr)
+                return;
+            auto it = s_instance->_preloadBatches.find(batch->id);
+            if (it != s_instance->_preloadBatches.end() && it->second == batch)
+                s_instance->_notifyBatch(batch);
+        });
+    }
+
+    return batch->id;
+}
+
+void AudioEngineImpl::cancelPreloadBatch(int batchID)
+{
+    auto it = _preloadBatches.find(batchID);
+    if (it == _preloadBatches.end())
+        return;
+    auto batch = it->second;
+
+    std::vector<AudioCache*> unclaimed;
+    {
+        std::lock_guard<std::mutex> lk(batch->mutex);
+        for (size_t i = batch->next; i < batch->decodeQueue.size(); ++i)
+        {
+            if (batch->decodeQueue[i])
+                unclaimed.emplace_back(batch->decodeQueue[i]);
+        }
+        batch->next = batch->decodeQueue.size();
+    }
+
+    std::unique_lock<std::recursive_mutex> lck(_threadMutex);
+    for (auto cache : unclaimed)
+    {
+        // a file played meanwhile still has to load
+        if (_isCacheInUse(cache))
+        {
+            _launchReadDataTask(cache);
+            continue;
+        }
+
+        cache->setSkipReadDataTask(true);
+        for (auto&& item : batch->items)
+        {
+            if (item.cache == cache)
+            {
+                item.cache = nullptr;
+                item.done  = true;
+                ++batch->progress.failed;
+            }
+        }
+        for (auto cacheIt = _audioCaches.begin(); cacheIt != _audioCaches.end(); ++cacheIt)
+        {
+            if (cacheIt->second.get() == cache)
+            {
+                _audioCaches.erase(cacheIt);
+                break;
+            }
+        }
+    }
+    lck.unlock();
+
+    batch->progress.cancelled = true;
+    _notifyBatch(batch);
+}
+
+void AudioEngineImpl::_onBatchItemDone(const std::shared_ptr<PreloadBatch>& batch, size_t index, bool succeed)
+{
+    auto& item = batch->items[index];
+    if (batch->progress.cancelled || item.done)
+        return;
+
+    item.done = true;
+    if (succeed)
+        ++batch->progress.loaded;
+    else
+        ++batch->progress.failed;
+    _notifyBatch(batch);
+}
+
+void AudioEngineImpl::_notifyBatch(const std::shared_ptr<PreloadBatch>& batch)
+{
+    if (batch->deferred)
+        return;
+    if (batch->progress.isFinished())
+        _preloadBatches.erase(batch->id);
+    if (batch->callback)
+        batch->callback(batch->progress);
+}
+
+void AudioEngineImpl::_detachFromBatches(const AudioCache* cache)
+{
+    std::vector<std::shared_ptr<PreloadBatch>> changed;
+    for (auto&& entry : _preloadBatches)
+    {
+        auto& batch = entry.second;
+        {
+            std::lock_guard<std::mutex> lk(batch->mutex);
+            for (size_t i = batch->next; i < batch->decodeQueue.size(); ++i)
+            {
+                if (batch->decodeQueue[i] == cache)
+                {
+                    batch->decodeQueue[i] = nullptr;
+                    const_cast<AudioCache*>(cache)->setSkipReadDataTask(true);
+                }
+            }
+        }
+
+        bool isChanged = false;
+        for (auto&& item : batch->items)
+        {
+            if (item.cache == cache && !item.done)
+            {
+                item.done = true;
+                ++batch->progress.failed;
+                isChanged = true;
+            }
+        }
+        if (isChanged)
+            changed.emplace_back(batch);
+    }
+
+    for (auto&& batch : changed)
+        _notifyBatch(batch);
+}
+
+AUDIO_ID AudioEngineImpl::play2d(std::string_view filePath,
+                                 bool loop,
+                                 float volume,
+                                 float time,
+                                 const AudioProfile* profile)
 {
     if (s_ALDevice == nullptr)
     {
@@ -548,9 +816,15 @@ AUDIO_ID AudioEngineImpl::play2d(std::string_view filePath, bool loop, float vol
         return AudioEngine::INVALID_AUDIO_ID;
     }
 
-    player->_alSource = alSource;
-    player->_loop     = loop;
-    player->_volume   = volume;
+    player->_alSource      = alSource;
+    player->_loop          = loop;
+    player->_volume        = volume;
+    player->_streamService = _streamService.get();
+    if (profile)
+    {
+        player->_streamBufferTime  = profile->streamBufferTime;
+        player->_streamBufferCount = profile->streamBufferCount;
+    }
     if (time > 0.0f)
     {
         player->_currTime  = time;
@@ -871,8 +1145,16 @@ void AudioEngineImpl::setFinishCallback(AUDIO_ID audioID,
 
 void AudioEngineImpl::update(float /*dt*/)
 {
+    _streamService->update();
+
     std::unique_lock<std::recursive_mutex> lck(_threadMutex);
     _updatePlayers(false);
+    enforceCacheBudget(nullptr);
+}
+
+AudioStreamStats AudioEngineImpl::getStreamStats() const
+{
+    return _streamService ? _streamService->getStats() : AudioStreamStats{};
 }
 
 void AudioEngineImpl::_updatePlayers(bool forStop)
@@ -956,8 +1238,98 @@ void AudioEngineImpl::_unscheduleUpdate()
     }
 }
 
+bool AudioEngineImpl::_isCacheInUse(const AudioCache* cache) const
+{
+    for (auto&& player : _audioPlayers)
+    {
+        if (player.second->_audioCache == cache)
+            return true;
+    }
+    return false;
+}
+
+bool AudioEngineImpl::_isCacheInBatch(const AudioCache* cache) const
+{
+    // finished batches are removed by _notifyBatch
+    for (auto&& entry : _preloadBatches)
+    {
+        for (auto&& item : entry.second->items)
+        {
+            if (item.cache == cache)
+                return true;
+        }
+    }
+    return false;
+}
+
+size_t AudioEngineImpl::getCacheMemoryUsage()
+{
+    size_t usage = 0;
+    for (auto&& item : _audioCaches)
+        usage += item.second->_memoryBytes;
+    return usage;
+}
+
+std::vector<AudioCacheInfo> AudioEngineImpl::getCacheInfos()
+{
+    std::unique_lock<std::recursive_mutex> lck(_threadMutex);
+    std::vector<AudioCacheInfo> infos;
+    infos.reserve(_audioCaches.size());
+    for (auto&& item : _audioCaches)
+    {
+        auto cache = item.second.get();
+        AudioCacheInfo info;
+        info.filePath = item.first;
+        info.memoryBytes = cache->_memoryBytes;
+        if (cache->_isLoadingFinished)
+        {
+            info.duration      = cache->_duration;
+            info.streaming     = cache->_queBufferFrames > 0;
+            info.fromDiskCache = cache->_isFromDiskCache;
+        }
+        info.inUse = _isCacheInUse(cache);
+        infos.emplace_back(std::move(info));
+    }
+    return infos;
+}
+
+void AudioEngineImpl::enforceCacheBudget(const AudioCache* keep)
+{
+    const size_t budget = AudioEngine::_cacheBudget;
+    if (budget == 0)
+        return;
+
+    std::unique_lock<std::recursive_mutex> lck(_threadMutex);
+    size_t usage = getCacheMemoryUsage();
+    while (usage > budget)
+    {
+        // least recently used cache which has finished loading, isn't played and isn't held by a preload batch
+        auto victim = _audioCaches.end();
+        for (auto it = _audioCaches.begin(); it != _audioCaches.end(); ++it)
+        {
+            auto cache = it->second.get();
+            if (cache == keep || !cache->_isLoadingFinished || cache->_memoryBytes == 0 || _isCacheInUse(cache) ||
+                _isCacheInBatch(cache))
+                continue;
+            if (victim == _audioCaches.end() || cache->_lastUsed < victim->second->_lastUsed)
+                victim = it;
+        }
+        if (victim == _audioCaches.end())
+            break;
+
+        ALOGV("Evict audio cache %s, %u bytes", victim->first.c_str(), victim->second->_memoryBytes.load());
+        usage -= victim->second->_memoryBytes;
+        _audioCaches.erase(victim);
+    }
+}
+
 void AudioEngineImpl::uncache(std::string_view filePath)
 {
+    auto it = _audioCaches.find(filePath);
+    if (it == _audioCaches.end())
+        return;
+
+    _detachFromBatches(it->second.get());
     _audioCaches.erase(filePath);
 }
 
@@ -967,6 +1339,21 @@ void AudioEngineImpl::uncacheAll()
     for (auto&& player : _audioPlayers)
         player.second->setCache(nullptr);
 
+    // cancel all batches silently, the caches they haven't claimed yet mustn't wait for their decoding jobs
+    for (auto&& entry : _preloadBatches)
+    {
+        auto& batch = entry.second;
+        std::lock_guard<std::mutex> lk(batch->mutex);
+        for (size_t i = batch->next; i < batch->decodeQueue.size(); ++i)
+        {
+            if (batch->decodeQueue[i])
+                batch->decodeQueue[i]->setSkipReadDataTask(true);
+        }
+        batch->next               = batch->decodeQueue.size();
+        batch->progress.cancelled = true;
+    }
+    _preloadBatches.clear();
+
     _audioCaches.clear();
 }
 NS_AX_END
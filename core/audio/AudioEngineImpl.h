@@ -37,6 +37,8 @@
 #    include "audio/AudioMacros.h"
 #    include "audio/AudioCache.h"
 #    include "audio/AudioPlayer.h"
+#    include "audio/AudioMixer.h"
+#    include "audio/AudioStreamService.h"
 
 NS_AX_BEGIN
 
@@ -49,7 +51,11 @@ public:
     ~AudioEngineImpl();
 
     bool init();
-    AUDIO_ID play2d(std::string_view fileFullPath, bool loop, float volume, float time);
+    AUDIO_ID play2d(std::string_view fileFullPath,
+                    bool loop,
+                    float volume,
+                    float time,
+                    const AudioProfile* profile = nullptr);
     void setVolume(AUDIO_ID audioID, float volume);
     void setLoop(AUDIO_ID audioID, bool loop);
     bool pause(AUDIO_ID audioID);
@@ -64,13 +70,62 @@ public:
     void uncache(std::string_view filePath);
     void uncacheAll();
     AudioCache* preload(std::string_view filePath, std::function<void(bool)> callback);
+    int preloadBatch(const std::vector<std::string>& filePaths,
+                     std::function<void(const AudioPreloadProgress&)> callback);
+    void cancelPreloadBatch(int batchID);
     void update(float dt);
 
+    /** Gets the software mixer streaming to its own OpenAL source, it's started on first use. */
+    AudioMixer* getMixer();
+
+    AudioStreamStats getStreamStats() const;
+
+    size_t getCacheMemoryUsage();
+    std::vector<AudioCacheInfo> getCacheInfos();
+    /** Uncaches the least recently used idle caches until the budget of AudioEngine is met, except keep. */
+    void enforceCacheBudget(const AudioCache* keep);
+
 private:
+    struct PreloadBatch
+    {
+        struct Item
+        {
+            std::string filePath;
+            AudioCache* cache;
+            bool done;
+        };
+
+        int id;
+        std::vector<Item> items;
+        AudioPreloadProgress progress;
+        std::function<void(const AudioPreloadProgress&)> callback;
+        // set while preloadBatch runs, the progress made meanwhile is reported on the next tick
+        bool deferred = false;
+
+        // caches created by the batch, claimed in order by the decoding jobs
+        std::mutex mutex;
+        std::vector<AudioCache*> decodeQueue;
+        size_t next = 0;
+
+        // runs on a JobSystem worker until the queue is empty
+        void decode();
+    };
+
+    // creates the cache of a file without loading it
+    AudioCache* _createCache(std::string_view filePath);
+    void _launchReadDataTask(AudioCache* cache);
+    void _onBatchItemDone(const std::shared_ptr<PreloadBatch>& batch, size_t index, bool succeed);
+    void _notifyBatch(const std::shared_ptr<PreloadBatch>& batch);
+    // removes a cache about to be destroyed from the batches, its pending items count as failed
+    void _detachFromBatches(const AudioCache* cache);
+
     // query players state per frame and dispatch finish callback if possible
     void _updatePlayers(bool forStop);
     void _play2d(AudioCache* cache, AUDIO_ID audioID);
     void _unscheduleUpdate();
+    bool _isCacheInUse(const AudioCache* cache) const;
+    // whether an unfinished preload batch holds the cache in its items
+    bool _isCacheInBatch(const AudioCache* cache) const;
     ALuint findValidSource();
 #if defined(__APPLE__) && !AX_USE_ALSOFT
     static ALvoid myAlSourceNotificationCallback(ALuint sid, ALuint notificationID, ALvoid* userData);
@@ -82,6 +137,10 @@ private:
 
     // filePath,bufferInfo
     hlookup::string_map<std::unique_ptr<AudioCache>> _audioCaches;
+    uint64_t _cacheUseCounter;
+
+    std::unordered_map<int, std::shared_ptr<PreloadBatch>> _preloadBatches;
+    int _currentBatchID;
 
     // audioID,AudioInfo
     std::unordered_map<AUDIO_ID, AudioPlayer*> _audioPlayers;
@@ -94,6 +153,11 @@ private:
 
     AUDIO_ID _currentAudioID;
     Scheduler* _scheduler;
+
+    std::unique_ptr<AudioMixer> _mixer;
+
+    // refills the buffers of all streaming players
+    std::unique_ptr<AudioStreamService> _streamService;
 };
 
 NS_AX_END
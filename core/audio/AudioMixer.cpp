@@ -0,0 +1,735 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#define LOG_TAG "AudioMixer"
+
+#include "audio/AudioMixer.h"
+#include "audio/AudioMacros.h"
+#include "audio/AudioDecoderManager.h"
+#include "audio/AudioDecoder.h"
+#include "base/Macros.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <chrono>
+
+#if defined(AX_USE_SSE)
+#    include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define AX_MIXER_NEON 1
+#endif
+
+NS_AX_BEGIN
+
+namespace
+{
+const uint64_t FIXED_ONE        = 1ull << 32;
+const float FIXED_TO_FLOAT      = 1.0f / 4294967296.0f;
+const int COMMAND_QUEUE_SIZE    = 1024;
+const int FINISHED_QUEUE_SIZE   = AudioMixer::MAX_VOICES * 4;
+
+// out[2i + c] += src[i] * (g_c + d_c * i)
+void mixMono(float* out, const float* src, uint32_t frames, float gl, float gr, float dl, float dr)
+{
+    uint32_t i = 0;
+#if defined(AX_USE_SSE)
+    __m128 g0  = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+    __m128 g1  = _mm_add_ps(g0, _mm_setr_ps(2 * dl, 2 * dr, 2 * dl, 2 * dr));
+    __m128 inc = _mm_setr_ps(4 * dl, 4 * dr, 4 * dl, 4 * dr);
+    for (; i + 4 <= frames; i += 4)
+    {
+        __m128 s  = _mm_loadu_ps(src + i);
+        __m128 lo = _mm_unpacklo_ps(s, s);
+        __m128 hi = _mm_unpackhi_ps(s, s);
+        _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(lo, g0)));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_add_ps(_mm_loadu_ps(out + 2 * i + 4), _mm_mul_ps(hi, g1)));
+        g0 = _mm_add_ps(g0, inc);
+        g1 = _mm_add_ps(g1, inc);
+    }
+#elif defined(AX_MIXER_NEON)
+    const float g0s[4] = {gl, gr, gl + dl, gr + dr};
+    const float incs[4] = {2 * dl, 2 * dr, 2 * dl, 2 * dr};
+    float32x4_t g0  = vld1q_f32(g0s);
+    float32x4_t inc = vld1q_f32(incs);
+    float32x4_t g1  = vaddq_f32(g0, inc);
+    inc             = vaddq_f32(inc, inc);
+    for (; i + 4 <= frames; i += 4)
+    {
+        float32x4x2_t s = vzipq_f32(vld1q_f32(src + i), vld1q_f32(src + i));
+        vst1q_f32(out + 2 * i, vmlaq_f32(vld1q_f32(out + 2 * i), s.val[0], g0));
+        vst1q_f32(out + 2 * i + 4, vmlaq_f32(vld1q_f32(out + 2 * i + 4), s.val[1], g1));
+        g0 = vaddq_f32(g0, inc);
+        g1 = vaddq_f32(g1, inc);
+    }
+#endif
+    for (; i < frames; ++i)
+    {
+        out[2 * i] += src[i] * (gl + dl * i);
+        out[2 * i + 1] += src[i] * (gr + dr * i);
+    }
+}
+
+// out[2i + c] += src[2i + c] * (g_c + d_c * i)
+void mixStereo(float* out, const float* src, uint32_t frames, float gl, float gr, float dl, float dr)
+{
+    uint32_t i = 0;
+#if defined(AX_USE_SSE)
+    __m128 g   = _mm_setr_ps(gl, gr, gl + dl, gr + dr);
+    __m128 inc = _mm_setr_ps(2 * dl, 2 * dr, 2 * dl, 2 * dr);
+    for (; i + 2 <= frames; i += 2)
+    {
+        _mm_storeu_ps(out + 2 * i, _mm_add_ps(_mm_loadu_ps(out + 2 * i), _mm_mul_ps(_mm_loadu_ps(src + 2 * i), g)));
+        g = _mm_add_ps(g, inc);
+    }
+#elif defined(AX_MIXER_NEON)
+    const float gs[4]   = {gl, gr, gl + dl, gr + dr};
+    const float incs[4] = {2 * dl, 2 * dr, 2 * dl, 2 * dr};
+    float32x4_t g   = vld1q_f32(gs);
+    float32x4_t inc = vld1q_f32(incs);
+    for (; i + 2 <= frames; i += 2)
+    {
+        vst1q_f32(out + 2 * i, vmlaq_f32(vld1q_f32(out + 2 * i), vld1q_f32(src + 2 * i), g));
+        g = vaddq_f32(g, inc);
+    }
+#endif
+    for (; i < frames; ++i)
+    {
+        out[2 * i] += src[2 * i] * (gl + dl * i);
+        out[2 * i + 1] += src[2 * i + 1] * (gr + dr * i);
+    }
+}
+
+// scales by the master volume and clamps to [-1, 1]
+void applyMaster(float* samples, uint32_t count, float volume)
+{
+    uint32_t i = 0;
+#if defined(AX_USE_SSE)
+    const __m128 v  = _mm_set1_ps(volume);
+    const __m128 hi = _mm_set1_ps(1.0f);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(samples + i, _mm_max_ps(lo, _mm_min_ps(hi, _mm_mul_ps(_mm_loadu_ps(samples + i), v))));
+#elif defined(AX_MIXER_NEON)
+    const float32x4_t v  = vdupq_n_f32(volume);
+    const float32x4_t hi = vdupq_n_f32(1.0f);
+    const float32x4_t lo = vdupq_n_f32(-1.0f);
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(samples + i, vmaxq_f32(lo, vminq_f32(hi, vmulq_f32(vld1q_f32(samples + i), v))));
+#endif
+    for (; i < count; ++i)
+        samples[i] = std::max(-1.0f, std::min(1.0f, samples[i] * volume));
+}
+
+// linear interpolation from a 32.32 fixed point position, returns the frames produced,
+// less than frames only when a non looping clip reaches its end.
+uint32_t resample(float* dst, const AudioMixerClip& clip, uint64_t& position, uint64_t step, uint32_t frames, bool loop)
+{
+    const float* src      = clip.samples.data();
+    const uint32_t ch     = clip.channels;
+    const uint64_t length = static_cast<uint64_t>(clip.frames) << 32;
+    uint32_t i            = 0;
+    for (; i < frames; ++i)
+    {
+        if (position >= length)
+        {
+            if (!loop)
+                break;
+            position %= length;
+        }
+        const uint32_t index = static_cast<uint32_t>(position >> 32);
+        const uint32_t next  = index + 1 < clip.frames ? index + 1 : (loop ? 0 : index);
+        const float frac     = static_cast<float>(position & 0xffffffffull) * FIXED_TO_FLOAT;
+        for (uint32_t c = 0; c < ch; ++c)
+        {
+            const float a       = src[index * ch + c];
+            dst[i * ch + c] = a + (src[next * ch + c] - a) * frac;
+        }
+        position += step;
+    }
+    return i;
+}
+
+void computeGains(float volume, float pan, uint32_t channels, float& gl, float& gr)
+{
+    if (channels == 1)
+    {
+        // constant power pan for mono voices
+        const float angle = (std::max(-1.0f, std::min(1.0f, pan)) + 1.0f) * 0.785398163f;
+        gl                = volume * std::cos(angle);
+        gr                = volume * std::sin(angle);
+    }
+    else
+    {
+        // balance for stereo voices
+        gl = volume * std::min(1.0f, 1.0f - pan);
+        gr = volume * std::min(1.0f, 1.0f + pan);
+    }
+}
+}  // namespace
+
+// ALAudioMixerOutput
+
+bool ALAudioMixerOutput::open(uint32_t sampleRate, uint32_t framesPerBlock)
+{
+    alGetError();
+    alGenSources(1, &_source);
+    auto alError = alGetError();
+    if (alError != AL_NO_ERROR)
+    {
+        ALOGE("%s: generating mixer source failed: %x", __FUNCTION__, alError);
+        _source = 0;
+        return false;
+    }
+
+    alGenBuffers(BUFFER_COUNT, _buffers);
+    alError = alGetError();
+    if (alError != AL_NO_ERROR)
+    {
+        ALOGE("%s: generating mixer buffers failed: %x", __FUNCTION__, alError);
+        alDeleteSources(1, &_source);
+        _source = 0;
+        return false;
+    }
+
+    alSourcei(_source, AL_SOURCE_RELATIVE, AL_TRUE);
+    alSource3f(_source, AL_POSITION, 0.0f, 0.0f, 0.0f);
+    alSourcef(_source, AL_GAIN, 1.0f);
+
+    _sampleRate    = sampleRate;
+    _buffersQueued = 0;
+    _pcm.resize(framesPerBlock * 2);
+    return true;
+}
+
+void ALAudioMixerOutput::close()
+{
+    if (_source == 0)
+        return;
+
+    alSourceStop(_source);
+    alSourcei(_source, AL_BUFFER, 0);
+    alDeleteSources(1, &_source);
+    alDeleteBuffers(BUFFER_COUNT, _buffers);
+    _source        = 0;
+    _buffersQueued = 0;
+}
+
+int ALAudioMixerOutput::getWritableBlocks()
+{
+    if (_buffersQueued < BUFFER_COUNT)
+        return BUFFER_COUNT - _buffersQueued;
+
+    ALint state = AL_PLAYING;
+    alGetSourcei(_source, AL_SOURCE_STATE, &state);
+    if (state == AL_STOPPED)
+    {
+        // the mixer fell behind and the source ran dry, drop the stale buffers and refill the whole queue
+        ++_underruns;
+        alSourcei(_source, AL_BUFFER, 0);
+        _buffersQueued = 0;
+        return BUFFER_COUNT;
+    }
+
+    ALint processed = 0;
+    alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+    return processed;
+}
+
+void ALAudioMixerOutput::write(const float* stereo, uint32_t frames)
+{
+    ALuint buffer = 0;
+    if (_buffersQueued < BUFFER_COUNT)
+        buffer = _buffers[_buffersQueued++];
+    else
+        alSourceUnqueueBuffers(_source, 1, &buffer);
+
+    if (_pcm.size() < frames * 2)
+        _pcm.resize(frames * 2);
+    for (uint32_t i = 0; i < frames * 2; ++i)
+        _pcm[i] = static_cast<int16_t>(stereo[i] * 32767.0f);
+
+    alBufferData(buffer, AL_FORMAT_STEREO16, _pcm.data(), static_cast<ALsizei>(frames * 2 * sizeof(int16_t)),
+                 static_cast<ALsizei>(_sampleRate));
+    alSourceQueueBuffers(_source, 1, &buffer);
+
+    // start once the whole queue is filled, at startup and after an underrun
+    if (_buffersQueued == BUFFER_COUNT)
+    {
+        ALint state = AL_PLAYING;
+        alGetSourcei(_source, AL_SOURCE_STATE, &state);
+        if (state != AL_PLAYING)
+            alSourcePlay(_source);
+    }
+}
+
+uint32_t ALAudioMixerOutput::getFramesUntilWritable(uint32_t framesPerBlock)
+{
+    if (getWritableBlocks() > 0)
+        return 0;
+
+    // all buffers hold a block, so the offset into the queue gives the position in the block playing
+    ALint offset = 0;
+    alGetSourcei(_source, AL_SAMPLE_OFFSET, &offset);
+    return framesPerBlock - static_cast<uint32_t>(offset) % framesPerBlock;
+}
+
+// NullAudioMixerOutput
+
+void NullAudioMixerOutput::write(const float* stereo, uint32_t frames)
+{
+    float peak = _peak;
+    for (uint32_t i = 0; i < frames * 2; ++i)
+        peak = std::max(peak, std::abs(stereo[i]));
+    _peak = peak;
+    _framesWritten += frames;
+}
+
+// AudioMixer
+
+std::shared_ptr<AudioMixerClip> AudioMixer::loadClip(std::string_view fullPath)
+{
+    std::shared_ptr<AudioMixerClip> clip;
+
+    AudioDecoder* decoder = AudioDecoderManager::createDecoder(fullPath);
+    do
+    {
+        if (decoder == nullptr || !decoder->open(fullPath))
+            break;
+
+        const auto format     = decoder->getSourceFormat();
+        const uint32_t frames = decoder->getTotalFrames();
+        const uint32_t ch     = decoder->getChannelCount();
+        if (frames == 0 || ch == 0 || ch > 2)
+            break;
+        if (format != AUDIO_SOURCE_FORMAT::PCM_16 && format != AUDIO_SOURCE_FORMAT::PCM_U8 &&
+            format != AUDIO_SOURCE_FORMAT::PCM_FLT32)
+        {
+            ALOGW("%s: unsupported source format %d of %s", __FUNCTION__, (int)format, fullPath.data());
+            break;
+        }
+
+        std::vector<char> pcm(decoder->framesToBytes(frames));
+        uint32_t framesRead = 0;
+        while (framesRead < frames)
+        {
+            auto n = decoder->read(frames - framesRead, pcm.data() + decoder->framesToBytes(framesRead));
+            if (n == 0)
+                break;
+            framesRead += n;
+        }
+        if (framesRead == 0)
+            break;
+
+        clip             = std::make_shared<AudioMixerClip>();
+        clip->frames     = framesRead;
+        clip->sampleRate = decoder->getSampleRate();
+        clip->channels   = ch;
+        clip->samples.resize(static_cast<size_t>(framesRead) * ch);
+
+        const size_t count = clip->samples.size();
+        float* dst         = clip->samples.data();
+        switch (format)
+        {
+        case AUDIO_SOURCE_FORMAT::PCM_16:
+        {
+            auto src = reinterpret_cast<const int16_t*>(pcm.data());
+            for (size_t i = 0; i < count; ++i)
+                dst[i] = src[i] * (1.0f / 32768.0f);
+            break;
+        }
+        case AUDIO_SOURCE_FORMAT::PCM_U8:
+        {
+            auto src = reinterpret_cast<const uint8_t*>(pcm.data());
+            for (size_t i = 0; i < count; ++i)
+                dst[i] = (src[i] - 128) * (1.0f / 128.0f);
+            break;
+        }
+        default:
+            memcpy(dst, pcm.data(), count * sizeof(float));
+            break;
+        }
+    } while (false);
+
+    if (decoder)
+        AudioDecoderManager::destroyDecoder(decoder);
+
+    return clip;
+}
+
+AudioMixer::AudioMixer(std::unique_ptr<AudioMixerOutput> output, uint32_t sampleRate, uint32_t framesPerBlock)
+    : _output(std::move(output))
+    , _sampleRate(sampleRate)
+    , _framesPerBlock(framesPerBlock)
+    , _commands(COMMAND_QUEUE_SIZE)
+    , _finished(FINISHED_QUEUE_SIZE)
+{
+    _freeSlots.reserve(MAX_VOICES);
+    for (int i = MAX_VOICES - 1; i >= 0; --i)
+        _freeSlots.push_back(i);
+
+    _mixBuffer.resize(framesPerBlock * 2);
+    _scratch.resize(framesPerBlock * 2);
+}
+
+AudioMixer::~AudioMixer()
+{
+    stop();
+}
+
+bool AudioMixer::start()
+{
+    if (_running)
+        return true;
+
+    if (!_output || !_output->open(_sampleRate, _framesPerBlock))
+        return false;
+
+    _running = true;
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+    _thread = std::thread(&AudioMixer::threadLoop, this);
+#endif
+    return true;
+}
+
+void AudioMixer::stop()
+{
+    if (!_running)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lck(_threadMutex);
+        _running = false;
+    }
+    _threadCondition.notify_all();
+    if (_thread.joinable())
+        _thread.join();
+    _output->close();
+}
+
+bool AudioMixer::postCommand(const Command& cmd)
+{
+    if (_commands.try_enqueue(cmd))
+        return true;
+
+    ++_droppedCommands;
+    ALOGW("%s: command queue is full, command %d dropped", __FUNCTION__, (int)cmd.type);
+    return false;
+}
+
+AudioMixer::VOICE_ID AudioMixer::play(std::shared_ptr<AudioMixerClip> clip, float volume, bool loop, float pitch, float pan)
+{
+    if (!clip || clip->frames == 0 || _freeSlots.empty())
+        return INVALID_VOICE;
+
+    const int slot = _freeSlots.back();
+    const VOICE_ID voice = static_cast<VOICE_ID>(((++_generations[slot] & 0x7fffff) << 8) | slot);
+
+    Command cmd{Command::Type::PLAY, voice, clip.get(), volume, pan, pitch, loop};
+    if (!postCommand(cmd))
+        return INVALID_VOICE;
+
+    _freeSlots.pop_back();
+    _clips[slot] = std::move(clip);
+    return voice;
+}
+
+void AudioMixer::stop(VOICE_ID voice)
+{
+    if (voice != INVALID_VOICE)
+        postCommand(Command{Command::Type::STOP, voice, nullptr, 0.0f, 0.0f, 0.0f, false});
+}
+
+void AudioMixer::stopAll()
+{
+    postCommand(Command{Command::Type::STOP_ALL, INVALID_VOICE, nullptr, 0.0f, 0.0f, 0.0f, false});
+}
+
+void AudioMixer::setVolume(VOICE_ID voice, float volume)
+{
+    if (voice != INVALID_VOICE)
+        postCommand(Command{Command::Type::VOLUME, voice, nullptr, volume, 0.0f, 0.0f, false});
+}
+
+void AudioMixer::setPitch(VOICE_ID voice, float pitch)
+{
+    if (voice != INVALID_VOICE)
+        postCommand(Command{Command::Type::PITCH, voice, nullptr, 0.0f, 0.0f, pitch, false});
+}
+
+void AudioMixer::setPan(VOICE_ID voice, float pan)
+{
+    if (voice != INVALID_VOICE)
+        postCommand(Command{Command::Type::PAN, voice, nullptr, 0.0f, pan, 0.0f, false});
+}
+
+void AudioMixer::setLoop(VOICE_ID voice, bool loop)
+{
+    if (voice != INVALID_VOICE)
+        postCommand(Command{Command::Type::LOOP, voice, nullptr, 0.0f, 0.0f, 0.0f, loop});
+}
+
+void AudioMixer::setPaused(VOICE_ID voice, bool paused)
+{
+    if (voice != INVALID_VOICE)
+        postCommand(Command{Command::Type::PAUSE, voice, nullptr, 0.0f, 0.0f, 0.0f, paused});
+}
+
+void AudioMixer::setFinishCallback(VOICE_ID voice, std::function<void(VOICE_ID)> callback)
+{
+    if (voice == INVALID_VOICE)
+        return;
+    if (callback)
+        _finishCallbacks[voice] = std::move(callback);
+    else
+        _finishCallbacks.erase(voice);
+}
+
+void AudioMixer::setMasterVolume(float volume)
+{
+    postCommand(Command{Command::Type::MASTER_VOLUME, INVALID_VOICE, nullptr, volume, 0.0f, 0.0f, false});
+}
+
+void AudioMixer::update()
+{
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    if (_running)
+        pump();
+#endif
+
+    VOICE_ID voice;
+    while (_finished.try_dequeue(voice))
+    {
+        const int slot = slotOf(voice);
+        _clips[slot].reset();
+        _freeSlots.push_back(slot);
+
+        auto it = _finishCallbacks.find(voice);
+        if (it != _finishCallbacks.end())
+        {
+            auto callback = std::move(it->second);
+            _finishCallbacks.erase(it);
+            callback(voice);
+        }
+    }
+}
+
+void AudioMixer::updateStep(Voice& voice, float pitch)
+{
+    const double ratio = static_cast<double>(voice.clip->sampleRate) / _sampleRate * std::max(0.01f, pitch);
+    voice.step         = static_cast<uint64_t>(ratio * FIXED_ONE);
+}
+
+void AudioMixer::applyCommands()
+{
+    Command cmd;
+    while (_commands.try_dequeue(cmd))
+    {
+        if (cmd.type == Command::Type::STOP_ALL)
+        {
+            for (auto& voice : _voices)
+                if (voice.active)
+                    finishVoice(voice);
+            continue;
+        }
+        if (cmd.type == Command::Type::MASTER_VOLUME)
+        {
+            _masterVolume = cmd.value;
+            continue;
+        }
+
+        Voice& voice = _voices[slotOf(cmd.voice)];
+        if (cmd.type == Command::Type::PLAY)
+        {
+            voice.id       = cmd.voice;
+            voice.clip     = cmd.clip;
+            voice.position = 0;
+            voice.volume   = cmd.value;
+            voice.pan      = cmd.pan;
+            voice.loop     = cmd.loop;
+            voice.paused   = false;
+            voice.active   = true;
+            updateStep(voice, cmd.pitch);
+            computeGains(voice.volume, voice.pan, voice.clip->channels, voice.gainL, voice.gainR);
+            _activeVoices.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        // the voice may have finished already, or its slot reused by a newer voice
+        if (!voice.active || voice.id != cmd.voice)
+            continue;
+
+        switch (cmd.type)
+        {
+        case Command::Type::STOP:
+            finishVoice(voice);
+            break;
+        case Command::Type::VOLUME:
+            voice.volume = cmd.value;
+            break;
+        case Command::Type::PITCH:
+            updateStep(voice, cmd.pitch);
+            break;
+        case Command::Type::PAN:
+            voice.pan = cmd.pan;
+            break;
+        case Command::Type::LOOP:
+            voice.loop = cmd.loop;
+            break;
+        case Command::Type::PAUSE:
+            voice.paused = cmd.loop;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void AudioMixer::finishVoice(Voice& voice)
+{
+    voice.active = false;
+    voice.clip   = nullptr;
+    _activeVoices.fetch_sub(1, std::memory_order_relaxed);
+    if (!_finished.try_enqueue(voice.id))
+        ALOGE("%s: finished queue is full, voice %d leaked", __FUNCTION__, voice.id);
+}
+
+void AudioMixer::mixVoice(Voice& voice, float* out, uint32_t frames)
+{
+    const AudioMixerClip& clip = *voice.clip;
+    const uint32_t ch          = clip.channels;
+
+    // ramp the gains over the block so volume and pan changes don't click
+    float targetL, targetR;
+    computeGains(voice.volume, voice.pan, ch, targetL, targetR);
+    const float dl = (targetL - voice.gainL) / frames;
+    const float dr = (targetR - voice.gainR) / frames;
+    float gl       = voice.gainL;
+    float gr       = voice.gainR;
+
+    const uint64_t length = static_cast<uint64_t>(clip.frames) << 32;
+    uint32_t done         = 0;
+    while (done < frames)
+    {
+        if (voice.position >= length)
+        {
+            if (!voice.loop)
+            {
+                finishVoice(voice);
+                return;
+            }
+            voice.position %= length;
+        }
+
+        uint32_t n       = frames - done;
+        const float* src = nullptr;
+        if (voice.step == FIXED_ONE)
+        {
+            // same rate, mix straight from the clip
+            const uint32_t index = static_cast<uint32_t>(voice.position >> 32);
+            n                    = std::min(n, clip.frames - index);
+            src                  = clip.samples.data() + static_cast<size_t>(index) * ch;
+            voice.position += static_cast<uint64_t>(n) << 32;
+        }
+        else
+        {
+            n   = resample(_scratch.data(), clip, voice.position, voice.step, n, voice.loop);
+            src = _scratch.data();
+            if (n == 0)
+                continue;
+        }
+
+        if (ch == 1)
+            mixMono(out + done * 2, src, n, gl, gr, dl, dr);
+        else
+            mixStereo(out + done * 2, src, n, gl, gr, dl, dr);
+        gl += dl * n;
+        gr += dr * n;
+        done += n;
+    }
+
+    voice.gainL = targetL;
+    voice.gainR = targetR;
+}
+
+void AudioMixer::render(float* out, uint32_t frames)
+{
+    applyCommands();
+
+    if (_scratch.size() < frames * 2)
+        _scratch.resize(frames * 2);
+    memset(out, 0, frames * 2 * sizeof(float));
+
+    for (auto& voice : _voices)
+    {
+        if (voice.active && !voice.paused)
+            mixVoice(voice, out, frames);
+    }
+
+    applyMaster(out, frames * 2, _masterVolume);
+    _mixedFrames.fetch_add(frames, std::memory_order_relaxed);
+}
+
+void AudioMixer::renderOffline(uint64_t frames)
+{
+    AXASSERT(!_running, "AudioMixer::renderOffline can't be used while the mixer is running");
+    while (frames > 0)
+    {
+        const uint32_t n = static_cast<uint32_t>(std::min<uint64_t>(frames, _framesPerBlock));
+        render(_mixBuffer.data(), n);
+        _output->write(_mixBuffer.data(), n);
+        frames -= n;
+    }
+}
+
+void AudioMixer::pump()
+{
+    int blocks = _output->getWritableBlocks();
+    while (blocks-- > 0)
+    {
+        render(_mixBuffer.data(), _framesPerBlock);
+        _output->write(_mixBuffer.data(), _framesPerBlock);
+    }
+}
+
+void AudioMixer::threadLoop()
+{
+    std::unique_lock<std::mutex> lck(_threadMutex);
+    while (_running)
+    {
+        lck.unlock();
+        pump();
+        const auto frames = _output->getFramesUntilWritable(_framesPerBlock);
+        lck.lock();
+
+        // sleep until the output consumed a block, the rest of its queue keeps playing meanwhile;
+        // stop() wakes the thread at once
+        if (frames > 0)
+            _threadCondition.wait_for(lck, std::chrono::microseconds(1000000ull * frames / _sampleRate),
+                                      [this] { return !_running; });
+    }
+}
+
+NS_AX_END
@@ -0,0 +1,278 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "platform/PlatformConfig.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+
+#include "platform/PlatformMacros.h"
+#include "audio/alconfig.h"
+#include "concurrentqueue/concurrentqueue.h"
+
+NS_AX_BEGIN
+
+/**
+ * Decoded PCM of a sound, converted to 32 bits float and interleaved by channel (mono or stereo).
+ */
+struct AudioMixerClip
+{
+    std::vector<float> samples;
+    uint32_t frames     = 0;
+    uint32_t sampleRate = 0;
+    uint32_t channels   = 0;
+};
+
+/**
+ * The device the mixer writes its interleaved stereo float blocks to.
+ * All methods except open and close are called from the mixing thread.
+ */
+class AX_DLL AudioMixerOutput
+{
+public:
+    virtual ~AudioMixerOutput() {}
+
+    virtual bool open(uint32_t sampleRate, uint32_t framesPerBlock) = 0;
+    virtual void close() = 0;
+
+    /** Returns how many blocks the device can take without blocking. */
+    virtual int getWritableBlocks() = 0;
+
+    virtual void write(const float* stereo, uint32_t frames) = 0;
+
+    /**
+     * Returns how many frames the device plays before another block is writable, the mixing thread sleeps that
+     * long once the output is filled. The default is a whole block.
+     */
+    virtual uint32_t getFramesUntilWritable(uint32_t framesPerBlock) { return framesPerBlock; }
+};
+
+/**
+ * Streams the mix through a single OpenAL source with a small buffer queue,
+ * so the OpenAL backend (oboe/AAudio on android) only sees one voice.
+ */
+class AX_DLL ALAudioMixerOutput : public AudioMixerOutput
+{
+public:
+    static const int BUFFER_COUNT = 4;
+
+    bool open(uint32_t sampleRate, uint32_t framesPerBlock) override;
+    void close() override;
+    int getWritableBlocks() override;
+    void write(const float* stereo, uint32_t frames) override;
+    uint32_t getFramesUntilWritable(uint32_t framesPerBlock) override;
+
+    /** Gets how many times the source ran dry and had to be restarted. */
+    uint32_t getUnderrunCount() const { return _underruns; }
+
+private:
+    ALuint _source = 0;
+    ALuint _buffers[BUFFER_COUNT]{};
+    int _buffersQueued = 0;
+    uint32_t _sampleRate = 0;
+    std::atomic<uint32_t> _underruns{0};
+    std::vector<int16_t> _pcm;
+};
+
+/**
+ * Discards the mix and only counts it, used to run the mixer headless, i.e. to benchmark mixing throughput.
+ */
+class AX_DLL NullAudioMixerOutput : public AudioMixerOutput
+{
+public:
+    bool open(uint32_t sampleRate, uint32_t framesPerBlock) override { return true; }
+    void close() override {}
+    int getWritableBlocks() override { return 1; }
+    void write(const float* stereo, uint32_t frames) override;
+
+    uint64_t getFramesWritten() const { return _framesWritten; }
+
+    /** Gets the peak absolute sample written, to verify the mix isn't silent or clipping. */
+    float getPeak() const { return _peak; }
+
+private:
+    std::atomic<uint64_t> _framesWritten{0};
+    float _peak = 0.0f;
+};
+
+/**
+ * @class AudioMixer
+ * @brief Mixes a fixed pool of voices in software on one thread and writes the result to a single output.
+ *
+ * The game thread never touches voice state, play, stop and parameter changes are posted to a lock-free
+ * command queue and picked up at the start of the next block, finished voices come back through a second
+ * queue and are dispatched by update(). Unlike AudioEngine, a voice costs no OpenAL source, so hundreds of
+ * short effects can overlap.
+ */
+class AX_DLL AudioMixer
+{
+public:
+    using VOICE_ID = int;
+
+    static const int MAX_VOICES         = 128;
+    static const VOICE_ID INVALID_VOICE = -1;
+    static const uint32_t DEFAULT_BLOCK = 512;
+
+    /**
+     * Decodes a whole sound file to float PCM, returns nullptr if the file can't be decoded.
+     * It's safe to call from any thread.
+     */
+    static std::shared_ptr<AudioMixerClip> loadClip(std::string_view fullPath);
+
+    AudioMixer(std::unique_ptr<AudioMixerOutput> output,
+               uint32_t sampleRate     = 48000,
+               uint32_t framesPerBlock = DEFAULT_BLOCK);
+    ~AudioMixer();
+
+    /** Opens the output and starts the mixing thread. */
+    bool start();
+    void stop();
+    bool isRunning() const { return _running; }
+
+    VOICE_ID play(std::shared_ptr<AudioMixerClip> clip,
+                  float volume = 1.0f,
+                  bool loop    = false,
+                  float pitch  = 1.0f,
+                  float pan    = 0.0f);
+    void stop(VOICE_ID voice);
+    void stopAll();
+
+    void setVolume(VOICE_ID voice, float volume);
+    void setPitch(VOICE_ID voice, float pitch);
+    /** Sets the pan in [-1, 1], 0 is centered. */
+    void setPan(VOICE_ID voice, float pan);
+    void setLoop(VOICE_ID voice, bool loop);
+    void setPaused(VOICE_ID voice, bool paused);
+    void setFinishCallback(VOICE_ID voice, std::function<void(VOICE_ID)> callback);
+
+    void setMasterVolume(float volume);
+
+    /** Dispatches finish callbacks and releases the clips of finished voices, call it from the game thread. */
+    void update();
+
+    /**
+     * Renders frames of the mix on the calling thread straight to the output, ignoring getWritableBlocks.
+     * The mixer must not be running, it's the way to drive a NullAudioMixerOutput offline.
+     */
+    void renderOffline(uint64_t frames);
+
+    /**
+     * Mixes frames of interleaved stereo into out, only one thread may render at a time.
+     */
+    void render(float* out, uint32_t frames);
+
+    AudioMixerOutput* getOutput() const { return _output.get(); }
+    uint32_t getSampleRate() const { return _sampleRate; }
+    uint32_t getFramesPerBlock() const { return _framesPerBlock; }
+    int getActiveVoiceCount() const { return _activeVoices.load(std::memory_order_relaxed); }
+    uint64_t getMixedFrames() const { return _mixedFrames.load(std::memory_order_relaxed); }
+    /** Gets how many commands were dropped because the queue was full. */
+    uint32_t getDroppedCommandCount() const { return _droppedCommands; }
+
+private:
+    struct Command
+    {
+        enum class Type : uint8_t
+        {
+            PLAY,
+            STOP,
+            STOP_ALL,
+            VOLUME,
+            PITCH,
+            PAN,
+            LOOP,
+            PAUSE,
+            MASTER_VOLUME
+        };
+        Type type;
+        VOICE_ID voice;
+        const AudioMixerClip* clip;
+        float value;
+        float pan;
+        float pitch;
+        bool loop;
+    };
+
+    struct Voice
+    {
+        VOICE_ID id                = INVALID_VOICE;
+        const AudioMixerClip* clip = nullptr;
+        uint64_t position          = 0;  // 32.32 fixed point source frame
+        uint64_t step              = 0;
+        float volume               = 1.0f;
+        float pan                  = 0.0f;
+        float gainL                = 0.0f;  // gains reached at the end of the last block
+        float gainR                = 0.0f;
+        bool loop                  = false;
+        bool paused                = false;
+        bool active                = false;
+    };
+
+    bool postCommand(const Command& cmd);
+    void applyCommands();
+    void mixVoice(Voice& voice, float* out, uint32_t frames);
+    void finishVoice(Voice& voice);
+    void updateStep(Voice& voice, float pitch);
+    void pump();
+    void threadLoop();
+
+    static int slotOf(VOICE_ID voice) { return voice & 0xff; }
+
+    std::unique_ptr<AudioMixerOutput> _output;
+    uint32_t _sampleRate;
+    uint32_t _framesPerBlock;
+
+    // game thread state
+    std::shared_ptr<AudioMixerClip> _clips[MAX_VOICES];
+    uint32_t _generations[MAX_VOICES]{};
+    std::vector<int> _freeSlots;
+    std::unordered_map<VOICE_ID, std::function<void(VOICE_ID)>> _finishCallbacks;
+
+    // mixing thread state
+    Voice _voices[MAX_VOICES];
+    float _masterVolume = 1.0f;
+    std::vector<float> _mixBuffer;
+    std::vector<float> _scratch;
+
+    moodycamel::ConcurrentQueue<Command> _commands;
+    moodycamel::ConcurrentQueue<VOICE_ID> _finished;
+
+    std::thread _thread;
+    std::mutex _threadMutex;
+    std::condition_variable _threadCondition;
+    std::atomic<bool> _running{false};
+    std::atomic<int> _activeVoices{0};
+    std::atomic<uint64_t> _mixedFrames{0};
+    uint32_t _droppedCommands = 0;
+};
+
+NS_AX_END
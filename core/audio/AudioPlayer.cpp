@@ -33,6 +33,11 @@
 #include "platform/FileUtils.h"
 #include "audio/AudioDecoder.h"
 #include "audio/AudioDecoderManager.h"
+#include "audio/AudioStreamService.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
 
 #ifdef VERY_VERY_VERBOSE_LOGGING
 #    define ALOGVV ALOGV
@@ -48,7 +53,12 @@ NS_AX_BEGIN
 namespace
 {
 unsigned int __playerIdIndex = 0;
-}
+
+#if AX_TARGET_PLATFORM == AX_PLATFORM_IOS
+// the longest destroy waits on the game thread for the queued stream buffers to play
+const auto IOS_STREAM_DRAIN_TIMEOUT = std::chrono::milliseconds(50);
+#endif
+}  // namespace
 
 AudioPlayer::AudioPlayer()
     : _audioCache(nullptr)
@@ -58,16 +68,20 @@ AudioPlayer::AudioPlayer()
     , _ready(false)
     , _currTime(0.0f)
     , _streamingSource(false)
-    , _rotateBufferThread(nullptr)
     , _timeDirty(false)
-    , _isRotateThreadExited(false)
-#if defined(__APPLE__)
-    , _needWakeupRotateThread(false)
-#endif
+    , _isStreamFinished(false)
+    , _streamService(nullptr)
+    , _streamDecoder(nullptr)
+    , _streamFormat(0)
+    , _streamDuration(0.0f)
+    , _streamOffsetFrame(0)
+    , _streamBufferFrames(0)
+    , _streamInterval(0)
+    , _streamEOF(false)
+    , _streamBufferTime(0.0f)
+    , _streamBufferCount(0)
     , _id(++__playerIdIndex)
-{
-    memset(_bufferIds, 0, sizeof(_bufferIds));
-}
+{}
 
 AudioPlayer::~AudioPlayer()
 {
@@ -76,7 +90,7 @@ AudioPlayer::~AudioPlayer()
 
     if (_streamingSource)
     {
-        alDeleteBuffers(QUEUEBUFFER_NUM, _bufferIds);
+        alDeleteBuffers(static_cast<ALsizei>(_bufferIds.size()), _bufferIds.data());
     }
 }
 
@@ -106,45 +120,41 @@ void AudioPlayer::destroy()
             }
         }
 
-        if (_streamingSource)
+        if (_streamingSource && _streamService != nullptr)
         {
-            if (_rotateBufferThread != nullptr)
-            {
-                while (!_isRotateThreadExited)
-                {
-                    _sleepCondition.notify_one();
-                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
-                }
-
-                if (_rotateBufferThread->joinable())
-                {
-                    _rotateBufferThread->join();
-                }
-
-                delete _rotateBufferThread;
-                _rotateBufferThread = nullptr;
-                ALOGVV("rotateBufferThread exited!");
+            _streamService->removeStream(this);
+            _streamService = nullptr;
+            closeStream();
+            ALOGVV("stream removed from the stream service!");
 
 #if AX_TARGET_PLATFORM == AX_PLATFORM_IOS
-                // some specific OpenAL implement defects existed on iOS platform
-                // refer to: https://github.com/cocos2d/cocos2d-x/issues/18597
-                ALint sourceState;
-                ALint bufferProcessed = 0;
-                alGetSourcei(_alSource, AL_SOURCE_STATE, &sourceState);
-                if (sourceState == AL_PLAYING)
+            // some specific OpenAL implement defects existed on iOS platform
+            // refer to: https://github.com/cocos2d/cocos2d-x/issues/18597
+            // the queue may hold seconds of audio with a large streamBufferCount, so the wait is bounded and
+            // the buffers still queued after it are detached by alSourcei(AL_BUFFER, 0) like on other platforms
+            ALint sourceState;
+            ALint bufferProcessed = 0;
+            ALint bufferQueued    = 0;
+            alGetSourcei(_alSource, AL_SOURCE_STATE, &sourceState);
+            if (sourceState == AL_PLAYING)
+            {
+                alGetSourcei(_alSource, AL_BUFFERS_QUEUED, &bufferQueued);
+                alGetSourcei(_alSource, AL_BUFFERS_PROCESSED, &bufferProcessed);
+                const auto deadline = std::chrono::steady_clock::now() + IOS_STREAM_DRAIN_TIMEOUT;
+                while (bufferProcessed < bufferQueued && std::chrono::steady_clock::now() < deadline)
                 {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
                     alGetSourcei(_alSource, AL_BUFFERS_PROCESSED, &bufferProcessed);
-                    while (bufferProcessed < QUEUEBUFFER_NUM)
-                    {
-                        std::this_thread::sleep_for(std::chrono::milliseconds(2));
-                        alGetSourcei(_alSource, AL_BUFFERS_PROCESSED, &bufferProcessed);
-                    }
-                    alSourceUnqueueBuffers(_alSource, QUEUEBUFFER_NUM, _bufferIds);
+                }
+                if (bufferProcessed > 0)
+                {
+                    std::vector<ALuint> unqueued(bufferProcessed);
+                    alSourceUnqueueBuffers(_alSource, bufferProcessed, unqueued.data());
                     CHECK_AL_ERROR_DEBUG();
                 }
-                ALOGVV("UnqueueBuffers Before alSourceStop");
-#endif
             }
+            ALOGVV("UnqueueBuffers Before alSourceStop");
+#endif
         }
     } while (false);
 
@@ -205,7 +215,13 @@ bool AudioPlayer::play2d()
         }
         else
         {
-            alGenBuffers(QUEUEBUFFER_NUM, _bufferIds);
+            BREAK_IF_ERR_LOG(_streamService == nullptr, "AudioPlayer::play2d, no stream service!");
+
+            // the cache holds the first QUEUEBUFFER_NUM buffers, extra buffers of the profile start free
+            const auto bufferCount = std::max<unsigned int>(_streamBufferCount, QUEUEBUFFER_NUM);
+            _bufferIds.resize(bufferCount);
+            _bufferFrames.assign(bufferCount, 0);
+            alGenBuffers(static_cast<ALsizei>(bufferCount), _bufferIds.data());
 
             auto alError = alGetError();
             if (alError == AL_NO_ERROR)
@@ -214,38 +230,44 @@ bool AudioPlayer::play2d()
                 {
                     alBufferData(_bufferIds[index], _audioCache->_format, _audioCache->_queBuffers[index],
                                  _audioCache->_queBufferSize[index], _audioCache->_sampleRate);
+                    _bufferFrames[index] = _audioCache->_queBufferFrames;
                 }
                 CHECK_AL_ERROR_DEBUG();
+                _freeBuffers.assign(_bufferIds.begin() + QUEUEBUFFER_NUM, _bufferIds.end());
             }
             else
             {
                 ALOGE("%s:alGenBuffers error code:%x", __FUNCTION__, alError);
+                _bufferIds.clear();
                 break;
             }
+
+            // copy what the stream needs, the cache may be released while the stream plays
+            const float bufferTime = _streamBufferTime > 0.0f ? _streamBufferTime : QUEUEBUFFER_TIME_STEP;
+            _streamPath            = _audioCache->_fileFullPath;
+            _streamFormat          = _audioCache->_format;
+            _streamDuration        = _audioCache->_duration;
+            _streamOffsetFrame     = _audioCache->_queBufferFrames * QUEUEBUFFER_NUM + 1;
+            _streamBufferFrames    = std::max(1u, static_cast<uint32_t>(_audioCache->_sampleRate * bufferTime));
+            // refill well before the queued audio after the playing buffer runs out
+            _streamInterval = std::chrono::milliseconds(
+                std::max(5, static_cast<int>(bufferTime * 1000 * (bufferCount - 1) / 4)));
             _streamingSource = true;
         }
 
+        if (_streamingSource)
         {
-            std::unique_lock<std::mutex> lk(_sleepMutex);
-            if (_isDestroyed)
-                break;
-
-            if (_streamingSource)
-            {
-                // To continuously stream audio from a source without interruption, buffer queuing is required.
-                alSourceQueueBuffers(_alSource, QUEUEBUFFER_NUM, _bufferIds);
-                CHECK_AL_ERROR_DEBUG();
-                _rotateBufferThread = new std::thread(&AudioPlayer::rotateBufferThread, this,
-                                                      _audioCache->_queBufferFrames * QUEUEBUFFER_NUM + 1);
-            }
-            else
-            {
-                alSourcei(_alSource, AL_BUFFER, _audioCache->_alBufferId);
-                CHECK_AL_ERROR_DEBUG();
-            }
-
-            alSourcePlay(_alSource);
+            // To continuously stream audio from a source without interruption, buffer queuing is required.
+            alSourceQueueBuffers(_alSource, QUEUEBUFFER_NUM, _bufferIds.data());
+            CHECK_AL_ERROR_DEBUG();
         }
+        else
+        {
+            alSourcei(_alSource, AL_BUFFER, _audioCache->_alBufferId);
+            CHECK_AL_ERROR_DEBUG();
+        }
+
+        alSourcePlay(_alSource);
 
         auto alError = alGetError();
         if (alError != AL_NO_ERROR)
@@ -264,7 +286,11 @@ bool AudioPlayer::play2d()
         // alError, so just skip for workaround.
         assert(state == AL_PLAYING);
 
-        if (!_streamingSource && _currTime >= 0.0f)
+        if (_streamingSource)
+        {
+            _streamService->addStream(this);
+        }
+        else if (_currTime >= 0.0f)
         {
             alSourcef(_alSource, AL_SEC_OFFSET, _currTime);
             CHECK_AL_ERROR_DEBUG();
@@ -282,161 +308,157 @@ bool AudioPlayer::play2d()
     return ret;
 }
 
-// rotateBufferThread is used to rotate alBufferData for _alSource when playing big audio file
-void AudioPlayer::rotateBufferThread(int offsetFrame)
+bool AudioPlayer::openStream()
 {
-#if defined(__APPLE__)
-    pthread_setname_np("ALStreaming");
-#endif
+    _streamDecoder = AudioDecoderManager::createDecoder(_streamPath);
+    if (_streamDecoder == nullptr || !_streamDecoder->open(_streamPath))
+        return false;
 
-    char* tmpBuffer           = nullptr;
-    auto& fullPath            = _audioCache->_fileFullPath;
-    AudioDecoder* decoder     = AudioDecoderManager::createDecoder(fullPath);
-    long long rotateSleepTime = static_cast<long long>(QUEUEBUFFER_TIME_STEP * 1000) / 2;
-    do
+    _streamBuffer.resize(_streamDecoder->framesToBytes(_streamBufferFrames));
+    if (_streamOffsetFrame != 0)
+    {
+        _streamDecoder->seek(_streamOffsetFrame);
+    }
+    return true;
+}
+
+void AudioPlayer::closeStream()
+{
+    if (_streamDecoder != nullptr)
     {
-        BREAK_IF(decoder == nullptr || !decoder->open(fullPath));
+        AudioDecoderManager::destroyDecoder(_streamDecoder);
+        _streamDecoder = nullptr;
+    }
+    std::vector<char>().swap(_streamBuffer);
+}
 
-        uint32_t framesRead         = 0;
-        const uint32_t framesToRead = _audioCache->_queBufferFrames;
-        const uint32_t bufferSize   = decoder->framesToBytes(framesToRead);
+void AudioPlayer::queueBuffer(ALuint bid, const char* data, uint32_t frames)
+{
 #if AX_USE_ALSOFT
-        const auto sourceFormat = decoder->getSourceFormat();
+    const auto sourceFormat = _streamDecoder->getSourceFormat();
+    if (sourceFormat == AUDIO_SOURCE_FORMAT::ADPCM || sourceFormat == AUDIO_SOURCE_FORMAT::IMA_ADPCM)
+        alBufferi(bid, AL_UNPACK_BLOCK_ALIGNMENT_SOFT, _streamDecoder->getSamplesPerBlock());
 #endif
-        tmpBuffer = (char*)malloc(bufferSize);
-        memset(tmpBuffer, 0, bufferSize);
+    alBufferData(bid, _streamFormat, data, _streamDecoder->framesToBytes(frames), _streamDecoder->getSampleRate());
+    alSourceQueueBuffers(_alSource, 1, &bid);
 
-        if (offsetFrame != 0)
-        {
-            decoder->seek(offsetFrame);
-        }
+    auto it                                 = std::find(_bufferIds.begin(), _bufferIds.end(), bid);
+    _bufferFrames[it - _bufferIds.begin()] = frames;
+}
 
-        ALint sourceState;
-        ALint bufferProcessed = 0;
-        bool needToExitThread = false;
+std::chrono::steady_clock::time_point AudioPlayer::serviceStream(AudioStreamStats& stats)
+{
+    // Note: It's in the stream service thread
+    const auto now      = std::chrono::steady_clock::now();
+    const auto finished = std::chrono::steady_clock::time_point::max();
 
-        while (!_isDestroyed)
+    if (_isDestroyed)
+        return finished;
+
+    if (_streamDecoder == nullptr && !openStream())
+    {
+        ALOGE("AudioPlayer::serviceStream, open %s failed!", _streamPath.c_str());
+        _isStreamFinished = true;
+        return finished;
+    }
+
+    ALint sourceState;
+    alGetSourcei(_alSource, AL_SOURCE_STATE, &sourceState);
+    if (sourceState == AL_PAUSED)
+        return now + _streamInterval;
+
+    /*
+     While the source is playing, alSourceUnqueueBuffers can be called to remove buffers which have
+     already played. Those buffers can then be filled with new data or discarded. New or refilled
+     buffers can then be attached to the playing source using alSourceQueueBuffers. As long as there is
+     always a new buffer to play in the queue, the source will continue to play.
+     */
+    ALint bufferProcessed = 0;
+    alGetSourcei(_alSource, AL_BUFFERS_PROCESSED, &bufferProcessed);
+    while (bufferProcessed-- > 0)
+    {
+        ALuint bid;
+        alSourceUnqueueBuffers(_alSource, 1, &bid);
+        _freeBuffers.push_back(bid);
+
+        if (!_timeDirty)
         {
-            alGetSourcei(_alSource, AL_SOURCE_STATE, &sourceState);
-            if (sourceState == AL_PLAYING)
+            auto it = std::find(_bufferIds.begin(), _bufferIds.end(), bid);
+            _currTime += static_cast<float>(_bufferFrames[it - _bufferIds.begin()]) / _streamDecoder->getSampleRate();
+            if (_currTime > _streamDuration)
             {
-                alGetSourcei(_alSource, AL_BUFFERS_PROCESSED, &bufferProcessed);
-                while (bufferProcessed > 0)
-                {
-                    bufferProcessed--;
-                    if (_timeDirty)
-                    {
-                        _timeDirty  = false;
-                        offsetFrame = _currTime * decoder->getSampleRate();
-                        decoder->seek(offsetFrame);
-                    }
-                    else
-                    {
-                        _currTime += QUEUEBUFFER_TIME_STEP;
-                        if (_currTime > _audioCache->_duration)
-                        {
-                            if (_loop)
-                            {
-                                _currTime = 0.0f;
-                            }
-                            else
-                            {
-                                _currTime = _audioCache->_duration;
-                            }
-                        }
-                    }
-
-                    framesRead = decoder->readFixedFrames(framesToRead, tmpBuffer);
-
-                    if (framesRead == 0)
-                    {
-                        if (_loop)
-                        {
-                            decoder->seek(0);
-                            framesRead = decoder->readFixedFrames(framesToRead, tmpBuffer);
-                        }
-                        else
-                        {
-                            needToExitThread = true;
-                            break;
-                        }
-                    }
-                    /*
-                     While the source is playing, alSourceUnqueueBuffers can be called to remove buffers which have
-                     already played. Those buffers can then be filled with new data or discarded. New or refilled
-                     buffers can then be attached to the playing source using alSourceQueueBuffers. As long as there is
-                     always a new buffer to play in the queue, the source will continue to play.
-                     */
-                    ALuint bid;
-                    alSourceUnqueueBuffers(_alSource, 1, &bid);
-#if AX_USE_ALSOFT
-                    if (sourceFormat == AUDIO_SOURCE_FORMAT::ADPCM || sourceFormat == AUDIO_SOURCE_FORMAT::IMA_ADPCM)
-                        alBufferi(bid, AL_UNPACK_BLOCK_ALIGNMENT_SOFT, decoder->getSamplesPerBlock());
-#endif
-                    alBufferData(bid, _audioCache->_format, tmpBuffer, decoder->framesToBytes(framesRead),
-                                 decoder->getSampleRate());
-                    alSourceQueueBuffers(_alSource, 1, &bid);
-                }
+                _currTime = _loop ? fmodf(_currTime, _streamDuration) : _streamDuration;
             }
-            /* Make sure the source hasn't underrun */
-            else if (sourceState != AL_PAUSED)
-            {
-                ALint queued;
+        }
+    }
 
-                /* If no buffers are queued, playback is finished */
-                alGetSourcei(_alSource, AL_BUFFERS_QUEUED, &queued);
-                if (queued == 0)
-                {
-                    needToExitThread = true;
-                }
-                else
-                {
-                    alSourcePlay(_alSource);
-                    if (alGetError() != AL_NO_ERROR)
-                    {
-                        ALOGE("Error restarting playback!");
-                        needToExitThread = true;
-                    }
-                }
-            }
+    // the whole file was queued and played
+    if (sourceState != AL_PLAYING && _streamEOF && !_loop)
+    {
+        _isStreamFinished = true;
+        return finished;
+    }
 
-            std::unique_lock<std::mutex> lk(_sleepMutex);
-            if (_isDestroyed || needToExitThread)
-            {
-                break;
-            }
-#if defined(__APPLE__)
-            if (!_needWakeupRotateThread)
-            {
-                _sleepCondition.wait_for(lk, std::chrono::milliseconds(rotateSleepTime));
-            }
+    if (_timeDirty)
+    {
+        _timeDirty = false;
+        _streamEOF = false;
+        _streamDecoder->seek(static_cast<uint32_t>(_currTime * _streamDecoder->getSampleRate()));
+    }
+    else if (_streamEOF && _loop)
+    {
+        // looping was enabled after the end was reached
+        _streamEOF = false;
+        _streamDecoder->seek(0);
+    }
 
-            _needWakeupRotateThread = false;
-#else
-            _sleepCondition.wait_for(lk, std::chrono::milliseconds(rotateSleepTime));
-#endif
+    while (!_freeBuffers.empty() && !_streamEOF)
+    {
+        uint32_t framesRead = _streamDecoder->readFixedFrames(_streamBufferFrames, _streamBuffer.data());
+        if (framesRead == 0 && _loop)
+        {
+            _streamDecoder->seek(0);
+            framesRead = _streamDecoder->readFixedFrames(_streamBufferFrames, _streamBuffer.data());
+        }
+        if (framesRead == 0)
+        {
+            _streamEOF = true;
+            break;
         }
 
-    } while (false);
+        queueBuffer(_freeBuffers.back(), _streamBuffer.data(), framesRead);
+        _freeBuffers.pop_back();
+        ++stats.buffersQueued;
+    }
 
-    ALOGVV("Exit rotate buffer thread ...");
-    AudioDecoderManager::destroyDecoder(decoder);
-    free(tmpBuffer);
-    _isRotateThreadExited = true;
-}
+    /* Make sure the source hasn't underrun */
+    if (sourceState != AL_PLAYING)
+    {
+        ALint queued = 0;
+        alGetSourcei(_alSource, AL_BUFFERS_QUEUED, &queued);
+        if (queued == 0)
+        {
+            _isStreamFinished = true;
+            return finished;
+        }
 
-#if defined(__APPLE__)
-void AudioPlayer::wakeupRotateThread()
-{
-    _needWakeupRotateThread = true;
-    _sleepCondition.notify_all();
+        ++stats.underruns;
+        alSourcePlay(_alSource);
+        if (alGetError() != AL_NO_ERROR)
+        {
+            ALOGE("Error restarting playback!");
+            _isStreamFinished = true;
+            return finished;
+        }
+    }
+
+    return now + _streamInterval;
 }
-#endif
 
 bool AudioPlayer::isFinished() const
 {
     if (_streamingSource)
-        return _isRotateThreadExited;
+        return _isStreamFinished;
     else
     {
         ALint sourceState;
@@ -464,6 +486,9 @@ bool AudioPlayer::setTime(float time)
         _currTime  = time;
         _timeDirty = true;
 
+        if (_streamService != nullptr)
+            _streamService->wakeup(this);
+
         return true;
     }
     return false;
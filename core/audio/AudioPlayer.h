@@ -30,9 +30,10 @@
 #include "platform/PlatformConfig.h"
 
 #include <string>
-#include <condition_variable>
 #include <mutex>
-#include <thread>
+#include <vector>
+#include <atomic>
+#include <chrono>
 
 #include "audio/AudioMacros.h"
 #include "platform/PlatformMacros.h"
@@ -42,6 +43,9 @@ NS_AX_BEGIN
 
 class AudioCache;
 class AudioEngineImpl;
+class AudioDecoder;
+class AudioStreamService;
+struct AudioStreamStats;
 
 class AX_DLL AudioPlayer
 {
@@ -62,19 +66,23 @@ public:
 
 protected:
     void setCache(AudioCache* cache);
-    void rotateBufferThread(int offsetFrame);
     bool play2d();
-#if defined(__APPLE__)
-    void wakeupRotateThread();
-#endif
+    /**
+     * Refills the processed buffers of a streaming source, called by AudioStreamService on its thread.
+     * Returns the deadline of the next pass, or time_point::max() once the stream is finished.
+     */
+    std::chrono::steady_clock::time_point serviceStream(AudioStreamStats& stats);
+    bool openStream();
+    void closeStream();
+    void queueBuffer(ALuint bid, const char* data, uint32_t frames);
 
     AudioCache* _audioCache;
 
     float _volume;
-    bool _loop;
+    std::atomic_bool _loop;
     std::function<void(AUDIO_ID, std::string_view)> _finishCallbak;
 
-    bool _isDestroyed;
+    std::atomic_bool _isDestroyed;
     bool _removeByAudioEngine;
     bool _ready;
     ALuint _alSource;
@@ -82,20 +90,33 @@ protected:
     // play by circular buffer
     float _currTime;
     bool _streamingSource;
-    ALuint _bufferIds[QUEUEBUFFER_NUM];
-    std::thread* _rotateBufferThread;
-    std::condition_variable _sleepCondition;
-    std::mutex _sleepMutex;
-    bool _timeDirty;
-    bool _isRotateThreadExited;
-#if defined(__APPLE__)
-    std::atomic_bool _needWakeupRotateThread;
-#endif
+    std::vector<ALuint> _bufferIds;
+    std::vector<uint32_t> _bufferFrames;  // frames held by each buffer of _bufferIds
+    std::vector<ALuint> _freeBuffers;
+    std::atomic_bool _timeDirty;
+    std::atomic_bool _isStreamFinished;
+
+    // streaming state, only touched by the stream service once play2d queued the first buffers
+    AudioStreamService* _streamService;
+    AudioDecoder* _streamDecoder;
+    std::vector<char> _streamBuffer;
+    std::string _streamPath;
+    ALenum _streamFormat;
+    float _streamDuration;
+    uint32_t _streamOffsetFrame;
+    uint32_t _streamBufferFrames;
+    std::chrono::milliseconds _streamInterval;
+    bool _streamEOF;
+
+    // buffer settings of the profile the player was created with, 0 for the defaults
+    float _streamBufferTime;
+    unsigned int _streamBufferCount;
 
     std::mutex _play2dMutex;
 
     unsigned int _id;
     friend class AudioEngineImpl;
+    friend class AudioStreamService;
 };
 
 NS_AX_END
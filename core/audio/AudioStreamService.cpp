@@ -0,0 +1,169 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#define LOG_TAG "AudioStreamService"
+
+#include "audio/AudioStreamService.h"
+#include "audio/AudioPlayer.h"
+
+#include <algorithm>
+
+NS_AX_BEGIN
+
+AudioStreamService::AudioStreamService()
+{
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+    _thread = std::thread(&AudioStreamService::threadLoop, this);
+#endif
+}
+
+AudioStreamService::~AudioStreamService()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        _stop = true;
+        _condition.notify_all();
+    }
+    if (_thread.joinable())
+        _thread.join();
+}
+
+void AudioStreamService::addStream(AudioPlayer* player)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    _streams.emplace_back(Stream{player, clock::now()});
+    _stats.activeStreams = static_cast<unsigned int>(_streams.size());
+    _condition.notify_one();
+}
+
+void AudioStreamService::removeStream(AudioPlayer* player)
+{
+    std::unique_lock<std::mutex> lk(_mutex);
+    auto it = std::find_if(_streams.begin(), _streams.end(), [player](const Stream& s) { return s.player == player; });
+    if (it != _streams.end())
+        _streams.erase(it);
+    _stats.activeStreams = static_cast<unsigned int>(_streams.size());
+
+    _idleCondition.wait(lk, [this, player]() { return _busy != player; });
+}
+
+void AudioStreamService::wakeup(AudioPlayer* player)
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    for (auto& stream : _streams)
+    {
+        if (stream.player == player)
+        {
+            stream.deadline = clock::now();
+            _condition.notify_one();
+            break;
+        }
+    }
+}
+
+AudioStreamStats AudioStreamService::getStats() const
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _stats;
+}
+
+bool AudioStreamService::serviceNext(std::unique_lock<std::mutex>& lk, clock::time_point& nextDeadline)
+{
+    if (_streams.empty())
+    {
+        nextDeadline = clock::time_point::max();
+        return false;
+    }
+
+    auto it = std::min_element(_streams.begin(), _streams.end(),
+                               [](const Stream& a, const Stream& b) { return a.deadline < b.deadline; });
+    const auto now = clock::now();
+    if (it->deadline > now)
+    {
+        nextDeadline = it->deadline;
+        return false;
+    }
+
+    AudioPlayer* player = it->player;
+    const float lateMs  = std::chrono::duration<float, std::milli>(now - it->deadline).count();
+    _stats.maxLatenessMs = std::max(_stats.maxLatenessMs, lateMs);
+    ++_stats.wakeups;
+    _busy = player;
+
+    // decode without the lock so the game thread can add, remove and wake streams meanwhile
+    lk.unlock();
+    AudioStreamStats delta;
+    auto deadline = player->serviceStream(delta);
+    lk.lock();
+
+    _busy = nullptr;
+    _idleCondition.notify_all();
+    _stats.underruns += delta.underruns;
+    _stats.buffersQueued += delta.buffersQueued;
+
+    // the player may have been removed while it was serviced
+    it = std::find_if(_streams.begin(), _streams.end(), [player](const Stream& s) { return s.player == player; });
+    if (it != _streams.end())
+    {
+        if (deadline == clock::time_point::max())
+            _streams.erase(it);
+        else if (it->deadline <= now)  // keep a wakeup requested while servicing
+            it->deadline = deadline;
+    }
+    _stats.activeStreams = static_cast<unsigned int>(_streams.size());
+    return true;
+}
+
+void AudioStreamService::threadLoop()
+{
+#if defined(__APPLE__)
+    pthread_setname_np("ALStreaming");
+#endif
+    std::unique_lock<std::mutex> lk(_mutex);
+    while (!_stop)
+    {
+        clock::time_point nextDeadline;
+        if (serviceNext(lk, nextDeadline))
+            continue;
+
+        if (nextDeadline == clock::time_point::max())
+            _condition.wait(lk);
+        else
+            _condition.wait_until(lk, nextDeadline);
+    }
+}
+
+void AudioStreamService::update()
+{
+    if (_thread.joinable())
+        return;
+
+    std::unique_lock<std::mutex> lk(_mutex);
+    clock::time_point nextDeadline;
+    while (serviceNext(lk, nextDeadline))
+        ;
+}
+
+NS_AX_END
+#undef LOG_TAG
@@ -0,0 +1,92 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "platform/PlatformConfig.h"
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include "platform/PlatformMacros.h"
+#include "audio/AudioEngine.h"
+
+NS_AX_BEGIN
+
+class AudioPlayer;
+
+/**
+ * @class AudioStreamService
+ * @brief One thread refilling the buffer queues of all streaming AudioPlayers.
+ *
+ * Each stream has a deadline computed from how much audio it has queued, the thread sleeps until the
+ * earliest one instead of every player polling on its own thread.
+ */
+class AX_DLL AudioStreamService
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    AudioStreamService();
+    ~AudioStreamService();
+
+    /** Starts servicing a player, the first pass runs immediately. */
+    void addStream(AudioPlayer* player);
+
+    /** Stops servicing a player, waits if the thread is servicing it right now. */
+    void removeStream(AudioPlayer* player);
+
+    /** Moves the deadline of a player to now, i.e. after a seek or an OpenAL buffer notification. */
+    void wakeup(AudioPlayer* player);
+
+    /** Services due streams on the calling thread on platforms without threads, otherwise does nothing. */
+    void update();
+
+    AudioStreamStats getStats() const;
+
+private:
+    struct Stream
+    {
+        AudioPlayer* player;
+        clock::time_point deadline;
+    };
+
+    void threadLoop();
+    // services the earliest stream if it's due, returns false when there is nothing to do until its deadline
+    bool serviceNext(std::unique_lock<std::mutex>& lk, clock::time_point& nextDeadline);
+
+    std::vector<Stream> _streams;
+    AudioPlayer* _busy = nullptr;
+    AudioStreamStats _stats;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    std::condition_variable _idleCondition;
+    std::thread _thread;
+    bool _stop = false;
+};
+
+NS_AX_END
@@ -42,6 +42,7 @@ THE SOFTWARE.
 
 // base
 #include "base/AsyncTaskPool.h"
+#include "base/JobSystem.h"
 #include "base/AutoreleasePool.h"
 #include "base/Configuration.h"
 #include "base/Console.h"
@@ -257,6 +258,8 @@ THE SOFTWARE.
 #include "2d/ParallaxNode.h"
 #include "2d/TMXObjectGroup.h"
 #include "2d/TMXXMLParser.h"
+#include "2d/TMXBinaryMap.h"
+#include "2d/TMXBinaryCompiler.h"
 #include "2d/TileMapAtlas.h"
 #include "2d/FastTMXLayer.h"
 #include "2d/FastTMXTiledMap.h"
@@ -280,10 +283,16 @@ THE SOFTWARE.
 #include "3d/Plane.h"
 #include "3d/Ray.h"
 #include "3d/Skeleton3D.h"
+#include "3d/SkeletalAnimationStage.h"
+#include "3d/SkinningPaletteBuffer.h"
+#include "3d/SceneBVH.h"
+#include "3d/MeshOptimizer.h"
+#include "3d/GLTFLoader.h"
 #include "3d/Skybox.h"
 #include "3d/MeshRenderer.h"
 #include "3d/MeshMaterial.h"
 #include "3d/Terrain.h"
+#include "3d/TiledTerrain.h"
 #include "3d/VertexAttribBinding.h"
 
 NS_AX_BEGIN
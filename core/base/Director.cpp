@@ -58,9 +58,12 @@ THE SOFTWARE.
 #include "base/AutoreleasePool.h"
 #include "base/Configuration.h"
 #include "base/AsyncTaskPool.h"
+#include "base/JobSystem.h"
 #include "base/ObjectFactory.h"
 #include "platform/Application.h"
 #include "audio/AudioEngine.h"
+#include "3d/SkeletalAnimationStage.h"
+#include "3d/SkinningPaletteBuffer.h"
 
 #if AX_ENABLE_SCRIPT_BINDING
 #    include "base/ScriptSupport.h"
@@ -1041,6 +1044,9 @@ void Director::reset()
     SpriteFrameCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destroyInstance();
+    SkeletalAnimationStage::destroyInstance();
+    SkinningPaletteBuffer::destroyInstance();
+    JobSystem::destroyInstance();
     backend::ProgramManager::destroyInstance();
 
     // axmol specific data structures
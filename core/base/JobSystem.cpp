@@ -0,0 +1,180 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/JobSystem.h"
+
+#include <algorithm>
+
+NS_AX_BEGIN
+
+JobSystem* JobSystem::s_sharedJobSystem = nullptr;
+
+// image decoding may create the shared instance on a loader thread
+static std::mutex s_sharedJobSystemMutex;
+
+JobSystem* JobSystem::getInstance()
+{
+    std::lock_guard<std::mutex> lck(s_sharedJobSystemMutex);
+    if (s_sharedJobSystem == nullptr)
+    {
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+        int threads = (std::max)(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+#else
+        // no threads, jobs run on the calling thread
+        int threads = 0;
+#endif
+        s_sharedJobSystem = new JobSystem(threads);
+    }
+    return s_sharedJobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    JobSystem* jobSystem;
+    {
+        std::lock_guard<std::mutex> lck(s_sharedJobSystemMutex);
+        jobSystem = s_sharedJobSystem;
+    }
+
+    // the queued jobs are drained on destruction and may still use the shared instance, don't hold the lock
+    delete jobSystem;
+
+    std::lock_guard<std::mutex> lck(s_sharedJobSystemMutex);
+    if (s_sharedJobSystem == jobSystem)
+        s_sharedJobSystem = nullptr;
+}
+
+JobSystem::JobSystem(int threads)
+{
+    for (int i = 0; i < threads; ++i)
+        _workers.emplace_back(&JobSystem::workerLoop, this);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::unique_lock<std::mutex> lck(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    for (auto& worker : _workers)
+        worker.join();
+}
+
+void JobSystem::enqueue(std::function<void()> job)
+{
+    if (_workers.empty())
+    {
+        job();
+        return;
+    }
+
+    std::unique_lock<std::mutex> lck(_mutex);
+    if (_stop)
+    {
+        // enqueued while the workers drain the queue on shutdown, someone may be waiting for it
+        lck.unlock();
+        job();
+        return;
+    }
+    _jobs.emplace_back(std::move(job));
+    lck.unlock();
+    _condition.notify_one();
+}
+
+void JobSystem::workerLoop()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lck(_mutex);
+            _condition.wait(lck, [this] { return _stop || !_jobs.empty(); });
+            // queued jobs are still run on shutdown, callers may be blocked on their results
+            if (_jobs.empty())
+                return;
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+        job();
+    }
+}
+
+void JobSystem::parallelFor(size_t first,
+                            size_t last,
+                            size_t grain,
+                            const std::function<void(size_t, size_t)>& func)
+{
+    if (first >= last)
+        return;
+
+    grain             = (std::max)(grain, size_t{1});
+    const auto chunks = (last - first + grain - 1) / grain;
+
+    int helpers = getThreadCount();
+    if (_maxParallelism > 0)
+        helpers = (std::min)(helpers, _maxParallelism - 1);
+    helpers = static_cast<int>((std::min)(static_cast<size_t>((std::max)(helpers, 0)), chunks - 1));
+
+    if (helpers == 0)
+    {
+        func(first, last);
+        return;
+    }
+
+    // the helpers may start after all chunks are done, so the state is shared
+    struct State
+    {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+
+    auto runChunks = [state, first, last, grain, chunks, &func]() {
+        size_t chunk;
+        while ((chunk = state->next.fetch_add(1)) < chunks)
+        {
+            auto begin = first + chunk * grain;
+            func(begin, (std::min)(begin + grain, last));
+            if (state->done.fetch_add(1) + 1 == chunks)
+            {
+                std::lock_guard<std::mutex> lck(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    for (int i = 0; i < helpers; ++i)
+        enqueue(runChunks);
+
+    runChunks();
+
+    // wait for chunks taken by helpers, func is only touched by claimed chunks
+    std::unique_lock<std::mutex> lck(state->mutex);
+    state->finished.wait(lck, [&state, chunks] { return state->done.load() == chunks; });
+}
+
+NS_AX_END
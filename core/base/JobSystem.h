@@ -0,0 +1,103 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "platform/PlatformMacros.h"
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_AX_BEGIN
+
+/**
+ * @class JobSystem
+ * @brief A fixed size worker pool for CPU bound jobs, i.e. texture transcoding, animation and physics queries.
+ *
+ * Unlike AsyncTaskPool, which owns one thread per task type for blocking IO, the workers are shared by all
+ * jobs and parallelFor lets the calling thread take part in the work, so it's safe to call it from a job.
+ */
+class AX_DLL JobSystem
+{
+public:
+    /**
+     * Returns the shared instance, the worker count defaults to hardware concurrency - 1,
+     * and 0 on platforms without threads.
+     */
+    static JobSystem* getInstance();
+
+    /**
+     * Destroys the shared instance, pending jobs are run before the workers exit.
+     */
+    static void destroyInstance();
+
+    explicit JobSystem(int threads);
+    ~JobSystem();
+
+    /** Gets the number of worker threads. */
+    int getThreadCount() const { return static_cast<int>(_workers.size()); }
+
+    /**
+     * Limits how many workers parallelFor uses, 0 means all of them.
+     * Mainly used to benchmark scaling by thread count.
+     */
+    void setMaxParallelism(int threads) { _maxParallelism = threads; }
+    int getMaxParallelism() const { return _maxParallelism; }
+
+    /**
+     * Enqueue a job to run on a worker thread, it runs immediately on the calling thread if there are no workers.
+     */
+    void enqueue(std::function<void()> job);
+
+    /**
+     * Runs func(begin, end) over [first, last) split to chunks of grain items on the workers and the calling
+     * thread, and returns once all chunks are done.
+     */
+    void parallelFor(size_t first, size_t last, size_t grain, const std::function<void(size_t, size_t)>& func);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _jobs;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stop          = false;
+    int _maxParallelism = 0;
+
+    static JobSystem* s_sharedJobSystem;
+};
+
+NS_AX_END
+// end group
+/// @}
@@ -11,6 +11,8 @@
 #ifndef __ASTC_H__
 #define __ASTC_H__
 
+#include "platform/PlatformMacros.h"
+
 #include <stdint.h>
 
 // ASTC parameters
@@ -38,12 +40,13 @@ static unsigned int astc_unpack_bytes(uint8_t a, uint8_t b, uint8_t c, uint8_t d
 }
 
 
-int astc_decompress_image(const uint8_t* in,
-                          uint32_t inlen,
-                          uint8_t* out,
-                          uint32_t xdim,
-                          uint32_t ydim,
-                          uint32_t xblock,
-                          uint32_t yblock);
+// Decode to RGBA8888, the rows of blocks are decoded on the JobSystem workers
+AX_DLL int astc_decompress_image(const uint8_t* in,
+                                 uint32_t inlen,
+                                 uint8_t* out,
+                                 uint32_t xdim,
+                                 uint32_t ydim,
+                                 uint32_t xblock,
+                                 uint32_t yblock);
 
 #endif  //__ASTC_H__
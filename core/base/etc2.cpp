@@ -33,12 +33,14 @@
  ****************************************************************************/
 
 #include "base/etc2.h"
+#include "base/JobSystem.h"
 #include <stdint.h>
 #include <string.h>
 #include <assert.h>
 #include <type_traits>
 #include <algorithm>
 #include <limits>
+#include <atomic>
 
 static const char ketc2Magic[] = {'P', 'K', 'M', ' ', '2', '0'};
 
@@ -999,3 +1001,38 @@ int etc2_decode_image(int format, const etc2_byte* input, etc2_byte* output, etc
 
     return -1;
 }
+
+int etc2_decode_image_parallel(int format,
+                               const etc2_byte* input,
+                               etc2_byte* output,
+                               etc2_uint32 width,
+                               etc2_uint32 height)
+{
+    size_t bytesPerBlock = 0;
+    switch (format)
+    {
+    case ETC2_RGBA_NO_MIPMAPS:
+        bytesPerBlock = 16;
+        break;
+    case ETC2_RGB_NO_MIPMAPS:
+        bytesPerBlock = 8;
+        break;
+    default:
+        return -1;
+    }
+
+    // each job decodes a strip of 4 rows of blocks, the last strip is clipped to the image height
+    const size_t inputRowPitch = ComputeETC2RowPitch(width, 4 /*blockWidth*/, bytesPerBlock);
+    const size_t blocksY       = (height + 3) / 4;
+
+    // any failed strip fails the whole image
+    std::atomic<int> result{0};
+    ax::JobSystem::getInstance()->parallelFor(0, blocksY, 4, [=, &result](size_t first, size_t last) {
+        etc2_uint32 top    = static_cast<etc2_uint32>(first * 4);
+        etc2_uint32 bottom = (std::min)(static_cast<etc2_uint32>(last * 4), height);
+        if (etc2_decode_image(format, input + first * inputRowPitch, output + static_cast<size_t>(top) * width * 4,
+                              width, bottom - top) != 0)
+            result.store(-1, std::memory_order_relaxed);
+    });
+    return result.load(std::memory_order_relaxed);
+}
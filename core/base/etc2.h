@@ -34,6 +34,8 @@
 #define __etc2_h__
 /// @cond DO_NOT_SHOW
 
+#include "platform/PlatformMacros.h"
+
 typedef unsigned char etc2_byte;
 typedef int etc2_bool;
 typedef unsigned int etc2_uint32;
@@ -75,7 +77,18 @@ etc2_uint32 etc2_pkm_get_format(const etc2_byte* pHeader);
 /// <param name="width">pixelsHeight</param>
 /// <param name="height">pixelsWidth</param>
 /// <returns>0: success, -1: failed</returns>
-int etc2_decode_image(int format, const etc2_byte* input, etc2_byte* output, etc2_uint32 width, etc2_uint32 height);
+AX_DLL int etc2_decode_image(int format,
+                             const etc2_byte* input,
+                             etc2_byte* output,
+                             etc2_uint32 width,
+                             etc2_uint32 height);
+
+// Same as etc2_decode_image, but the rows of blocks are decoded on the JobSystem workers
+AX_DLL int etc2_decode_image_parallel(int format,
+                                      const etc2_byte* input,
+                                      etc2_byte* output,
+                                      etc2_uint32 width,
+                                      etc2_uint32 height);
 
 /// @endcond
 #endif
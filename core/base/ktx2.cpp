@@ -0,0 +1,180 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/ktx2.h"
+#include "base/etc2.h"
+#include "base/s3tc.h"
+#include "base/ZipUtils.h"
+#include "base/JobSystem.h"
+
+#include <string.h>
+#include <algorithm>
+#include <memory>
+
+static const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                            0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+// the rows of blocks each job transcodes
+#define KTX2_ROWS_PER_JOB 4
+
+static uint32_t ktx2_level_dim(uint32_t dim, uint32_t level)
+{
+    return (std::max)(dim >> level, 1u);
+}
+
+static size_t ktx2_source_block_size(const KTX2Header* header)
+{
+    return ktx2_has_alpha(header) ? 16 : 8;
+}
+
+bool ktx2_is_valid(const uint8_t* data, size_t dataLen)
+{
+    if (dataLen < KTX2_HEADER_SIZE || memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+        return false;
+
+    auto header = reinterpret_cast<const KTX2Header*>(data);
+    switch (header->vkFormat)
+    {
+    case KTX2Header::VkFormat::ETC2_R8G8B8_UNORM_BLOCK:
+    case KTX2Header::VkFormat::ETC2_R8G8B8_SRGB_BLOCK:
+    case KTX2Header::VkFormat::ETC2_R8G8B8A8_UNORM_BLOCK:
+    case KTX2Header::VkFormat::ETC2_R8G8B8A8_SRGB_BLOCK:
+        break;
+    default:
+        return false;
+    }
+
+    if (header->supercompressionScheme != KTX2Header::SupercompressionScheme::NONE &&
+        header->supercompressionScheme != KTX2Header::SupercompressionScheme::ZLIB)
+        return false;
+
+    // cubemaps, arrays and 3d textures are not supported
+    if (header->pixelWidth == 0 || header->pixelDepth > 1 || header->layerCount > 1 || header->faceCount != 1)
+        return false;
+
+    return dataLen >= KTX2_HEADER_SIZE + sizeof(KTX2LevelIndex) * ktx2_get_level_count(header);
+}
+
+bool ktx2_has_alpha(const KTX2Header* header)
+{
+    return header->vkFormat == KTX2Header::VkFormat::ETC2_R8G8B8A8_UNORM_BLOCK ||
+           header->vkFormat == KTX2Header::VkFormat::ETC2_R8G8B8A8_SRGB_BLOCK;
+}
+
+uint32_t ktx2_get_level_count(const KTX2Header* header)
+{
+    return (std::max)(header->levelCount, 1u);
+}
+
+size_t ktx2_get_transcoded_size(const KTX2Header* header, uint32_t level, KTX2TranscodeTarget target)
+{
+    size_t width  = ktx2_level_dim(header->pixelWidth, level);
+    size_t height = ktx2_level_dim(header->pixelHeight, level);
+    size_t blocks = ((width + 3) / 4) * ((height + 3) / 4);
+
+    switch (target)
+    {
+    case KTX2TranscodeTarget::ETC2:
+    case KTX2TranscodeTarget::S3TC:
+        return blocks * ktx2_source_block_size(header);
+    default:
+        return width * height * 4;
+    }
+}
+
+bool ktx2_transcode_level(const uint8_t* data,
+                          size_t dataLen,
+                          uint32_t level,
+                          KTX2TranscodeTarget target,
+                          uint8_t* output,
+                          size_t outputLen)
+{
+    auto header = reinterpret_cast<const KTX2Header*>(data);
+    if (level >= ktx2_get_level_count(header) || outputLen < ktx2_get_transcoded_size(header, level, target))
+        return false;
+
+    auto levelIndex = reinterpret_cast<const KTX2LevelIndex*>(data + KTX2_HEADER_SIZE) + level;
+    if (levelIndex->byteOffset > dataLen || levelIndex->byteLength > dataLen - levelIndex->byteOffset)
+        return false;
+
+    const uint32_t width     = ktx2_level_dim(header->pixelWidth, level);
+    const uint32_t height    = ktx2_level_dim(header->pixelHeight, level);
+    const uint32_t blocksX   = (width + 3) / 4;
+    const uint32_t blocksY   = (height + 3) / 4;
+    const size_t blockSize   = ktx2_source_block_size(header);
+    const size_t sourceLen   = blocksX * blocksY * blockSize;
+    const uint8_t* source    = data + levelIndex->byteOffset;
+    yasio::byte_buffer inflated;
+
+    if (header->supercompressionScheme == KTX2Header::SupercompressionScheme::ZLIB)
+    {
+        inflated = ax::ZipUtils::decompressGZ(source, static_cast<size_t>(levelIndex->byteLength),
+                                              static_cast<int>(sourceLen));
+        if (inflated.size() < sourceLen)
+            return false;
+        source = inflated.data();
+    }
+    else if (levelIndex->byteLength < sourceLen)
+        return false;
+
+    if (target == KTX2TranscodeTarget::ETC2)
+    {
+        memcpy(output, source, sourceLen);
+        return true;
+    }
+
+    const int etc2Format = blockSize == 16 ? ETC2_RGBA_NO_MIPMAPS : ETC2_RGB_NO_MIPMAPS;
+
+    ax::JobSystem::getInstance()->parallelFor(0, blocksY, KTX2_ROWS_PER_JOB, [=](size_t first, size_t last) {
+        if (target == KTX2TranscodeTarget::RGBA8)
+        {
+            // etc2_decode_image clips the last row of blocks to the image height
+            uint32_t top    = static_cast<uint32_t>(first) * 4;
+            uint32_t bottom = (std::min)(static_cast<uint32_t>(last) * 4, height);
+            etc2_decode_image(etc2Format, source + first * blocksX * blockSize, output + top * width * 4, width,
+                              bottom - top);
+            return;
+        }
+
+        // ETC2 -> S3TC, decode a row of blocks to rgba, then encode block by block
+        const auto flag  = blockSize == 16 ? S3TCDecodeFlag::DXT5 : S3TCDecodeFlag::DXT1;
+        const auto pitch = blocksX * 16;
+        auto rowPixels   = std::make_unique<uint8_t[]>(pitch * 4);
+        uint8_t blockPixels[64];
+        for (size_t y = first; y < last; ++y)
+        {
+            etc2_decode_image(etc2Format, source + y * blocksX * blockSize, rowPixels.get(), blocksX * 4, 4);
+
+            uint8_t* encodeData = output + y * blocksX * blockSize;
+            for (uint32_t x = 0; x < blocksX; ++x, encodeData += blockSize)
+            {
+                for (int row = 0; row < 4; ++row)
+                    memcpy(blockPixels + row * 16, rowPixels.get() + row * pitch + x * 16, 16);
+                s3tc_encode_block(blockPixels, encodeData, flag);
+            }
+        }
+    });
+
+    return true;
+}
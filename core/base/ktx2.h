@@ -0,0 +1,111 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+#pragma once
+
+#include "platform/PlatformMacros.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define KTX2_HEADER_SIZE 80
+
+// ktx2 header, refer to: https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+struct KTX2Header
+{
+    struct VkFormat
+    {
+        enum
+        {
+            ETC2_R8G8B8_UNORM_BLOCK   = 147,
+            ETC2_R8G8B8_SRGB_BLOCK    = 148,
+            ETC2_R8G8B8A8_UNORM_BLOCK = 151,
+            ETC2_R8G8B8A8_SRGB_BLOCK  = 152,
+        };
+    };
+
+    struct SupercompressionScheme
+    {
+        enum
+        {
+            NONE = 0,
+            ZLIB = 3,
+        };
+    };
+
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+
+// the level index follows the header, level 0 is the base level
+struct KTX2LevelIndex
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+
+/**
+ * The universal texture is stored as ETC2 blocks, and transcoded at load time to what the device supports.
+ */
+enum class KTX2TranscodeTarget
+{
+    ETC2,  // no transcoding, the blocks are uploaded as is
+    S3TC,  // ETC2_RGB -> DXT1, ETC2_RGBA -> DXT5
+    RGBA8,
+};
+
+// Check whether the data is a 2D ktx2 texture with a source format and supercompression we can transcode
+AX_DLL bool ktx2_is_valid(const uint8_t* data, size_t dataLen);
+
+// Check whether the source format has an alpha channel
+AX_DLL bool ktx2_has_alpha(const KTX2Header* header);
+
+// Gets the number of mipmap levels stored, at least 1
+AX_DLL uint32_t ktx2_get_level_count(const KTX2Header* header);
+
+// Gets the bytes of a level after transcoding
+AX_DLL size_t ktx2_get_transcoded_size(const KTX2Header* header, uint32_t level, KTX2TranscodeTarget target);
+
+// Transcode a level to output, the rows of blocks are split across the JobSystem workers.
+// returns false if the level is out of range or truncated
+AX_DLL bool ktx2_transcode_level(const uint8_t* data,
+                                 size_t dataLen,
+                                 uint32_t level,
+                                 KTX2TranscodeTarget target,
+                                 uint8_t* output,
+                                 size_t outputLen);
@@ -180,3 +180,115 @@ void s3tc_decode(uint8_t* encodeData,  // in_data
         }      // for block_x
     }          // for block_y
 }
+
+static uint16_t s3tc_pack_565(int r, int g, int b)
+{
+    return static_cast<uint16_t>((((r * 31 + 127) / 255) << 11) | (((g * 63 + 127) / 255) << 5) |
+                                 ((b * 31 + 127) / 255));
+}
+
+static void s3tc_unpack_565(uint16_t color, int* rgb)
+{
+    int r  = (color >> 11) & 0x1f;
+    int g  = (color >> 5) & 0x3f;
+    int b  = color & 0x1f;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+// Encode the color part with 4 colors mode, the endpoints are inset by 1/16 of the range to reduce the error
+static void s3tc_encode_color_block(const uint8_t* rgba, uint8_t* encodeData)
+{
+    int minColor[3] = {255, 255, 255}, maxColor[3] = {0, 0, 0};
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            int value   = rgba[i * 4 + c];
+            minColor[c] = value < minColor[c] ? value : minColor[c];
+            maxColor[c] = value > maxColor[c] ? value : maxColor[c];
+        }
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+        int inset = (maxColor[c] - minColor[c]) >> 4;
+        minColor[c] += inset;
+        maxColor[c] -= inset;
+    }
+
+    uint16_t color0 = s3tc_pack_565(maxColor[0], maxColor[1], maxColor[2]);
+    uint16_t color1 = s3tc_pack_565(minColor[0], minColor[1], minColor[2]);
+    if (color0 < color1)
+    {
+        uint16_t temp = color0;
+        color0        = color1;
+        color1        = temp;
+    }
+
+    uint32_t pixelsIndex = 0;
+    if (color0 != color1)
+    {
+        int end0[3], end1[3], dir[3];
+        s3tc_unpack_565(color0, end0);
+        s3tc_unpack_565(color1, end1);
+        for (int c = 0; c < 3; ++c)
+            dir[c] = end1[c] - end0[c];
+        int lengthSquare = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+
+        // project to color0 -> color1, the palette order is color0, color1, 2/3 color0 + 1/3 color1, 1/3 color0 + 2/3
+        // color1
+        static const uint32_t indexOfStep[6] = {0, 2, 2, 3, 3, 1};
+        for (int i = 15; i >= 0; --i)
+        {
+            const uint8_t* pixel = rgba + i * 4;
+            int dot = (pixel[0] - end0[0]) * dir[0] + (pixel[1] - end0[1]) * dir[1] + (pixel[2] - end0[2]) * dir[2];
+            int step = dot <= 0 ? 0 : (dot >= lengthSquare ? 5 : dot * 6 / lengthSquare);
+            pixelsIndex = (pixelsIndex << 2) | indexOfStep[step];
+        }
+    }
+
+    memcpy(encodeData, &color0, 2);
+    memcpy(encodeData + 2, &color1, 2);
+    memcpy(encodeData + 4, &pixelsIndex, 4);
+}
+
+// Encode the alpha part with 8 alphas mode
+static void s3tc_encode_alpha_block(const uint8_t* rgba, uint8_t* encodeData)
+{
+    int minAlpha = 255, maxAlpha = 0;
+    for (int i = 0; i < 16; ++i)
+    {
+        int value = rgba[i * 4 + 3];
+        minAlpha  = value < minAlpha ? value : minAlpha;
+        maxAlpha  = value > maxAlpha ? value : maxAlpha;
+    }
+
+    uint64_t alphaIndex = 0;
+    if (maxAlpha != minAlpha)
+    {
+        // alpha0 > alpha1: code 0 = alpha0, 1 = alpha1, 2..7 interpolate from alpha0 to alpha1
+        int range = maxAlpha - minAlpha;
+        for (int i = 15; i >= 0; --i)
+        {
+            int step      = ((maxAlpha - rgba[i * 4 + 3]) * 7 + range / 2) / range;
+            uint64_t code = step == 0 ? 0 : (step == 7 ? 1 : step + 1);
+            alphaIndex    = (alphaIndex << 3) | code;
+        }
+    }
+
+    encodeData[0] = static_cast<uint8_t>(maxAlpha);
+    encodeData[1] = static_cast<uint8_t>(minAlpha);
+    for (int i = 0; i < 6; ++i)
+        encodeData[2 + i] = static_cast<uint8_t>(alphaIndex >> (i * 8));
+}
+
+void s3tc_encode_block(const uint8_t* rgba, uint8_t* encodeData, S3TCDecodeFlag encodeFlag)
+{
+    if (S3TCDecodeFlag::DXT5 == encodeFlag)
+    {
+        s3tc_encode_alpha_block(rgba, encodeData);
+        encodeData += 8;
+    }
+    s3tc_encode_color_block(rgba, encodeData);
+}
@@ -43,5 +43,11 @@ void s3tc_decode(uint8_t* encode_data,
                  const int pixelsHeight,
                  S3TCDecodeFlag decodeFlag);
 
+// Encode 4x4 RGBA8 pixels to a DXT1 (8 bytes) or DXT5 (16 bytes) block with a bounding box range fit,
+// fast enough for runtime transcoding, DXT3 is not supported
+void s3tc_encode_block(const uint8_t* rgba,  // in_data, 16 pixels, row by row
+                       uint8_t* encodeData,   // out_data
+                       S3TCDecodeFlag encodeFlag);
+
 /// @endcond
 #endif /* defined(COCOS2DX_PLATFORM_THIRDPARTY_S3TC_) */
@@ -30,7 +30,9 @@
 #    include "renderer/Renderer.h"
 #    include "recast/DetourCommon.h"
 #    include "recast/DetourDebugDraw.h"
+#    include "base/JobSystem.h"
 #    include <sstream>
+#    include <algorithm>
 
 NS_AX_BEGIN
 
@@ -88,7 +90,155 @@ static unsigned char* parseRow(unsigned char* buf, unsigned char* bufEnd, char*
 
 static const int TILECACHESET_MAGIC   = 'T' << 24 | 'S' << 16 | 'E' << 8 | 'T';  //'TSET';
 static const int TILECACHESET_VERSION = 1;
-static const int MAX_AGENTS           = 128;
+static const int MAX_AGENTS           = 512;
+static const int MAX_PATH_POLYS       = 256;
+static const int MAX_SMOOTH_PATH      = 2048;
+static const int PATH_QUERY_NODES     = 2048;
+
+// iterates over the path to find a smooth path on the detail mesh surface
+static void smoothPath(dtNavMeshQuery* navMeshQuery,
+                       const dtQueryFilter& filter,
+                       const Vec3& start,
+                       const Vec3& end,
+                       dtPolyRef* polys,
+                       int npolys,
+                       std::vector<Vec3>& pathPoints)
+{
+    if (npolys)
+    {
+        //// Iterate over the path to find smooth path on the detail mesh surface.
+        // dtPolyRef polys[MAX_PATH_POLYS];
+        // memcpy(polys, polys, sizeof(dtPolyRef)*npolys);
+        // int npolys = npolys;
+
+        float iterPos[3], targetPos[3];
+        navMeshQuery->closestPointOnPoly(polys[0], &start.x, iterPos, 0);
+        navMeshQuery->closestPointOnPoly(polys[npolys - 1], &end.x, targetPos, 0);
+
+        static const float STEP_SIZE = 0.5f;
+        static const float SLOP      = 0.01f;
+
+        int nsmoothPath = 0;
+        // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], iterPos);
+        // m_nsmoothPath++;
+
+        pathPoints.emplace_back(Vec3(iterPos[0], iterPos[1], iterPos[2]));
+        nsmoothPath++;
+
+        // Move towards target a small advancement at a time until target reached or
+        // when ran out of memory to store the path.
+        while (npolys && nsmoothPath < MAX_SMOOTH_PATH)
+        {
+            // Find location to steer towards.
+            float steerPos[3];
+            unsigned char steerPosFlag;
+            dtPolyRef steerPosRef;
+
+            if (!getSteerTarget(navMeshQuery, iterPos, targetPos, SLOP, polys, npolys, steerPos, steerPosFlag,
+                                steerPosRef))
+                break;
+
+            bool endOfPath         = (steerPosFlag & DT_STRAIGHTPATH_END) ? true : false;
+            bool offMeshConnection = (steerPosFlag & DT_STRAIGHTPATH_OFFMESH_CONNECTION) ? true : false;
+
+            // Find movement delta.
+            float delta[3], len;
+            dtVsub(delta, steerPos, iterPos);
+            len = dtMathSqrtf(dtVdot(delta, delta));
+            // If the steer target is end of path or off-mesh link, do not move past the location.
+            if ((endOfPath || offMeshConnection) && len < STEP_SIZE)
+                len = 1;
+            else
+                len = STEP_SIZE / len;
+            float moveTgt[3];
+            dtVmad(moveTgt, iterPos, delta, len);
+
+            // Move
+            float result[3];
+            dtPolyRef visited[16];
+            int nvisited = 0;
+            navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &filter, result, visited, &nvisited, 16);
+
+            npolys = fixupCorridor(polys, npolys, MAX_PATH_POLYS, visited, nvisited);
+            npolys = fixupShortcuts(polys, npolys, navMeshQuery);
+
+            float h = 0;
+            navMeshQuery->getPolyHeight(polys[0], result, &h);
+            result[1] = h;
+            dtVcopy(iterPos, result);
+
+            // Handle end of path and off-mesh links when close enough.
+            if (endOfPath && inRange(iterPos, steerPos, SLOP, 1.0f))
+            {
+                // Reached end of path.
+                dtVcopy(iterPos, targetPos);
+                if (nsmoothPath < MAX_SMOOTH_PATH)
+                {
+                    // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], iterPos);
+                    // m_nsmoothPath++;
+                    pathPoints.emplace_back(Vec3(iterPos[0], iterPos[1], iterPos[2]));
+                    nsmoothPath++;
+                }
+                break;
+            }
+            else if (offMeshConnection && inRange(iterPos, steerPos, SLOP, 1.0f))
+            {
+                // Reached off-mesh connection.
+                float startPos[3], endPos[3];
+
+                // Advance the path up to and over the off-mesh connection.
+                dtPolyRef prevRef = 0, polyRef = polys[0];
+                int npos = 0;
+                while (npos < npolys && polyRef != steerPosRef)
+                {
+                    prevRef = polyRef;
+                    polyRef = polys[npos];
+                    npos++;
+                }
+                for (int i = npos; i < npolys; ++i)
+                    polys[i - npos] = polys[i];
+                npolys -= npos;
+
+                // Handle the connection.
+                dtStatus status = navMeshQuery->getAttachedNavMesh()->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, startPos, endPos);
+                if (dtStatusSucceed(status))
+                {
+                    if (nsmoothPath < MAX_SMOOTH_PATH)
+                    {
+                        // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], startPos);
+                        // m_nsmoothPath++;
+                        pathPoints.emplace_back(Vec3(startPos[0], startPos[1], startPos[2]));
+                        nsmoothPath++;
+                        // Hack to make the dotted path not visible during off-mesh connection.
+                        if (nsmoothPath & 1)
+                        {
+                            // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], startPos);
+                            // m_nsmoothPath++;
+                            pathPoints.emplace_back(Vec3(startPos[0], startPos[1], startPos[2]));
+                            nsmoothPath++;
+                        }
+                    }
+                    // Move position at the other side of the off-mesh link.
+                    dtVcopy(iterPos, endPos);
+                    float eh = 0.0f;
+                    navMeshQuery->getPolyHeight(polys[0], iterPos, &eh);
+                    iterPos[1] = eh;
+                }
+            }
+
+            // Store results.
+            if (nsmoothPath < MAX_SMOOTH_PATH)
+            {
+                // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], iterPos);
+                // m_nsmoothPath++;
+
+                pathPoints.emplace_back(Vec3(iterPos[0], iterPos[1], iterPos[2]));
+                nsmoothPath++;
+            }
+        }
+    }
+}
+
 
 NavMesh* NavMesh::create(std::string_view navFilePath, std::string_view geomFilePath)
 {
@@ -111,11 +261,29 @@ NavMesh::NavMesh()
     , _compressor(nullptr)
     , _meshProcess(nullptr)
     , _geomData(nullptr)
+    , _tileBuilder(nullptr)
     , _isDebugDrawEnabled(false)
+    , _pathQueryCount(0)
+    , _pathFindingBudget(4096)
+    , _nextPathRequestId(0)
+    , _frontAgentResults(0)
+    , _crowdUpdateAsync(false)
+    , _crowdUpdating(false)
 {}
 
 NavMesh::~NavMesh()
 {
+    waitCrowdUpdate();
+    for (auto&& request : _pathRequests)
+    {
+        dtFreeNavMeshQuery(request.query);
+    }
+    for (auto&& query : _freePathQueries)
+    {
+        dtFreeNavMeshQuery(query);
+    }
+
+    AX_SAFE_DELETE(_tileBuilder);
     dtFreeTileCache(_tileCache);
     dtFreeCrowd(_crowed);
     dtFreeNavMesh(_navMesh);
@@ -224,6 +392,8 @@ bool NavMesh::loadNavMeshFile()
             _tileCache->buildNavMeshTile(tile, _navMesh);
     }
 
+    _tileBuilder = new NavMeshTileBuilder(_navMesh, _tileCache, _meshProcess);
+
     // create crowed
     _crowed = dtAllocCrowd();
     _crowed->init(MAX_AGENTS, header.cacheParams.walkableRadius, _navMesh);
@@ -233,6 +403,8 @@ bool NavMesh::loadNavMeshFile()
     _navMeshQuery->init(_navMesh, 2048);
 
     _agentList.assign(MAX_AGENTS, nullptr);
+    _agentResults[0].resize(MAX_AGENTS);
+    _agentResults[1].resize(MAX_AGENTS);
     _obstacleList.assign(header.cacheParams.maxObstacles, nullptr);
     // duDebugDrawNavMesh(&_debugDraw, *_navMesh, DU_DRAWNAVMESH_OFFMESHCONS);
     return true;
@@ -434,11 +606,13 @@ void NavMesh::addNavMeshObstacle(NavMeshObstacle* obstacle)
 
 void NavMesh::removeNavMeshAgent(NavMeshAgent* agent)
 {
+    waitCrowdUpdate();
     auto iter = std::find(_agentList.begin(), _agentList.end(), agent);
     if (iter != _agentList.end())
     {
         agent->removeFrom(_crowed);
         agent->setNavMeshQuery(nullptr);
+        agent->_navMesh = nullptr;
         agent->release();
         _agentList[iter - _agentList.begin()] = nullptr;
     }
@@ -446,11 +620,13 @@ void NavMesh::removeNavMeshAgent(NavMeshAgent* agent)
 
 void NavMesh::addNavMeshAgent(NavMeshAgent* agent)
 {
+    waitCrowdUpdate();
     auto iter = std::find(_agentList.begin(), _agentList.end(), nullptr);
     if (iter != _agentList.end())
     {
         agent->addTo(_crowed);
         agent->setNavMeshQuery(_navMeshQuery);
+        agent->_navMesh = this;
         agent->retain();
         _agentList[iter - _agentList.begin()] = agent;
     }
@@ -470,6 +646,7 @@ void NavMesh::debugDraw(Renderer* renderer)
 {
     if (_isDebugDrawEnabled)
     {
+        waitCrowdUpdate();
         _debugDraw.clear();
         dtDraw();
         _debugDraw.draw(renderer);
@@ -478,6 +655,19 @@ void NavMesh::debugDraw(Renderer* renderer)
 
 void NavMesh::update(float dt)
 {
+    if (_crowdUpdateAsync)
+    {
+        // the results of the update that ran during the last frame
+        waitCrowdUpdate();
+        const auto& results = _agentResults[_frontAgentResults];
+        for (size_t i = 0; i < _agentList.size(); ++i)
+        {
+            auto& result = results[i];
+            if (_agentList[i] && result.agent == _agentList[i])
+                _agentList[i]->postUpdate(result.position, result.velocity, result.state);
+        }
+    }
+
     for (auto&& iter : _agentList)
     {
         if (iter)
@@ -490,16 +680,44 @@ void NavMesh::update(float dt)
             iter->preUpdate(dt);
     }
 
-    if (_crowed)
-        _crowed->update(dt, nullptr);
+    updatePathRequests();
 
-    if (_tileCache)
-        _tileCache->update(dt, _navMesh);
+    if (_crowdUpdateAsync)
+    {
+        // the crowd only reads the navmesh, so the tiles are rebuilt before it runs
+        if (_tileCache)
+            _tileCache->update(dt, _navMesh);
+        if (_tileBuilder)
+            _tileBuilder->update();
 
-    for (auto&& iter : _agentList)
+        if (_crowed)
+        {
+            _crowdUpdating = true;
+            JobSystem::getInstance()->enqueue([this, dt]() {
+                updateCrowd(dt);
+                std::lock_guard<std::mutex> lk(_crowdMutex);
+                _crowdUpdating = false;
+                _crowdCondition.notify_all();
+            });
+        }
+    }
+    else
     {
-        if (iter)
-            iter->postUpdate(dt);
+        if (_crowed)
+            updateCrowd(dt);
+
+        if (_tileCache)
+            _tileCache->update(dt, _navMesh);
+        if (_tileBuilder)
+            _tileBuilder->update();
+
+        const auto& results = _agentResults[_frontAgentResults];
+        for (size_t i = 0; i < _agentList.size(); ++i)
+        {
+            auto& result = results[i];
+            if (_agentList[i] && result.agent == _agentList[i])
+                _agentList[i]->postUpdate(result.position, result.velocity, result.state);
+        }
     }
 
     for (auto&& iter : _obstacleList)
@@ -509,155 +727,181 @@ void NavMesh::update(float dt)
     }
 }
 
-void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>& pathPoints)
+void NavMesh::updateCrowd(float dt)
 {
-    static const int MAX_POLYS  = 256;
-    static const int MAX_SMOOTH = 2048;
-    float ext[3];
-    ext[0] = 2;
-    ext[1] = 4;
-    ext[2] = 2;
-    dtQueryFilter filter;
-    dtPolyRef startRef, endRef;
-    dtPolyRef polys[MAX_POLYS];
-    int npolys = 0;
-    _navMeshQuery->findNearestPoly(&start.x, ext, &filter, &startRef, 0);
-    _navMeshQuery->findNearestPoly(&end.x, ext, &filter, &endRef, 0);
-    _navMeshQuery->findPath(startRef, endRef, &start.x, &end.x, &filter, polys, &npolys, MAX_POLYS);
+    _crowed->update(dt, nullptr);
 
-    if (npolys)
+    auto& results = _agentResults[1 - _frontAgentResults];
+    for (size_t i = 0; i < _agentList.size(); ++i)
     {
-        //// Iterate over the path to find smooth path on the detail mesh surface.
-        // dtPolyRef polys[MAX_POLYS];
-        // memcpy(polys, polys, sizeof(dtPolyRef)*npolys);
-        // int npolys = npolys;
-
-        float iterPos[3], targetPos[3];
-        _navMeshQuery->closestPointOnPoly(startRef, &start.x, iterPos, 0);
-        _navMeshQuery->closestPointOnPoly(polys[npolys - 1], &end.x, targetPos, 0);
-
-        static const float STEP_SIZE = 0.5f;
-        static const float SLOP      = 0.01f;
+        results[i].agent = nullptr;
+        if (!_agentList[i])
+            continue;
+        auto agent = _crowed->getAgent(_agentList[i]->_agentID);
+        if (!agent)
+            continue;
+        results[i].agent    = _agentList[i];
+        results[i].position = Vec3(agent->npos[0], agent->npos[1], agent->npos[2]);
+        results[i].velocity = Vec3(agent->vel[0], agent->vel[1], agent->vel[2]);
+        results[i].state    = agent->state;
+    }
+    _frontAgentResults = 1 - _frontAgentResults;
+}
 
-        int nsmoothPath = 0;
-        // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], iterPos);
-        // m_nsmoothPath++;
+void NavMesh::setCrowdUpdateAsync(bool async)
+{
+    waitCrowdUpdate();
+    _crowdUpdateAsync = async;
+}
 
-        pathPoints.emplace_back(Vec3(iterPos[0], iterPos[1], iterPos[2]));
-        nsmoothPath++;
+void NavMesh::waitCrowdUpdate()
+{
+    std::unique_lock<std::mutex> lk(_crowdMutex);
+    _crowdCondition.wait(lk, [this]() { return !_crowdUpdating; });
+}
 
-        // Move towards target a small advancement at a time until target reached or
-        // when ran out of memory to store the path.
-        while (npolys && nsmoothPath < MAX_SMOOTH)
-        {
-            // Find location to steer towards.
-            float steerPos[3];
-            unsigned char steerPosFlag;
-            dtPolyRef steerPosRef;
+unsigned int NavMesh::addBlockingVolume(const AABB& box)
+{
+    return _tileBuilder ? _tileBuilder->addBlockingVolume(box) : 0;
+}
 
-            if (!getSteerTarget(_navMeshQuery, iterPos, targetPos, SLOP, polys, npolys, steerPos, steerPosFlag,
-                                steerPosRef))
-                break;
+void NavMesh::removeBlockingVolume(unsigned int volumeId)
+{
+    if (_tileBuilder)
+        _tileBuilder->removeBlockingVolume(volumeId);
+}
 
-            bool endOfPath         = (steerPosFlag & DT_STRAIGHTPATH_END) ? true : false;
-            bool offMeshConnection = (steerPosFlag & DT_STRAIGHTPATH_OFFMESH_CONNECTION) ? true : false;
+void NavMesh::rebuildTiles(const AABB& box)
+{
+    if (_tileBuilder)
+        _tileBuilder->rebuildTiles(box);
+}
 
-            // Find movement delta.
-            float delta[3], len;
-            dtVsub(delta, steerPos, iterPos);
-            len = dtMathSqrtf(dtVdot(delta, delta));
-            // If the steer target is end of path or off-mesh link, do not move past the location.
-            if ((endOfPath || offMeshConnection) && len < STEP_SIZE)
-                len = 1;
-            else
-                len = STEP_SIZE / len;
-            float moveTgt[3];
-            dtVmad(moveTgt, iterPos, delta, len);
+bool NavMesh::isRebuildingTiles() const
+{
+    return _tileBuilder && _tileBuilder->isBuilding();
+}
 
-            // Move
-            float result[3];
-            dtPolyRef visited[16];
-            int nvisited = 0;
-            _navMeshQuery->moveAlongSurface(polys[0], iterPos, moveTgt, &filter, result, visited, &nvisited, 16);
+unsigned int NavMesh::findPathAsync(const Vec3& start, const Vec3& end, const FindPathCallback& callback)
+{
+    PathRequest request;
+    request.id       = ++_nextPathRequestId;
+    request.start    = start;
+    request.end      = end;
+    request.callback = callback;
+    request.query    = nullptr;
+    request.status   = 0;
+    _pathRequests.emplace_back(std::move(request));
+    return _nextPathRequestId;
+}
 
-            npolys = fixupCorridor(polys, npolys, MAX_POLYS, visited, nvisited);
-            npolys = fixupShortcuts(polys, npolys, _navMeshQuery);
+void NavMesh::cancelFindPath(unsigned int requestId)
+{
+    auto iter = std::find_if(_pathRequests.begin(), _pathRequests.end(),
+                             [requestId](const PathRequest& request) { return request.id == requestId; });
+    if (iter != _pathRequests.end())
+    {
+        if (iter->query)
+            _freePathQueries.emplace_back(iter->query);
+        _pathRequests.erase(iter);
+    }
+}
 
-            float h = 0;
-            _navMeshQuery->getPolyHeight(polys[0], result, &h);
-            result[1] = h;
-            dtVcopy(iterPos, result);
+void NavMesh::updatePathRequests()
+{
+    if (_pathRequests.empty() || !_navMesh)
+        return;
 
-            // Handle end of path and off-mesh links when close enough.
-            if (endOfPath && inRange(iterPos, steerPos, SLOP, 1.0f))
+    // one query per search in flight, as many as there are threads to run them
+    const int maxQueries = JobSystem::getInstance()->getThreadCount() + 1;
+    size_t active        = 0;
+    for (auto&& request : _pathRequests)
+    {
+        if (!request.query)
+        {
+            if (_freePathQueries.empty() && _pathQueryCount < maxQueries)
             {
-                // Reached end of path.
-                dtVcopy(iterPos, targetPos);
-                if (nsmoothPath < MAX_SMOOTH)
-                {
-                    // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], iterPos);
-                    // m_nsmoothPath++;
-                    pathPoints.emplace_back(Vec3(iterPos[0], iterPos[1], iterPos[2]));
-                    nsmoothPath++;
-                }
-                break;
+                auto query = dtAllocNavMeshQuery();
+                query->init(_navMesh, PATH_QUERY_NODES);
+                _freePathQueries.emplace_back(query);
+                ++_pathQueryCount;
             }
-            else if (offMeshConnection && inRange(iterPos, steerPos, SLOP, 1.0f))
-            {
-                // Reached off-mesh connection.
-                float startPos[3], endPos[3];
-
-                // Advance the path up to and over the off-mesh connection.
-                dtPolyRef prevRef = 0, polyRef = polys[0];
-                int npos = 0;
-                while (npos < npolys && polyRef != steerPosRef)
-                {
-                    prevRef = polyRef;
-                    polyRef = polys[npos];
-                    npos++;
-                }
-                for (int i = npos; i < npolys; ++i)
-                    polys[i - npos] = polys[i];
-                npolys -= npos;
+            if (_freePathQueries.empty())
+                break;
+            request.query = _freePathQueries.back();
+            _freePathQueries.pop_back();
+        }
+        ++active;
+    }
 
-                // Handle the connection.
-                dtStatus status = _navMesh->getOffMeshConnectionPolyEndPoints(prevRef, polyRef, startPos, endPos);
-                if (dtStatusSucceed(status))
-                {
-                    if (nsmoothPath < MAX_SMOOTH)
-                    {
-                        // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], startPos);
-                        // m_nsmoothPath++;
-                        pathPoints.emplace_back(Vec3(startPos[0], startPos[1], startPos[2]));
-                        nsmoothPath++;
-                        // Hack to make the dotted path not visible during off-mesh connection.
-                        if (nsmoothPath & 1)
-                        {
-                            // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], startPos);
-                            // m_nsmoothPath++;
-                            pathPoints.emplace_back(Vec3(startPos[0], startPos[1], startPos[2]));
-                            nsmoothPath++;
-                        }
-                    }
-                    // Move position at the other side of the off-mesh link.
-                    dtVcopy(iterPos, endPos);
-                    float eh = 0.0f;
-                    _navMeshQuery->getPolyHeight(polys[0], iterPos, &eh);
-                    iterPos[1] = eh;
-                }
+    // the requests in flight are at the front, share the budget between them
+    const int iterations = (std::max)(_pathFindingBudget / static_cast<int>(active), 1);
+    JobSystem::getInstance()->parallelFor(0, active, 1, [this, iterations](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& request = _pathRequests[i];
+            auto query    = request.query;
+            if (request.status == 0)
+            {
+                const float ext[3] = {2, 4, 2};
+                dtPolyRef startRef = 0, endRef = 0;
+                query->findNearestPoly(&request.start.x, ext, &_pathFilter, &startRef, 0);
+                query->findNearestPoly(&request.end.x, ext, &_pathFilter, &endRef, 0);
+                request.status = query->initSlicedFindPath(startRef, endRef, &request.start.x, &request.end.x,
+                                                           &_pathFilter);
             }
 
-            // Store results.
-            if (nsmoothPath < MAX_SMOOTH)
-            {
-                // dtVcopy(&m_smoothPath[m_nsmoothPath * 3], iterPos);
-                // m_nsmoothPath++;
+            if (dtStatusInProgress(request.status))
+                request.status = query->updateSlicedFindPath(iterations, nullptr);
 
-                pathPoints.emplace_back(Vec3(iterPos[0], iterPos[1], iterPos[2]));
-                nsmoothPath++;
+            if (dtStatusSucceed(request.status))
+            {
+                dtPolyRef polys[MAX_PATH_POLYS];
+                int npolys = 0;
+                query->finalizeSlicedFindPath(polys, &npolys, MAX_PATH_POLYS);
+                smoothPath(query, _pathFilter, request.start, request.end, polys, npolys, request.pathPoints);
             }
         }
+    });
+
+    // deliver in request order, a callback may request or cancel paths, so the finished ones are taken out first
+    std::vector<PathRequest> finished;
+    for (size_t i = 0; i < active;)
+    {
+        auto& request = _pathRequests[i];
+        if (dtStatusInProgress(request.status))
+        {
+            ++i;
+            continue;
+        }
+        _freePathQueries.emplace_back(request.query);
+        request.query = nullptr;
+        finished.emplace_back(std::move(request));
+        _pathRequests.erase(_pathRequests.begin() + i);
+        --active;
     }
+    for (auto&& request : finished)
+    {
+        if (request.callback)
+            request.callback(request.pathPoints);
+    }
+}
+
+void ax::NavMesh::findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>& pathPoints)
+{
+    float ext[3];
+    ext[0] = 2;
+    ext[1] = 4;
+    ext[2] = 2;
+    dtQueryFilter filter;
+    dtPolyRef startRef, endRef;
+    dtPolyRef polys[MAX_PATH_POLYS];
+    int npolys = 0;
+    _navMeshQuery->findNearestPoly(&start.x, ext, &filter, &startRef, 0);
+    _navMeshQuery->findNearestPoly(&end.x, ext, &filter, &endRef, 0);
+    _navMeshQuery->findPath(startRef, endRef, &start.x, &end.x, &filter, polys, &npolys, MAX_PATH_POLYS);
+
+    smoothPath(_navMeshQuery, filter, start, end, polys, npolys, pathPoints);
 }
 
 NS_AX_END
@@ -37,11 +37,15 @@
 #    include "recast/DetourTileCache.h"
 #    include <string>
 #    include <vector>
+#    include <functional>
+#    include <mutex>
+#    include <condition_variable>
 
 #    include "navmesh/NavMeshAgent.h"
 #    include "navmesh/NavMeshDebugDraw.h"
 #    include "navmesh/NavMeshObstacle.h"
 #    include "navmesh/NavMeshUtils.h"
+#    include "navmesh/NavMeshTileBuilder.h"
 
 NS_AX_BEGIN
 
@@ -54,6 +58,9 @@ class Renderer;
 class AX_DLL NavMesh : public Ref
 {
 public:
+    /** Receives the key points of a path found by findPathAsync, empty if there is no path. */
+    typedef std::function<void(const std::vector<Vec3>& pathPoints)> FindPathCallback;
+
     /**
     Create navmesh
 
@@ -95,6 +102,62 @@ public:
     */
     void findPath(const Vec3& start, const Vec3& end, std::vector<Vec3>& pathPoints);
 
+    /**
+    find a path on navmesh without blocking the caller
+
+    The search is sliced, update advances all pending searches by a budget of A* iterations per frame
+    on the JobSystem workers, and the callback is called from update once the path is found.
+
+    @param start The start search position in world coordinate system.
+    @param end The end search position in world coordinate system.
+    @param callback Receives the key points of path.
+    @return The id of the request, to cancel it.
+    */
+    unsigned int findPathAsync(const Vec3& start, const Vec3& end, const FindPathCallback& callback);
+
+    /** cancel a path request, its callback won't be called. */
+    void cancelFindPath(unsigned int requestId);
+
+    /** set how many A* iterations all path requests may take per frame, 4096 by default. */
+    void setPathFindingBudget(int iterations) { _pathFindingBudget = iterations; }
+
+    /** get how many A* iterations all path requests may take per frame. */
+    int getPathFindingBudget() const { return _pathFindingBudget; }
+
+    /**
+    run the crowd update on a worker, concurrently with the rendering of the frame
+
+    The agents receive the results at the next update, so nodes follow their agents one frame late.
+    Adding or removing agents, the agent methods reading the crowd and debug draw wait for the update to finish.
+    */
+    void setCrowdUpdateAsync(bool async);
+
+    /** check whether the crowd update runs concurrently with rendering. */
+    bool isCrowdUpdateAsync() const { return _crowdUpdateAsync; }
+
+    /** wait for a crowd update running on a worker, if any. */
+    void waitCrowdUpdate();
+
+    /**
+    block the navmesh inside a box, i.e. a placed building or a wall
+
+    The tiles under the box are rebuilt on the JobSystem workers and swapped in by a later update,
+    the frame doesn't wait for them.
+
+    @param box The blocking volume in world coordinate system.
+    @return The id of the volume, to remove it.
+    */
+    unsigned int addBlockingVolume(const AABB& box);
+
+    /** remove a blocking volume, i.e. a destroyed wall, the tiles under it are rebuilt. */
+    void removeBlockingVolume(unsigned int volumeId);
+
+    /** rebuild the tiles overlapping a box in world coordinate system. */
+    void rebuildTiles(const AABB& box);
+
+    /** check whether tiles are waiting to be rebuilt or being rebuilt. */
+    bool isRebuildingTiles() const;
+
     NavMesh();
     virtual ~NavMesh();
 
@@ -107,6 +170,29 @@ protected:
     void drawAgents();
     void drawObstacles();
     void drawOffMeshConnections();
+    void updatePathRequests();
+    void updateCrowd(float dt);
+
+protected:
+    struct PathRequest
+    {
+        unsigned int id;
+        Vec3 start;
+        Vec3 end;
+        FindPathCallback callback;
+        dtNavMeshQuery* query;  // owned while the search runs, searches in flight never share one
+        dtStatus status;
+        std::vector<Vec3> pathPoints;
+    };
+
+    // the crowd results of an agent, written by the crowd update and read by the agent at the next update
+    struct AgentResult
+    {
+        NavMeshAgent* agent = nullptr;  // the agent the result was computed for
+        Vec3 position;
+        Vec3 velocity;
+        unsigned char state = 0;
+    };
 
 protected:
     dtNavMesh* _navMesh;
@@ -117,6 +203,7 @@ protected:
     dtTileCacheCompressor* _compressor;
     MeshProcess* _meshProcess;
     GeomData* _geomData;
+    NavMeshTileBuilder* _tileBuilder;
 
     std::vector<NavMeshAgent*> _agentList;
     std::vector<NavMeshObstacle*> _obstacleList;
@@ -124,6 +211,20 @@ protected:
     std::string _navFilePath;
     std::string _geomFilePath;
     bool _isDebugDrawEnabled;
+
+    dtQueryFilter _pathFilter;
+    std::vector<PathRequest> _pathRequests;
+    std::vector<dtNavMeshQuery*> _freePathQueries;
+    int _pathQueryCount;
+    int _pathFindingBudget;
+    unsigned int _nextPathRequestId;
+
+    std::vector<AgentResult> _agentResults[2];
+    int _frontAgentResults;
+    bool _crowdUpdateAsync;
+    bool _crowdUpdating;
+    std::mutex _crowdMutex;
+    std::condition_variable _crowdCondition;
 };
 
 /** @} */
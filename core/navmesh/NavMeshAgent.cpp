@@ -78,6 +78,7 @@ ax::NavMeshAgent::NavMeshAgent()
     , _userData(nullptr)
     , _crowd(nullptr)
     , _navMeshQuery(nullptr)
+    , _navMesh(nullptr)
 {}
 
 ax::NavMeshAgent::~NavMeshAgent() {}
@@ -179,15 +180,7 @@ unsigned char NavMeshAgent::getObstacleAvoidanceType() const
 
 Vec3 NavMeshAgent::getCurrentVelocity() const
 {
-    if (_crowd)
-    {
-        auto agent = _crowd->getAgent(_agentID);
-        if (agent)
-        {
-            return Vec3(agent->vel[0], agent->vel[1], agent->vel[2]);
-        }
-    }
-    return Vec3::ZERO;
+    return _crowd ? _velocity : Vec3::ZERO;
 }
 
 void NavMeshAgent::setMaxSpeed(float maxSpeed)
@@ -242,6 +235,7 @@ OffMeshLinkData NavMeshAgent::getCurrentOffMeshLinkData()
     OffMeshLinkData data;
     if (_crowd && isOnOffMeshLink())
     {
+        waitCrowdUpdate();
         auto agentAnim = _crowd->getEditableAgentAnim(_agentID);
         if (agentAnim)
         {
@@ -273,6 +267,7 @@ void NavMeshAgent::setAutoTraverseOffMeshLink(bool isAuto)
 {
     if (_crowd && isOnOffMeshLink())
     {
+        waitCrowdUpdate();
         auto agentAnim = _crowd->getEditableAgentAnim(_agentID);
         if (agentAnim)
         {
@@ -340,10 +335,17 @@ void NavMeshAgent::preUpdate(float delta)
     }
 }
 
-void NavMeshAgent::postUpdate(float /*delta*/)
+void NavMeshAgent::postUpdate(const Vec3& position, const Vec3& velocity, unsigned char state)
 {
+    _velocity = velocity;
     if ((_syncFlag & AGENT_TO_NODE) != 0)
-        syncToNode();
+        applyToNode(position, velocity, state);
+}
+
+void NavMeshAgent::waitCrowdUpdate()
+{
+    if (_navMesh)
+        _navMesh->waitCrowdUpdate();
 }
 
 void NavMeshAgent::syncToNode()
@@ -351,33 +353,40 @@ void NavMeshAgent::syncToNode()
     const dtCrowdAgent* agent = nullptr;
     if (_crowd)
     {
+        waitCrowdUpdate();
         agent = _crowd->getAgent(_agentID);
     }
 
     if (agent)
     {
-        Mat4 wtop;
-        Vec3 pos;
-        if (_owner->getParent())
-            wtop = _owner->getParent()->getWorldToNodeTransform();
-        wtop.transformPoint(Vec3(agent->npos[0], agent->npos[1], agent->npos[2]), &pos);
-        _owner->setPosition3D(pos);
-        _state = agent->state;
-        if (_needAutoOrientation)
+        applyToNode(Vec3(agent->npos[0], agent->npos[1], agent->npos[2]),
+                    Vec3(agent->vel[0], agent->vel[1], agent->vel[2]), agent->state);
+    }
+}
+
+void NavMeshAgent::applyToNode(const Vec3& position, const Vec3& velocity, unsigned char state)
+{
+    Mat4 wtop;
+    Vec3 pos;
+    if (_owner->getParent())
+        wtop = _owner->getParent()->getWorldToNodeTransform();
+    wtop.transformPoint(position, &pos);
+    _owner->setPosition3D(pos);
+    _state = state;
+    if (_needAutoOrientation)
+    {
+        if (std::abs(velocity.x) > 0.3f || std::abs(velocity.y) > 0.3f || std::abs(velocity.z) > 0.3f)
         {
-            if (std::abs(agent->vel[0]) > 0.3f || std::abs(agent->vel[1]) > 0.3f || std::abs(agent->vel[2]) > 0.3f)
-            {
-                Vec3 axes(_rotRefAxes);
-                axes.normalize();
-                Vec3 dir;
-                wtop.transformVector(Vec3(agent->vel[0], agent->vel[1], agent->vel[2]), &dir);
-                dir.normalize();
-                float cosTheta = Vec3::dot(axes, dir);
-                Vec3 rotAxes;
-                Vec3::cross(axes, dir, &rotAxes);
-                Quaternion rot = Quaternion(rotAxes, acosf(cosTheta));
-                _owner->setRotationQuat(rot);
-            }
+            Vec3 axes(_rotRefAxes);
+            axes.normalize();
+            Vec3 dir;
+            wtop.transformVector(velocity, &dir);
+            dir.normalize();
+            float cosTheta = Vec3::dot(axes, dir);
+            Vec3 rotAxes;
+            Vec3::cross(axes, dir, &rotAxes);
+            Quaternion rot = Quaternion(rotAxes, acosf(cosTheta));
+            _owner->setRotationQuat(rot);
         }
     }
 }
@@ -386,6 +395,7 @@ void NavMeshAgent::syncToAgent()
 {
     if (_crowd)
     {
+        waitCrowdUpdate();
         auto agent     = _crowd->getEditableAgent(_agentID);
         Mat4 mat       = _owner->getNodeToWorldTransform();
         agent->npos[0] = mat.m[12];
@@ -410,16 +420,7 @@ void NavMeshAgent::syncToAgent()
 
 Vec3 NavMeshAgent::getVelocity() const
 {
-    const dtCrowdAgent* agent = nullptr;
-    if (_crowd)
-    {
-        agent = _crowd->getAgent(_agentID);
-    }
-    if (agent)
-    {
-        return Vec3(agent->vel[0], agent->vel[1], agent->vel[2]);
-    }
-    return Vec3::ZERO;
+    return getCurrentVelocity();
 }
 
 NS_AX_END
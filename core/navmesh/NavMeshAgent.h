@@ -37,6 +37,8 @@
 class dtNavMeshQuery;
 NS_AX_BEGIN
 
+class NavMesh;
+
 /**
  * @addtogroup 3d
  * @{
@@ -207,7 +209,9 @@ private:
     void removeFrom(dtCrowd* crowed);
     void setNavMeshQuery(dtNavMeshQuery* query);
     void preUpdate(float delta);
-    void postUpdate(float delta);
+    void postUpdate(const Vec3& position, const Vec3& velocity, unsigned char state);
+    void applyToNode(const Vec3& position, const Vec3& velocity, unsigned char state);
+    void waitCrowdUpdate();
     static void convertTodtAgentParam(const NavMeshAgentParam& inParam, dtCrowdAgentParams& outParam);
 
 private:
@@ -226,6 +230,8 @@ private:
     void* _userData;
     dtCrowd* _crowd;
     dtNavMeshQuery* _navMeshQuery;
+    NavMesh* _navMesh;
+    Vec3 _velocity;  // of the last crowd update
 };
 
 /** @} */
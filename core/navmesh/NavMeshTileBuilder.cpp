@@ -0,0 +1,383 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "navmesh/NavMeshTileBuilder.h"
+#if AX_USE_NAVMESH
+#    include "navmesh/NavMeshUtils.h"
+#    include "3d/AABB.h"
+#    include "base/JobSystem.h"
+#    include "recast/DetourCommon.h"
+#    include "recast/DetourNavMeshBuilder.h"
+#    include <algorithm>
+
+NS_AX_BEGIN
+
+namespace
+{
+// the same size as the allocator of the tile cache, one per build chunk
+const int BUILD_ALLOCATOR_SIZE = 32000;
+
+// frees the intermediate data of a tile build, like NavMeshTileBuildContext of the tile cache
+struct TileBuildContext
+{
+    explicit TileBuildContext(dtTileCacheAlloc* a) : layer(nullptr), lcset(nullptr), lmesh(nullptr), alloc(a) {}
+    ~TileBuildContext()
+    {
+        dtFreeTileCacheLayer(alloc, layer);
+        dtFreeTileCacheContourSet(alloc, lcset);
+        dtFreeTileCachePolyMesh(alloc, lmesh);
+    }
+    dtTileCacheLayer* layer;
+    dtTileCacheContourSet* lcset;
+    dtTileCachePolyMesh* lmesh;
+    dtTileCacheAlloc* alloc;
+};
+
+bool overlapBounds(const float* amin, const float* amax, const float* bmin, const float* bmax)
+{
+    return amin[0] <= bmax[0] && amax[0] >= bmin[0] && amin[1] <= bmax[1] && amax[1] >= bmin[1] &&
+           amin[2] <= bmax[2] && amax[2] >= bmin[2];
+}
+}  // namespace
+
+NavMeshTileBuilder::NavMeshTileBuilder(dtNavMesh* navMesh, dtTileCache* tileCache, dtTileCacheMeshProcess* meshProcess)
+    : _navMesh(navMesh), _tileCache(tileCache), _meshProcess(meshProcess), _nextVolumeId(0), _building(false)
+{}
+
+NavMeshTileBuilder::~NavMeshTileBuilder()
+{
+    wait();
+    for (auto&& build : _builds)
+    {
+        dtFree(build.navData);
+    }
+}
+
+unsigned int NavMeshTileBuilder::addBlockingVolume(const AABB& box)
+{
+    Volume volume;
+    volume.id = ++_nextVolumeId;
+    dtVcopy(volume.bmin, &box._min.x);
+    dtVcopy(volume.bmax, &box._max.x);
+    _volumes.push_back(volume);
+
+    markTiles(volume.bmin, volume.bmax);
+    return volume.id;
+}
+
+void NavMeshTileBuilder::removeBlockingVolume(unsigned int volumeId)
+{
+    auto iter =
+        std::find_if(_volumes.begin(), _volumes.end(), [volumeId](const Volume& v) { return v.id == volumeId; });
+    if (iter == _volumes.end())
+        return;
+
+    Volume volume = *iter;
+    _volumes.erase(iter);
+    markTiles(volume.bmin, volume.bmax);
+}
+
+void NavMeshTileBuilder::rebuildTiles(const AABB& box)
+{
+    markTiles(&box._min.x, &box._max.x);
+}
+
+bool NavMeshTileBuilder::isBuilding() const
+{
+    std::lock_guard<std::mutex> lk(_mutex);
+    return _building || !_dirtyTiles.empty();
+}
+
+void NavMeshTileBuilder::wait()
+{
+    std::unique_lock<std::mutex> lk(_mutex);
+    _condition.wait(lk, [this]() { return !_building; });
+}
+
+void NavMeshTileBuilder::markTiles(const float* bmin, const float* bmax)
+{
+    // walk the tile range ourselves, dtTileCache::queryTiles drops tiles past the end of its result buffer
+    const dtTileCacheParams* params = _tileCache->getParams();
+    const float tw                  = params->width * params->cs;
+    const float th                  = params->height * params->cs;
+    const int tx0                   = static_cast<int>(floorf((bmin[0] - params->orig[0]) / tw));
+    const int tx1                   = static_cast<int>(floorf((bmax[0] - params->orig[0]) / tw));
+    const int ty0                   = static_cast<int>(floorf((bmin[2] - params->orig[2]) / th));
+    const int ty1                   = static_cast<int>(floorf((bmax[2] - params->orig[2]) / th));
+
+    // one entry per layer at a location, grown while a location fills it
+    std::vector<dtCompressedTileRef> tiles(32);
+    for (int ty = ty0; ty <= ty1; ++ty)
+    {
+        for (int tx = tx0; tx <= tx1; ++tx)
+        {
+            int ntiles = 0;
+            while ((ntiles = _tileCache->getTilesAt(tx, ty, tiles.data(), static_cast<int>(tiles.size()))) ==
+                   static_cast<int>(tiles.size()))
+                tiles.resize(tiles.size() * 2);
+
+            for (int i = 0; i < ntiles; ++i)
+            {
+                float tbmin[3], tbmax[3];
+                _tileCache->calcTightTileBounds(_tileCache->getTileByRef(tiles[i])->header, tbmin, tbmax);
+                if (overlapBounds(bmin, bmax, tbmin, tbmax) &&
+                    std::find(_dirtyTiles.begin(), _dirtyTiles.end(), tiles[i]) == _dirtyTiles.end())
+                    _dirtyTiles.push_back(tiles[i]);
+            }
+        }
+    }
+}
+
+bool NavMeshTileBuilder::isCoveredByVolume(const dtCompressedTile* tile) const
+{
+    for (auto&& volume : _volumes)
+    {
+        if (overlapBounds(volume.bmin, volume.bmax, tile->header->bmin, tile->header->bmax))
+            return true;
+    }
+    return false;
+}
+
+void NavMeshTileBuilder::checkTiles()
+{
+    // the tile cache rebuilds tiles touched by obstacles from its own layers, without the volumes
+    for (auto iter = _installedTiles.begin(); iter != _installedTiles.end();)
+    {
+        const dtCompressedTile* tile = _tileCache->getTileByRef(iter->first);
+        if (!tile || !tile->header)
+        {
+            iter = _installedTiles.erase(iter);
+            continue;
+        }
+        if (_navMesh->getTileRefAt(tile->header->tx, tile->header->ty, tile->header->tlayer) != iter->second)
+        {
+            if (std::find(_dirtyTiles.begin(), _dirtyTiles.end(), iter->first) == _dirtyTiles.end())
+                _dirtyTiles.push_back(iter->first);
+            iter = _installedTiles.erase(iter);
+            continue;
+        }
+        ++iter;
+    }
+}
+
+void NavMeshTileBuilder::installTiles()
+{
+    for (auto&& build : _builds)
+    {
+        const dtTileCacheLayerHeader* header = build.tile->header;
+        const dtTileRef current              = _navMesh->getTileRefAt(header->tx, header->ty, header->tlayer);
+        if (current != build.expectedRef)
+        {
+            // replaced while building, the result may miss an obstacle
+            dtFree(build.navData);
+            if (std::find(_dirtyTiles.begin(), _dirtyTiles.end(), build.ref) == _dirtyTiles.end())
+                _dirtyTiles.push_back(build.ref);
+            continue;
+        }
+        if (dtStatusFailed(build.status))
+        {
+            AXLOG("NavMeshTileBuilder: failed to build tile %d,%d,%d", header->tx, header->ty, header->tlayer);
+            dtFree(build.navData);
+            continue;
+        }
+
+        _navMesh->removeTile(current, 0, 0);
+        if (build.navData && dtStatusFailed(_navMesh->addTile(build.navData, build.navDataSize, DT_TILE_FREE_DATA, 0, 0)))
+            dtFree(build.navData);
+
+        if (isCoveredByVolume(build.tile))
+            _installedTiles[build.ref] = _navMesh->getTileRefAt(header->tx, header->ty, header->tlayer);
+        else
+            _installedTiles.erase(build.ref);
+    }
+    _builds.clear();
+}
+
+void NavMeshTileBuilder::update()
+{
+    {
+        std::lock_guard<std::mutex> lk(_mutex);
+        if (_building)
+            return;
+    }
+
+    installTiles();
+    checkTiles();
+    if (_dirtyTiles.empty())
+        return;
+
+    for (auto&& ref : _dirtyTiles)
+    {
+        const dtCompressedTile* tile = _tileCache->getTileByRef(ref);
+        if (!tile || !tile->header)
+            continue;
+        TileBuild build;
+        build.ref         = ref;
+        build.tile        = tile;
+        build.expectedRef = _navMesh->getTileRefAt(tile->header->tx, tile->header->ty, tile->header->tlayer);
+        build.navData     = nullptr;
+        build.navDataSize = 0;
+        build.status      = DT_FAILURE;
+        _builds.push_back(build);
+    }
+    _dirtyTiles.clear();
+    if (_builds.empty())
+        return;
+
+    // the build works on copies, so volumes and obstacles may change while it runs
+    _buildVolumes = _volumes;
+    _buildObstacles.clear();
+    for (int i = 0; i < _tileCache->getObstacleCount(); ++i)
+    {
+        const dtTileCacheObstacle* ob = _tileCache->getObstacle(i);
+        if (ob->state == DT_OBSTACLE_EMPTY || ob->state == DT_OBSTACLE_REMOVING)
+            continue;
+        _buildObstacles.push_back(*ob);
+    }
+
+    _building = true;
+    JobSystem::getInstance()->enqueue([this]() {
+        JobSystem::getInstance()->parallelFor(0, _builds.size(), 1, [this](size_t begin, size_t end) {
+            LinearAllocator alloc(BUILD_ALLOCATOR_SIZE);
+            for (size_t i = begin; i < end; ++i)
+            {
+                alloc.reset();
+                buildTile(_builds[i], &alloc);
+            }
+        });
+
+        std::lock_guard<std::mutex> lk(_mutex);
+        _building = false;
+        _condition.notify_all();
+    });
+}
+
+void NavMeshTileBuilder::buildTile(TileBuild& build, dtTileCacheAlloc* alloc) const
+{
+    const dtTileCacheParams* cacheParams = _tileCache->getParams();
+    const dtCompressedTile* tile         = build.tile;
+    const int walkableClimbVx            = (int)(cacheParams->walkableClimb / cacheParams->ch);
+
+    TileBuildContext bc(alloc);
+    dtStatus status = dtDecompressTileCacheLayer(alloc, _tileCache->getCompressor(), tile->data, tile->dataSize,
+                                                 &bc.layer);
+    if (dtStatusFailed(status))
+    {
+        build.status = status;
+        return;
+    }
+
+    for (auto&& ob : _buildObstacles)
+    {
+        if (std::find(ob.touched, ob.touched + ob.ntouched, build.ref) == ob.touched + ob.ntouched)
+            continue;
+        if (ob.type == DT_OBSTACLE_CYLINDER)
+            dtMarkCylinderArea(*bc.layer, tile->header->bmin, cacheParams->cs, cacheParams->ch, ob.cylinder.pos,
+                               ob.cylinder.radius, ob.cylinder.height, 0);
+        else if (ob.type == DT_OBSTACLE_BOX)
+            dtMarkBoxArea(*bc.layer, tile->header->bmin, cacheParams->cs, cacheParams->ch, ob.box.bmin, ob.box.bmax,
+                          0);
+        else if (ob.type == DT_OBSTACLE_ORIENTED_BOX)
+            dtMarkBoxArea(*bc.layer, tile->header->bmin, cacheParams->cs, cacheParams->ch, ob.orientedBox.center,
+                          ob.orientedBox.halfExtents, ob.orientedBox.rotAux, 0);
+    }
+
+    for (auto&& volume : _buildVolumes)
+    {
+        if (overlapBounds(volume.bmin, volume.bmax, tile->header->bmin, tile->header->bmax))
+            dtMarkBoxArea(*bc.layer, tile->header->bmin, cacheParams->cs, cacheParams->ch, volume.bmin, volume.bmax,
+                          0);
+    }
+
+    status = dtBuildTileCacheRegions(alloc, *bc.layer, walkableClimbVx);
+    if (dtStatusFailed(status))
+    {
+        build.status = status;
+        return;
+    }
+
+    bc.lcset = dtAllocTileCacheContourSet(alloc);
+    if (!bc.lcset)
+    {
+        build.status = DT_FAILURE | DT_OUT_OF_MEMORY;
+        return;
+    }
+    status = dtBuildTileCacheContours(alloc, *bc.layer, walkableClimbVx, cacheParams->maxSimplificationError,
+                                      *bc.lcset);
+    if (dtStatusFailed(status))
+    {
+        build.status = status;
+        return;
+    }
+
+    bc.lmesh = dtAllocTileCachePolyMesh(alloc);
+    if (!bc.lmesh)
+    {
+        build.status = DT_FAILURE | DT_OUT_OF_MEMORY;
+        return;
+    }
+    status = dtBuildTileCachePolyMesh(alloc, *bc.lcset, *bc.lmesh);
+    if (dtStatusFailed(status))
+    {
+        build.status = status;
+        return;
+    }
+
+    // an empty mesh leaves the location empty
+    if (!bc.lmesh->npolys)
+    {
+        build.status = DT_SUCCESS;
+        return;
+    }
+
+    dtNavMeshCreateParams params;
+    memset(&params, 0, sizeof(params));
+    params.verts          = bc.lmesh->verts;
+    params.vertCount      = bc.lmesh->nverts;
+    params.polys          = bc.lmesh->polys;
+    params.polyAreas      = bc.lmesh->areas;
+    params.polyFlags      = bc.lmesh->flags;
+    params.polyCount      = bc.lmesh->npolys;
+    params.nvp            = DT_VERTS_PER_POLYGON;
+    params.walkableHeight = cacheParams->walkableHeight;
+    params.walkableRadius = cacheParams->walkableRadius;
+    params.walkableClimb  = cacheParams->walkableClimb;
+    params.tileX          = tile->header->tx;
+    params.tileY          = tile->header->ty;
+    params.tileLayer      = tile->header->tlayer;
+    params.cs             = cacheParams->cs;
+    params.ch             = cacheParams->ch;
+    params.buildBvTree    = false;
+    dtVcopy(params.bmin, tile->header->bmin);
+    dtVcopy(params.bmax, tile->header->bmax);
+
+    if (_meshProcess)
+        _meshProcess->process(&params, bc.lmesh->areas, bc.lmesh->flags);
+
+    build.status = dtCreateNavMeshData(&params, &build.navData, &build.navDataSize) ? DT_SUCCESS : DT_FAILURE;
+}
+
+NS_AX_END
+
+#endif  // AX_USE_NAVMESH
@@ -0,0 +1,132 @@
+/****************************************************************************
+ Copyright (c) 2023 Bytedance Inc.
+
+ https://axmolengine.github.io/
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCNAV_MESH_TILE_BUILDER_H__
+#define __CCNAV_MESH_TILE_BUILDER_H__
+
+#include "base/Config.h"
+#if AX_USE_NAVMESH
+
+#    include "platform/PlatformMacros.h"
+#    include "recast/DetourNavMesh.h"
+#    include "recast/DetourTileCache.h"
+#    include "recast/DetourTileCacheBuilder.h"
+#    include <vector>
+#    include <mutex>
+#    include <condition_variable>
+#    include <unordered_map>
+
+NS_AX_BEGIN
+
+/**
+ * @addtogroup 3d
+ * @{
+ */
+class AABB;
+
+/**
+ * @brief NavMeshTileBuilder: rebuilds the tiles of a navmesh on the JobSystem and swaps them in.
+ *
+ * The walkable surface comes from the compressed layers of the tile cache, blocking volumes and the tile cache
+ * obstacles are carved out of it when a tile is built. The dirty tiles are built in parallel by a job while the
+ * frames go on, and update installs the finished ones.
+ */
+class AX_DLL NavMeshTileBuilder
+{
+public:
+    NavMeshTileBuilder(dtNavMesh* navMesh, dtTileCache* tileCache, dtTileCacheMeshProcess* meshProcess);
+    ~NavMeshTileBuilder();
+
+    /** Blocks the navmesh inside a box, i.e. a placed building, returns the id of the volume. */
+    unsigned int addBlockingVolume(const AABB& box);
+
+    /** Removes a blocking volume, i.e. a destroyed wall, the navmesh below it becomes walkable again. */
+    void removeBlockingVolume(unsigned int volumeId);
+
+    /** Rebuilds the tiles overlapping a box. */
+    void rebuildTiles(const AABB& box);
+
+    /**
+     * Installs the tiles of a finished build and starts the next one.
+     * Call it when nothing else reads the navmesh, the build itself never touches it.
+     */
+    void update();
+
+    /** Checks whether tiles are waiting to be built or being built. */
+    bool isBuilding() const;
+
+    /** Waits for the running build, if any. */
+    void wait();
+
+private:
+    struct Volume
+    {
+        unsigned int id;
+        float bmin[3];
+        float bmax[3];
+    };
+
+    struct TileBuild
+    {
+        dtCompressedTileRef ref;
+        const dtCompressedTile* tile;
+        dtTileRef expectedRef;  // the navmesh tile when the build started
+        unsigned char* navData;
+        int navDataSize;
+        dtStatus status;
+    };
+
+    void markTiles(const float* bmin, const float* bmax);
+    void checkTiles();
+    void installTiles();
+    void buildTile(TileBuild& build, dtTileCacheAlloc* alloc) const;
+    bool isCoveredByVolume(const dtCompressedTile* tile) const;
+
+    dtNavMesh* _navMesh;
+    dtTileCache* _tileCache;
+    dtTileCacheMeshProcess* _meshProcess;
+
+    std::vector<Volume> _volumes;
+    unsigned int _nextVolumeId;
+    std::vector<dtCompressedTileRef> _dirtyTiles;
+    // the navmesh tiles installed under volumes, to notice when the tile cache rebuilds them without the volumes
+    std::unordered_map<dtCompressedTileRef, dtTileRef> _installedTiles;
+
+    // owned by the running build
+    std::vector<TileBuild> _builds;
+    std::vector<Volume> _buildVolumes;
+    std::vector<dtTileCacheObstacle> _buildObstacles;
+
+    bool _building;
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+};
+
+/** @} */
+
+NS_AX_END
+
+#endif  // AX_USE_NAVMESH
+
+#endif  // __CCNAV_MESH_TILE_BUILDER_H__
@@ -30,6 +30,7 @@
 
 #include "network/HttpClient.h"
 #include <errno.h>
+#include <algorithm>
 #include "base/Utils.h"
 #include "base/Director.h"
 #include "platform/FileUtils.h"
@@ -44,6 +45,16 @@ namespace network
 
 static HttpClient* _httpClient = nullptr;  // pointer to singleton
 
+static std::string __makePoolKey(const Uri& uri)
+{
+    std::string key{uri.getScheme()};
+    key += "://";
+    key += uri.getHost();
+    key += ':';
+    key += std::to_string(uri.getPort());
+    return key;
+}
+
 template <typename _Cont, typename _Fty>
 static void __clearQueueUnsafe(_Cont& queue, _Fty pred)
 {
@@ -117,6 +128,13 @@ HttpClient::HttpClient()
     , _dispatchOnWorkThread(false)
     , _timeoutForConnect(30)
     , _timeoutForRead(60)
+    , _maxConnectionsPerHost(DEFAULT_MAX_CONNECTIONS_PER_HOST)
+    , _idleTimeout(DEFAULT_IDLE_TIMEOUT)
+    , _maxPipelineDepth(1)
+    , _openedConnections(0)
+    , _reusedConnections(0)
+    , _pipelinedRequests(0)
+    , _retriedRequests(0)
     , _cookie(nullptr)
     , _clearResponsePredicate(nullptr)
 {
@@ -142,6 +160,13 @@ HttpClient::~HttpClient()
     _scheduler->unscheduleAllForTarget(this);
     delete _service;
 
+    for (auto& connection : _connections)
+    {
+        for (auto response : connection.responses)
+            response->release();
+        connection.responses.clear();
+    }
+
     clearPendingResponseQueue();
     clearFinishedResponseQueue();
     if (_cookie)
@@ -181,6 +206,9 @@ void HttpClient::tickInput()
 void HttpClient::handleNetworkStatusChanged()
 {
     _service->set_option(YOPT_S_DNS_DIRTY, 1);
+
+    // idle connections were established over the previous network
+    closeIdleConnections();
 }
 
 void HttpClient::setNameServers(std::string_view servers)
@@ -200,8 +228,18 @@ void HttpClient::send(HttpRequest* request)
 
     auto response = new HttpResponse(request);
     response->setLocation(request->getUrl(), false);
-    processResponse(response, -1);
-    response->release();
+    if (!response->validateUri())
+    {
+        finishResponse(response);
+        return;
+    }
+
+    // connections are only touched on the network thread, the request stays pending until it takes one there
+    _pendingResponseQueue.emplace_back(response);
+    _service->schedule(std::chrono::microseconds(0), [this](io_service&) {
+        processPendingResponses();
+        return true;
+    });
 }
 
 int HttpClient::tryTakeAvailChannel()
@@ -216,186 +254,394 @@ int HttpClient::tryTakeAvailChannel()
     return -1;
 }
 
-void HttpClient::processResponse(HttpResponse* response, int channelIndex)
+void HttpClient::processResponse(HttpResponse* response)
 {
     response->retain();
 
     if (response->validateUri())
     {
-        if (channelIndex == -1)
-            channelIndex = tryTakeAvailChannel();
-
-        if (channelIndex != -1)
-        {
-            auto channelHandle = _service->channel_at(channelIndex);
-            auto& requestUri = response->getRequestUri();
-            channelHandle->ud_.ptr = response;
-            _service->set_option(YOPT_C_REMOTE_ENDPOINT, channelIndex, requestUri.getHost().data(),
-                                 (int)requestUri.getPort());
-            if (requestUri.isSecure())
-                _service->open(channelIndex, YCK_SSL_CLIENT);
-            else
-                _service->open(channelIndex, YCK_TCP_CLIENT);
-        }
-        else
+        if (!tryAssignConnection(response))
             _pendingResponseQueue.emplace_back(response);
     }
     else
         finishResponse(response);
 }
 
-void HttpClient::handleNetworkEvent(yasio::io_event* event)
+void HttpClient::processPendingResponses()
 {
-    int channelIndex       = event->cindex();
-    auto channel           = _service->channel_at(event->cindex());
-    HttpResponse* response = (HttpResponse*)channel->ud_.ptr;
-    assert(response);
+    auto lck = _pendingResponseQueue.get_lock();
+    for (auto it = _pendingResponseQueue.unsafe_begin(); it != _pendingResponseQueue.unsafe_end();)
+    {
+        if (tryAssignConnection(*it))
+            it = _pendingResponseQueue.unsafe_erase(it);
+        else
+            ++it;
+    }
+}
 
-    bool responseFinished = response->isFinished();
-    switch (event->kind())
+bool HttpClient::tryAssignConnection(HttpResponse* response)
+{
+    auto host = __makePoolKey(response->getRequestUri());
+
+    int hostConnections = 0;
+    int pipelineIndex   = -1;
+    for (int i = 0; i < HttpClient::MAX_CHANNELS; ++i)
     {
-    case YEK_ON_PACKET:
-        if (!responseFinished)
+        auto& connection = _connections[i];
+        if (connection.closing || connection.host != host)
+            continue;
+
+        ++hostConnections;
+        if (connection.transport && connection.responses.empty())
+        {  // reuse the idle connection
+            ++_reusedConnections;
+            connection.responses.emplace_back(response);
+            writeRequest(i, response);
+            return true;
+        }
+        if (isPipelinable(connection, response) &&
+            (pipelineIndex == -1 || connection.responses.size() < _connections[pipelineIndex].responses.size()))
+            pipelineIndex = i;
+    }
+
+    if (hostConnections < _maxConnectionsPerHost)
+    {
+        int channelIndex = tryTakeAvailChannel();
+        if (channelIndex != -1)
         {
-            auto&& pkt = event->packet_view();
-            response->handleInput(pkt.data(), pkt.size());
+            openConnection(channelIndex, host, response);
+            return true;
         }
-        if (response->isFinished())
+    }
+
+    if (pipelineIndex != -1)
+    {
+        ++_pipelinedRequests;
+        _connections[pipelineIndex].responses.emplace_back(response);
+        writeRequest(pipelineIndex, response);
+        return true;
+    }
+
+    if (hostConnections < _maxConnectionsPerHost)
+    {  // all channels are taken, make room by closing an idle connection of another host
+        int idleIndex = -1;
+        for (int i = 0; i < HttpClient::MAX_CHANNELS; ++i)
         {
-            response->updateInternalCode(yasio::errc::eof);
-            _service->close(event->cindex());
+            auto& connection = _connections[i];
+            if (connection.closing)
+                return false;  // a channel is about to be recycled anyway
+            if (idleIndex == -1 && connection.transport && connection.responses.empty())
+                idleIndex = i;
         }
+        if (idleIndex != -1)
+            closeConnection(idleIndex);
+    }
+    return false;
+}
+
+bool HttpClient::isPipelinable(const Connection& connection, HttpResponse* response) const
+{
+    // only idempotent requests, they are resent if the connection closes before their responses arrive
+    if (!connection.transport || !connection.reusable ||
+        static_cast<int>(connection.responses.size()) >= _maxPipelineDepth ||
+        response->getHttpRequest()->getRequestType() != HttpRequest::Type::GET)
+        return false;
+
+    for (auto queued : connection.responses)
+    {
+        if (queued->getHttpRequest()->getRequestType() != HttpRequest::Type::GET)
+            return false;
+    }
+    return true;
+}
+
+void HttpClient::openConnection(int channelIndex, std::string_view host, HttpResponse* response)
+{
+    auto& connection = _connections[channelIndex];
+    connection.host  = host;
+    connection.responses.emplace_back(response);
+
+    auto& requestUri = response->getRequestUri();
+    _service->set_option(YOPT_C_REMOTE_ENDPOINT, channelIndex, requestUri.getHost().data(),
+                         (int)requestUri.getPort());
+    if (requestUri.isSecure())
+        _service->open(channelIndex, YCK_SSL_CLIENT);
+    else
+        _service->open(channelIndex, YCK_TCP_CLIENT);
+}
+
+void HttpClient::writeRequest(int channelIndex, HttpResponse* response)
+{
+    auto& connection = _connections[channelIndex];
+
+    obstream obs;
+    bool usePostData = false;
+    auto request     = response->getHttpRequest();
+    switch (request->getRequestType())
+    {
+    case HttpRequest::Type::GET:
+        obs.write_bytes("GET");
         break;
-    case YEK_ON_OPEN:
-        if (event->status() == 0)
-        {
-            obstream obs;
-            bool usePostData = false;
-            auto request     = response->getHttpRequest();
-            switch (request->getRequestType())
-            {
-            case HttpRequest::Type::GET:
-                obs.write_bytes("GET");
-                break;
-            case HttpRequest::Type::POST:
-                obs.write_bytes("POST");
-                usePostData = true;
-                break;
-            case HttpRequest::Type::DELETE:
-                obs.write_bytes("DELETE");
-                break;
-            case HttpRequest::Type::PUT:
-                obs.write_bytes("PUT");
-                usePostData = true;
-                break;
-            default:
-                obs.write_bytes("GET");
-                break;
-            }
-            obs.write_bytes(" ");
+    case HttpRequest::Type::POST:
+        obs.write_bytes("POST");
+        usePostData = true;
+        break;
+    case HttpRequest::Type::DELETE:
+        obs.write_bytes("DELETE");
+        break;
+    case HttpRequest::Type::PUT:
+        obs.write_bytes("PUT");
+        usePostData = true;
+        break;
+    default:
+        obs.write_bytes("GET");
+        break;
+    }
+    obs.write_bytes(" ");
 
-            auto& uri = response->getRequestUri();
-            obs.write_bytes(uri.getPathEtc());
+    auto& uri = response->getRequestUri();
+    obs.write_bytes(uri.getPathEtc());
 
-            obs.write_bytes(" HTTP/1.1\r\n");
+    obs.write_bytes(" HTTP/1.1\r\n");
 
-            obs.write_bytes("Host: ");
-            obs.write_bytes(uri.getHost());
+    obs.write_bytes("Host: ");
+    obs.write_bytes(uri.getHost());
+    obs.write_bytes("\r\n");
+
+    // process custom headers
+    struct HeaderFlag
+    {
+        enum
+        {
+            UESR_AGENT   = 1,
+            CONTENT_TYPE = 1 << 1,
+            ACCEPT       = 1 << 2,
+            CONNECTION   = 1 << 3,
+        };
+    };
+    int headerFlags = 0;
+    auto& headers   = request->getHeaders();
+    if (!headers.empty())
+    {
+        using namespace cxx17;  // for string_view literal
+        for (auto&& header : headers)
+        {
+            obs.write_bytes(header);
             obs.write_bytes("\r\n");
 
-            // process custom headers
-            struct HeaderFlag
-            {
-                enum
-                {
-                    UESR_AGENT   = 1,
-                    CONTENT_TYPE = 1 << 1,
-                    ACCEPT       = 1 << 2,
-                };
-            };
-            int headerFlags = 0;
-            auto& headers   = request->getHeaders();
-            if (!headers.empty())
+            if (cxx20::ic::starts_with(cxx17::string_view{header}, "User-Agent:"_sv))
+                headerFlags |= HeaderFlag::UESR_AGENT;
+            else if (cxx20::ic::starts_with(cxx17::string_view{header}, "Content-Type:"_sv))
+                headerFlags |= HeaderFlag::CONTENT_TYPE;
+            else if (cxx20::ic::starts_with(cxx17::string_view{header}, "Accept:"_sv))
+                headerFlags |= HeaderFlag::ACCEPT;
+            else if (cxx20::ic::starts_with(cxx17::string_view{header}, "Connection:"_sv))
             {
-                using namespace cxx17;  // for string_view literal
-                for (auto&& header : headers)
-                {
-                    obs.write_bytes(header);
-                    obs.write_bytes("\r\n");
-
-                    if (cxx20::ic::starts_with(cxx17::string_view{header}, "User-Agent:"_sv))
-                        headerFlags |= HeaderFlag::UESR_AGENT;
-                    else if (cxx20::ic::starts_with(cxx17::string_view{header}, "Content-Type:"_sv))
-                        headerFlags |= HeaderFlag::CONTENT_TYPE;
-                    else if (cxx20::ic::starts_with(cxx17::string_view{header}, "Accept:"_sv))
-                        headerFlags |= HeaderFlag::ACCEPT;
-                }
+                headerFlags |= HeaderFlag::CONNECTION;
+                if (cxx20::ic::ends_with(cxx17::string_view{header}, "close"_sv))
+                    connection.reusable = false;
             }
+        }
+    }
 
-            if (_cookie)
-            {
-                auto cookies = _cookie->checkAndGetFormatedMatchCookies(uri);
-                if (!cookies.empty())
-                {
-                    obs.write_bytes("Cookie: ");
-                    obs.write_bytes(cookies);
-                }
-            }
+    if (_cookie)
+    {
+        auto cookies = _cookie->checkAndGetFormatedMatchCookies(uri);
+        if (!cookies.empty())
+        {
+            obs.write_bytes("Cookie: ");
+            obs.write_bytes(cookies);
+        }
+    }
 
-            if (!(headerFlags & HeaderFlag::UESR_AGENT))
-                obs.write_bytes("User-Agent: yasio-http\r\n");
+    if (!(headerFlags & HeaderFlag::UESR_AGENT))
+        obs.write_bytes("User-Agent: yasio-http\r\n");
 
-            if (!(headerFlags & HeaderFlag::ACCEPT))
-                obs.write_bytes("Accept: */*;q=0.8\r\n");
+    if (!(headerFlags & HeaderFlag::ACCEPT))
+        obs.write_bytes("Accept: */*;q=0.8\r\n");
 
-            if (usePostData)
-            {
-                if (!(headerFlags & HeaderFlag::CONTENT_TYPE))
-                    obs.write_bytes("Content-Type: application/x-www-form-urlencoded;charset=UTF-8\r\n");
-
-                char strContentLength[128] = {0};
-                auto requestData           = request->getRequestData();
-                auto requestDataSize       = request->getRequestDataSize();
-                snprintf(strContentLength, sizeof(strContentLength), "Content-Length: %d\r\n\r\n",
-                         static_cast<int>(requestDataSize));
-                obs.write_bytes(strContentLength);
-
-                if (requestData && requestDataSize > 0)
-                    obs.write_bytes(cxx17::string_view{requestData, static_cast<size_t>(requestDataSize)});
-            }
-            else
-            {
-                obs.write_bytes("\r\n");
-            }
+    if (!(headerFlags & HeaderFlag::CONNECTION) && _idleTimeout <= 0)
+    {
+        obs.write_bytes("Connection: close\r\n");
+        connection.reusable = false;
+    }
+
+    if (usePostData)
+    {
+        if (!(headerFlags & HeaderFlag::CONTENT_TYPE))
+            obs.write_bytes("Content-Type: application/x-www-form-urlencoded;charset=UTF-8\r\n");
+
+        char strContentLength[128] = {0};
+        auto requestData           = request->getRequestData();
+        auto requestDataSize       = request->getRequestDataSize();
+        snprintf(strContentLength, sizeof(strContentLength), "Content-Length: %d\r\n\r\n",
+                 static_cast<int>(requestDataSize));
+        obs.write_bytes(strContentLength);
+
+        if (requestData && requestDataSize > 0)
+            obs.write_bytes(cxx17::string_view{requestData, static_cast<size_t>(requestDataSize)});
+    }
+    else
+    {
+        obs.write_bytes("\r\n");
+    }
+
+    _service->write(connection.transport, std::move(obs.buffer()));
+
+    // the pipelined ones start their timer once the responses before them arrived
+    if (response == connection.responses.front())
+        startReadTimer(channelIndex);
+}
+
+void HttpClient::closeConnection(int channelIndex)
+{
+    auto& connection = _connections[channelIndex];
+    if (connection.closing)
+        return;
+
+    connection.closing = true;
+    _service->close(channelIndex);
+}
 
-            _service->write(event->transport(), std::move(obs.buffer()));
+void HttpClient::startReadTimer(int channelIndex)
+{
+    auto& timerForRead = _service->channel_at(channelIndex)->get_user_timer();
+    timerForRead.cancel();
+    timerForRead.expires_from_now(std::chrono::seconds(this->_timeoutForRead));
+    timerForRead.async_wait([this, channelIndex](io_service&) {
+        auto& connection = _connections[channelIndex];
+        if (!connection.responses.empty())
+            connection.responses.front()->updateInternalCode(yasio::errc::read_timeout);
+        closeConnection(channelIndex);  // timeout
+        return true;
+    });
+}
+
+void HttpClient::startIdleTimer(int channelIndex)
+{
+    auto& timerForIdle = _service->channel_at(channelIndex)->get_user_timer();
+    timerForIdle.cancel();
+    timerForIdle.expires_from_now(std::chrono::seconds(this->_idleTimeout));
+    timerForIdle.async_wait([this, channelIndex](io_service&) {
+        closeConnection(channelIndex);
+        return true;
+    });
+}
 
-            auto& timerForRead = channel->get_user_timer();
-            timerForRead.cancel();
-            timerForRead.expires_from_now(std::chrono::seconds(this->_timeoutForRead));
-            timerForRead.async_wait([=](io_service& s) {
-                response->updateInternalCode(yasio::errc::read_timeout);
-                s.close(channelIndex);  // timeout
-                return true;
-            });
+void HttpClient::handleNetworkEvent(yasio::io_event* event)
+{
+    int channelIndex = event->cindex();
+    auto& connection = _connections[channelIndex];
+
+    switch (event->kind())
+    {
+    case YEK_ON_PACKET:
+    {
+        auto&& pkt = event->packet_view();
+        handleNetworkInput(channelIndex, pkt.data(), static_cast<size_t>(pkt.size()));
+        break;
+    }
+    case YEK_ON_OPEN:
+        if (event->status() == 0)
+        {
+            connection.transport = event->transport();
+            ++_openedConnections;
+            for (auto response : connection.responses)
+                writeRequest(channelIndex, response);
         }
         else
         {
-            handleNetworkEOF(response, channel, event->status());
+            handleNetworkEOF(channelIndex, event->status());
         }
         break;
     case YEK_ON_CLOSE:
-        handleNetworkEOF(response, channel, event->status());
+        handleNetworkEOF(channelIndex, event->status());
         break;
     }
 }
 
-void HttpClient::handleNetworkEOF(HttpResponse* response, yasio::io_channel* channel, int internalErrorCode)
+void HttpClient::handleNetworkInput(int channelIndex, const char* data, size_t size)
 {
-    channel->ud_.ptr = nullptr;
+    auto& connection = _connections[channelIndex];
+    while (size > 0 && !connection.responses.empty() && !connection.closing)
+    {
+        auto response = connection.responses.front();
+        auto consumed = response->handleInput(data, size);
+        data += consumed;
+        size -= consumed;
+        if (!response->isFinished())
+            break;
+
+        connection.responses.pop_front();
+        ++connection.completed;
+        response->updateInternalCode(yasio::errc::eof);
+
+        bool idle = false;
+        if (!response->isKeepAlive() || !connection.reusable || _idleTimeout <= 0)
+            closeConnection(channelIndex);  // the pipelined requests are resent once it's closed
+        else if (!connection.responses.empty())
+            startReadTimer(channelIndex);
+        else
+        {
+            startIdleTimer(channelIndex);
+            idle = true;
+        }
 
-    channel->get_user_timer().cancel();
-    response->updateInternalCode(internalErrorCode);
+        dispatchResponse(response);
+
+        if (idle)
+        {  // the rest of the packet isn't for any request, let the waiting requests take the connection
+            processPendingResponses();
+            break;
+        }
+    }
+}
+
+void HttpClient::handleNetworkEOF(int channelIndex, int internalErrorCode)
+{
+    _service->channel_at(channelIndex)->get_user_timer().cancel();
+
+    auto& connection = _connections[channelIndex];
+    auto responses   = std::move(connection.responses);
+    bool wasReused   = connection.completed > 0;
+    connection       = Connection{};
+
+    // recycle channel
+    _availChannelQueue.push_front(channelIndex);
+
+    for (auto it = responses.begin(); it != responses.end(); ++it)
+    {
+        auto response = *it;
+        if (it == responses.begin())
+        {
+            // the server may close a kept alive connection at the moment the request was written,
+            // resend it once if nothing was received, only if idempotent since the server may have processed it
+            auto requestType = response->getHttpRequest()->getRequestType();
+            bool stale       = wasReused && !response->_retried && response->_receivedBytes == 0 &&
+                               response->getInternalCode() == 0 &&
+                               (requestType == HttpRequest::Type::GET || requestType == HttpRequest::Type::DELETE);
+            if (!stale)
+            {
+                response->handleEOF();
+                response->updateInternalCode(internalErrorCode);
+                dispatchResponse(response);
+                continue;
+            }
+            response->_retried = true;
+            ++_retriedRequests;
+        }
+
+        // never answered, resend it on another connection
+        processResponse(response);
+        response->release();
+    }
+
+    // try process pending response
+    processPendingResponses();
+}
+
+void HttpClient::dispatchResponse(HttpResponse* response)
+{
     auto responseCode = response->getResponseCode();
     switch (responseCode)
     {
@@ -404,28 +650,12 @@ void HttpClient::handleNetworkEOF(HttpResponse* response, yasio::io_channel* cha
     case 307:
         if (response->tryRedirect())
         {
-            processResponse(response, channel->index());
+            processResponse(response);
             response->release();
             break;
         }
     default:
         finishResponse(response);
-
-        // try process pending response
-        auto lck = _pendingResponseQueue.get_lock();
-        if (!_pendingResponseQueue.unsafe_empty())
-        {
-            auto pendingResponse = _pendingResponseQueue.unsafe_front();
-            _pendingResponseQueue.unsafe_pop_front();
-            lck.unlock();
-
-            processResponse(pendingResponse, channel->index());
-            pendingResponse->release();
-        }
-        else
-        {  // recycle channel
-            _availChannelQueue.push_front(channel->index());
-        }
     }
 }
 
@@ -508,6 +738,44 @@ int HttpClient::getTimeoutForRead()
     return _timeoutForRead;
 }
 
+void HttpClient::setMaxConnectionsPerHost(int value)
+{
+    _maxConnectionsPerHost = std::clamp(value, 1, HttpClient::MAX_CHANNELS);
+}
+
+void HttpClient::setIdleTimeout(int value)
+{
+    _idleTimeout = (std::max)(value, 0);
+}
+
+void HttpClient::setMaxPipelineDepth(int value)
+{
+    _maxPipelineDepth = (std::max)(value, 1);
+}
+
+void HttpClient::closeIdleConnections()
+{
+    _service->schedule(std::chrono::microseconds(0), [this](io_service&) {
+        for (int i = 0; i < HttpClient::MAX_CHANNELS; ++i)
+        {
+            auto& connection = _connections[i];
+            if (connection.transport && connection.responses.empty())
+                closeConnection(i);
+        }
+        return true;
+    });
+}
+
+HttpClient::ConnectionStats HttpClient::getConnectionStats() const
+{
+    ConnectionStats stats;
+    stats.opened    = _openedConnections;
+    stats.reused    = _reusedConnections;
+    stats.pipelined = _pipelinedRequests;
+    stats.retried   = _retriedRequests;
+    return stats;
+}
+
 std::string_view HttpClient::getCookieFilename()
 {
     std::lock_guard<std::recursive_mutex> lock(_cookieFileMutex);
@@ -32,6 +32,7 @@
 #include <thread>
 #include <condition_variable>
 #include <deque>
+#include <atomic>
 
 #include "base/Scheduler.h"
 #include "network/HttpRequest.h"
@@ -55,6 +56,9 @@ namespace network
  *
  * Once the request completed, a callback will issued in main thread when it provided during make request.
  *
+ * Connections are kept alive and pooled per host (scheme, host and port), a request to a host with an idle
+ * connection is written to it directly instead of paying another TCP and TLS handshake.
+ *
  * @lua NA
  */
 class AX_DLL HttpClient
@@ -65,6 +69,24 @@ public:
      */
     static const int MAX_CHANNELS       = 21;
 
+    /**
+     * Default limit of connections open to the same host, idle ones included.
+     */
+    static const int DEFAULT_MAX_CONNECTIONS_PER_HOST = 6;
+
+    /**
+     * Default seconds a kept alive connection stays open without requests.
+     */
+    static const int DEFAULT_IDLE_TIMEOUT = 15;
+
+    struct ConnectionStats
+    {
+        unsigned int opened    = 0;  // connections established
+        unsigned int reused    = 0;  // requests written to an already established connection
+        unsigned int pipelined = 0;  // requests written before the previous response of the connection arrived
+        unsigned int retried   = 0;  // GET and DELETE requests resent after the server closed an idle connection
+    };
+
     /**
      * Get instance of HttpClient.
      *
@@ -149,6 +171,42 @@ public:
      */
     int getTimeoutForRead();
 
+    /**
+     * Limits how many connections could be open to the same host, requests beyond it wait for a connection
+     * of that host to become idle.
+     *
+     * @param value the limit, clamped to [1, MAX_CHANNELS].
+     */
+    void setMaxConnectionsPerHost(int value);
+
+    int getMaxConnectionsPerHost() const { return _maxConnectionsPerHost; }
+
+    /**
+     * Set how long in seconds a kept alive connection waits for the next request before it's closed.
+     *
+     * @param value the idle timeout, 0 disables keep-alive and closes every connection after its response.
+     */
+    void setIdleTimeout(int value);
+
+    int getIdleTimeout() const { return _idleTimeout; }
+
+    /**
+     * Set how many GET requests could be written to one connection before their responses arrive.
+     * Pipelining only kicks in once a host reached the connection limit, not every server supports it.
+     *
+     * @param value the pipeline depth, 1 (default) disables pipelining.
+     */
+    void setMaxPipelineDepth(int value);
+
+    int getMaxPipelineDepth() const { return _maxPipelineDepth; }
+
+    /**
+     * Close all idle connections, i.e. when the app enters background.
+     */
+    void closeIdleConnections();
+
+    ConnectionStats getConnectionStats() const;
+
     HttpCookie* getCookie() const { return _cookie; }
 
     std::recursive_mutex& getCookieFileMutex() { return _cookieFileMutex; }
@@ -197,16 +255,50 @@ public:
     yasio::io_service* getInternalService();
 
 private:
+    /**
+     * The state of a channel, all members are only touched on the network thread.
+     */
+    struct Connection
+    {
+        std::string host;                              // the pool key of the connection, empty if the channel is free
+        yasio::transport_handle_t transport = nullptr;  // set once connected
+        std::deque<HttpResponse*> responses;            // in request order, the front one is being received
+        int completed = 0;                              // responses received over the connection
+        bool reusable = true;                           // false if a request asked to close the connection
+        bool closing  = false;
+    };
+
     HttpClient();
     virtual ~HttpClient();
 
-    void processResponse(HttpResponse* response, int channelIndex);
+    void processResponse(HttpResponse* response);
+
+    void processPendingResponses();
+
+    // takes over the reference of the response if it returns true
+    bool tryAssignConnection(HttpResponse* response);
 
     int tryTakeAvailChannel();
 
+    bool isPipelinable(const Connection& connection, HttpResponse* response) const;
+
+    void openConnection(int channelIndex, std::string_view host, HttpResponse* response);
+
+    void writeRequest(int channelIndex, HttpResponse* response);
+
+    void closeConnection(int channelIndex);
+
+    void startReadTimer(int channelIndex);
+
+    void startIdleTimer(int channelIndex);
+
     void handleNetworkEvent(yasio::io_event* event);
 
-    void handleNetworkEOF(HttpResponse* response, yasio::io_channel* channel, int internalErrorCode);
+    void handleNetworkInput(int channelIndex, const char* data, size_t size);
+
+    void handleNetworkEOF(int channelIndex, int internalErrorCode);
+
+    void dispatchResponse(HttpResponse* response);
 
     void tickInput();
 
@@ -234,6 +326,17 @@ private:
 
     ConcurrentDeque<int> _availChannelQueue;
 
+    Connection _connections[MAX_CHANNELS];
+
+    std::atomic<int> _maxConnectionsPerHost;
+    std::atomic<int> _idleTimeout;
+    std::atomic<int> _maxPipelineDepth;
+
+    std::atomic<unsigned int> _openedConnections;
+    std::atomic<unsigned int> _reusedConnections;
+    std::atomic<unsigned int> _pipelinedRequests;
+    std::atomic<unsigned int> _retriedRequests;
+
     std::string _cookieFilename;
     std::recursive_mutex _cookieFileMutex;
 
@@ -143,15 +143,39 @@ private:
      */
     bool isFinished() const { return _finished; }
 
-    void handleInput(const char* d, size_t n)
+    /**
+     * Parses received data, returns how many bytes belong to this response, the rest of a pipelined
+     * connection's packet is the start of the next response.
+     */
+    size_t handleInput(const char* d, size_t n)
     {
         enum llhttp_errno err = llhttp_execute(&_context, d, n);
-        if (err != HPE_OK)
+        if (err == HPE_PAUSED)  // paused by on_complete at the end of the message
+            n = static_cast<size_t>(llhttp_get_error_pos(&_context) - d);
+        else if (err != HPE_OK)
         {
-            _finished = true;
+            _finished  = true;
+            _keepAlive = false;
         }
+        _receivedBytes += n;
+        return n;
     }
 
+    /**
+     * Called when the connection closed before the response finished, completes a response whose body is
+     * delimited by the end of the connection.
+     */
+    void handleEOF()
+    {
+        if (!_finished && _receivedBytes > 0)
+            llhttp_finish(&_context);
+    }
+
+    /**
+     * Whether the connection can take another request after this response.
+     */
+    bool isKeepAlive() const { return _keepAlive; }
+
     bool tryRedirect()
     {
         if ((_redirectCount < HttpRequest::MAX_REDIRECT_COUNT))
@@ -194,8 +218,10 @@ private:
             _finished = false;
             _responseData.clear();
             _currentHeader.clear();
-            _responseCode = -1;
-            _internalCode = 0;
+            _responseCode  = -1;
+            _internalCode  = 0;
+            _receivedBytes = 0;
+            _keepAlive     = false;
 
             /* Initialize user callbacks and settings */
             llhttp_settings_init(&_contextSettings);
@@ -260,7 +286,8 @@ private:
         auto thiz           = (HttpResponse*)context->data;
         thiz->_responseCode = context->status_code;
         thiz->_finished     = true;
-        return 0;
+        thiz->_keepAlive    = llhttp_should_keep_alive(context) != 0;
+        return HPE_PAUSED;
     }
 
 protected:
@@ -276,6 +303,9 @@ protected:
     ResponseHeaderMap _responseHeaders;  /// the returned raw header data. You can also dump it as a string
     int _responseCode = -1;              /// the status code returned from server, e.g. 200, 404
     int _internalCode = 0;               /// the ret code of perform
+    size_t _receivedBytes = 0;           /// how many bytes of the connection were parsed by this response
+    bool _keepAlive       = false;       /// whether the server keeps the connection open after this response
+    bool _retried         = false;       /// whether the request was resent after a kept alive connection closed
     llhttp_t _context;
     llhttp_settings_t _contextSettings;
 };
@@ -42,6 +42,7 @@ PhysicsContact::PhysicsContact()
     , _eventCode(EventCode::NONE)
     , _notificationEnable(true)
     , _result(true)
+    , _batched(false)
     , _data(nullptr)
     , _contactInfo(nullptr)
     , _contactData(nullptr)
@@ -137,6 +137,7 @@ private:
     EventCode _eventCode;
     bool _notificationEnable;
     bool _result;
+    bool _batched;
 
     void* _data;
     void* _contactInfo;
@@ -148,6 +149,25 @@ private:
     friend class PhysicsWorld;
 };
 
+/**
+ * @brief A contact delivered by the batched contact stream of PhysicsWorld, see PhysicsWorld::addContactBatchHandler.
+ *
+ * The shapes and bodies are retained until the batch is delivered, they may have left the world meanwhile.
+ */
+struct AX_DLL PhysicsContactRecord
+{
+    /** BEGIN, POSTSOLVE or SEPARATE. */
+    PhysicsContact::EventCode eventCode;
+    PhysicsShape* shapeA;
+    PhysicsShape* shapeB;
+    PhysicsBody* bodyA;
+    PhysicsBody* bodyB;
+    /** The contact points and normal, empty for SEPARATE. */
+    PhysicsContactData data;
+    /** The total impulse applied to resolve the contact, only set for POSTSOLVE. */
+    Vec2 impulse;
+};
+
 /**
  * @brief Presolve value generated when onContactPreSolve called.
  */
@@ -40,6 +40,7 @@
 #    include "base/Director.h"
 #    include "base/EventDispatcher.h"
 #    include "base/EventCustom.h"
+#    include "base/JobSystem.h"
 
 NS_AX_BEGIN
 const float PHYSICS_INFINITY = FLT_MAX;
@@ -55,6 +56,72 @@ const float _debugDrawThickness = 0.5f;  // thickness of the DebugDraw lines, ci
 
 namespace
 {
+// queries per JobSystem chunk in the batched queries
+const size_t QUERY_BATCH_GRAIN = 64;
+
+// runs query(i, shapes) for each query of a batch and lays the shapes found out contiguously
+template <typename Query>
+void collectQueryBatch(size_t count,
+                       bool parallel,
+                       const Query& query,
+                       std::vector<PhysicsShape*>& shapes,
+                       std::vector<uint32_t>& offsets)
+{
+    shapes.clear();
+    offsets.assign(count + 1, 0);
+    if (count == 0)
+        return;
+
+    // one list per chunk, so the workers don't share anything
+    std::vector<std::vector<PhysicsShape*>> chunkShapes((count + QUERY_BATCH_GRAIN - 1) / QUERY_BATCH_GRAIN);
+    auto run = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& found = chunkShapes[i / QUERY_BATCH_GRAIN];
+            auto before = found.size();
+            query(i, found);
+            offsets[i + 1] = static_cast<uint32_t>(found.size() - before);
+        }
+    };
+    if (parallel)
+        JobSystem::getInstance()->parallelFor(0, count, QUERY_BATCH_GRAIN, run);
+    else
+        run(0, count);
+
+    for (size_t i = 0; i < count; ++i)
+        offsets[i + 1] += offsets[i];
+    shapes.reserve(offsets[count]);
+    for (auto&& found : chunkShapes)
+        shapes.insert(shapes.end(), found.begin(), found.end());
+}
+
+struct BatchQueryContext
+{
+    cpVect point;
+    cpBB bb;
+    std::vector<PhysicsShape*>* shapes;
+};
+
+// same tests as cpSpaceBBQuery and cpSpacePointQuery, without locking the space so queries can run concurrently
+cpCollisionID batchRectQueryFunc(BatchQueryContext* context, cpShape* shape, cpCollisionID id, void* /*data*/)
+{
+    if (!cpShapeFilterReject(shape->filter, CP_SHAPE_FILTER_ALL) && cpBBIntersects(context->bb, shape->bb))
+        context->shapes->emplace_back(static_cast<PhysicsShape*>(cpShapeGetUserData(shape)));
+    return id;
+}
+
+cpCollisionID batchPointQueryFunc(BatchQueryContext* context, cpShape* shape, cpCollisionID id, void* /*data*/)
+{
+    if (!cpShapeFilterReject(shape->filter, CP_SHAPE_FILTER_ALL))
+    {
+        cpPointQueryInfo info;
+        cpShapePointQuery(shape, context->point, &info);
+        if (info.shape && info.distance < 0.0f)
+            context->shapes->emplace_back(static_cast<PhysicsShape*>(cpShapeGetUserData(shape)));
+    }
+    return id;
+}
+
 typedef struct RayCastCallbackInfo
 {
     PhysicsWorld* world;
@@ -109,6 +176,9 @@ public:
 
 bool PhysicsWorldCallback::continues = true;
 
+// the user data of arbiters only recorded for contact batches, when contact events are disabled
+static int s_batchedContactTag = 0;
+
 cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter* arb, struct cpSpace* /*space*/, PhysicsWorld* world)
 {
     CP_ARBITER_GET_SHAPES(arb, a, b);
@@ -117,6 +187,18 @@ cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter* arb, struct c
     PhysicsShape* shapeB = static_cast<PhysicsShape*>(cpShapeGetUserData(b));
     AX_ASSERT(shapeA != nullptr && shapeB != nullptr);
 
+    if (!world->_contactEventsEnabled)
+    {
+        bool jointDisabled = false;
+        bool ret           = world->canCollide(shapeA, shapeB, jointDisabled);
+        if (!jointDisabled && world->isContactBatched(shapeA, shapeB))
+        {
+            world->recordContact(PhysicsContact::EventCode::BEGIN, arb, shapeA, shapeB);
+            cpArbiterSetUserData(arb, &s_batchedContactTag);
+        }
+        return ret;
+    }
+
     auto contact = PhysicsContact::construct(shapeA, shapeB);
     cpArbiterSetUserData(arb, contact);
     contact->_contactInfo = arb;
@@ -126,21 +208,53 @@ cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter* arb, struct c
 
 cpBool PhysicsWorldCallback::collisionPreSolveCallbackFunc(cpArbiter* arb, cpSpace* /*space*/, PhysicsWorld* world)
 {
-    return world->collisionPreSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
+    auto data = cpArbiterGetUserData(arb);
+    if (!data || data == &s_batchedContactTag)
+        return cpTrue;
+
+    return world->collisionPreSolveCallback(*static_cast<PhysicsContact*>(data));
 }
 
 void PhysicsWorldCallback::collisionPostSolveCallbackFunc(cpArbiter* arb, cpSpace* /*space*/, PhysicsWorld* world)
 {
-    world->collisionPostSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
+    auto data = cpArbiterGetUserData(arb);
+    if (!data)
+        return;
+
+    if (data != &s_batchedContactTag)
+        world->collisionPostSolveCallback(*static_cast<PhysicsContact*>(data));
+
+    if (world->_contactBatchPostSolve && (data == &s_batchedContactTag || static_cast<PhysicsContact*>(data)->_batched))
+    {
+        CP_ARBITER_GET_SHAPES(arb, a, b);
+        world->recordContact(PhysicsContact::EventCode::POSTSOLVE, arb,
+                             static_cast<PhysicsShape*>(cpShapeGetUserData(a)),
+                             static_cast<PhysicsShape*>(cpShapeGetUserData(b)));
+    }
 }
 
 void PhysicsWorldCallback::collisionSeparateCallbackFunc(cpArbiter* arb, cpSpace* /*space*/, PhysicsWorld* world)
 {
-    PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    auto data = cpArbiterGetUserData(arb);
+    if (!data)
+        return;
 
-    world->collisionSeparateCallback(*contact);
+    bool batched = data == &s_batchedContactTag;
+    if (!batched)
+    {
+        PhysicsContact* contact = static_cast<PhysicsContact*>(data);
+        world->collisionSeparateCallback(*contact);
+        batched = contact->_batched;
+        delete contact;
+    }
 
-    delete contact;
+    if (batched)
+    {
+        CP_ARBITER_GET_SHAPES(arb, a, b);
+        world->recordContact(PhysicsContact::EventCode::SEPARATE, arb,
+                             static_cast<PhysicsShape*>(cpShapeGetUserData(a)),
+                             static_cast<PhysicsShape*>(cpShapeGetUserData(b)));
+    }
 }
 
 void PhysicsWorldCallback::rayCastCallbackFunc(cpShape* shape,
@@ -345,15 +459,11 @@ void PhysicsWorld::debugDraw()
     }
 }
 
-bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
+bool PhysicsWorld::canCollide(PhysicsShape* shapeA, PhysicsShape* shapeB, bool& jointDisabled) const
 {
-    bool ret = true;
-
-    PhysicsShape* shapeA = contact.getShapeA();
-    PhysicsShape* shapeB = contact.getShapeB();
-    PhysicsBody* bodyA   = shapeA->getBody();
-    PhysicsBody* bodyB   = shapeB->getBody();
-    auto&& jointsA       = bodyA->getJoints();
+    PhysicsBody* bodyA = shapeA->getBody();
+    PhysicsBody* bodyB = shapeB->getBody();
+    auto&& jointsA     = bodyA->getJoints();
 
     // check the joint is collision enable or not
     for (PhysicsJoint* joint : jointsA)
@@ -369,12 +479,34 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
 
             if (body == bodyB)
             {
-                contact.setNotificationEnable(false);
+                jointDisabled = true;
                 return false;
             }
         }
     }
 
+    if (shapeA->getGroup() != 0 && shapeA->getGroup() == shapeB->getGroup())
+    {
+        return shapeA->getGroup() > 0;
+    }
+
+    return (shapeA->getCategoryBitmask() & shapeB->getCollisionBitmask()) != 0 &&
+           (shapeB->getCategoryBitmask() & shapeA->getCollisionBitmask()) != 0;
+}
+
+bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
+{
+    PhysicsShape* shapeA = contact.getShapeA();
+    PhysicsShape* shapeB = contact.getShapeB();
+
+    bool jointDisabled = false;
+    bool ret           = canCollide(shapeA, shapeB, jointDisabled);
+    if (jointDisabled)
+    {
+        contact.setNotificationEnable(false);
+        return false;
+    }
+
     // bitmask check
     if ((shapeA->getCategoryBitmask() & shapeB->getContactTestBitmask()) == 0 ||
         (shapeA->getContactTestBitmask() & shapeB->getCategoryBitmask()) == 0)
@@ -382,17 +514,10 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
         contact.setNotificationEnable(false);
     }
 
-    if (shapeA->getGroup() != 0 && shapeA->getGroup() == shapeB->getGroup())
+    if (isContactBatched(shapeA, shapeB))
     {
-        ret = shapeA->getGroup() > 0;
-    }
-    else
-    {
-        if ((shapeA->getCategoryBitmask() & shapeB->getCollisionBitmask()) == 0 ||
-            (shapeB->getCategoryBitmask() & shapeA->getCollisionBitmask()) == 0)
-        {
-            ret = false;
-        }
+        recordContact(PhysicsContact::EventCode::BEGIN, static_cast<cpArbiter*>(contact._contactInfo), shapeA, shapeB);
+        contact._batched = true;
     }
 
     if (contact.isNotificationEnabled())
@@ -405,6 +530,123 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     return ret ? contact.resetResult() : false;
 }
 
+void PhysicsWorld::recordContact(PhysicsContact::EventCode eventCode,
+                                 cpArbiter* arb,
+                                 PhysicsShape* shapeA,
+                                 PhysicsShape* shapeB)
+{
+    auto& record     = _contactRecords.emplace_back();
+    record.eventCode = eventCode;
+    record.shapeA    = shapeA;
+    record.shapeB    = shapeB;
+    record.bodyA     = shapeA->getBody();
+    record.bodyB     = shapeB->getBody();
+    shapeA->retain();
+    shapeB->retain();
+    AX_SAFE_RETAIN(record.bodyA);
+    AX_SAFE_RETAIN(record.bodyB);
+
+    if (eventCode != PhysicsContact::EventCode::SEPARATE)
+    {
+        record.data.count = cpArbiterGetCount(arb);
+        if (record.data.count > PhysicsContactData::POINT_MAX)
+            record.data.count = PhysicsContactData::POINT_MAX;
+        for (int i = 0; i < record.data.count; ++i)
+            record.data.points[i] = PhysicsHelper::cpv2vec2(cpArbiterGetPointA(arb, i));
+        record.data.normal = record.data.count > 0 ? PhysicsHelper::cpv2vec2(cpArbiterGetNormal(arb)) : Vec2::ZERO;
+    }
+    record.impulse = eventCode == PhysicsContact::EventCode::POSTSOLVE
+                         ? PhysicsHelper::cpv2vec2(cpArbiterTotalImpulse(arb))
+                         : Vec2::ZERO;
+}
+
+void PhysicsWorld::deliverContactBatches()
+{
+    if (_contactRecords.empty())
+        return;
+
+    // contacts recorded meanwhile, i.e. separations of bodies removed by a handler, go to the next batch
+    _deliveredContactRecords.swap(_contactRecords);
+    _deliveringContacts = true;
+    for (auto&& handler : _contactBatchHandlers)
+    {
+        if (!handler.callback)
+            continue;
+
+        if (handler.categoryBitmask == _contactBatchMask && (handler.postSolve || !_contactBatchPostSolve))
+        {
+            handler.callback(*this, _deliveredContactRecords.data(), _deliveredContactRecords.size());
+            continue;
+        }
+
+        _filteredContactRecords.clear();
+        for (const auto& record : _deliveredContactRecords)
+        {
+            if (((record.shapeA->getCategoryBitmask() | record.shapeB->getCategoryBitmask()) &
+                 handler.categoryBitmask) != 0 &&
+                (handler.postSolve || record.eventCode != PhysicsContact::EventCode::POSTSOLVE))
+                _filteredContactRecords.emplace_back(record);
+        }
+        if (!_filteredContactRecords.empty())
+            handler.callback(*this, _filteredContactRecords.data(), _filteredContactRecords.size());
+    }
+    _deliveringContacts = false;
+
+    for (auto&& record : _deliveredContactRecords)
+    {
+        record.shapeA->release();
+        record.shapeB->release();
+        AX_SAFE_RELEASE(record.bodyA);
+        AX_SAFE_RELEASE(record.bodyB);
+    }
+    _deliveredContactRecords.clear();
+    _filteredContactRecords.clear();
+
+    _contactBatchHandlers.remove_if([](const ContactBatchHandler& handler) { return !handler.callback; });
+}
+
+void PhysicsWorld::updateContactBatchMask()
+{
+    _contactBatchMask      = 0;
+    _contactBatchPostSolve = false;
+    for (auto&& handler : _contactBatchHandlers)
+    {
+        if (handler.callback)
+        {
+            _contactBatchMask |= handler.categoryBitmask;
+            _contactBatchPostSolve |= handler.postSolve;
+        }
+    }
+}
+
+int PhysicsWorld::addContactBatchHandler(const PhysicsContactBatchCallbackFunc& callback,
+                                         int categoryBitmask,
+                                         bool postSolve)
+{
+    AXASSERT(callback != nullptr, "callback shouldn't be nullptr");
+
+    _contactBatchHandlers.push_back({++_nextContactBatchHandlerId, categoryBitmask, postSolve, callback});
+    updateContactBatchMask();
+    return _nextContactBatchHandlerId;
+}
+
+void PhysicsWorld::removeContactBatchHandler(int handlerId)
+{
+    for (auto it = _contactBatchHandlers.begin(); it != _contactBatchHandlers.end(); ++it)
+    {
+        if (it->id == handlerId)
+        {
+            // the list is being iterated by deliverContactBatches, it's erased after
+            if (_deliveringContacts)
+                it->callback = nullptr;
+            else
+                _contactBatchHandlers.erase(it);
+            break;
+        }
+    }
+    updateContactBatchMask();
+}
+
 bool PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
 {
     if (!contact.isNotificationEnabled())
@@ -498,6 +740,85 @@ void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& po
     }
 }
 
+void PhysicsWorld::rayCastBatch(const PhysicsRay* rays, size_t count, PhysicsRayCastResult* results)
+{
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    // cpSpaceSegmentQueryFirst only reads the spatial indices, so the rays can be cast concurrently
+    auto run = [this, rays, results](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            cpSegmentQueryInfo info;
+            auto& result = results[i];
+            if (cpSpaceSegmentQueryFirst(_cpSpace, PhysicsHelper::vec22cpv(rays[i].start),
+                                         PhysicsHelper::vec22cpv(rays[i].end), 0.0f, CP_SHAPE_FILTER_ALL, &info))
+            {
+                result.shape    = static_cast<PhysicsShape*>(cpShapeGetUserData(info.shape));
+                result.contact  = PhysicsHelper::cpv2vec2(info.point);
+                result.normal   = PhysicsHelper::cpv2vec2(info.normal);
+                result.fraction = static_cast<float>(info.alpha);
+            }
+            else
+            {
+                result = PhysicsRayCastResult{};
+            }
+        }
+    };
+
+    if (cpSpaceIsLocked(_cpSpace))
+        run(0, count);
+    else
+        JobSystem::getInstance()->parallelFor(0, count, QUERY_BATCH_GRAIN, run);
+}
+
+void PhysicsWorld::queryRectBatch(const Rect* rects,
+                                  size_t count,
+                                  std::vector<PhysicsShape*>& shapes,
+                                  std::vector<uint32_t>& offsets)
+{
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    collectQueryBatch(
+        count, !cpSpaceIsLocked(_cpSpace),
+        [this, rects](size_t i, std::vector<PhysicsShape*>& found) {
+            BatchQueryContext context = {cpvzero, PhysicsHelper::rect2cpbb(rects[i]), &found};
+            cpSpatialIndexQuery(_cpSpace->dynamicShapes, &context, context.bb,
+                                (cpSpatialIndexQueryFunc)batchRectQueryFunc, nullptr);
+            cpSpatialIndexQuery(_cpSpace->staticShapes, &context, context.bb,
+                                (cpSpatialIndexQueryFunc)batchRectQueryFunc, nullptr);
+        },
+        shapes, offsets);
+}
+
+void PhysicsWorld::queryPointBatch(const Vec2* points,
+                                   size_t count,
+                                   std::vector<PhysicsShape*>& shapes,
+                                   std::vector<uint32_t>& offsets)
+{
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+
+    collectQueryBatch(
+        count, !cpSpaceIsLocked(_cpSpace),
+        [this, points](size_t i, std::vector<PhysicsShape*>& found) {
+            auto point                = PhysicsHelper::vec22cpv(points[i]);
+            BatchQueryContext context = {point, cpBBNewForCircle(point, 0.0f), &found};
+            cpSpatialIndexQuery(_cpSpace->dynamicShapes, &context, context.bb,
+                                (cpSpatialIndexQueryFunc)batchPointQueryFunc, nullptr);
+            cpSpatialIndexQuery(_cpSpace->staticShapes, &context, context.bb,
+                                (cpSpatialIndexQueryFunc)batchPointQueryFunc, nullptr);
+        },
+        shapes, offsets);
+}
+
 Vector<PhysicsShape*> PhysicsWorld::getShapes(const Vec2& point) const
 {
     Vector<PhysicsShape*> arr;
@@ -925,7 +1246,10 @@ void PhysicsWorld::update(float delta, bool userCall /* = false*/)
     }
 
     auto sceneToWorldTransform = _scene->getNodeToParentTransform();
-    beforeSimulation(_scene, sceneToWorldTransform, 1.f, 1.f, 0.f);
+    if (_syncBodiesOnly)
+        beforeSimulation();
+    else
+        beforeSimulation(_scene, sceneToWorldTransform, 1.f, 1.f, 0.f);
 
     if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
     {
@@ -992,7 +1316,12 @@ void PhysicsWorld::update(float delta, bool userCall /* = false*/)
 
     // Update physics position, should loop as the same sequence as node tree.
     // PhysicsWorld::afterSimulation() will depend on the sequence.
-    afterSimulation(_scene, sceneToWorldTransform, 0.f);
+    if (_syncBodiesOnly)
+        afterSimulation();
+    else
+        afterSimulation(_scene, sceneToWorldTransform, 0.f);
+
+    deliverContactBatches();
 
     if (_postUpdateCallback)
         _postUpdateCallback();  // fix #11154
@@ -1027,6 +1356,13 @@ PhysicsWorld::PhysicsWorld()
     , _debugDraw(nullptr)
     , _debugDrawMask(DEBUGDRAW_NONE)
     , _eventDispatcher(nullptr)
+    , _syncBodiesOnly(true)
+    , _syncPass(0)
+    , _contactEventsEnabled(true)
+    , _contactBatchPostSolve(false)
+    , _deliveringContacts(false)
+    , _contactBatchMask(0)
+    , _nextContactBatchHandlerId(0)
 {}
 
 PhysicsWorld::~PhysicsWorld()
@@ -1042,6 +1378,15 @@ PhysicsWorld::~PhysicsWorld()
 #    endif
     }
     AX_SAFE_RELEASE_NULL(_debugDraw);
+
+    // the contacts recorded since the last update are dropped
+    for (auto&& record : _contactRecords)
+    {
+        record.shapeA->release();
+        record.shapeB->release();
+        AX_SAFE_RELEASE(record.bodyA);
+        AX_SAFE_RELEASE(record.bodyB);
+    }
 }
 
 void PhysicsWorld::beforeSimulation(Node* node,
@@ -1081,6 +1426,100 @@ void PhysicsWorld::afterSimulation(Node* node, const Mat4& parentToWorldTransfor
         afterSimulation(child, nodeToWorldTransform, nodeRotation);
 }
 
+void PhysicsWorld::beginSyncPass()
+{
+    ++_syncPass;
+    _syncRoot.nodeToWorld = _scene->getNodeToParentTransform();
+    _syncRoot.scaleX      = 1.f;
+    _syncRoot.scaleY      = 1.f;
+    _syncRoot.rotation    = 0.f;
+    _syncRoot.pass        = _syncPass;
+}
+
+const PhysicsWorld::SyncTransform* PhysicsWorld::getParentSyncTransform(Node* node)
+{
+    if (node == _scene)
+        return &_syncRoot;
+
+    // collect the ancestors not computed in this pass yet, up to the scene
+    _syncStack.clear();
+    const SyncTransform* parentTransform = nullptr;
+    for (auto parent = node->getParent(); !parentTransform; parent = parent->getParent())
+    {
+        if (!parent)
+            return nullptr;
+
+        auto it = _syncTransforms.find(parent);
+        if (it != _syncTransforms.end() && it->second.pass == _syncPass)
+            parentTransform = &it->second;
+        else
+        {
+            _syncStack.emplace_back(parent);
+            if (parent == _scene)
+                break;
+        }
+    }
+
+    // then compute them down from there, as the scene recursion does, the scene transform is applied twice
+    SyncTransform transform = parentTransform ? *parentTransform : _syncRoot;
+
+    for (auto it = _syncStack.rbegin(); it != _syncStack.rend(); ++it)
+    {
+        auto ancestor         = *it;
+        transform.nodeToWorld = transform.nodeToWorld * ancestor->getNodeToParentTransform();
+        transform.scaleX *= ancestor->getScaleX();
+        transform.scaleY *= ancestor->getScaleY();
+        transform.rotation += ancestor->getRotation();
+        parentTransform = &_syncTransforms.insert_or_assign(ancestor, transform).first.value();
+    }
+    return parentTransform;
+}
+
+void PhysicsWorld::beforeSimulation()
+{
+    // the transforms cached by the last pass may belong to deleted nodes, drop them when they pile up
+    if (_syncTransforms.size() > 4 * static_cast<size_t>(_bodies.size()) + 64)
+        _syncTransforms.clear();
+    beginSyncPass();
+
+    for (auto&& body : _bodies)
+    {
+        auto node = body->getNode();
+        if (!node)
+            continue;
+
+        auto parentTransform = getParentSyncTransform(node);
+        if (!parentTransform)
+            continue;
+
+        body->beforeSimulation(parentTransform->nodeToWorld,
+                               parentTransform->nodeToWorld * node->getNodeToParentTransform(),
+                               parentTransform->scaleX * node->getScaleX(), parentTransform->scaleY * node->getScaleY(),
+                               parentTransform->rotation + node->getRotation());
+    }
+}
+
+void PhysicsWorld::afterSimulation()
+{
+    // the scene recursion hands every body the transform its parent had before the step, so all of them are
+    // taken before any node is written back, moving a parent must not move where its children land
+    beginSyncPass();
+    _syncWriteBack.clear();
+    for (auto&& body : _bodies)
+    {
+        auto node = body->getNode();
+        if (!node)
+            continue;
+
+        auto parentTransform = getParentSyncTransform(node);
+        if (parentTransform)
+            _syncWriteBack.emplace_back(body, *parentTransform);
+    }
+
+    for (auto&& item : _syncWriteBack)
+        item.first->afterSimulation(item.second.nodeToWorld, item.second.rotation);
+}
+
 void PhysicsWorld::setPostUpdateCallback(const std::function<void()>& callback)
 {
     _postUpdateCallback = callback;
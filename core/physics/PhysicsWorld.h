@@ -33,8 +33,11 @@
 #    include "base/Vector.h"
 #    include "math/Math.h"
 #    include "physics/PhysicsBody.h"
+#    include "physics/PhysicsContact.h"
+#    include "tsl/robin_map.h"
 
 struct cpSpace;
+struct cpArbiter;
 
 NS_AX_BEGIN
 
@@ -85,6 +88,29 @@ typedef std::function<bool(PhysicsWorld& world, const PhysicsRayCastInfo& info,
 typedef std::function<bool(PhysicsWorld&, PhysicsShape&, void*)> PhysicsQueryRectCallbackFunc;
 typedef PhysicsQueryRectCallbackFunc PhysicsQueryPointCallbackFunc;
 
+/** A ray of a batched ray cast, along the line segment from start to end. */
+struct AX_DLL PhysicsRay
+{
+    Vec2 start;
+    Vec2 end;
+};
+
+/** The closest hit of a ray in a batched ray cast, shape is nullptr if the ray hit nothing. */
+struct AX_DLL PhysicsRayCastResult
+{
+    PhysicsShape* shape = nullptr;
+    Vec2 contact;
+    Vec2 normal;
+    float fraction = 1.0f;
+};
+/**
+ * @brief Called once per world update with the contacts recorded during the update, in the order they happened.
+ * @param contacts the contacts, only valid during the call
+ * @param count the number of contacts
+ */
+typedef std::function<void(PhysicsWorld& world, const PhysicsContactRecord* contacts, size_t count)>
+    PhysicsContactBatchCallbackFunc;
+
 /**
  * @addtogroup physics
  * @{
@@ -191,6 +217,39 @@ public:
      */
     void queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, void* data);
 
+    /**
+     * Casts many rays at once and stores the closest non sensor hit of each one.
+     *
+     * The rays are split across the JobSystem workers, unless it's called while the world is stepping,
+     * i.e. from a contact callback.
+     * @param   rays   The rays to cast.
+     * @param   count   The number of rays.
+     * @param   results   Receives one result per ray, in the same order.
+     */
+    void rayCastBatch(const PhysicsRay* rays, size_t count, PhysicsRayCastResult* results);
+
+    /**
+     * Searches for the shapes overlapping many rects at once, in parallel as rayCastBatch.
+     *
+     * The shapes found by rect i are shapes[offsets[i]] to shapes[offsets[i + 1] - 1].
+     * @param   rects   The rects to query.
+     * @param   count   The number of rects.
+     * @param   shapes   Receives the shapes found by all rects.
+     * @param   offsets   Receives count + 1 offsets into shapes.
+     */
+    void queryRectBatch(const Rect* rects,
+                        size_t count,
+                        std::vector<PhysicsShape*>& shapes,
+                        std::vector<uint32_t>& offsets);
+
+    /**
+     * Searches for the shapes containing many points at once, the results are laid out as in queryRectBatch.
+     */
+    void queryPointBatch(const Vec2* points,
+                         size_t count,
+                         std::vector<PhysicsShape*>& shapes,
+                         std::vector<uint32_t>& offsets);
+
     /**
      * Get physics shapes that contains the point.
      *
@@ -374,6 +433,48 @@ public:
      */
     void step(float delta);
 
+    /**
+     * Add a handler receiving the contacts of each update at once, instead of per contact events.
+     *
+     * Contacts are recorded to a buffer reused by every update, and delivered after the nodes are synced.
+     * Only pairs where a shape's category bitmask intersects categoryBitmask are recorded for the handler.
+     * Unlike EventListenerPhysicsContact, the contact test bitmasks don't apply and handlers can't reject a contact.
+     * @param callback Called once per update with the contacts, if there are any.
+     * @param categoryBitmask The categories of shapes the handler is interested in.
+     * @param postSolve Whether POSTSOLVE contacts are delivered too, they are recorded every step per touching pair.
+     * @return An id to remove the handler.
+     */
+    int addContactBatchHandler(const PhysicsContactBatchCallbackFunc& callback,
+                               int categoryBitmask = 0xFFFFFFFF,
+                               bool postSolve      = false);
+
+    /** Remove a handler added by addContactBatchHandler, it's safe to call from a handler. */
+    void removeContactBatchHandler(int handlerId);
+
+    /**
+     * Set whether contacts are dispatched as EventListenerPhysicsContact events.
+     *
+     * Disable it when all contacts are consumed from batch handlers, so no PhysicsContact is allocated
+     * and no event is dispatched per contact.
+     * @param enabled A bool object, default value is true.
+     */
+    void setContactEventsEnabled(bool enabled) { _contactEventsEnabled = enabled; }
+
+    /** Get whether contacts are dispatched as EventListenerPhysicsContact events. */
+    bool isContactEventsEnabled() const { return _contactEventsEnabled; }
+
+    /**
+     * Set whether nodes are synced with their bodies by walking only the nodes owning bodies.
+     *
+     * By default the world iterates its body list and computes the node to world transforms of their ancestors
+     * once per step, instead of visiting every node of the scene. Disable it to sync by the scene graph recursion.
+     * @param enabled A bool object, default value is true.
+     */
+    void setSyncBodiesOnly(bool enabled) { _syncBodiesOnly = enabled; }
+
+    /** Get whether nodes are synced with their bodies by walking only the nodes owning bodies. */
+    bool isSyncBodiesOnly() const { return _syncBodiesOnly; }
+
 protected:
     static PhysicsWorld* construct(Scene* scene);
     bool init();
@@ -427,10 +528,54 @@ protected:
     std::function<void()> _preUpdateCallback;
     std::function<void()> _postUpdateCallback;
 
+    // the node to world transforms of the nodes owning bodies and their ancestors, valid during one sync pass
+    struct SyncTransform
+    {
+        Mat4 nodeToWorld;
+        float scaleX;
+        float scaleY;
+        float rotation;
+        uint32_t pass;
+    };
+    bool _syncBodiesOnly;
+    uint32_t _syncPass;
+    SyncTransform _syncRoot;
+    tsl::robin_map<Node*, SyncTransform> _syncTransforms;
+    std::vector<Node*> _syncStack;
+    std::vector<std::pair<PhysicsBody*, SyncTransform>> _syncWriteBack;
+
+    struct ContactBatchHandler
+    {
+        int id;
+        int categoryBitmask;
+        bool postSolve;
+        PhysicsContactBatchCallbackFunc callback;
+    };
+    bool _contactEventsEnabled;
+    bool _contactBatchPostSolve;
+    bool _deliveringContacts;
+    int _contactBatchMask;
+    int _nextContactBatchHandlerId;
+    // a list, handlers may add handlers while they are called
+    std::list<ContactBatchHandler> _contactBatchHandlers;
+    std::vector<PhysicsContactRecord> _contactRecords;
+    std::vector<PhysicsContactRecord> _deliveredContactRecords;
+    std::vector<PhysicsContactRecord> _filteredContactRecords;
+
 protected:
     PhysicsWorld();
     virtual ~PhysicsWorld();
 
+    // whether the shapes collide, jointDisabled is set if a joint between their bodies disables it
+    bool canCollide(PhysicsShape* shapeA, PhysicsShape* shapeB, bool& jointDisabled) const;
+    bool isContactBatched(PhysicsShape* shapeA, PhysicsShape* shapeB) const
+    {
+        return ((shapeA->getCategoryBitmask() | shapeB->getCategoryBitmask()) & _contactBatchMask) != 0;
+    }
+    void recordContact(PhysicsContact::EventCode eventCode, cpArbiter* arb, PhysicsShape* shapeA, PhysicsShape* shapeB);
+    void deliverContactBatches();
+    void updateContactBatchMask();
+
     void beforeSimulation(Node* node,
                           const Mat4& parentToWorldTransform,
                           float nodeParentScaleX,
@@ -438,6 +583,13 @@ protected:
                           float parentRotation);
     void afterSimulation(Node* node, const Mat4& parentToWorldTransform, float parentRotation);
 
+    // body list driven versions of the above
+    void beforeSimulation();
+    void afterSimulation();
+    void beginSyncPass();
+    // returns the transform of node's parent as the recursion computes it, nullptr if node isn't in the scene
+    const SyncTransform* getParentSyncTransform(Node* node);
+
     friend class Node;
     friend class Sprite;
     friend class Scene;
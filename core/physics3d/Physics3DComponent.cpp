@@ -187,7 +187,17 @@ void Physics3DComponent::syncPhysicsToNode()
         if (_owner->getParent())
             parentMat = _owner->getParent()->getNodeToWorldTransform();
 
-        auto mat = parentMat.getInversed() * _physics3DObj->getWorldTransform();
+        Mat4 worldMat;
+        auto world = _physics3DObj->getPhysicsWorld();
+        if (world && world->isInterpolationEnabled() &&
+            _physics3DObj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY &&
+            !static_cast<Physics3DRigidBody*>(_physics3DObj)->isKinematic())
+            worldMat = static_cast<Physics3DRigidBody*>(_physics3DObj)
+                           ->getInterpolatedWorldTransform(world->getInterpolationAlpha());
+        else
+            worldMat = _physics3DObj->getWorldTransform();
+
+        auto mat = parentMat.getInversed() * worldMat;
         // remove scale, no scale support for physics
         float oneOverLen = 1.f / sqrtf(mat.m[0] * mat.m[0] + mat.m[1] * mat.m[1] + mat.m[2] * mat.m[2]);
         mat.m[0] *= oneOverLen;
@@ -235,10 +245,7 @@ void Physics3DComponent::syncNodeToPhysics()
         mat *= _invTransformInPhysics;
         if (_physics3DObj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
         {
-            auto body        = static_cast<Physics3DRigidBody*>(_physics3DObj)->getRigidBody();
-            auto motionState = body->getMotionState();
-            motionState->setWorldTransform(convertMat4TobtTransform(mat));
-            body->setMotionState(motionState);
+            static_cast<Physics3DRigidBody*>(_physics3DObj)->setWorldTransform(mat);
         }
         else if (_physics3DObj->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
         {
@@ -83,6 +83,7 @@ bool Physics3DRigidBody::init(Physics3DRigidBodyDes* info)
     btDefaultMotionState* myMotionState = new btDefaultMotionState(transform);
     btRigidBody::btRigidBodyConstructionInfo rbInfo(mass, myMotionState, shape, localInertia);
     _btRigidBody    = new btRigidBody(rbInfo);
+    _btRigidBody->setUserPointer(static_cast<Physics3DObject*>(this));
     _type           = Physics3DObject::PhysicsObjType::RIGID_BODY;
     _physics3DShape = info->shape;
     _physics3DShape->retain();
@@ -347,6 +348,36 @@ ax::Mat4 Physics3DRigidBody::getWorldTransform() const
     return convertbtTransformToMat4(transform);
 }
 
+ax::Mat4 Physics3DRigidBody::getInterpolatedWorldTransform(float alpha) const
+{
+    const auto& transform = _btRigidBody->getWorldTransform();
+    auto position         = _previousPosition.lerp(convertbtVector3ToVec3(transform.getOrigin()), alpha);
+    Quaternion rotation;
+    Quaternion::slerp(_previousRotation, convertbtQuatToQuat(transform.getRotation()), alpha, &rotation);
+
+    Mat4 mat;
+    Mat4::createRotation(rotation, &mat);
+    mat.m[12] = position.x;
+    mat.m[13] = position.y;
+    mat.m[14] = position.z;
+    return mat;
+}
+
+void Physics3DRigidBody::setWorldTransform(const ax::Mat4& transform)
+{
+    auto motionState = _btRigidBody->getMotionState();
+    motionState->setWorldTransform(convertMat4TobtTransform(transform));
+    _btRigidBody->setMotionState(motionState);
+    savePreviousTransform();
+}
+
+void Physics3DRigidBody::savePreviousTransform()
+{
+    const auto& transform = _btRigidBody->getWorldTransform();
+    _previousPosition     = convertbtVector3ToVec3(transform.getOrigin());
+    _previousRotation     = convertbtQuatToQuat(transform.getRotation());
+}
+
 void Physics3DRigidBody::setKinematic(bool kinematic)
 {
     if (kinematic)
@@ -530,6 +561,7 @@ bool Physics3DCollider::init(Physics3DColliderDes* info)
     _physics3DShape = info->shape;
     _physics3DShape->retain();
     _btGhostObject = new btCollider(this);
+    _btGhostObject->setUserPointer(static_cast<Physics3DObject*>(this));
     _btGhostObject->setCollisionShape(_physics3DShape->getbtShape());
 
     setTrigger(info->isTrigger);
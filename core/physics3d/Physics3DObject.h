@@ -322,6 +322,20 @@ public:
     /** override. */
     virtual ax::Mat4 getWorldTransform() const override;
 
+    /**
+     * Teleport the body, the interpolation restarts from there instead of sweeping from where the body was.
+     */
+    void setWorldTransform(const ax::Mat4& transform);
+
+    /**
+     * Get the world transform between the previous simulation step (alpha 0) and the last one (alpha 1),
+     * the position is interpolated linearly and the rotation spherically.
+     */
+    ax::Mat4 getInterpolatedWorldTransform(float alpha) const;
+
+    /** Remember the current world transform as the one of the previous step, called by the world before a step. */
+    void savePreviousTransform();
+
     /** Get constraint by index. */
     Physics3DConstraint* getConstraint(unsigned int idx) const;
 
@@ -344,6 +358,8 @@ protected:
     btRigidBody* _btRigidBody;
     Physics3DShape* _physics3DShape;
     std::vector<Physics3DConstraint*> _constraintList;
+    ax::Vec3 _previousPosition;
+    ax::Quaternion _previousRotation;
 };
 
 /**
@@ -30,12 +30,91 @@
 
 #    if (AX_ENABLE_BULLET_INTEGRATION)
 
+#        include "base/JobSystem.h"
+#        include "3d/AABB.h"
+#        include "bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#        include "bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#        include "bullet/LinearMath/btThreads.h"
+
 NS_AX_BEGIN
 
+namespace
+{
+// queries per JobSystem chunk in the batched queries
+const size_t QUERY_BATCH_GRAIN = 64;
+
+class AABBBatchCallback : public btBroadphaseAabbCallback
+{
+public:
+    explicit AABBBatchCallback(std::vector<Physics3DObject*>& objects) : _objects(objects) {}
+
+    bool process(const btBroadphaseProxy* proxy) override
+    {
+        auto obj = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+        if (auto physicsObj = static_cast<Physics3DObject*>(obj->getUserPointer()))
+            _objects.emplace_back(physicsObj);
+        return true;
+    }
+
+private:
+    std::vector<Physics3DObject*>& _objects;
+};
+}  // namespace
+
+#        if BT_THREADSAFE
+namespace
+{
+// runs the parallel loops of bullet on the JobSystem, the calling thread takes part
+class JobSystemTaskScheduler : public btITaskScheduler
+{
+public:
+    JobSystemTaskScheduler() : btITaskScheduler("JobSystem") {}
+
+    int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    int getNumThreads() const override
+    {
+        return (std::min)(JobSystem::getInstance()->getThreadCount() + 1, static_cast<int>(BT_MAX_THREAD_COUNT));
+    }
+    void setNumThreads(int /*numThreads*/) override {}  // use JobSystem::setMaxParallelism
+
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+    {
+        JobSystem::getInstance()->parallelFor(iBegin, iEnd, grainSize, [&body](size_t begin, size_t end) {
+            body.forLoop(static_cast<int>(begin), static_cast<int>(end));
+        });
+    }
+
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+    {
+        if (iBegin >= iEnd)
+            return btScalar(0);
+
+        // one sum per chunk, added in order so the result doesn't depend on the scheduling
+        grainSize = (std::max)(grainSize, 1);
+        std::vector<btScalar> sums((iEnd - iBegin + grainSize - 1) / grainSize, btScalar(0));
+        JobSystem::getInstance()->parallelFor(iBegin, iEnd, grainSize, [&](size_t begin, size_t end) {
+            sums[(begin - iBegin) / grainSize] = body.sumLoop(static_cast<int>(begin), static_cast<int>(end));
+        });
+
+        btScalar sum = 0;
+        for (auto value : sums)
+            sum += value;
+        return sum;
+    }
+};
+}  // namespace
+#        endif  // BT_THREADSAFE
+
 Physics3DWorld::Physics3DWorld()
     : _needCollisionChecking(false)
     , _collisionCheckingFlag(false)
     , _needGhostPairCallbackChecking(false)
+    , _multiThreaded(false)
+    , _interpolate(false)
+    , _maxSubSteps(3)
+    , _fixedTimeStep(1.f / 60.f)
+    , _accumulator(0.f)
+    , _interpolationAlpha(0.f)
     , _btPhyiscsWorld(nullptr)
     , _collisionConfiguration(nullptr)
     , _dispatcher(nullptr)
@@ -49,12 +128,12 @@ Physics3DWorld::~Physics3DWorld()
     removeAllPhysics3DConstraints();
     removeAllPhysics3DObjects();
 
+    AX_SAFE_DELETE(_btPhyiscsWorld);
     AX_SAFE_DELETE(_collisionConfiguration);
     AX_SAFE_DELETE(_dispatcher);
     AX_SAFE_DELETE(_broadphase);
     AX_SAFE_DELETE(_ghostCallback);
     AX_SAFE_DELETE(_solver);
-    AX_SAFE_DELETE(_btPhyiscsWorld);
     AX_SAFE_DELETE(_debugDrawer);
     for (auto&& it : _physicsComponents)
         it->setPhysics3DObject(nullptr);
@@ -81,25 +160,49 @@ Vec3 Physics3DWorld::getGravity() const
 
 bool Physics3DWorld::init(Physics3DWorldDes* info)
 {
+    _fixedTimeStep = info->fixedTimeStep > 0.f ? info->fixedTimeStep : 1.f / 60.f;
+    _maxSubSteps   = (std::max)(info->maxSubSteps, 1);
+    _interpolate   = info->interpolate;
+
     /// collision configuration contains default setup for memory, collision setup
     _collisionConfiguration = new btDefaultCollisionConfiguration();
     //_collisionConfiguration->setConvexConvexMultipointIterations();
 
-    /// use the default collision dispatcher. For parallel processing you can use a different dispatcher (see
-    /// Extras/BulletMultiThreaded)
-    _dispatcher = new btCollisionDispatcher(_collisionConfiguration);
-
     _broadphase = new btDbvtBroadphase();
 
-    /// the default constraint solver. For parallel processing you can use a different solver (see
-    /// Extras/BulletMultiThreaded)
-    btSequentialImpulseConstraintSolver* sol = new btSequentialImpulseConstraintSolver();
-    _solver                                  = sol;
-
     btGhostPairCallback* ghostCallback = new btGhostPairCallback();
     _ghostCallback                     = ghostCallback;
 
-    _btPhyiscsWorld = new btDiscreteDynamicsWorld(_dispatcher, _broadphase, _solver, _collisionConfiguration);
+    if (info->multiThreaded)
+    {
+#        if BT_THREADSAFE
+        // the scheduler is global to bullet, all multithreaded worlds share the JobSystem
+        static JobSystemTaskScheduler scheduler;
+        if (btGetTaskScheduler() != &scheduler)
+            btSetTaskScheduler(&scheduler);
+
+        /// narrow phase pairs and islands are processed in parallel, each island by one solver of the pool
+        _dispatcher     = new btCollisionDispatcherMt(_collisionConfiguration);
+        auto solverPool = new btConstraintSolverPoolMt(scheduler.getNumThreads());
+        _solver         = solverPool;
+        _btPhyiscsWorld =
+            new btDiscreteDynamicsWorldMt(_dispatcher, _broadphase, solverPool, nullptr, _collisionConfiguration);
+        _multiThreaded = true;
+#        else
+        AXLOG("Physics3DWorld: bullet is built without BT_THREADSAFE, simulating on one thread");
+#        endif
+    }
+
+    if (!_btPhyiscsWorld)
+    {
+        /// use the default collision dispatcher.
+        _dispatcher = new btCollisionDispatcher(_collisionConfiguration);
+
+        /// the default constraint solver.
+        _solver = new btSequentialImpulseConstraintSolver();
+
+        _btPhyiscsWorld = new btDiscreteDynamicsWorld(_dispatcher, _broadphase, _solver, _collisionConfiguration);
+    }
     _btPhyiscsWorld->setGravity(convertVec3TobtVector3(info->gravity));
     if (info->isDebugDrawEnabled)
     {
@@ -133,7 +236,9 @@ void Physics3DWorld::addPhysics3DObject(Physics3DObject* physicsObj)
         physicsObj->retain();
         if (physicsObj->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
         {
-            _btPhyiscsWorld->addRigidBody(static_cast<Physics3DRigidBody*>(physicsObj)->getRigidBody());
+            auto body = static_cast<Physics3DRigidBody*>(physicsObj);
+            body->savePreviousTransform();
+            _btPhyiscsWorld->addRigidBody(body->getRigidBody());
         }
         else if (physicsObj->getObjType() == Physics3DObject::PhysicsObjType::COLLIDER)
         {
@@ -264,7 +369,31 @@ void Physics3DWorld::stepSimulate(float dt)
         {
             it->preSimulate();
         }
-        _btPhyiscsWorld->stepSimulation(dt, 3);
+        if (_interpolate)
+        {
+            // fixed steps only, the rest of the time is carried over and the nodes are placed between the last two steps
+            _accumulator += dt;
+            int steps = 0;
+            while (_accumulator >= _fixedTimeStep && steps < _maxSubSteps)
+            {
+                for (auto&& it : _objects)
+                {
+                    if (it->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
+                        static_cast<Physics3DRigidBody*>(it)->savePreviousTransform();
+                }
+                _btPhyiscsWorld->stepSimulation(_fixedTimeStep, 0, _fixedTimeStep);
+                _accumulator -= _fixedTimeStep;
+                ++steps;
+            }
+            // too late to catch up, drop the time rather than simulating more steps next frame
+            if (_accumulator >= _fixedTimeStep)
+                _accumulator = std::fmod(_accumulator, _fixedTimeStep);
+            _interpolationAlpha = _accumulator / _fixedTimeStep;
+        }
+        else
+        {
+            _btPhyiscsWorld->stepSimulation(dt, _maxSubSteps, _fixedTimeStep);
+        }
         // sync dynamic node after simulation
         for (auto&& it : _physicsComponents)
         {
@@ -326,8 +455,62 @@ bool Physics3DWorld::sweepShape(Physics3DShape* shape,
     return false;
 }
 
+void Physics3DWorld::rayCastBatch(const ax::Vec3* startPos,
+                                  const ax::Vec3* endPos,
+                                  size_t count,
+                                  HitResult* results)
+{
+    auto run = [this, startPos, endPos, results](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            rayCast(startPos[i], endPos[i], &results[i]);
+    };
+
+#        if BT_THREADSAFE
+    // the dbvt broadphase only keeps a ray stack per call in thread safe builds
+    JobSystem::getInstance()->parallelFor(0, count, QUERY_BATCH_GRAIN, run);
+#        else
+    run(0, count);
+#        endif
+}
+
+void Physics3DWorld::queryAABBBatch(const AABB* boxes,
+                                    size_t count,
+                                    std::vector<Physics3DObject*>& objects,
+                                    std::vector<uint32_t>& offsets)
+{
+    objects.clear();
+    offsets.assign(count + 1, 0);
+    if (count == 0)
+        return;
+
+    // one list per chunk, so the workers don't share anything
+    std::vector<std::vector<Physics3DObject*>> chunkObjects((count + QUERY_BATCH_GRAIN - 1) / QUERY_BATCH_GRAIN);
+    auto broadphase = _btPhyiscsWorld->getBroadphase();
+    JobSystem::getInstance()->parallelFor(0, count, QUERY_BATCH_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& found = chunkObjects[i / QUERY_BATCH_GRAIN];
+            auto before = found.size();
+            AABBBatchCallback callback(found);
+            broadphase->aabbTest(convertVec3TobtVector3(boxes[i]._min), convertVec3TobtVector3(boxes[i]._max),
+                                 callback);
+            offsets[i + 1] = static_cast<uint32_t>(found.size() - before);
+        }
+    });
+
+    for (size_t i = 0; i < count; ++i)
+        offsets[i + 1] += offsets[i];
+    objects.reserve(offsets[count]);
+    for (auto&& found : chunkObjects)
+        objects.insert(objects.end(), found.begin(), found.end());
+}
+
 Physics3DObject* Physics3DWorld::getPhysicsObject(const btCollisionObject* btObj)
 {
+    // the objects set themselves as the user pointer of their bullet object
+    if (auto physicsObj = static_cast<Physics3DObject*>(btObj->getUserPointer()))
+        return physicsObj;
+
     for (auto&& it : _objects)
     {
         if (it->getObjType() == Physics3DObject::PhysicsObjType::RIGID_BODY)
@@ -38,7 +38,7 @@ class btDynamicsWorld;
 class btDefaultCollisionConfiguration;
 class btCollisionDispatcher;
 struct btDbvtBroadphase;
-class btSequentialImpulseConstraintSolver;
+class btConstraintSolver;
 class btGhostPairCallback;
 class btRigidBody;
 class btCollisionObject;
@@ -55,6 +55,7 @@ class Physics3DDebugDrawer;
 class Physics3DComponent;
 class Physics3DShape;
 class Renderer;
+class AABB;
 
 /**
  * @brief The description of Physics3DWorld.
@@ -63,10 +64,18 @@ struct AX_DLL Physics3DWorldDes
 {
     bool isDebugDrawEnabled;  // using physics debug draw?, false by default
     ax::Vec3 gravity;    // gravity, (0, -9.8, 0)
+    float fixedTimeStep;  // the duration of a simulation step, 1/60 by default
+    int maxSubSteps;      // the most steps simulated per frame, the late time is dropped, 3 by default
+    bool interpolate;     // nodes follow their bodies interpolated between the last two steps, false by default
+    bool multiThreaded;   // simulate islands in parallel on the JobSystem, needs bullet built with BT_THREADSAFE, false by default
     Physics3DWorldDes()
     {
         isDebugDrawEnabled = false;
         gravity            = ax::Vec3(0.f, -9.8f, 0.f);
+        fixedTimeStep      = 1.f / 60.f;
+        maxSubSteps        = 3;
+        interpolate        = false;
+        multiThreaded      = false;
     }
 };
 
@@ -117,9 +126,24 @@ public:
     /** Remove all Physics3DConstraint. */
     void removeAllPhysics3DConstraints();
 
-    /** Simulate one frame. */
+    /**
+     * Simulate one frame.
+     *
+     * The world is simulated in steps of fixedTimeStep, so the result only depends on the sequence of steps and not on
+     * the frame rate. With interpolation, the time left over is carried to the next frame and nodes are placed between
+     * the last two steps, otherwise bullet extrapolates it.
+     */
     void stepSimulate(float dt);
 
+    /** Check whether the islands are simulated in parallel. */
+    bool isMultiThreaded() const { return _multiThreaded; }
+
+    /** Check whether the nodes follow their bodies interpolated between the last two steps. */
+    bool isInterpolationEnabled() const { return _interpolate; }
+
+    /** Get where the frame is between the last two steps, in [0, 1). */
+    float getInterpolationAlpha() const { return _interpolationAlpha; }
+
     /** Enable or disable debug drawing. */
     void setDebugDrawEnable(bool enableDebugDraw);
 
@@ -146,6 +170,25 @@ public:
                     const ax::Mat4& endTransform,
                     HitResult* result);
 
+    /**
+     * Casts many rays at once, ray i goes from startPos[i] to endPos[i] and its closest hit is stored in results[i],
+     * with a null hitObj if it hit nothing.
+     *
+     * The rays are split across the JobSystem workers when bullet is built with BT_THREADSAFE, call it outside
+     * stepSimulate.
+     */
+    void rayCastBatch(const ax::Vec3* startPos, const ax::Vec3* endPos, size_t count, HitResult* results);
+
+    /**
+     * Searches for the objects whose bounding boxes overlap many boxes at once, in parallel.
+     *
+     * The objects found by box i are objects[offsets[i]] to objects[offsets[i + 1] - 1].
+     */
+    void queryAABBBatch(const AABB* boxes,
+                        size_t count,
+                        std::vector<Physics3DObject*>& objects,
+                        std::vector<uint32_t>& offsets);
+
     Physics3DWorld();
     virtual ~Physics3DWorld();
 
@@ -166,13 +209,19 @@ protected:
     bool _needCollisionChecking;
     bool _collisionCheckingFlag;
     bool _needGhostPairCallbackChecking;
+    bool _multiThreaded;
+    bool _interpolate;
+    int _maxSubSteps;
+    float _fixedTimeStep;
+    float _accumulator;
+    float _interpolationAlpha;
 
 #        if (AX_ENABLE_BULLET_INTEGRATION)
     btDynamicsWorld* _btPhyiscsWorld;
     btDefaultCollisionConfiguration* _collisionConfiguration;
     btCollisionDispatcher* _dispatcher;
     btDbvtBroadphase* _broadphase;
-    btSequentialImpulseConstraintSolver* _solver;
+    btConstraintSolver* _solver;
     btGhostPairCallback* _ghostCallback;
     Physics3DDebugDrawer* _debugDrawer;
 #        endif  // AX_ENABLE_BULLET_INTEGRATION
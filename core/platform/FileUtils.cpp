@@ -46,8 +46,8 @@ THE SOFTWARE.
 
 #if defined(_WIN32)
 #    include "ntcvt/ntcvt.hpp"
-#    include "yasio/string_view.hpp"
 #endif
+#include "yasio/string_view.hpp"
 
 #include "pugixml/pugixml.hpp"
 
@@ -544,6 +544,146 @@ void FileUtils::purgeCachedEntries()
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _missingPathCache.clear();
+}
+
+void FileUtils::setMissingPathCacheEnabled(bool enabled)
+{
+    DECLARE_GUARD;
+    _missingPathCacheEnabled = enabled;
+    if (!enabled)
+        _missingPathCache.clear();
+}
+
+// Checks whether a path has backslashes, repeated separators or '.'/'..' segments
+static bool isNonCanonicalPath(std::string_view path)
+{
+    if (path.find('\\') != std::string_view::npos || path.find("//", 1) != std::string_view::npos)
+        return true;
+
+    for (size_t pos = 0; pos < path.size();)
+    {
+        auto slash   = path.find('/', pos);
+        auto segment = path.substr(pos, slash - pos);
+        if (segment == "." || segment == "..")
+            return true;
+        if (slash == std::string_view::npos)
+            break;
+        pos = slash + 1;
+    }
+    return false;
+}
+
+// Converts a path to the form used by the manifest: '/' separators, no repeated separators and no '.'/'..'
+// segments. A leading '/' and a trailing '/' (directories) are kept, unresolvable leading '..' are kept too.
+static std::string canonicalizePath(std::string_view path)
+{
+    if (path.empty())
+        return std::string{};
+
+    std::string unixPath{path};
+    std::replace(unixPath.begin(), unixPath.end(), '\\', '/');
+
+    std::vector<std::string_view> segments;
+    std::string_view remaining{unixPath};
+    while (!remaining.empty())
+    {
+        auto slash   = remaining.find('/');
+        auto segment = remaining.substr(0, slash);
+        remaining.remove_prefix(slash != std::string_view::npos ? slash + 1 : remaining.size());
+
+        if (segment.empty() || segment == ".")
+            continue;
+        if (segment == ".." && !segments.empty() && segments.back() != "..")
+            segments.pop_back();
+        else
+            segments.emplace_back(segment);
+    }
+
+    std::string result;
+    result.reserve(unixPath.size());
+    if (unixPath.front() == '/')
+        result.push_back('/');
+    for (auto&& segment : segments)
+        result.append(segment).push_back('/');
+    if (!result.empty() && result.back() == '/' && unixPath.back() != '/' && !segments.empty())
+        result.pop_back();
+    return result;
+}
+
+bool FileUtils::loadFileManifest(std::string_view manifestFile)
+{
+    DECLARE_GUARD;
+    _fileManifest.reset();
+
+    std::string content;
+    if (getContents(manifestFile, &content) != Status::OK)
+    {
+        AXLOGWARN("axmol: loadFileManifest: can't read %s", manifestFile.data());
+        return false;
+    }
+
+    auto manifest  = std::make_unique<FileManifest>();
+    manifest->root = _defaultResRootPath;
+    if (isNonCanonicalPath(manifest->root))
+        manifest->root = canonicalizePath(manifest->root);
+
+    std::string_view text{content};
+    while (!text.empty())
+    {
+        auto eol              = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text.remove_prefix(eol != std::string_view::npos ? eol + 1 : text.size());
+
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        // register every parent directory, so fullPathForDirectory can be answered too
+        for (auto slash = line.find('/'); slash != std::string_view::npos; slash = line.find('/', slash + 1))
+            manifest->dirs.emplace(line.substr(0, slash + 1));
+        manifest->files.emplace(line);
+    }
+
+    _fileManifest = std::move(manifest);
+
+    _fullPathCache.clear();
+    _fullPathCacheDir.clear();
+    _missingPathCache.clear();
+    return true;
+}
+
+void FileUtils::unloadFileManifest()
+{
+    DECLARE_GUARD;
+    _fileManifest.reset();
+    _missingPathCache.clear();
+}
+
+FileUtils::ManifestLookup FileUtils::lookupFileManifest(std::string_view fullPath) const
+{
+    auto manifest = _fileManifest.get();
+    if (!manifest)
+        return ManifestLookup::NotCovered;
+
+    // e.g. "res/./Images//a.png" or "res/fonts/../Images/a.png" must hit the same entry as "res/Images/a.png"
+    std::string canonicalPath;
+    if (isNonCanonicalPath(fullPath))
+    {
+        canonicalPath = canonicalizePath(fullPath);
+        fullPath      = canonicalPath;
+    }
+
+    if (!cxx20::starts_with(fullPath, std::string_view{manifest->root}))
+        return ManifestLookup::NotCovered;
+
+    auto relativePath = fullPath.substr(manifest->root.size());
+    if (relativePath.empty())
+        return ManifestLookup::Exists;
+
+    const auto& entries = relativePath.back() == '/' ? manifest->dirs : manifest->files;
+    return entries.find(relativePath) != entries.end() ? ManifestLookup::Exists : ManifestLookup::Missing;
 }
 
 std::string FileUtils::getStringFromFile(std::string_view filename) const
@@ -688,11 +828,32 @@ std::string FileUtils::fullPathForFilename(std::string_view filename) const
         return cacheIter->second;
     }
 
+    // Known to be missing ?
+    if (_missingPathCacheEnabled)
+    {
+        const auto serial = _fileChangeSerial.load(std::memory_order_relaxed);
+        if (_missingPathCacheSerial != serial)
+        {
+            _missingPathCache.clear();
+            _missingPathCacheSerial = serial;
+        }
+        else if (_missingPathCache.find(filename) != _missingPathCache.end())
+        {
+            return std::string{};
+        }
+    }
+
     std::string fullpath;
 
     for (const auto& searchIt : _searchPathArray)
     {
-        fullpath = this->getPathForFilename(filename, searchIt);
+        // The manifest knows everything under the default resource root, don't stat the disk
+        fullpath.assign(searchIt).append(filename);
+        auto manifestResult = lookupFileManifest(fullpath);
+        if (manifestResult == ManifestLookup::Missing)
+            continue;
+        if (manifestResult == ManifestLookup::NotCovered)
+            fullpath = this->getPathForFilename(filename, searchIt);
 
         if (!fullpath.empty())
         {
@@ -702,6 +863,9 @@ std::string FileUtils::fullPathForFilename(std::string_view filename) const
         }
     }
 
+    if (_missingPathCacheEnabled)
+        _missingPathCache.emplace(filename);
+
     if (isPopupNotify())
     {
         AXLOG("axmol: fullPathForFilename: No file found at %s. Possible missing file.", filename.data());
@@ -742,7 +906,12 @@ std::string FileUtils::fullPathForDirectory(std::string_view dir) const
     for (const auto& searchIt : _searchPathArray)
     {
         fullpath = this->getPathForDirectory(longdir, searchIt);
-        if (!fullpath.empty() && isDirectoryExistInternal(fullpath))
+        if (fullpath.empty())
+            continue;
+
+        auto manifestResult = lookupFileManifest(fullpath);
+        if (manifestResult == ManifestLookup::Exists ||
+            (manifestResult == ManifestLookup::NotCovered && isDirectoryExistInternal(fullpath)))
         {
             // Using the filename passed in as key.
             _fullPathCacheDir.emplace(dir, fullpath);
@@ -795,6 +964,7 @@ void FileUtils::setDefaultResourceRootPath(std::string_view path)
     {
         _fullPathCache.clear();
         _fullPathCacheDir.clear();
+        _missingPathCache.clear();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length() - 1] != '/')
         {
@@ -814,6 +984,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _missingPathCache.clear();
     _searchPathArray.clear();
 
     for (const auto& path : _originalSearchPaths)
@@ -857,6 +1028,9 @@ void FileUtils::addSearchPath(std::string_view searchpath, const bool front)
         path += "/";
     }
 
+    // a file missing before may be found in the new search path
+    _missingPathCache.clear();
+
 #ifdef AX_NO_DUP_SEARCH_PATH
     auto it = std::find(_searchPathArray.begin(), _searchPathArray.end(), path);
     if (it != _searchPathArray.end())
@@ -904,6 +1078,9 @@ bool FileUtils::isFileExist(std::string_view filename) const
 {
     if (isAbsolutePath(filename))
     {
+        auto manifestResult = lookupFileManifest(filename);
+        if (manifestResult != ManifestLookup::NotCovered)
+            return manifestResult == ManifestLookup::Exists;
         return isFileExistInternal(filename);
     }
     else
@@ -1041,6 +1218,9 @@ void FileUtils::listFilesRecursivelyAsync(std::string_view dirPath,
 
 std::unique_ptr<IFileStream> FileUtils::openFileStream(std::string_view filePath, IFileStream::Mode mode)
 {
+    if (mode != IFileStream::Mode::READ)
+        notifyFileChanged();
+
     FileStream fs;
     return fs.open(filePath, mode) ? std::make_unique<FileStream>(std::move(fs)) : nullptr;
 }
@@ -1299,6 +1479,7 @@ bool FileUtils::renameFile(std::string_view oldfullpath, std::string_view newful
     AXASSERT(!oldfullpath.empty(), "Invalid path");
     AXASSERT(!newfullpath.empty(), "Invalid path");
 
+    notifyFileChanged();
     int errorCode = rename(oldfullpath.data(), newfullpath.data());
 
     if (0 != errorCode)
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include <type_traits>
 #include <mutex>
 #include <memory>
+#include <atomic>
 
 #include "platform/IFileStream.h"
 #include "platform/PlatformMacros.h"
@@ -755,6 +756,39 @@ public:
     /** Returns the full path cache. */
     const hlookup::string_map<std::string> getFullPathCache() const { return _fullPathCache; }
 
+    /**
+     *  Enables or disables caching of failed lookups in fullPathForFilename.
+     *  When enabled (the default), a relative filename which couldn't be found in any search path is remembered,
+     *  so probing optional files (e.g. -hd variants, localization fallbacks) doesn't touch the disk again.
+     *  The cache is dropped whenever search paths change, purgeCachedEntries() is called, or a file is
+     *  written/renamed through FileUtils.
+     */
+    void setMissingPathCacheEnabled(bool enabled);
+
+    /** Checks whether failed lookups are cached. */
+    bool isMissingPathCacheEnabled() const { return _missingPathCacheEnabled; }
+
+    /**
+     *  Loads a prebuilt file manifest, generated at build time by `ax_gen_file_manifest` (see AXBuildHelpers.cmake).
+     *
+     *  The manifest is a text file listing every file of the package, one path per line, relative to the default
+     *  resource root path. While a manifest is loaded, existence queries for paths under the default resource root
+     *  are answered from memory without touching the filesystem; other search paths (e.g. the writable path) are
+     *  still probed on disk.
+     *
+     *  @note Load the manifest at startup, before any other thread uses FileUtils. Once loaded it's immutable,
+     *        so it can be queried concurrently.
+     *  @param manifestFile The manifest file, it could be a relative or absolute path.
+     *  @return True if the manifest was loaded, false if it couldn't be read.
+     */
+    bool loadFileManifest(std::string_view manifestFile);
+
+    /** Unloads the file manifest loaded by loadFileManifest, all queries will go to the filesystem again. */
+    void unloadFileManifest();
+
+    /** Checks whether a file manifest is loaded. */
+    bool isFileManifestLoaded() const { return _fileManifest != nullptr; }
+
     /**
      *  Checks whether a file exists without considering search paths and resolution orders.
      *  @param filename The file (with absolute path) to look up for
@@ -825,6 +859,25 @@ protected:
      */
     virtual std::string fullPathForDirectory(std::string_view dirname) const;
 
+    enum class ManifestLookup
+    {
+        NotCovered,  // the path is outside of the manifest root, ask the filesystem
+        Missing,
+        Exists,
+    };
+
+    /**
+     *  Looks up a full path in the loaded file manifest.
+     *  @param fullPath The full path of a file or directory, directories must end with '/'.
+     */
+    ManifestLookup lookupFileManifest(std::string_view fullPath) const;
+
+    /**
+     *  Invalidates the missing path cache, called when a file is written or renamed through FileUtils.
+     *  It's safe to call from any thread.
+     */
+    void notifyFileChanged() const { ++_fileChangeSerial; }
+
     /**
      * mutex used to protect fields.
      */
@@ -862,6 +915,23 @@ protected:
      */
     mutable hlookup::string_map<std::string> _fullPathCacheDir;
 
+    /**
+     *  The relative filenames which couldn't be found in any search path.
+     *  Only valid while _missingPathCacheSerial equals _fileChangeSerial.
+     */
+    mutable hlookup::string_set _missingPathCache;
+    mutable unsigned int _missingPathCacheSerial = 0;
+    mutable std::atomic<unsigned int> _fileChangeSerial{0};
+    bool _missingPathCacheEnabled = true;
+
+    struct FileManifest
+    {
+        std::string root;  // the default resource root path when the manifest was loaded
+        hlookup::string_set files;
+        hlookup::string_set dirs;  // with trailing '/'
+    };
+    std::unique_ptr<const FileManifest> _fileManifest;
+
     /**
      * Writable path.
      */
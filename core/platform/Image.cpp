@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include <string>
 #include <ctype.h>
+#include <atomic>
 
 #include "base/axstd.h"
 #include "base/Config.h"  // AX_USE_JPEG, AX_USE_WEBP
@@ -105,6 +106,7 @@ struct dirent* readdir$INODE64(DIR* dir)
 } /* extern "C" */
 
 #include "base/ktxspec_v1.h"
+#include "base/ktx2.h"
 
 #include "base/s3tc.h"
 #include "base/atitc.h"
@@ -546,6 +548,23 @@ static uint32_t makeFourCC(char ch0, char ch1, char ch2, char ch3)
 bool Image::PNG_PREMULTIPLIED_ALPHA_ENABLED = true;
 uint32_t Image::COMPRESSED_IMAGE_PMA_FLAGS  = Image::CompressedImagePMAFlag::DUAL_SAMPLER;
 
+static std::atomic<uint64_t> s_copiedBytes{0};
+
+uint64_t Image::getCopiedBytes()
+{
+    return s_copiedBytes.load(std::memory_order_relaxed);
+}
+
+void Image::resetCopiedBytes()
+{
+    s_copiedBytes.store(0, std::memory_order_relaxed);
+}
+
+void Image::trackCopiedBytes(size_t bytes)
+{
+    s_copiedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
 void Image::setCompressedImagesHavePMA(uint32_t targets, bool havePMA)
 {
     if (havePMA)
@@ -570,6 +589,7 @@ Image::Image()
     , _pixelFormat(backend::PixelFormat::NONE)
     , _numberOfMipmaps(0)
     , _hasPremultipliedAlpha(false)
+    , _transient(false)
 {}
 
 Image::~Image()
@@ -593,11 +613,7 @@ bool Image::initWithImageFile(std::string_view path)
     Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
 
     if (!data.isNull())
-    {
-        ssize_t n = 0;
-        auto buf  = data.takeBuffer(&n);
-        ret       = initWithImageData(buf, n, true);
-    }
+        ret = initWithImageData(std::move(data));
 
     return ret;
 }
@@ -610,11 +626,7 @@ bool Image::initWithImageFileThreadSafe(std::string_view fullpath)
     Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
 
     if (!data.isNull())
-    {
-        ssize_t n = 0;
-        auto buf  = data.takeBuffer(&n);
-        ret       = initWithImageData(buf, n, true);
-    }
+        ret = initWithImageData(std::move(data));
 
     return ret;
 }
@@ -624,6 +636,30 @@ bool Image::initWithImageData(const uint8_t* data, ssize_t dataLen)
     return initWithImageData(const_cast<uint8_t*>(data), dataLen, false);
 }
 
+bool Image::initWithImageData(Data&& data)
+{
+    ssize_t n = 0;
+    auto buf  = data.takeBuffer(&n);
+    return initWithImageData(buf, n, true);
+}
+
+bool Image::convertPixelFormatInPlace(backend::PixelFormat format)
+{
+    if (_pixelFormat == format)
+        return true;
+    if (isCompressed() || _numberOfMipmaps > 1 || _unpack || !_data)
+        return false;
+
+    size_t outDataLen = 0;
+    if (!backend::PixelFormatUtils::convertDataToFormatInPlace(getData(), getDataLen(), _pixelFormat, format,
+                                                                &outDataLen))
+        return false;
+
+    _dataLen     = _offset + static_cast<ssize_t>(outDataLen);
+    _pixelFormat = format;
+    return true;
+}
+
 bool Image::initWithImageData(uint8_t* data, ssize_t dataLen, bool ownData)
 {
     bool ret = false;
@@ -688,6 +724,9 @@ bool Image::initWithImageData(uint8_t* data, ssize_t dataLen, bool ownData)
         case Format::ASTC:
             ret = initWithASTCData(unpackedData, unpackedLen, ownData);
             break;
+        case Format::KTX2:
+            ret = initWithKTX2Data(unpackedData, unpackedLen, ownData);
+            break;
         case Format::BMP:
             ret = initWithBmpData(unpackedData, unpackedLen);
             break;
@@ -741,6 +780,7 @@ bool Image::initWithRawData(const uint8_t* data,
         _data                 = static_cast<uint8_t*>(malloc(_dataLen));
         AX_BREAK_IF(!_data);
         memcpy(_data, data, _dataLen);
+        trackCopiedBytes(_dataLen);
 
         ret = true;
     } while (0);
@@ -775,6 +815,11 @@ bool Image::isEtc2(const uint8_t* data, ssize_t dataLen)
     return !!etc2_pkm_is_valid((etc2_byte*)data);
 }
 
+bool Image::isKtx2(const uint8_t* data, ssize_t dataLen)
+{
+    return ktx2_is_valid(data, static_cast<size_t>(dataLen));
+}
+
 bool Image::isS3TC(const uint8_t* data, ssize_t /*dataLen*/)
 {
 
@@ -869,6 +914,10 @@ Image::Format Image::detectFormat(const uint8_t* data, ssize_t dataLen)
     {
         return Format::ASTC;
     }
+    else if (isKtx2(data, dataLen))
+    {
+        return Format::KTX2;
+    }
     else if (dataLen >= KTX_V1_HEADER_SIZE)
     {  // Check whether ktxspec v1.1 file format
         auto header = (KTXv1Header*)data;
@@ -1738,8 +1787,8 @@ bool Image::initWithPVRv3Data(uint8_t* data, ssize_t dataLen, bool ownData)
                 _unpack                = true;
                 _mipmaps[i].len        = width * height * bytePerPixel;
                 _mipmaps[i].address    = (uint8_t*)malloc(width * height * bytePerPixel);
-                if (etc2_decode_image(ETC2_RGB_NO_MIPMAPS, pixelData + dataOffset,
-                                      static_cast<etc1_byte*>(_mipmaps[i].address), width, height) != 0)
+                if (etc2_decode_image_parallel(ETC2_RGB_NO_MIPMAPS, pixelData + dataOffset,
+                                               static_cast<etc1_byte*>(_mipmaps[i].address), width, height) != 0)
                 {
                     return false;
                 }
@@ -1848,8 +1897,8 @@ bool Image::initWithETCData(uint8_t* data, ssize_t dataLen, bool ownData)
 
         _dataLen = _width * _height * 4;
         _data    = static_cast<uint8_t*>(malloc(_dataLen));
-        if (etc2_decode_image(ETC2_RGB_NO_MIPMAPS, static_cast<const uint8_t*>(data) + pixelOffset,
-                              static_cast<etc2_byte*>(_data), _width, _height) == 0)
+        if (etc2_decode_image_parallel(ETC2_RGB_NO_MIPMAPS, static_cast<const uint8_t*>(data) + pixelOffset,
+                                       static_cast<etc2_byte*>(_data), _width, _height) == 0)
         {  // if it is not gles or device do not support ETC1, decode texture by software
            // directly decode ETC1_RGB to RGBA8888
             _pixelFormat = backend::PixelFormat::RGBA8;
@@ -1915,8 +1964,8 @@ bool Image::initWithETC2Data(uint8_t* data, ssize_t dataLen, bool ownData)
             // etc2_decode_image always decode to RGBA8888
             _dataLen = _width * _height * 4;
             _data    = static_cast<uint8_t*>(malloc(_dataLen));
-            if (UTILS_UNLIKELY(etc2_decode_image(format, static_cast<const uint8_t*>(data) + pixelOffset,
-                                                 static_cast<etc2_byte*>(_data), _width, _height) != 0))
+            if (UTILS_UNLIKELY(etc2_decode_image_parallel(format, static_cast<const uint8_t*>(data) + pixelOffset,
+                                                          static_cast<etc2_byte*>(_data), _width, _height) != 0))
             {
                 // software decode fail, release pixels data
                 AX_SAFE_FREE(_data);
@@ -1934,6 +1983,75 @@ bool Image::initWithETC2Data(uint8_t* data, ssize_t dataLen, bool ownData)
     return false;
 }
 
+bool Image::initWithKTX2Data(uint8_t* data, ssize_t dataLen, bool ownData)
+{
+    auto header = reinterpret_cast<const KTX2Header*>(data);
+    _width      = header->pixelWidth;
+    _height     = (std::max)(header->pixelHeight, 1u);
+
+    // transcode to the best format the device supports, ETC2 blocks are uploaded as is
+    const bool alpha = ktx2_has_alpha(header);
+    auto config      = Configuration::getInstance();
+    KTX2TranscodeTarget target;
+    if (config->supportsETC2())
+    {
+        target       = KTX2TranscodeTarget::ETC2;
+        _pixelFormat = alpha ? backend::PixelFormat::ETC2_RGBA : backend::PixelFormat::ETC2_RGB;
+    }
+    else if (config->supportsS3TC())
+    {
+        target       = KTX2TranscodeTarget::S3TC;
+        _pixelFormat = alpha ? backend::PixelFormat::S3TC_DXT5 : backend::PixelFormat::S3TC_DXT1;
+    }
+    else
+    {
+        target       = KTX2TranscodeTarget::RGBA8;
+        _pixelFormat = backend::PixelFormat::RGBA8;
+    }
+
+    _numberOfMipmaps       = static_cast<int>((std::min)(ktx2_get_level_count(header), (uint32_t)MIPMAP_MAX));
+    _hasPremultipliedAlpha = isCompressedImageHavePMA(CompressedImagePMAFlag::ETC2);
+
+    auto levelIndex = reinterpret_cast<const KTX2LevelIndex*>(data + KTX2_HEADER_SIZE);
+    if (_numberOfMipmaps == 1 && target == KTX2TranscodeTarget::ETC2 &&
+        header->supercompressionScheme == KTX2Header::SupercompressionScheme::NONE)
+    {
+        auto levelEnd = levelIndex->byteOffset + levelIndex->byteLength;
+        if (levelEnd > static_cast<uint64_t>(dataLen))
+            return false;
+
+        forwardPixels(data, static_cast<ssize_t>(levelEnd), static_cast<int>(levelIndex->byteOffset), ownData);
+        return true;
+    }
+
+    // all levels are transcoded to one buffer, base level first
+    size_t levelSizes[MIPMAP_MAX];
+    _dataLen = 0;
+    for (int i = 0; i < _numberOfMipmaps; ++i)
+    {
+        levelSizes[i] = ktx2_get_transcoded_size(header, i, target);
+        _dataLen += levelSizes[i];
+    }
+    _data = static_cast<uint8_t*>(malloc(_dataLen));
+
+    size_t offset = 0;
+    for (int i = 0; i < _numberOfMipmaps; ++i)
+    {
+        if (!ktx2_transcode_level(data, static_cast<size_t>(dataLen), i, target, _data + offset, levelSizes[i]))
+        {
+            AXLOG("axmol: Image - failed to transcode ktx2 level %d", i);
+            AX_SAFE_FREE(_data);
+            _dataLen = 0;
+            return false;
+        }
+        _mipmaps[i].address = _data + offset;
+        _mipmaps[i].len     = static_cast<int>(levelSizes[i]);
+        offset += levelSizes[i];
+    }
+
+    return true;
+}
+
 bool Image::initWithASTCData(uint8_t* data, ssize_t dataLen, bool ownData)
 {
     astc_header* hdr = (astc_header*)data;
@@ -2303,6 +2421,7 @@ void Image::forwardPixels(uint8_t* data, ssize_t dataLen, int offset, bool ownDa
         _dataLen = dataLen - offset;
         _data    = (uint8_t*)malloc(_dataLen);
         memcpy(_data, data + offset, _dataLen);
+        trackCopiedBytes(_dataLen);
     }
 }
 
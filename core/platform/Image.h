@@ -106,7 +106,9 @@ public:
         //! Raw Data
         RAW_DATA,
         //! Unknown format
-        UNKNOWN
+        UNKNOWN,
+        //! KTX2 universal texture, transcoded at load time
+        KTX2
     };
 
     struct CompressedImagePMAFlag
@@ -159,6 +161,11 @@ public:
     bool initWithImageData(const uint8_t* data, ssize_t dataLen);
     bool initWithImageData(uint8_t* data, ssize_t dataLen, bool ownData);
 
+    /**
+    @brief Load image from Data, the image takes the buffer of data without copy.
+    */
+    bool initWithImageData(Data&& data);
+
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const uint8_t* data,
                          ssize_t dataLen,
@@ -183,6 +190,29 @@ public:
     bool hasAlpha();
     bool isCompressed();
 
+    /**
+     * Marks the image is only used to create a texture and will be released right after, so the texture
+     * could convert pixel format in the image buffer instead of allocating a new one.
+     */
+    void setTransient(bool transient) { _transient = transient; }
+    bool isTransient() const { return _transient; }
+
+    /**
+     * Converts the pixels to the format in the image buffer, only works for uncompressed images
+     * without mipmaps and conversions don't widen pixels.
+     * @return true if converted.
+     */
+    bool convertPixelFormatInPlace(backend::PixelFormat format);
+
+    /**
+     * Bytes of image data duplicated into intermediate buffers while loading images and uploading them
+     * to textures, i.e. copies of not owned compressed data and pixel format conversion buffers.
+     * Decoding isn't counted, so a zero-copy load keeps it unchanged.
+     */
+    static uint64_t getCopiedBytes();
+    static void resetCopiedBytes();
+    static void trackCopiedBytes(size_t bytes);
+
     /**
      @brief    Save Image data to the specified file, with specified format.
      @param    filePath        the file's absolute path, including file suffix.
@@ -214,6 +244,7 @@ protected:
     bool initWithASTCData(uint8_t* data, ssize_t dataLen, bool ownData);
     bool initWithS3TCData(uint8_t* data, ssize_t dataLen, bool ownData);
     bool initWithATITCData(uint8_t* data, ssize_t dataLen, bool ownData);
+    bool initWithKTX2Data(uint8_t* data, ssize_t dataLen, bool ownData);
 
     // fast forward pixels to GPU if ownData
     void forwardPixels(uint8_t* data, ssize_t dataLen, int offset, bool ownData);
@@ -245,6 +276,7 @@ protected:
     int _numberOfMipmaps;
     // false if we can't auto detect the image is premultiplied or not.
     bool _hasPremultipliedAlpha;
+    bool _transient;
     std::string _filePath;
 
 protected:
@@ -271,6 +303,7 @@ protected:
     bool isEtc2(const uint8_t* data, ssize_t dataLen);
     bool isS3TC(const uint8_t* data, ssize_t dataLen);
     bool isASTC(const uint8_t* data, ssize_t dataLen);
+    bool isKtx2(const uint8_t* data, ssize_t dataLen);
 };
 
 // end of platform group
@@ -230,6 +230,9 @@ bool FileUtilsWin32::renameFile(std::string_view oldfullpath, std::string_view n
     std::wstring _wNew = ntcvt::from_chars(newfullpath);
     std::wstring _wOld = ntcvt::from_chars(oldfullpath);
 
+    // both the old and the new name may be remembered as missing
+    notifyFileChanged();
+
     if (FileUtils::getInstance()->isFileExist(newfullpath))
     {
         if (!DeleteFile(_wNew.c_str()))
@@ -280,6 +280,9 @@ bool FileUtilsWinRT::renameFile(std::string_view oldfullpath, std::string_view n
 
     std::wstring _wNewfullpath = ntcvt::from_chars(_newfullpath);
 
+    // both the old and the new name may be remembered as missing
+    notifyFileChanged();
+
     if (FileUtils::getInstance()->isFileExist(_newfullpath))
     {
         if (!DeleteFile(_wNewfullpath.c_str()))
@@ -153,8 +153,10 @@ void Pass::initUniformLocations()
     _locTexture       = ps->getUniformLocation("u_tex0");
     _locNormalTexture = ps->getUniformLocation("u_normalTex");
 
-    _locColor         = ps->getUniformLocation("u_color");
-    _locMatrixPalette = ps->getUniformLocation("u_matrixPalette");
+    _locColor          = ps->getUniformLocation("u_color");
+    _locMatrixPalette  = ps->getUniformLocation("u_matrixPalette");
+    _locPaletteTexture = ps->getUniformLocation("u_paletteTex");
+    _locPaletteParams  = ps->getUniformLocation("u_paletteParams");
 
     _locDirLightColor = ps->getUniformLocation(s_dirLightUniformColorName);
     _locDirLightDir   = ps->getUniformLocation(s_dirLightUniformDirName);
@@ -284,6 +286,11 @@ void Pass::setUniformNormTexture(uint32_t slot, backend::TextureBackend* tex)
     _programState->setTexture(_locNormalTexture, slot, tex);
 }
 
+void Pass::setUniformPaletteTexture(uint32_t slot, backend::TextureBackend* tex)
+{
+    _programState->setTexture(_locPaletteTexture, slot, tex);
+}
+
 #define TRY_SET_UNIFORM(loc)                                         \
     do                                                               \
     {                                                                \
@@ -303,6 +310,11 @@ void Pass::setUniformMatrixPalette(const void* data, size_t dataLen)
     TRY_SET_UNIFORM(_locMatrixPalette);
 }
 
+void Pass::setUniformPaletteParams(const void* data, size_t dataLen)
+{
+    TRY_SET_UNIFORM(_locPaletteParams);
+}
+
 void Pass::setUniformDirLightColor(const void* data, size_t dataLen)
 {
     TRY_SET_UNIFORM(_locDirLightColor);
@@ -113,6 +113,11 @@ public:
     void setUniformColor(const void*, size_t);          // ucolor
     void setUniformMatrixPalette(const void*, size_t);  // u_matrixPalette
 
+    /** Whether the program reads the matrix palette from SkinningPaletteBuffer instead of u_matrixPalette. */
+    bool hasUniformPaletteTexture() { return _locPaletteTexture; }
+    void setUniformPaletteTexture(uint32_t slot, backend::TextureBackend*);  // u_paletteTex
+    void setUniformPaletteParams(const void*, size_t);                       // u_paletteParams
+
     void setUniformDirLightColor(const void*, size_t);
     void setUniformDirLightDir(const void*, size_t);
 
@@ -158,8 +163,10 @@ private:
     backend::UniformLocation _locTexture;        // u_tex0
     backend::UniformLocation _locNormalTexture;  // u_normalTex
 
-    backend::UniformLocation _locColor;          // ucolor
-    backend::UniformLocation _locMatrixPalette;  // u_matrixPalette
+    backend::UniformLocation _locColor;           // ucolor
+    backend::UniformLocation _locMatrixPalette;   // u_matrixPalette
+    backend::UniformLocation _locPaletteTexture;  // u_paletteTex
+    backend::UniformLocation _locPaletteParams;   // u_paletteParams
 
     backend::UniformLocation _locDirLightColor;
     backend::UniformLocation _locDirLightDir;
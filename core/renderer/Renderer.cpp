@@ -403,7 +403,8 @@ void Renderer::doVisitRenderQueue(const std::vector<RenderCommand*>& renderComma
 void Renderer::render()
 {
     // TODO: setup camera or MVP
-    _isRendering = true;
+    _isRendering  = true;
+    _currentFrame = Director::getInstance()->getTotalFrames();
     //    if (_glViewAssigned)
     {
         // Process render commands
@@ -713,6 +714,7 @@ void Renderer::drawBatchedTriangles()
         _commandBuffer->updatePipelineState(_currentRT, drawInfo.cmd->getPipelineDescriptor());
         auto& pipelineDescriptor = drawInfo.cmd->getPipelineDescriptor();
         _commandBuffer->setProgramState(pipelineDescriptor.programState);
+        markTexturesUsed(pipelineDescriptor.programState);
         _commandBuffer->drawElements(backend::PrimitiveType::TRIANGLE, backend::IndexFormat::U_SHORT,
                                      drawInfo.indicesToDraw, drawInfo.offset * sizeof(_indices[0]));
 
@@ -743,6 +745,7 @@ void Renderer::drawCustomCommand(RenderCommand* command)
 
     _commandBuffer->updatePipelineState(_currentRT, cmd->getPipelineDescriptor());
     _commandBuffer->setProgramState(cmd->getPipelineDescriptor().programState);
+    markTexturesUsed(cmd->getPipelineDescriptor().programState);
 
     auto drawType = cmd->getDrawType();
     if (CustomCommand::DrawType::ELEMENT == drawType)
@@ -773,6 +776,13 @@ void Renderer::drawCustomCommand(RenderCommand* command)
         cmd->getAfterCallback()();
 }
 
+void Renderer::markTexturesUsed(backend::ProgramState* programState)
+{
+    // a program state shared by many draw calls only walks its textures once a frame
+    if (programState)
+        programState->markTexturesUsed(_currentFrame);
+}
+
 void Renderer::drawMeshCommand(RenderCommand* command)
 {
     // MeshCommand and CustomCommand are identical while rendering.
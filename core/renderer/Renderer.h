@@ -54,6 +54,7 @@ class RenderPipeline;
 class RenderPass;
 class TextureBackend;
 class RenderTarget;
+class ProgramState;
 struct PixelBufferDescriptor;
 }  // namespace backend
 
@@ -472,6 +473,8 @@ protected:
     void drawBatchedTriangles();
     void drawCustomCommand(RenderCommand* command);
     void drawMeshCommand(RenderCommand* command);
+    // stamps the textures sampled by a draw call with the current frame, used by TextureCache residency
+    void markTexturesUsed(backend::ProgramState* programState);
 
     bool beginFrame();  /// Indicate the begining of a frame
     void endFrame();    /// Finish a frame.
@@ -546,8 +549,9 @@ protected:
     unsigned int _filledVertex           = 0;
 
     // stats
-    size_t _drawnBatches  = 0;
-    size_t _drawnVertices = 0;
+    size_t _drawnBatches       = 0;
+    size_t _drawnVertices      = 0;
+    unsigned int _currentFrame = 0;
     // the flag for checking whether renderer is rendering
     bool _isRendering      = false;
     bool _isDepthTestFor2D = false;
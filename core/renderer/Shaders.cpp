@@ -76,10 +76,13 @@ AX_DLL const std::string_view skinPositionNormalTexture_vert       = "skinPositi
 AX_DLL const std::string_view positionTexture3D_vert               = "positionTexture3D_vs"sv;
 AX_DLL const std::string_view positionTextureInstance_vert         = "positionTextureInstance_vs"sv;
 AX_DLL const std::string_view skinPositionTexture_vert             = "skinPositionTexture_vs"sv;
+AX_DLL const std::string_view skinPositionTexturePalette_vert      = "skinPositionTexturePalette_vs"sv;
+AX_DLL const std::string_view skinPositionTextureInstance_vert     = "skinPositionTextureInstance_vs"sv;
 AX_DLL const std::string_view skybox_frag                          = "skybox_fs"sv;
 AX_DLL const std::string_view skybox_vert                          = "skybox_vs"sv;
 AX_DLL const std::string_view terrain_frag                         = "terrain_fs"sv;
 AX_DLL const std::string_view terrain_vert                         = "terrain_vs"sv;
+AX_DLL const std::string_view terrainTiled_vert                    = "terrainTiled_vs"sv;
 AX_DLL const std::string_view colorNormalTexture_frag_1            = "colorNormalTexture_fs_1"sv;
 AX_DLL const std::string_view positionNormalTexture_vert_1         = "positionNormalTexture_vs_1"sv;
 AX_DLL const std::string_view skinPositionNormalTexture_vert_1     = "skinPositionNormalTexture_vs_1"sv;
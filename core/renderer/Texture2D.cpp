@@ -251,6 +251,14 @@ bool Texture2D::updateWithImage(Image* image, backend::PixelFormat format, int i
     }
 #endif
 
+    // the transient image will be released after upload, convert in its buffer to avoid an intermediate copy
+    if (image->isTransient() && renderFormat != imagePixelFormat && image->convertPixelFormatInPlace(renderFormat))
+    {
+        imagePixelFormat = renderFormat;
+        tempData         = image->getData();
+        tempDataLen      = image->getDataLen();
+    }
+
     if (image->getNumberOfMipmaps() > 1)
     {
         if (renderFormat != image->getPixelFormat())
@@ -377,6 +385,8 @@ bool Texture2D::updateWithMipmaps(MipmapInfo* mipmaps,
 #endif
             if (convertedFormat == renderFormat)
                 pixelFormat = renderFormat;
+            if (outData != data)
+                Image::trackCopiedBytes(outDataLen);
         }
 
         textureDescriptor.textureFormat = pixelFormat;
@@ -421,6 +431,8 @@ bool Texture2D::updateWithMipmaps(MipmapInfo* mipmaps,
         _pixelFormat = pixelFormat;
         _maxS        = 1;
         _maxT        = 1;
+        // new full contents, e.g. a VolatileTexture reload after context loss, updateResidentImage sets its level
+        _residentLevel = 0;
 
         setPremultipliedAlpha(preMultipliedAlpha);
     }
@@ -448,6 +460,40 @@ bool Texture2D::updateWithSubData(void* data, int offsetX, int offsetY, int widt
 }
 
 // implementation Texture2D (Image)
+unsigned int Texture2D::getLastUsedFrame() const
+{
+    return _texture ? _texture->getLastUsedFrame() : 0;
+}
+
+size_t Texture2D::getMemoryBytes() const
+{
+    if (!_texture)
+        return 0;
+
+    size_t bytes = (size_t)_texture->getWidth() * _texture->getHeight() * getBitsPerPixelForFormat() / 8;
+    // a full mip chain takes 1/3 more
+    if (_texture->hasMipmaps())
+        bytes += bytes / 3;
+    return bytes * _texture->getCount();
+}
+
+bool Texture2D::updateResidentImage(Image* image, int level)
+{
+    auto contentSize = _contentSize;
+    auto pixelsWide  = _pixelsWide;
+    auto pixelsHigh  = _pixelsHigh;
+
+    if (!updateWithImage(image, _pixelFormat))
+        return false;
+
+    // the texture coordinates are normalized, so only the logical size needs to be kept
+    _contentSize   = contentSize;
+    _pixelsWide    = pixelsWide;
+    _pixelsHigh    = pixelsHigh;
+    _residentLevel = level;
+    return true;
+}
+
 bool Texture2D::initWithImage(Image* image)
 {
     return initWithImage(image, g_defaultAlphaPixelFormat);
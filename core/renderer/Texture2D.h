@@ -373,6 +373,23 @@ public:
 
     std::string getPath() const { return _filePath; }
 
+    /** Gets the Director total frames when the texture was last drawn. */
+    unsigned int getLastUsedFrame() const;
+
+    /** Gets the GPU memory of the texture in bytes, includes the mipmaps. */
+    size_t getMemoryBytes() const;
+
+    /** Gets the mip level resident on GPU, 0 means full resolution. */
+    int getResidentLevel() const { return _residentLevel; }
+
+    /** Replaces the GPU contents by a downscaled or full resolution image and keeps the content size,
+     * so the sprites using the texture don't change.
+     *
+     * @param image The image of the level, (pixelsWide >> level) x (pixelsHigh >> level).
+     * @param level The resident mip level.
+     */
+    bool updateResidentImage(Image* image, int level);
+
 private:
     /**
      * A struct for storing 9-patch image capInsets.
@@ -450,6 +467,7 @@ protected:
     friend class ui::Scale9Sprite;
 
     bool _valid;
+    int _residentLevel = 0;
     std::string _filePath;
 
     backend::ProgramState* _programState = nullptr;
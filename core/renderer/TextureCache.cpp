@@ -43,7 +43,9 @@ THE SOFTWARE.
 #include "platform/FileUtils.h"
 #include "base/Utils.h"
 #include "base/NinePatchImageParser.h"
+#include "base/AsyncTaskPool.h"
 #include "renderer/backend/Device.h"
+#include "renderer/backend/PixelFormatUtils.h"
 
 using namespace std;
 
@@ -63,12 +65,25 @@ std::string TextureCache::getETC1AlphaFileSuffix()
     return s_etc1AlphaFileSuffix;
 }
 
-TextureCache::TextureCache() : _loadingThread(nullptr), _needQuit(false), _asyncRefCount(0) {}
+TextureCache::TextureCache()
+    : _loadingThread(nullptr), _needQuit(false), _asyncRefCount(0), _residencyToken(std::make_shared<bool>(true))
+{}
 
 TextureCache::~TextureCache()
 {
     AXLOGINFO("deallocing TextureCache: %p", this);
 
+    if (_residencyScheduled)
+        Director::getInstance()->getScheduler()->unschedule(AX_SCHEDULE_SELECTOR(TextureCache::updateResidency), this);
+    if (_residencyUploadsScheduled)
+        Director::getInstance()->getScheduler()->unschedule(AX_SCHEDULE_SELECTOR(TextureCache::uploadResidentImages),
+                                                            this);
+    for (auto&& upload : _residencyUploads)
+    {
+        upload.image->release();
+        upload.texture->release();
+    }
+
     for (auto&& texture : _textures)
         texture.second->release();
 
@@ -338,6 +353,8 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
             if (asyncStruct->loadSuccess)
             {
                 Image* image = &(asyncStruct->image);
+                // 9-patch info is parsed from RGBA8 pixels after upload
+                image->setTransient(!NinePatchImageParser::isNinePatchImage(asyncStruct->filename));
                 // generate texture in render thread
                 texture = new Texture2D();
 
@@ -351,6 +368,8 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                 // cache the texture. retain it, since it is added in the map
                 _textures.emplace(asyncStruct->filename, texture);
                 texture->retain();
+                // counts as used, so it isn't idle before the first draw
+                texture->getBackendTexture()->markUsed(Director::getInstance()->getTotalFrames());
 
                 texture->autorelease();
                 // ETC1 ALPHA supports.
@@ -444,6 +463,11 @@ Texture2D* TextureCache::addImage(std::string_view path, PixelFormat format)
     // MUTEX:
     // Needed since addImageAsync calls this method from a different thread
 
+    // images added with a key, i.e. the ones embedded in models, aren't files
+    auto keyIt = _textures.find(path);
+    if (keyIt != _textures.end())
+        return keyIt->second;
+
     std::string fullpath = FileUtils::getInstance()->fullPathForFilename(path);
     if (fullpath.empty())
     {
@@ -463,6 +487,8 @@ Texture2D* TextureCache::addImage(std::string_view path, PixelFormat format)
             bool bRet = image->initWithImageFile(fullpath);
             AX_BREAK_IF(!bRet);
 
+            // 9-patch info is parsed from RGBA8 pixels after upload
+            image->setTransient(!NinePatchImageParser::isNinePatchImage(path));
             texture = new Texture2D();
 
             if (texture->initWithImage(image, format))
@@ -473,6 +499,8 @@ Texture2D* TextureCache::addImage(std::string_view path, PixelFormat format)
 #endif
                 // texture already retained, no need to re-retain it
                 _textures.emplace(fullpath, texture);
+                // counts as used, so it isn't idle before the first draw
+                texture->getBackendTexture()->markUsed(Director::getInstance()->getTotalFrames());
 
                 //-- ANDROID ETC1 ALPHA SUPPORTS.
                 std::string alphaFullPath{path};
@@ -705,8 +733,8 @@ std::string TextureCache::getCachedTextureInfo() const
     std::string buffer;
     char buftmp[4096];
 
-    unsigned int count      = 0;
-    unsigned int totalBytes = 0;
+    unsigned int count = 0;
+    size_t totalBytes  = 0;
 
     for (auto&& texture : _textures)
     {
@@ -715,13 +743,15 @@ std::string TextureCache::getCachedTextureInfo() const
 
         Texture2D* tex   = texture.second;
         unsigned int bpp = tex->getBitsPerPixelForFormat();
-        // Each texture takes up width * height * bytesPerPixel bytes.
-        auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
+        // Each texture takes up width * height * bytesPerPixel bytes at the resident level.
+        auto bytes = tex->getMemoryBytes();
         totalBytes += bytes;
         count++;
-        snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%d id=%p %d x %d @ %d bpp => %d KB\n", texture.first.c_str(),
+        snprintf(buftmp, sizeof(buftmp) - 1,
+                 "\"%s\" rc=%d id=%p %d x %d @ %d bpp %s level=%d frame=%u => %d KB\n", texture.first.c_str(),
                  (int32_t)tex->getReferenceCount(), tex->getBackendTexture(), (int32_t)tex->getPixelsWide(),
-                 (int32_t)tex->getPixelsHigh(), (int32_t)bpp, (int32_t)bytes / 1024);
+                 (int32_t)tex->getPixelsHigh(), (int32_t)bpp, tex->getStringForFormat(), tex->getResidentLevel(),
+                 tex->getLastUsedFrame(), (int32_t)bytes / 1024);
 
         buffer += buftmp;
     }
@@ -759,6 +789,266 @@ void TextureCache::renameTextureWithKey(std::string_view srcName, std::string_vi
     }
 }
 
+// TextureCache - Memory budget & residency
+
+// the level reloads uploaded per frame
+static const int MAX_RESIDENCY_UPLOADS_PER_FRAME = 2;
+
+// Box filters a RGBA8/RGB8 image down by 2^level, returns nullptr for other formats
+static Image* createDownscaledImage(Image* image, int level)
+{
+    int channels = 0;
+    if (image->getPixelFormat() == backend::PixelFormat::RGBA8)
+        channels = 4;
+    else if (image->getPixelFormat() == backend::PixelFormat::RGB8)
+        channels = 3;
+    else
+        return nullptr;
+
+    const int scale  = 1 << level;
+    const int width  = (std::max)(image->getWidth() >> level, 1);
+    const int height = (std::max)(image->getHeight() >> level, 1);
+    const int pitch  = image->getWidth() * channels;
+    auto src         = image->getData();
+
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+    auto dst = pixels.data();
+    for (int y = 0; y < height; ++y)
+    {
+        const int rows = (std::min)(scale, image->getHeight() - y * scale);
+        for (int x = 0; x < width; ++x, dst += 4)
+        {
+            const int cols = (std::min)(scale, image->getWidth() - x * scale);
+            unsigned int sum[4]{};
+            for (int j = 0; j < rows; ++j)
+            {
+                auto pixel = src + (y * scale + j) * pitch + x * scale * channels;
+                for (int i = 0; i < cols; ++i, pixel += channels)
+                {
+                    sum[0] += pixel[0];
+                    sum[1] += pixel[1];
+                    sum[2] += pixel[2];
+                    sum[3] += channels == 4 ? pixel[3] : 255;
+                }
+            }
+            const unsigned int count = rows * cols;
+            for (int c = 0; c < 4; ++c)
+                dst[c] = static_cast<uint8_t>((sum[c] + count / 2) / count);
+        }
+    }
+
+    auto scaled = new Image();
+    scaled->initWithRawData(pixels.data(), static_cast<ssize_t>(pixels.size()), width, height, 8,
+                            image->hasPremultipliedAlpha());
+    return scaled;
+}
+
+void TextureCache::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+    scheduleResidencyUpdate();
+}
+
+void TextureCache::setIdleDownscale(unsigned int idleFrames, int level)
+{
+    _idleDownscaleFrames = idleFrames;
+    _idleDownscaleLevel  = (std::max)(level, 1);
+    scheduleResidencyUpdate();
+}
+
+size_t TextureCache::getMemoryUsage() const
+{
+    size_t bytes = 0;
+    for (auto&& item : _textures)
+        bytes += item.second->getMemoryBytes();
+    return bytes;
+}
+
+void TextureCache::scheduleResidencyUpdate()
+{
+    bool needed = _memoryBudget > 0 || _idleDownscaleFrames > 0;
+    if (needed == _residencyScheduled)
+        return;
+
+    auto scheduler = Director::getInstance()->getScheduler();
+    if (needed)
+        scheduler->schedule(AX_SCHEDULE_SELECTOR(TextureCache::updateResidency), this, 0.5f, false);
+    else
+        scheduler->unschedule(AX_SCHEDULE_SELECTOR(TextureCache::updateResidency), this);
+    _residencyScheduled = needed;
+}
+
+size_t TextureCache::purgeToMemoryBudget()
+{
+    if (_memoryBudget == 0)
+        return 0;
+
+    size_t usage = getMemoryUsage();
+    if (usage <= _memoryBudget)
+        return 0;
+
+    // only textures loaded from files can be loaded again
+    std::vector<std::pair<unsigned int, std::string>> candidates;
+    for (auto&& item : _textures)
+    {
+        if (item.second->getReferenceCount() == 1 && item.second->getPath() == item.first)
+            candidates.emplace_back(item.second->getLastUsedFrame(), item.first);
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    size_t freed = 0;
+    for (auto&& candidate : candidates)
+    {
+        if (usage - freed <= _memoryBudget)
+            break;
+
+        auto it    = _textures.find(candidate.second);
+        auto bytes = it->second->getMemoryBytes();
+        AXLOG("axmol: TextureCache: evicting texture over budget: %s, %u KB", it->first.c_str(),
+              static_cast<unsigned int>(bytes / 1024));
+        it->second->release();
+        _textures.erase(it);
+        freed += bytes;
+    }
+    return freed;
+}
+
+void TextureCache::updateResidency(float /*dt*/)
+{
+    purgeToMemoryBudget();
+
+    if (_idleDownscaleFrames == 0)
+        return;
+
+    const auto frame = Director::getInstance()->getTotalFrames();
+    for (auto&& item : _textures)
+    {
+        auto texture = item.second;
+        if (_residencyRequests.count(texture) || texture->getPath() != item.first)
+            continue;
+
+        int level = frame - texture->getLastUsedFrame() >= _idleDownscaleFrames ? _idleDownscaleLevel : 0;
+        if (level == texture->getResidentLevel())
+            continue;
+
+        if (level > 0 && (backend::PixelFormatUtils::isCompressed(texture->getPixelFormat()) ||
+                          texture->hasMipmaps() || texture->isRenderTarget() ||
+                          (texture->getSamplerFlags() & TextureSamplerFlag::DUAL_SAMPLER)))
+            continue;
+
+        requestResidentLevel(item.first, texture, level);
+    }
+}
+
+void TextureCache::requestResidentLevel(std::string_view key, Texture2D* texture, int level)
+{
+    struct ResidencyResult
+    {
+        ~ResidencyResult() { AX_SAFE_RELEASE(image); }
+        Image* image = nullptr;
+    };
+    auto result = std::make_shared<ResidencyResult>();
+
+    texture->retain();
+    _residencyRequests.emplace(texture);
+
+    std::weak_ptr<bool> token = _residencyToken;
+    std::string path{key};
+    auto renderFormat = texture->getPixelFormat();
+    AsyncTaskPool::getInstance()->enqueue(
+        AsyncTaskPool::TaskType::TASK_IO,
+        [this, token, texture, result, path, level](void*) {
+            if (token.expired())
+            {
+                texture->release();
+                return;
+            }
+
+            if (!result->image)
+            {
+                _residencyRequests.erase(texture);
+                texture->release();
+                return;
+            }
+
+            // keeps the texture retained until uploaded
+            _residencyUploads.push_back(ResidencyUpload{path, texture, result->image, level});
+            result->image = nullptr;
+            if (!_residencyUploadsScheduled)
+            {
+                Director::getInstance()->getScheduler()->schedule(
+                    AX_SCHEDULE_SELECTOR(TextureCache::uploadResidentImages), this, 0, false);
+                _residencyUploadsScheduled = true;
+            }
+        },
+        nullptr,
+        [result, path, level, renderFormat]() {
+            auto image = new Image();
+            if (image->initWithImageFileThreadSafe(path))
+            {
+                if (level > 0)
+                {
+                    result->image = createDownscaledImage(image, level);
+                    image->release();
+                }
+                else
+                    result->image = image;
+
+                // convert here, so the render thread only uploads
+                if (result->image)
+                    result->image->convertPixelFormatInPlace(renderFormat);
+            }
+            else
+                image->release();
+        });
+}
+
+void TextureCache::uploadResidentImages(float /*dt*/)
+{
+    int uploads = 0;
+    while (uploads < MAX_RESIDENCY_UPLOADS_PER_FRAME && !_residencyUploads.empty())
+    {
+        auto upload = _residencyUploads.front();
+        _residencyUploads.pop_front();
+        _residencyRequests.erase(upload.texture);
+
+        // the texture may be removed or replaced while loading, those don't take an upload
+        auto it   = _textures.find(upload.key);
+        auto size = (std::max)(upload.texture->getPixelsWide() >> upload.level, 1);
+        if (it != _textures.end() && it->second == upload.texture && upload.image->getWidth() == size)
+        {
+            upload.texture->updateResidentImage(upload.image, upload.level);
+            ++uploads;
+        }
+        upload.image->release();
+        upload.texture->release();
+    }
+
+    if (_residencyUploads.empty())
+    {
+        Director::getInstance()->getScheduler()->unschedule(AX_SCHEDULE_SELECTOR(TextureCache::uploadResidentImages),
+                                                            this);
+        _residencyUploadsScheduled = false;
+    }
+}
+
+std::vector<TextureCache::TextureMemoryInfo> TextureCache::getTextureMemoryReport() const
+{
+    std::vector<TextureMemoryInfo> report;
+    report.reserve(_textures.size());
+    for (auto&& item : _textures)
+    {
+        auto texture = item.second;
+        report.push_back(TextureMemoryInfo{item.first, texture->getMemoryBytes(), texture->getPixelFormat(),
+                                           texture->getPixelsWide(), texture->getPixelsHigh(),
+                                           texture->getResidentLevel(), texture->getLastUsedFrame(),
+                                           texture->getReferenceCount()});
+    }
+    std::sort(report.begin(), report.end(),
+              [](const TextureMemoryInfo& lhs, const TextureMemoryInfo& rhs) { return lhs.bytes > rhs.bytes; });
+    return report;
+}
+
 #if AX_ENABLE_CACHE_TEXTURE_DATA
 
 std::list<VolatileTexture*> VolatileTextureMgr::_textures;
@@ -930,7 +1220,8 @@ void VolatileTextureMgr::reloadTexture(Texture2D* texture, std::string_view file
     Image* image = new Image();
     Data data    = FileUtils::getInstance()->getDataFromFile(filename);
 
-    if (image->initWithImageData(data.getBytes(), data.getSize()))
+    image->setTransient(true);
+    if (image->initWithImageData(std::move(data)))
         texture->initWithImage(image, pixelFormat);
 
     AX_SAFE_DELETE(image);
@@ -35,9 +35,13 @@ THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <deque>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
+#include <memory>
+#include <vector>
 
 #include "base/Ref.h"
 #include "renderer/Texture2D.h"
@@ -65,6 +69,19 @@ NS_AX_BEGIN
 class AX_DLL TextureCache : public Ref
 {
 public:
+    /** The memory report entry of a cached texture. */
+    struct TextureMemoryInfo
+    {
+        std::string key;
+        size_t bytes;
+        backend::PixelFormat format;
+        int pixelsWide;
+        int pixelsHigh;
+        int residentLevel;
+        unsigned int lastUsedFrame;
+        unsigned int referenceCount;
+    };
+
     // ETC1 ALPHA supports.
     static void setETC1AlphaFileSuffix(std::string_view suffix);
     static std::string getETC1AlphaFileSuffix();
@@ -215,11 +232,46 @@ public:
      */
     void renameTextureWithKey(std::string_view srcName, std::string_view dstName);
 
+    /** Sets the GPU memory budget of the cached textures in bytes, 0 means no budget (default).
+     * When the cache goes over budget, unreferenced textures loaded from files are removed, least recently drawn
+     * first, they are loaded again by the next addImage.
+     */
+    void setMemoryBudget(size_t bytes);
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Gets the GPU memory used by the cached textures in bytes. */
+    size_t getMemoryUsage() const;
+
+    /** Downscales textures loaded from files which are not drawn for idleFrames, 0 disables it (default).
+     * The idle textures are reloaded in the background at 1/2^level resolution, and at full resolution once they are
+     * drawn again. Only textures with uncompressed formats and without mipmaps are downscaled.
+     *
+     * @param idleFrames The frames a texture is not drawn before downscaling.
+     * @param level The resident mip level of the idle textures, 1 means half width and height.
+     */
+    void setIdleDownscale(unsigned int idleFrames, int level = 1);
+    unsigned int getIdleDownscaleFrames() const { return _idleDownscaleFrames; }
+
+    /** Removes unreferenced textures until the cache fits the memory budget.
+     * It's called periodically when a budget is set.
+     *
+     * @return The bytes freed.
+     */
+    size_t purgeToMemoryBudget();
+
+    /** Gets the memory report of all cached textures, sorted by bytes. */
+    std::vector<TextureMemoryInfo> getTextureMemoryReport() const;
+
 private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
     void parseNinePatchImage(Image* image, Texture2D* texture, std::string_view path);
 
+    void updateResidency(float dt);
+    void scheduleResidencyUpdate();
+    void requestResidentLevel(std::string_view key, Texture2D* texture, int level);
+    void uploadResidentImages(float dt);
+
 public:
 protected:
     struct AsyncStruct;
@@ -241,6 +293,26 @@ protected:
 
     hlookup::string_map<Texture2D*> _textures;
 
+    size_t _memoryBudget              = 0;
+    unsigned int _idleDownscaleFrames = 0;
+    int _idleDownscaleLevel           = 1;
+    bool _residencyScheduled          = false;
+    // textures with a level reload in flight or waiting for upload
+    std::unordered_set<Texture2D*> _residencyRequests;
+
+    struct ResidencyUpload
+    {
+        std::string key;
+        Texture2D* texture;
+        Image* image;
+        int level;
+    };
+    // the loaded levels, a few are uploaded per frame so a burst of reloads doesn't stall a frame
+    std::deque<ResidencyUpload> _residencyUploads;
+    bool _residencyUploadsScheduled = false;
+    // the pending reloads are dropped once the cache is destroyed
+    std::shared_ptr<bool> _residencyToken;
+
     static std::string s_etc1AlphaFileSuffix;
 };
 
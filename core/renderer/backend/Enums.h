@@ -389,6 +389,10 @@ struct ProgramType
         VIDEO_TEXTURE_NV12,
         VIDEO_TEXTURE_BGR32,
 
+        SKINPOSITION_TEXTURE_3D_PALETTE,      // skinPositionTexturePalette_vert,  colorTexture_frag
+        SKINPOSITION_TEXTURE_3D_INSTANCE,     // skinPositionTextureInstance_vert, colorTexture_frag
+        TERRAIN_3D_TILED,                     // terrainTiled_vert,                terrain_frag
+
         BUILTIN_COUNT,
 
         VIDEO_TEXTURE_RGB32 = POSITION_TEXTURE_COLOR,
@@ -486,13 +486,18 @@ void convertA8ToRGBA8(const unsigned char* data, size_t dataLen, unsigned char*
 
 void convertBGRA8ToRGBA8(const unsigned char* data, size_t dataLen, unsigned char* outData)
 {
+    // read the whole pixel before writing, so outData can be data
     const size_t pixelCounts = dataLen / 4;
     for (size_t i = 0; i < pixelCounts; i++)
     {
-        *outData++ = data[i * 4 + 2];
-        *outData++ = data[i * 4 + 1];
-        *outData++ = data[i * 4 + 0];
-        *outData++ = data[i * 4 + 3];
+        const unsigned char b = data[i * 4 + 0];
+        const unsigned char g = data[i * 4 + 1];
+        const unsigned char r = data[i * 4 + 2];
+        const unsigned char a = data[i * 4 + 3];
+        *outData++            = r;
+        *outData++            = g;
+        *outData++            = b;
+        *outData++            = a;
     }
 }
 
@@ -954,6 +959,97 @@ ax::backend::PixelFormat convertDataToFormat(const unsigned char* data,
         return originFormat;
     }
 }
+/*
+ All converters walk pixels forward and never write ahead of the pixel being read,
+ so the ones don't widen pixels can work in place.
+ */
+bool convertDataToFormatInPlace(unsigned char* data,
+                                size_t dataLen,
+                                PixelFormat originFormat,
+                                PixelFormat format,
+                                size_t* outDataLen)
+{
+    using converter_t = void (*)(const unsigned char*, size_t, unsigned char*);
+
+    converter_t converter = nullptr;
+    switch (originFormat)
+    {
+    case PixelFormat::RGBA8:
+        switch (format)
+        {
+        case PixelFormat::RGB8:
+            converter = convertRGBA8ToRGB8;
+            break;
+        case PixelFormat::RGB565:
+            converter = convertRGBA8ToRGB565;
+            break;
+        case PixelFormat::RGBA4:
+            converter = convertRGBA8ToRGBA4;
+            break;
+        case PixelFormat::RGB5A1:
+            converter = convertRGBA8ToRGB5A1;
+            break;
+        case PixelFormat::A8:
+            converter = convertRGBA8ToA8;
+            break;
+        case PixelFormat::L8:
+            converter = convertRGBA8ToL8;
+            break;
+        case PixelFormat::LA8:
+            converter = convertRGBA8ToLA8;
+            break;
+        default:
+            break;
+        }
+        break;
+    case PixelFormat::RGB8:
+        switch (format)
+        {
+        case PixelFormat::RGB565:
+            converter = convertRGB8ToRGB565;
+            break;
+        case PixelFormat::RGBA4:
+            converter = convertRGB8ToRGBA4;
+            break;
+        case PixelFormat::RGB5A1:
+            converter = convertRGB8ToRGB5A1;
+            break;
+        case PixelFormat::A8:
+            converter = convertRGB8ToA8;
+            break;
+        case PixelFormat::L8:
+            converter = convertRGB8ToL8;
+            break;
+        case PixelFormat::LA8:
+            converter = convertRGB8ToLA8;
+            break;
+        default:
+            break;
+        }
+        break;
+    case PixelFormat::LA8:
+        if (format == PixelFormat::A8)
+            converter = convertLA8ToA8;
+        else if (format == PixelFormat::L8)
+            converter = convertLA8ToL8;
+        break;
+    case PixelFormat::BGRA8:
+        if (format == PixelFormat::RGBA8)
+            converter = convertBGRA8ToRGBA8;
+        break;
+    default:
+        break;
+    }
+
+    if (!converter)
+        return false;
+
+    converter(data, dataLen, data);
+    const auto srcBytesPerPixel = getBitsPerPixel(originFormat) / 8;
+    const auto dstBytesPerPixel = getBitsPerPixel(format) / 8;
+    *outDataLen                 = dataLen / srcBytesPerPixel * dstBytesPerPixel;
+    return true;
+}
 }  // namespace PixelFormatUtils
 }  // namespace backend
 
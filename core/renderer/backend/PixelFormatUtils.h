@@ -74,6 +74,17 @@ PixelFormat convertDataToFormat(const unsigned char* data,
                                 unsigned char** outData,
                                 size_t* outDataLen);
 
+/**
+Convert the data to the format param you specified in the same buffer, no extra buffer is allocated.
+Only conversions which don't widen pixels (e.g. RGBA8 -> RGB565, BGRA8 -> RGBA8) can be done in place.
+@return true if converted, the converted data length is stored to outDataLen.
+*/
+bool convertDataToFormatInPlace(unsigned char* data,
+                                size_t dataLen,
+                                PixelFormat originFormat,
+                                PixelFormat format,
+                                size_t* outDataLen);
+
 PixelFormat convertL8ToFormat(const unsigned char* data,
                               size_t dataLen,
                               PixelFormat format,
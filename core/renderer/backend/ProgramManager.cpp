@@ -132,6 +132,10 @@ bool ProgramManager::init()
                     VertexLayoutType::Unspec);
     registerProgram(ProgramType::POSITION_TEXTURE_3D_INSTANCE, positionTextureInstance_vert, colorTexture_frag,
                     VertexLayoutType::Unspec);
+    registerProgram(ProgramType::SKINPOSITION_TEXTURE_3D_PALETTE, skinPositionTexturePalette_vert, colorTexture_frag,
+                    VertexLayoutType::Unspec);
+    registerProgram(ProgramType::SKINPOSITION_TEXTURE_3D_INSTANCE, skinPositionTextureInstance_vert,
+                    colorTexture_frag, VertexLayoutType::Unspec);
     registerProgram(ProgramType::POSITION_3D, position_vert, color_frag, VertexLayoutType::Unspec);
     registerProgram(ProgramType::POSITION_NORMAL_3D, positionNormalTexture_vert, colorNormal_frag,
                     VertexLayoutType::Unspec);
@@ -140,6 +144,7 @@ bool ProgramManager::init()
     registerProgram(ProgramType::SKINPOSITION_BUMPEDNORMAL_TEXTURE_3D, skinPositionNormalTexture_vert_1,
                     colorNormalTexture_frag_1, VertexLayoutType::Unspec);
     registerProgram(ProgramType::TERRAIN_3D, terrain_vert, terrain_frag, VertexLayoutType::Terrain3D);
+    registerProgram(ProgramType::TERRAIN_3D_TILED, terrainTiled_vert, terrain_frag, VertexLayoutType::Unspec);
     registerProgram(ProgramType::PARTICLE_TEXTURE_3D, particle_vert, particleTexture_frag, VertexLayoutType::PU3D);
     registerProgram(ProgramType::PARTICLE_COLOR_3D, particle_vert, particleColor_frag, VertexLayoutType::PU3D);
     registerProgram(ProgramType::QUAD_COLOR_2D, quadColor_vert, quadColor_frag, VertexLayoutType::Unspec);
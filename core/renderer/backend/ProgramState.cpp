@@ -166,6 +166,20 @@ void ProgramState::updateBatchId()
     _batchId = XXH64(_uniformBuffers.data(), _uniformBuffers.size(), _program->getProgramId());
 }
 
+void ProgramState::markTexturesUsed(unsigned int frame)
+{
+    if (_texturesUsedFrame == frame)
+        return;
+    _texturesUsedFrame = frame;
+
+    for (auto&& textureInfo : _vertexTextureInfos)
+        for (auto texture : textureInfo.second.textures)
+            texture->markUsed(frame);
+    for (auto&& textureInfo : _fragmentTextureInfos)
+        for (auto texture : textureInfo.second.textures)
+            texture->markUsed(frame);
+}
+
 void ProgramState::resetUniforms()
 {
 #if AX_ENABLE_CACHE_TEXTURE_DATA
@@ -306,6 +306,12 @@ public:
     */
     void updateBatchId();
 
+    /*
+    * Stamps the sampled textures with the frame they are drawn in, used by TextureCache residency.
+    * The renderer calls it for every draw call, the textures are only walked on the first call of a frame.
+    */
+    void markTexturesUsed(unsigned int frame);
+
     /*
      * Follow API is deprecated, use getMutableVertexLayout instead
      */
@@ -398,6 +404,9 @@ protected:
 
     uint64_t _batchId = -1;
 
+    // the frame of the last markTexturesUsed, the textures can't change while a frame is rendered
+    unsigned int _texturesUsedFrame = static_cast<unsigned int>(-1);
+
 #if AX_ENABLE_CACHE_TEXTURE_DATA
     EventListenerCustom* _backToForegroundListener = nullptr;
 #endif
@@ -103,6 +103,13 @@ public:
     int getWidth() const { return _width; }
     int getHeight() const { return _height; }
 
+    /**
+     * Set by the renderer when a draw call samples the texture.
+     * @param frame The Director total frames at the draw call.
+     */
+    void markUsed(unsigned int frame) { _lastUsedFrame = frame; }
+    unsigned int getLastUsedFrame() const { return _lastUsedFrame; }
+
 protected:
     /**
      * @param descriptor Specifies the texture descirptor.
@@ -117,6 +124,8 @@ protected:
     uint32_t _width       = 0;
     uint32_t _height      = 0;
 
+    unsigned int _lastUsedFrame = 0;
+
     TextureType _textureType   = TextureType::TEXTURE_2D;
     PixelFormat _textureFormat = PixelFormat::RGBA8;
     TextureUsage _textureUsage = TextureUsage::READ;
@@ -73,10 +73,16 @@ MTLVertexFormat toMTLVertexFormat(VertexFormat vertexFormat, bool needNormalize)
         ret = MTLVertexFormatInt;
         break;
     case VertexFormat::USHORT4:
-        ret = MTLVertexFormatUShort4;
+        if (needNormalize)
+            ret = MTLVertexFormatUShort4Normalized;
+        else
+            ret = MTLVertexFormatUShort4;
         break;
     case VertexFormat::USHORT2:
-        ret = MTLVertexFormatUShort2;
+        if (needNormalize)
+            ret = MTLVertexFormatUShort2Normalized;
+        else
+            ret = MTLVertexFormatUShort2;
         break;
     case VertexFormat::UBYTE4:
         if (needNormalize)
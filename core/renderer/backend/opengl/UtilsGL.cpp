@@ -122,6 +122,10 @@ GLenum UtilsGL::toGLAttributeType(VertexFormat vertexFormat)
     case VertexFormat::INT:
         ret = GL_INT;
         break;
+    case VertexFormat::USHORT4:
+    case VertexFormat::USHORT2:
+        ret = GL_UNSIGNED_SHORT;
+        break;
     case VertexFormat::UBYTE4:
         ret = GL_UNSIGNED_BYTE;
         break;
@@ -138,6 +142,7 @@ GLsizei UtilsGL::getGLAttributeSize(VertexFormat vertexFormat)
     {
     case VertexFormat::FLOAT4:
     case VertexFormat::INT4:
+    case VertexFormat::USHORT4:
     case VertexFormat::UBYTE4:
         ret = 4;
         break;
@@ -147,6 +152,7 @@ GLsizei UtilsGL::getGLAttributeSize(VertexFormat vertexFormat)
         break;
     case VertexFormat::FLOAT2:
     case VertexFormat::INT2:
+    case VertexFormat::USHORT2:
         ret = 2;
         break;
     case VertexFormat::FLOAT:
@@ -0,0 +1,35 @@
+
+// Matrix palettes packed by SkinningPaletteBuffer, 3 RGBA32F texels per bone, 341 bones per row of 1024 texels
+#define PALETTE_BONES_PER_ROW 341
+
+vec4 getPaletteRow(sampler2D palette, int bone, int row)
+{
+#ifdef GLES2
+    // no texelFetch, SkinningPaletteBuffer can't be enabled on GLES2
+    return vec4(0.0);
+#else
+    int y = bone / PALETTE_BONES_PER_ROW;
+    int x = (bone - y * PALETTE_BONES_PER_ROW) * 3 + row;
+    return texelFetch(palette, ivec2(x, y), 0);
+#endif
+}
+
+void getSkinMatrix(sampler2D palette, int firstBone, vec4 blendWeight, vec4 blendIndex,
+                   out vec4 matrixPalette1, out vec4 matrixPalette2, out vec4 matrixPalette3)
+{
+    int bone = firstBone + int(blendIndex[0]);
+    matrixPalette1 = getPaletteRow(palette, bone, 0) * blendWeight[0];
+    matrixPalette2 = getPaletteRow(palette, bone, 1) * blendWeight[0];
+    matrixPalette3 = getPaletteRow(palette, bone, 2) * blendWeight[0];
+
+    for (int i = 1; i < 4; ++i)
+    {
+        if (blendWeight[i] <= 0.0)
+            break;
+
+        bone = firstBone + int(blendIndex[i]);
+        matrixPalette1 += getPaletteRow(palette, bone, 0) * blendWeight[i];
+        matrixPalette2 += getPaletteRow(palette, bone, 1) * blendWeight[i];
+        matrixPalette3 += getPaletteRow(palette, bone, 2) * blendWeight[i];
+    }
+}
@@ -0,0 +1,56 @@
+#version 310 es
+
+#include "base.glsl"
+#include "skinPalette.glsl"
+
+layout(location = POSITION) in vec3 a_position;
+
+layout(location = BLENDWEIGHT) in vec4 a_blendWeight;
+layout(location = BLENDINDICES) in vec4 a_blendIndex;
+
+layout(location = TEXCOORD0) in vec2 a_texCoord;
+#if !defined(METAL)
+layout(location = TEXCOORD1) in mat4 a_instance;
+#endif
+
+// Varyings
+layout(location = TEXCOORD0) out vec2 v_texCoord;
+
+layout(std140, binding = 0) uniform vs_ub {
+    vec4 u_paletteParams;  // x: first bone of the first instance in u_paletteTex, y: bones per instance
+    mat4 u_MVPMatrix;
+};
+
+#if defined(METAL)
+layout(std140, binding = 1) buffer vs_inst {
+    mat4 u_instance[];
+};
+#endif
+
+layout(binding = 4) uniform sampler2D u_paletteTex;
+
+void main()
+{
+#ifdef GLES2
+    int instance = 0;
+#else
+    int instance = gl_InstanceIndex;
+#endif
+    int firstBone = int(u_paletteParams.x) + instance * int(u_paletteParams.y);
+
+    vec4 matrixPalette1, matrixPalette2, matrixPalette3;
+    getSkinMatrix(u_paletteTex, firstBone, a_blendWeight, a_blendIndex, matrixPalette1, matrixPalette2,
+                  matrixPalette3);
+
+    vec4 position = vec4(a_position, 1.0);
+    vec4 skinnedPosition = vec4(dot(position, matrixPalette1), dot(position, matrixPalette2),
+                                dot(position, matrixPalette3), 1.0);
+#if defined(METAL)
+    gl_Position = u_MVPMatrix * u_instance[gl_InstanceIndex] * skinnedPosition;
+#else
+    gl_Position = u_MVPMatrix * a_instance * skinnedPosition;
+#endif
+
+    v_texCoord = a_texCoord;
+    v_texCoord.y = 1.0 - v_texCoord.y;
+}
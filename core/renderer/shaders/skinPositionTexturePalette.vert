@@ -0,0 +1,36 @@
+#version 310 es
+
+#include "base.glsl"
+#include "skinPalette.glsl"
+
+layout(location = POSITION) in vec3 a_position;
+
+layout(location = BLENDWEIGHT) in vec4 a_blendWeight;
+layout(location = BLENDINDICES) in vec4 a_blendIndex;
+
+layout(location = TEXCOORD0) in vec2 a_texCoord;
+
+// Varyings
+layout(location = TEXCOORD0) out vec2 v_texCoord;
+
+layout(std140) uniform vs_ub {
+    vec4 u_paletteParams;  // x: first bone of the mesh in u_paletteTex
+    mat4 u_MVPMatrix;
+};
+
+layout(binding = 4) uniform sampler2D u_paletteTex;
+
+void main()
+{
+    vec4 matrixPalette1, matrixPalette2, matrixPalette3;
+    getSkinMatrix(u_paletteTex, int(u_paletteParams.x), a_blendWeight, a_blendIndex, matrixPalette1, matrixPalette2,
+                  matrixPalette3);
+
+    vec4 position = vec4(a_position, 1.0);
+    vec4 skinnedPosition = vec4(dot(position, matrixPalette1), dot(position, matrixPalette2),
+                                dot(position, matrixPalette3), 1.0);
+    gl_Position = u_MVPMatrix * skinnedPosition;
+
+    v_texCoord = a_texCoord;
+    v_texCoord.y = 1.0 - v_texCoord.y;
+}
@@ -0,0 +1,28 @@
+#version 310 es
+
+layout(location = POSITION) in vec4 a_position;
+layout(location = TEXCOORD0) in vec2 a_texCoord;
+layout(location = NORMAL) in vec3 a_normal;
+layout(location = TEXCOORD1) in vec2 a_texCoord1;  // x: height of the coarser LOD, y: the LOD the vertex morphs in
+layout(location = TEXCOORD0) out vec2 v_texCoord;
+layout(location = 1) out vec3 v_normal;
+
+layout(std140) uniform vs_ub {
+    mat4 u_MVPMatrix;
+    vec4 u_cameraPos;    // in terrain space
+    vec4 u_morphParams;  // x: morph start distance, y: morph end distance, z: LOD of the chunk
+};
+
+void main()
+{
+    vec4 position = a_position;
+    if (abs(a_texCoord1.y - u_morphParams.z) < 0.5)
+    {
+        float dist = distance(position.xz, u_cameraPos.xz);
+        float morph = clamp((dist - u_morphParams.x) / (u_morphParams.y - u_morphParams.x), 0.0, 1.0);
+        position.y = mix(position.y, a_texCoord1.x, morph);
+    }
+    gl_Position = u_MVPMatrix * position;
+    v_texCoord = a_texCoord;
+    v_normal = a_normal;
+}
@@ -46,6 +46,7 @@ FileUtilsTests::FileUtilsTests()
     ADD_TEST_CASE(TestWriteDataAsync);
     ADD_TEST_CASE(TestListFiles);
     ADD_TEST_CASE(TestIsFileExistRejectFolder);
+    ADD_TEST_CASE(TestFileManifest);
 }
 
 // TestSearchPath
@@ -1239,3 +1240,66 @@ std::string TestIsFileExistRejectFolder::subtitle() const
 {
     return "";
 }
+
+void TestFileManifest::onEnter()
+{
+    FileUtilsDemo::onEnter();
+
+    auto winSize         = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+
+    // a manifest usually generated by ax_gen_file_manifest at build time
+    auto manifestPath = sharedFileUtils->getWritablePath() + "files.manifest";
+    sharedFileUtils->writeStringToFile("# axmol file manifest\nImages/grossini.png\n", manifestPath);
+    sharedFileUtils->loadFileManifest(manifestPath);
+
+    bool pngExists = sharedFileUtils->isFileExist("Images/grossini.png");
+    bool xcfExists = sharedFileUtils->isFileExist("Images/grossini.xcf");
+
+    // non canonical spellings of a manifest entry must still be found
+    auto resRoot       = sharedFileUtils->getDefaultResourceRootPath();
+    bool dottedExists  = sharedFileUtils->isFileExist(resRoot + "Images/./fonts/../grossini.png");
+    bool doubledExists = sharedFileUtils->isFileExist(resRoot + "Images//grossini.png");
+
+    // probe a missing file repeatedly, only the first lookup walks the search paths
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10000; ++i)
+        sharedFileUtils->fullPathForFilename("Images/grossini-missing-hd.png");
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+    auto label = Label::createWithSystemFont(
+        StringUtils::format("grossini.png: %s, grossini.xcf: %s (expect true, false)", pngExists ? "true" : "false",
+                            xcfExists ? "true" : "false"), "", 20);
+    label->setPosition(winSize.width / 2, winSize.height * 2 / 3);
+    this->addChild(label);
+
+    label = Label::createWithSystemFont(
+        StringUtils::format("non canonical paths: %s, %s (expect true, true)", dottedExists ? "true" : "false",
+                            doubledExists ? "true" : "false"), "", 20);
+    label->setPosition(winSize.width / 2, winSize.height / 2);
+    this->addChild(label);
+
+    label = Label::createWithSystemFont(StringUtils::format("10000 missing file lookups: %d us", static_cast<int>(elapsed)), "", 20);
+    label->setPosition(winSize.width / 2, winSize.height / 3);
+    this->addChild(label);
+}
+
+void TestFileManifest::onExit()
+{
+    auto sharedFileUtils = FileUtils::getInstance();
+    sharedFileUtils->unloadFileManifest();
+    sharedFileUtils->removeFile(sharedFileUtils->getWritablePath() + "files.manifest");
+
+    FileUtilsDemo::onExit();
+}
+
+std::string TestFileManifest::title() const
+{
+    return "FileUtils: file manifest & missing path cache";
+}
+
+std::string TestFileManifest::subtitle() const
+{
+    return "";
+}
@@ -245,4 +245,15 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class TestFileManifest : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestFileManifest);
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif /* __FILEUTILSTEST_H__ */
@@ -29,6 +29,11 @@
 #include "2d/CameraBackgroundBrush.h"
 #include "3d/MeshMaterial.h"
 #include "3d/MotionStreak3D.h"
+#include "3d/SkinningPaletteBuffer.h"
+#include "3d/SceneBVH.h"
+#include "3d/Bundle3D.h"
+#include "3d/MeshVertexIndexData.h"
+#include "3d/GLTFLoader.h"
 
 #include "extensions/Particle3D/PU/PUParticleSystem3D.h"
 
@@ -74,6 +79,11 @@ MeshRendererTests::MeshRendererTests()
     ADD_TEST_CASE(MeshRendererPropertyTest);
     ADD_TEST_CASE(MeshRendererNormalMappingTest);
     ADD_TEST_CASE(Issue16155Test);
+    ADD_TEST_CASE(Animate3DStressTest);
+    ADD_TEST_CASE(SkinnedInstancingTest);
+    ADD_TEST_CASE(SceneCullingBenchmarkTest);
+    ADD_TEST_CASE(MeshLoadBenchmarkTest);
+    ADD_TEST_CASE(GLTFImportTest);
 };
 
 //------------------------------------------------------------------
@@ -2830,3 +2840,454 @@ std::string Issue16155Test::subtitle() const
 {
     return "Should not leak texture. See console";
 }
+
+//------------------------------------------------------------------
+//
+// Animate3DStressTest
+//
+//------------------------------------------------------------------
+
+Animate3DStressTest::Animate3DStressTest()
+{
+    std::string fileName = "MeshRendererTest/orc.c3b";
+    auto animation       = Animation3D::create(fileName);
+    if (!animation)
+        return;
+
+    auto s = Director::getInstance()->getWinSize();
+    FastRNG r{};
+    for (int i = 0; i < 200; i++)
+    {
+        auto mesh = MeshRenderer::create(fileName);
+        mesh->setScale(1.5f);
+        mesh->setRotation3D(Vec3(0.f, 180.f, 0.f));
+        mesh->setPosition(Vec2(r.rangef(0.1f, 0.9f) * s.width, r.rangef(0.1f, 0.8f) * s.height));
+        addChild(mesh);
+
+        // driven by update() instead of the action manager to time the evaluation alone
+        auto animate = Animate3D::create(animation);
+        animate->retain();
+        animate->startWithTarget(mesh);
+        _animates.emplace_back(animate);
+    }
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(Vec2(s.width / 2.f, s.height / 5.f));
+    addChild(_label, 1);
+
+    _stageItem = MenuItemFont::create("Parallel stage: off", AX_CALLBACK_1(Animate3DStressTest::switchStageCallback, this));
+    _stageItem->setColor(Color3B(0, 200, 20));
+    auto menu = Menu::create(_stageItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    _stageItem->setPosition(VisibleRect::left().x + 80, VisibleRect::top().y - 70);
+    addChild(menu, 1);
+
+    scheduleUpdate();
+}
+
+void Animate3DStressTest::onExit()
+{
+    SkeletalAnimationStage::getInstance()->setEnabled(false);
+    MeshRendererTestDemo::onExit();
+}
+
+void Animate3DStressTest::switchStageCallback(Ref* sender)
+{
+    auto stage = SkeletalAnimationStage::getInstance();
+    stage->setEnabled(!stage->isEnabled());
+    _stageItem->setString(stage->isEnabled() ? "Parallel stage: on" : "Parallel stage: off");
+    _totalUs      = 0.0;
+    _totalStageMs = 0.0;
+    _frames       = 0;
+}
+
+Animate3DStressTest::~Animate3DStressTest()
+{
+    for (auto&& animate : _animates)
+        animate->release();
+}
+
+std::string Animate3DStressTest::title() const
+{
+    return "Animate3D Stress Test";
+}
+
+std::string Animate3DStressTest::subtitle() const
+{
+    return "200 skinned characters, toggle the stage evaluating them on the job system";
+}
+
+void Animate3DStressTest::update(float dt)
+{
+    if (_animates.empty())
+        return;
+
+    auto duration = _animates.front()->getDuration();
+    _elapsed      = fmodf(_elapsed + dt, duration);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < _animates.size(); ++i)
+    {
+        // spread the characters over the clip so they don't animate in sync
+        auto t = fmodf(_elapsed + duration * i / _animates.size(), duration) / duration;
+        _animates[i]->update(t);
+    }
+    _totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    // the stage runs after this update, so it reports the previous frame
+    _totalStageMs += SkeletalAnimationStage::getInstance()->getLastRunTime();
+
+    if (++_frames == 60)
+    {
+        _label->setString(StringUtils::format("Animate3D::update of %d characters: %.1f us, stage: %.2f ms per frame",
+                                              static_cast<int>(_animates.size()), _totalUs / _frames,
+                                              _totalStageMs / _frames));
+        _totalUs      = 0.0;
+        _totalStageMs = 0.0;
+        _frames       = 0;
+    }
+}
+
+//------------------------------------------------------------------
+//
+// SkinnedInstancingTest
+//
+//------------------------------------------------------------------
+
+SkinnedInstancingTest::SkinnedInstancingTest()
+{
+    // has to be enabled before the mesh is created so it picks the palette programs
+    SkinningPaletteBuffer::getInstance()->setEnabled(true);
+    if (!SkinningPaletteBuffer::getInstance()->isEnabled())
+        return;
+
+    std::string fileName = "MeshRendererTest/orc.c3b";
+    auto mesh            = MeshRenderer::create(fileName);
+    mesh->setScale(1.5f);
+    mesh->setRotation3D(Vec3(0.f, 180.f, 0.f));
+
+    auto& s = Director::getInstance()->getWinSize();
+    mesh->setPosition(s.width / 2, s.height / 4);
+
+    auto animation = Animation3D::create(fileName);
+    if (animation)
+        mesh->runAction(RepeatForever::create(Animate3D::create(animation)));
+
+    mesh->enableInstancing(ax::MeshMaterial::InstanceMaterialType::UNLIT_INSTANCE, 500);
+
+    FastRNG r{};
+    for (int i = 0; i < 500; i++)
+    {
+        auto inst = Node::create();
+        inst->setPosition3D(Vec3(100 * r.rangef(-1.f, 1.f), 0.f, 100 * r.rangef(-1.f, 1.f)));
+        mesh->addInstanceChild(inst, true);
+    }
+
+    addChild(mesh);
+}
+
+void SkinnedInstancingTest::onExit()
+{
+    MeshRendererTestDemo::onExit();
+    SkinningPaletteBuffer::getInstance()->setEnabled(false);
+}
+
+std::string SkinnedInstancingTest::title() const
+{
+    return "Testing Skinned Instancing";
+}
+
+std::string SkinnedInstancingTest::subtitle() const
+{
+    return SkinningPaletteBuffer::getInstance()->isEnabled() ? "500 skinned orcs in one instanced draw"
+                                                             : "SkinningPaletteBuffer isn't supported";
+}
+
+//------------------------------------------------------------------
+//
+// SceneCullingBenchmarkTest
+//
+//------------------------------------------------------------------
+
+SceneCullingBenchmarkTest::SceneCullingBenchmarkTest()
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // 224 x 224 static boxes on a grid, the camera only sees a few hundred of them at once
+    const int side      = 224;
+    const float spacing = 10.f;
+    for (int z = 0; z < side; ++z)
+    {
+        for (int x = 0; x < side; ++x)
+        {
+            auto prop = MeshRenderer::create("MeshRendererTest/box.c3t");
+            prop->setTexture("MeshRendererTest/boss.png");
+            prop->setScale(2.f);
+            prop->setPosition3D(Vec3(x * spacing, 0.f, z * spacing));
+            prop->setCameraMask(static_cast<unsigned short>(CameraFlag::USER1));
+            addChild(prop);
+        }
+    }
+
+    auto camera = Camera::createPerspective(40.f, s.width / s.height, 1.f, 300.f);
+    camera->setCameraFlag(CameraFlag::USER1);
+    camera->setPosition3D(Vec3(side * spacing / 2, 30.f, side * spacing / 2));
+    camera->setRotation3D(Vec3(-10.f, 0.f, 0.f));
+    camera->runAction(RepeatForever::create(RotateBy::create(20.f, Vec3(0.f, 360.f, 0.f))));
+    addChild(camera);
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(Vec2(s.width / 2.f, s.height / 5.f));
+    addChild(_label, 1);
+
+    _cullingItem = MenuItemFont::create("Hierarchical culling: off",
+                                        AX_CALLBACK_1(SceneCullingBenchmarkTest::switchCullingCallback, this));
+    _cullingItem->setColor(Color3B(0, 200, 20));
+    auto menu = Menu::create(_cullingItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    _cullingItem->setPosition(VisibleRect::left().x + 100, VisibleRect::top().y - 70);
+    addChild(menu, 1);
+
+    // time the visit and the command submission of the scene, the culling saves on both
+    auto dispatcher   = Director::getInstance()->getEventDispatcher();
+    _beforeDrawListener = dispatcher->addCustomEventListener(
+        Director::EVENT_BEFORE_DRAW, [this](EventCustom*) { _visitStart = std::chrono::steady_clock::now(); });
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) {
+        _totalVisitMs +=
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _visitStart).count();
+    });
+
+    scheduleUpdate();
+}
+
+SceneCullingBenchmarkTest::~SceneCullingBenchmarkTest()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_beforeDrawListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+}
+
+void SceneCullingBenchmarkTest::switchCullingCallback(Ref* sender)
+{
+    setHierarchicalCulling(!isHierarchicalCulling());
+    _cullingItem->setString(isHierarchicalCulling() ? "Hierarchical culling: on" : "Hierarchical culling: off");
+    _totalVisitMs = 0.0;
+    _frames       = 0;
+}
+
+std::string SceneCullingBenchmarkTest::title() const
+{
+    return "Scene Culling Benchmark";
+}
+
+std::string SceneCullingBenchmarkTest::subtitle() const
+{
+    return "50176 static boxes, a few hundred in view";
+}
+
+void SceneCullingBenchmarkTest::update(float dt)
+{
+    if (++_frames < 60)
+        return;
+
+    auto bvh = getSceneBVH();
+    if (bvh)
+        _label->setString(StringUtils::format("scene: %.2f ms per frame, %d of %d visible, %d tree nodes tested",
+                                              _totalVisitMs / _frames, bvh->getLastVisibleCount(),
+                                              bvh->getProxyCount(), bvh->getLastTestCount()));
+    else
+        _label->setString(StringUtils::format("scene: %.2f ms per frame", _totalVisitMs / _frames));
+    _totalVisitMs = 0.0;
+    _frames       = 0;
+}
+
+MeshLoadBenchmarkTest::MeshLoadBenchmarkTest()
+{
+    _paths.emplace_back("MeshRendererTest/ReskinGirl.c3b");
+    _paths.emplace_back("MeshRendererTest/LightMapScene.c3b");
+    _paths.emplace_back("MeshRendererTest/girl.c3b");
+    _paths.emplace_back("MeshRendererTest/mesh_model.c3b");
+
+    auto s = Director::getInstance()->getWinSize();
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(Vec2(s.width / 2.f, s.height / 5.f));
+    addChild(_label, 1);
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    auto item = MenuItemFont::create("Run benchmark", AX_CALLBACK_1(MeshLoadBenchmarkTest::runBenchmarkCallback, this));
+    item->setColor(Color3B(0, 200, 20));
+    auto menu = Menu::create(item, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    item->setPosition(VisibleRect::left().x + 80, VisibleRect::top().y - 70);
+    addChild(menu, 1);
+
+    scheduleUpdate();
+    runBenchmarkCallback(nullptr);
+}
+
+std::string MeshLoadBenchmarkTest::title() const
+{
+    return "c3b Load Benchmark";
+}
+
+std::string MeshLoadBenchmarkTest::subtitle() const
+{
+    return "read + copy vs mmap + zero copy, then createAsync";
+}
+
+void MeshLoadBenchmarkTest::onExit()
+{
+    // Note that you must stop the tasks before leaving the scene.
+    AsyncTaskPool::getInstance()->stopTasks(AsyncTaskPool::TaskType::TASK_IO);
+    MeshRendererTestDemo::onExit();
+}
+
+double MeshLoadBenchmarkTest::loadModels(bool zeroCopy, int count, size_t& heapBytes)
+{
+    auto fileUtils = FileUtils::getInstance();
+    heapBytes      = 0;
+    auto start     = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i)
+    {
+        for (const auto& path : _paths)
+        {
+            auto fullPath = fileUtils->fullPathForFilename(path);
+            auto bundle   = Bundle3D::createBundle();
+            bundle->setZeroCopy(zeroCopy);
+            MeshDatas meshdatas;
+            if (bundle->load(fullPath) && bundle->loadMeshDatas(meshdatas))
+            {
+                for (auto meshdata : meshdatas.meshDatas)
+                {
+                    MeshVertexData::create(*meshdata, CustomCommand::IndexFormat::U_SHORT);
+                    if (i == 0)
+                    {
+                        // the file buffer and the vectors holding a copy of the blobs until the upload
+                        heapBytes += meshdata->vertex.size() * sizeof(float);
+                        for (const auto& indices : meshdata->subMeshIndices)
+                            heapBytes += indices.bsize();
+                    }
+                }
+                if (i == 0 && !meshdatas.meshDatas.empty() && !meshdatas.meshDatas[0]->mapping)
+                    heapBytes += static_cast<size_t>(fileUtils->getFileSize(fullPath));
+            }
+            meshdatas.resetData();
+            Bundle3D::destroyBundle(bundle);
+        }
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void MeshLoadBenchmarkTest::runBenchmarkCallback(Ref* sender)
+{
+    if (_asyncLoading)
+        return;
+
+    const int count = 10;
+    size_t copyBytes = 0, mappedBytes = 0;
+    // warm up the file cache so both runs read from memory
+    loadModels(false, 1, copyBytes);
+    auto copyMs   = loadModels(false, count, copyBytes);
+    auto mappedMs = loadModels(true, count, mappedBytes);
+    _syncResult   = StringUtils::format(
+        "%d models: read %.1f ms, %.1f KB heap | mmap %.1f ms, %.1f KB heap", static_cast<int>(_paths.size()),
+        copyMs / count, copyBytes / 1024.f, mappedMs / count, mappedBytes / 1024.f);
+    _label->setString(_syncResult);
+
+    // then load them in the background, only the uploads and the node creation run on this thread
+    removeChildByTag(101);
+    auto node = Node::create();
+    node->setTag(101);
+    addChild(node);
+    MeshRendererCache::getInstance()->removeAllMeshRenderData();
+    _asyncLoading = true;
+    _maxFrameMs   = 0.f;
+    _asyncStart   = std::chrono::steady_clock::now();
+    MeshRenderer::createAsync(_paths[0], AX_CALLBACK_2(MeshLoadBenchmarkTest::asyncLoadCallback, this), nullptr);
+}
+
+void MeshLoadBenchmarkTest::asyncLoadCallback(MeshRenderer* mesh, void* param)
+{
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _asyncStart).count();
+    _asyncLoading = false;
+
+    auto s = Director::getInstance()->getWinSize();
+    mesh->setPosition(Vec2(s.width / 2.f, s.height / 3.f));
+    mesh->setScale(3.f);
+    getChildByTag(101)->addChild(mesh);
+
+    _label->setString(StringUtils::format("%s\ncreateAsync: %.1f ms, longest frame meanwhile %.1f ms",
+                                          _syncResult.c_str(), ms, _maxFrameMs));
+}
+
+void MeshLoadBenchmarkTest::update(float dt)
+{
+    if (_asyncLoading)
+        _maxFrameMs = std::max(_maxFrameMs, dt * 1000.f);
+}
+
+GLTFImportTest::GLTFImportTest()
+{
+    auto s = Director::getInstance()->getWinSize();
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(Vec2(s.width / 2.f, s.height / 5.f));
+    addChild(_label, 1);
+
+    // import the flattened mesh of the file as is and optimized, to show what the optimization gains
+    auto fullPath = FileUtils::getInstance()->fullPathForFilename("MeshRendererTest/boss.glb");
+    MeshDatas meshdatas;
+    MaterialDatas materialdatas;
+    NodeDatas nodedatas;
+    GLTFImportOptions options;
+    options.optimize = false;
+    options.quantize = false;
+    GLTFImportStats rawStats, stats;
+    GLTFLoader::load(fullPath, meshdatas, materialdatas, nodedatas, options, &rawStats);
+    auto start = std::chrono::steady_clock::now();
+    GLTFLoader::load(fullPath, meshdatas, materialdatas, nodedatas, GLTFImportOptions(), &stats);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    _importResult = StringUtils::format(
+        "%d triangles, vertices %d -> %d, %.1f KB -> %.1f KB, ACMR %.2f -> %.2f, import %.2f ms",
+        static_cast<int>(stats.triangles), static_cast<int>(stats.sourceVertices), static_cast<int>(stats.vertices),
+        rawStats.bytes / 1024.f, stats.bytes / 1024.f, rawStats.acmr, stats.acmr, ms);
+    _label->setString(_importResult);
+
+    auto mesh = MeshRenderer::create("MeshRendererTest/boss.glb");
+    mesh->setScale(5.f);
+    mesh->setPositionNormalized(Vec2(.3f, .5f));
+    mesh->setRotation3D(Vec3(90.0f, 0.0f, 0.0f));
+    addChild(mesh);
+
+    MeshRendererCache::getInstance()->removeMeshRenderData("MeshRendererTest/boss.glb");
+    _asyncStart = std::chrono::steady_clock::now();
+    MeshRenderer::createAsync("MeshRendererTest/boss.glb", AX_CALLBACK_2(GLTFImportTest::asyncLoadCallback, this),
+                              nullptr);
+}
+
+std::string GLTFImportTest::title() const
+{
+    return "glTF Import";
+}
+
+std::string GLTFImportTest::subtitle() const
+{
+    return "left: create, right: createAsync";
+}
+
+void GLTFImportTest::onExit()
+{
+    // Note that you must stop the tasks before leaving the scene.
+    AsyncTaskPool::getInstance()->stopTasks(AsyncTaskPool::TaskType::TASK_IO);
+    MeshRendererTestDemo::onExit();
+}
+
+void GLTFImportTest::asyncLoadCallback(MeshRenderer* mesh, void* param)
+{
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _asyncStart).count();
+    mesh->setScale(5.f);
+    mesh->setPositionNormalized(Vec2(.7f, .5f));
+    mesh->setRotation3D(Vec3(90.0f, 0.0f, 0.0f));
+    addChild(mesh);
+
+    _label->setString(StringUtils::format("%s\ncreateAsync: %.1f ms", _importResult.c_str(), ms));
+}
@@ -27,6 +27,7 @@
 #include "BaseTest.h"
 #include "renderer/backend/ProgramState.h"
 #include <string>
+#include <chrono>
 
 NS_AX_BEGIN
 class Animate3D;
@@ -661,3 +662,101 @@ public:
     virtual std::string title() const override;
     virtual std::string subtitle() const override;
 };
+
+class Animate3DStressTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(Animate3DStressTest);
+    Animate3DStressTest();
+    virtual ~Animate3DStressTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+    virtual void onExit() override;
+
+    void switchStageCallback(ax::Ref* sender);
+
+protected:
+    std::vector<ax::Animate3D*> _animates;
+    ax::Label* _label               = nullptr;
+    ax::MenuItemFont* _stageItem    = nullptr;
+    float _elapsed                  = 0.f;
+    double _totalUs                 = 0.0;
+    double _totalStageMs            = 0.0;
+    int _frames                     = 0;
+};
+
+class SkinnedInstancingTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(SkinnedInstancingTest);
+    SkinnedInstancingTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onExit() override;
+};
+
+class SceneCullingBenchmarkTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(SceneCullingBenchmarkTest);
+    SceneCullingBenchmarkTest();
+    virtual ~SceneCullingBenchmarkTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+    void switchCullingCallback(ax::Ref* sender);
+
+protected:
+    ax::Label* _label                           = nullptr;
+    ax::MenuItemFont* _cullingItem              = nullptr;
+    ax::EventListenerCustom* _beforeDrawListener = nullptr;
+    ax::EventListenerCustom* _afterVisitListener = nullptr;
+    std::chrono::steady_clock::time_point _visitStart;
+    double _totalVisitMs = 0.0;
+    int _frames          = 0;
+};
+
+class MeshLoadBenchmarkTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(MeshLoadBenchmarkTest);
+    MeshLoadBenchmarkTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+    virtual void onExit() override;
+
+    void runBenchmarkCallback(ax::Ref* sender);
+
+protected:
+    // loads and uploads the models count times, returns the milliseconds taken and the heap bytes of the blobs
+    double loadModels(bool zeroCopy, int count, size_t& heapBytes);
+    void asyncLoadCallback(ax::MeshRenderer* mesh, void* param);
+
+    std::vector<std::string> _paths;
+    ax::Label* _label = nullptr;
+    std::string _syncResult;
+    std::chrono::steady_clock::time_point _asyncStart;
+    float _maxFrameMs = 0.f;  // longest main thread frame while the async load is running
+    bool _asyncLoading = false;
+};
+
+class GLTFImportTest : public MeshRendererTestDemo
+{
+public:
+    CREATE_FUNC(GLTFImportTest);
+    GLTFImportTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onExit() override;
+
+protected:
+    void asyncLoadCallback(ax::MeshRenderer* mesh, void* param);
+
+    ax::Label* _label = nullptr;
+    std::string _importResult;
+    std::chrono::steady_clock::time_point _asyncStart;
+};
+
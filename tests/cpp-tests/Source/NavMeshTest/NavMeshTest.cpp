@@ -45,6 +45,8 @@ NavMeshTests::NavMeshTests()
 #else
     ADD_TEST_CASE(NavMeshBasicTestDemo);
     ADD_TEST_CASE(NavMeshAdvanceTestDemo);
+    ADD_TEST_CASE(NavMeshCrowdTestDemo);
+    ADD_TEST_CASE(NavMeshRebuildTestDemo);
 #endif
 };
 
@@ -435,4 +437,214 @@ void NavMeshAdvanceTestDemo::touchesEnded(const std::vector<ax::Touch*>& touches
     }
 }
 
+bool NavMeshCrowdTestDemo::init()
+{
+    if (!NavMeshBaseTestDemo::init())
+        return false;
+
+    getNavMesh()->setDebugDrawEnable(false);
+
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    _modeLabel     = Label::createWithTTF(ttfConfig, "Crowd Update: Sync");
+    auto menuItem1 = MenuItemLabel::create(_modeLabel, [=](Ref*) {
+        bool async = !getNavMesh()->isCrowdUpdateAsync();
+        getNavMesh()->setCrowdUpdateAsync(async);
+        _modeLabel->setString(async ? "Crowd Update: Async" : "Crowd Update: Sync");
+        _frameTime = 0.0f;
+        _frames    = 0;
+    });
+    menuItem1->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    menuItem1->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 100));
+    auto menu = Menu::create(menuItem1, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu);
+
+    _statsLabel = Label::createWithTTF(ttfConfig, "");
+    _statsLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _statsLabel->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 130));
+    addChild(_statsLabel);
+
+    return true;
+}
+
+void NavMeshCrowdTestDemo::onEnter()
+{
+    NavMeshBaseTestDemo::onEnter();
+
+    // 500 agents on a grid, the ones off the navmesh are dropped by the crowd
+    for (int i = 0; i < 500; ++i)
+    {
+        Vec3 start((i % 25) * 3.0f - 36.0f, 50.0f, (i / 25) * 3.0f - 30.0f);
+        Physics3DWorld::HitResult result;
+        if (!getPhysics3DWorld()->rayCast(start, start - Vec3(0.0f, 100.0f, 0.0f), &result))
+            continue;
+
+        NavMeshAgentParam param;
+        param.radius   = 0.8f;
+        param.height   = 2.0f;
+        param.maxSpeed = 8.0f;
+        auto agent     = NavMeshAgent::create(param);
+        auto agentNode = MeshRenderer::create("MeshRendererTest/box.c3t");
+        agentNode->setScale(0.4f);
+        agentNode->addComponent(agent);
+        agentNode->setPosition3D(result.hitPosition);
+        agentNode->setCameraMask((unsigned short)CameraFlag::USER1);
+        this->addChild(agentNode);
+        _crowd.emplace_back(agent);
+    }
+}
+
+void NavMeshCrowdTestDemo::update(float delta)
+{
+    if (_pendingPaths)
+        ++_pathFrames;
+
+    _frameTime += delta;
+    if (++_frames == 60)
+    {
+        _statsLabel->setString(StringUtils::format("%d agents, %.2f ms per frame\n%d paths found in %u frames",
+                                                   static_cast<int>(_crowd.size()), _frameTime * 1000.0f / _frames,
+                                                   _foundPaths, _pathFrames));
+        _frameTime = 0.0f;
+        _frames    = 0;
+    }
+}
+
+void NavMeshCrowdTestDemo::touchesEnded(const std::vector<ax::Touch*>& touches, ax::Event* event)
+{
+    if (!_needMoveAgents || touches.empty())
+        return;
+
+    auto touch    = touches[0];
+    auto location = touch->getLocationInView();
+    Vec3 nearP(location.x, location.y, 0.0f), farP(location.x, location.y, 1.0f);
+
+    auto size = Director::getInstance()->getWinSize();
+    _camera->unproject(size, &nearP, &nearP);
+    _camera->unproject(size, &farP, &farP);
+
+    Physics3DWorld::HitResult result;
+    if (!getPhysics3DWorld()->rayCast(nearP, farP, &result))
+        return;
+
+    // the crowd plans its own paths, the async requests show the sliced search spread over frames
+    _foundPaths   = 0;
+    _pathFrames   = 0;
+    _pendingPaths = 0;
+    for (auto&& agent : _crowd)
+    {
+        agent->move(result.hitPosition);
+
+        auto owner = agent->getOwner();
+        Mat4 mat   = owner->getNodeToWorldTransform();
+        ++_pendingPaths;
+        getNavMesh()->findPathAsync(Vec3(mat.m[12], mat.m[13], mat.m[14]), result.hitPosition,
+                                    [this](const std::vector<Vec3>& pathPoints) {
+                                        --_pendingPaths;
+                                        if (!pathPoints.empty())
+                                            ++_foundPaths;
+                                    });
+    }
+}
+
+std::string NavMeshCrowdTestDemo::title() const
+{
+    return "Navigation Mesh Test";
+}
+
+std::string NavMeshCrowdTestDemo::subtitle() const
+{
+    return "Crowd Test, touch to move all agents";
+}
+
+bool NavMeshRebuildTestDemo::init()
+{
+    if (!NavMeshBaseTestDemo::init())
+        return false;
+
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    auto clearLabel = Label::createWithTTF(ttfConfig, "Remove Walls");
+    auto menuItem1  = MenuItemLabel::create(clearLabel, [=](Ref*) {
+        for (auto&& wall : _walls)
+        {
+            getNavMesh()->removeBlockingVolume(wall.first);
+            wall.second->removeFromParent();
+        }
+        _walls.clear();
+    });
+    menuItem1->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    menuItem1->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 100));
+    auto menu = Menu::create(menuItem1, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu);
+
+    _statusLabel = Label::createWithTTF(ttfConfig, "");
+    _statusLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _statusLabel->setPosition(Vec2(VisibleRect::left().x, VisibleRect::top().y - 130));
+    addChild(_statusLabel);
+
+    return true;
+}
+
+void NavMeshRebuildTestDemo::update(float delta)
+{
+    if (!getNavMesh())
+        return;
+
+    // the tiles are swapped in by the navmesh update, the frames keep going while they are built
+    if (getNavMesh()->isRebuildingTiles())
+    {
+        ++_rebuildFrames;
+        _statusLabel->setString(StringUtils::format("%d walls, rebuilding tiles", static_cast<int>(_walls.size())));
+    }
+    else
+    {
+        _statusLabel->setString(StringUtils::format("%d walls, tiles rebuilt over %u frames",
+                                                    static_cast<int>(_walls.size()), _rebuildFrames));
+    }
+}
+
+void NavMeshRebuildTestDemo::touchesEnded(const std::vector<ax::Touch*>& touches, ax::Event* event)
+{
+    if (!_needMoveAgents || touches.empty())
+        return;
+
+    auto touch    = touches[0];
+    auto location = touch->getLocationInView();
+    Vec3 nearP(location.x, location.y, 0.0f), farP(location.x, location.y, 1.0f);
+
+    auto size = Director::getInstance()->getWinSize();
+    _camera->unproject(size, &nearP, &nearP);
+    _camera->unproject(size, &farP, &farP);
+
+    Physics3DWorld::HitResult result;
+    if (!getPhysics3DWorld()->rayCast(nearP, farP, &result))
+        return;
+
+    // a wall across the touched point, the navmesh below it is cut out
+    const Vec3 halfExtents(8.0f, 4.0f, 1.0f);
+    auto wall = MeshRenderer::create("MeshRendererTest/box.c3t");
+    wall->setScaleX(halfExtents.x);
+    wall->setScaleY(halfExtents.y);
+    wall->setScaleZ(halfExtents.z);
+    wall->setPosition3D(result.hitPosition + Vec3(0.0f, halfExtents.y, 0.0f));
+    wall->setCameraMask((unsigned short)CameraFlag::USER1);
+    this->addChild(wall);
+
+    AABB box(result.hitPosition - Vec3(halfExtents.x, 0.0f, halfExtents.z),
+             result.hitPosition + Vec3(halfExtents.x, 2.0f * halfExtents.y, halfExtents.z));
+    _walls.emplace_back(getNavMesh()->addBlockingVolume(box), wall);
+    _rebuildFrames = 0;
+}
+
+std::string NavMeshRebuildTestDemo::title() const
+{
+    return "Navigation Mesh Test";
+}
+
+std::string NavMeshRebuildTestDemo::subtitle() const
+{
+    return "Tile Rebuild Test, touch to place a wall";
+}
+
 #endif
@@ -120,6 +120,54 @@ protected:
     ax::Label* _debugLabel;
 };
 
+class NavMeshCrowdTestDemo : public NavMeshBaseTestDemo
+{
+public:
+    CREATE_FUNC(NavMeshCrowdTestDemo);
+
+    // overrides
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    virtual void onEnter() override;
+    virtual void update(float delta) override;
+
+protected:
+    virtual void touchesEnded(const std::vector<ax::Touch*>& touches, ax::Event* event) override;
+
+protected:
+    std::vector<ax::NavMeshAgent*> _crowd;
+    ax::Label* _modeLabel     = nullptr;
+    ax::Label* _statsLabel    = nullptr;
+    int _pendingPaths         = 0;
+    int _foundPaths           = 0;
+    unsigned int _pathFrames  = 0;
+    float _frameTime          = 0.0f;
+    int _frames               = 0;
+};
+
+class NavMeshRebuildTestDemo : public NavMeshBaseTestDemo
+{
+public:
+    CREATE_FUNC(NavMeshRebuildTestDemo);
+
+    // overrides
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    virtual void update(float delta) override;
+
+protected:
+    virtual void touchesEnded(const std::vector<ax::Touch*>& touches, ax::Event* event) override;
+
+protected:
+    std::vector<std::pair<unsigned int, ax::Node*>> _walls;
+    ax::Label* _statusLabel = nullptr;
+    unsigned int _rebuildFrames = 0;
+};
+
 #endif
 
 #endif
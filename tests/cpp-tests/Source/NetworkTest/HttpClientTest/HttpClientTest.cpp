@@ -25,6 +25,9 @@
 
 #include "HttpClientTest.h"
 #include <string>
+#if !defined(__EMSCRIPTEN__)
+#include "yasio/yasio.hpp"
+#endif
 
 USING_NS_AX;
 using namespace ax::network;
@@ -37,6 +40,9 @@ HttpClientTests::HttpClientTests()
 {
     ADD_TEST_CASE(HttpClientTest);
     ADD_TEST_CASE(HttpClientClearRequestsTest);
+#if !defined(__EMSCRIPTEN__)
+    ADD_TEST_CASE(HttpClientKeepAliveTest);
+#endif
 }
 
 HttpClientTest::HttpClientTest() : _labelStatusCode(nullptr)
@@ -462,3 +468,182 @@ void HttpClientClearRequestsTest::onHttpRequestCompleted(HttpClient* sender, Htt
         // log("error buffer: %s", response->getErrorBuffer());
     }
 }
+
+#if !defined(__EMSCRIPTEN__)
+HttpClientKeepAliveTest::HttpClientKeepAliveTest()
+{
+    auto winSize = Director::getInstance()->getWinSize();
+
+    startServer();
+
+    const int MARGIN = 40;
+    const int SPACE  = 35;
+
+    auto menuRequest = Menu::create();
+    menuRequest->setPosition(Vec2::ZERO);
+    addChild(menuRequest);
+
+    // Sequential
+    auto labelSequential = Label::createWithTTF("Sequential Requests", "fonts/arial.ttf", 22);
+    auto itemSequential  = MenuItemLabel::create(
+        labelSequential, AX_CALLBACK_1(HttpClientKeepAliveTest::onMenuSequentialClicked, this));
+    itemSequential->setPosition(winSize.width / 2, winSize.height - MARGIN - 2 * SPACE);
+    menuRequest->addChild(itemSequential);
+
+    // Concurrent
+    auto labelConcurrent = Label::createWithTTF("Concurrent Requests", "fonts/arial.ttf", 22);
+    auto itemConcurrent  = MenuItemLabel::create(
+        labelConcurrent, AX_CALLBACK_1(HttpClientKeepAliveTest::onMenuConcurrentClicked, this));
+    itemConcurrent->setPosition(winSize.width / 2, winSize.height - MARGIN - 3 * SPACE);
+    menuRequest->addChild(itemConcurrent);
+
+    // Pipelined
+    auto labelPipelined = Label::createWithTTF("Pipelined Requests", "fonts/arial.ttf", 22);
+    auto itemPipelined =
+        MenuItemLabel::create(labelPipelined, AX_CALLBACK_1(HttpClientKeepAliveTest::onMenuPipelinedClicked, this));
+    itemPipelined->setPosition(winSize.width / 2, winSize.height - MARGIN - 4 * SPACE);
+    menuRequest->addChild(itemPipelined);
+
+    // Stats Label
+    _labelStats = Label::createWithTTF("", "fonts/arial.ttf", 18);
+    _labelStats->setAlignment(TextHAlignment::CENTER);
+    _labelStats->setPosition(winSize.width / 2, winSize.height / 2 - SPACE);
+    addChild(_labelStats);
+
+    reset("idle");
+}
+
+HttpClientKeepAliveTest::~HttpClientKeepAliveTest()
+{
+    HttpClient::destroyInstance();
+    delete _server;
+}
+
+void HttpClientKeepAliveTest::startServer()
+{
+    yasio::io_hostent endpoint{"127.0.0.1", PORT};
+    _server = new yasio::io_service(&endpoint, 1);
+    _server->set_option(yasio::YOPT_S_FORWARD_PACKET, 1);
+    _server->set_option(yasio::YOPT_C_MOD_FLAGS, 0, yasio::YCF_REUSEADDR, 0);
+    _server->start([this](yasio::event_ptr&& e) { handleServerEvent(e.get()); });
+    _server->open(0, yasio::YCK_TCP_SERVER);
+}
+
+void HttpClientKeepAliveTest::handleServerEvent(yasio::io_event* event)
+{
+    auto transport = event->transport();
+    if (!transport)
+        return;
+
+    switch (event->kind())
+    {
+    case yasio::YEK_ON_OPEN:
+        if (event->status() == 0)
+            ++_acceptedConnections;
+        break;
+    case yasio::YEK_ON_PACKET:
+    {
+        auto& input = _serverInputs[transport];
+        auto&& pkt  = event->packet_view();
+        input.append(pkt.data(), pkt.size());
+
+        // the requests have no body, every header block is a request, answer them in order
+        size_t pos;
+        while ((pos = input.find("\r\n\r\n")) != std::string::npos)
+        {
+            input.erase(0, pos + 4);
+            auto body  = StringUtils::format("connection #%u", transport->id());
+            auto reply = StringUtils::format(
+                "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: %d\r\n\r\n%s",
+                static_cast<int>(body.size()), body.c_str());
+            _server->write(transport, reply.data(), reply.size());
+        }
+        break;
+    }
+    case yasio::YEK_ON_CLOSE:
+        _serverInputs.erase(transport);
+        break;
+    }
+}
+
+void HttpClientKeepAliveTest::reset(std::string_view mode)
+{
+    // a new client starts with no connections and zeroed stats
+    HttpClient::destroyInstance();
+    _acceptedConnections = 0;
+
+    _mode              = mode;
+    _sentRequests      = 0;
+    _succeededRequests = 0;
+    _failedRequests    = 0;
+    updateStats();
+}
+
+void HttpClientKeepAliveTest::onMenuSequentialClicked(ax::Ref* sender)
+{
+    // every request is sent once the previous one completed, they should all share one connection
+    reset("sequential");
+    sendRequest(true);
+}
+
+void HttpClientKeepAliveTest::onMenuConcurrentClicked(ax::Ref* sender)
+{
+    // at most 4 connections, the rest of the requests wait for one of them to become idle
+    reset("concurrent");
+    HttpClient::getInstance()->setMaxConnectionsPerHost(4);
+    for (int i = 0; i < REQUEST_COUNT; ++i)
+        sendRequest(false);
+}
+
+void HttpClientKeepAliveTest::onMenuPipelinedClicked(ax::Ref* sender)
+{
+    // 2 connections taking up to 4 requests each before the responses arrive
+    reset("pipelined");
+    auto httpClient = HttpClient::getInstance();
+    httpClient->setMaxConnectionsPerHost(2);
+    httpClient->setMaxPipelineDepth(4);
+    for (int i = 0; i < REQUEST_COUNT; ++i)
+        sendRequest(false);
+}
+
+void HttpClientKeepAliveTest::sendRequest(bool chained)
+{
+    HttpRequest* request = new HttpRequest();
+    request->setUrl(StringUtils::format("http://127.0.0.1:%d/ping?id=%d", PORT, _sentRequests));
+    request->setRequestType(HttpRequest::Type::GET);
+    request->setResponseCallback(AX_CALLBACK_2(HttpClientKeepAliveTest::onHttpRequestCompleted, this));
+    request->setTag(chained ? "chained" : "");
+    HttpClient::getInstance()->send(request);
+    request->release();
+    ++_sentRequests;
+}
+
+void HttpClientKeepAliveTest::onHttpRequestCompleted(HttpClient* sender, HttpResponse* response)
+{
+    auto data = response->getResponseData();
+    if (response->isSucceed() && cxx20::starts_with(cxx17::string_view{data->data(), data->size()}, "connection #"))
+        ++_succeededRequests;
+    else
+    {
+        ax::print("request failed, response code: %d, internal code: %d", response->getResponseCode(),
+                  response->getInternalCode());
+        ++_failedRequests;
+    }
+
+    if (response->getHttpRequest()->getTag() == "chained" && _sentRequests < REQUEST_COUNT)
+        sendRequest(true);
+
+    updateStats();
+}
+
+void HttpClientKeepAliveTest::updateStats()
+{
+    auto stats = HttpClient::getInstance()->getConnectionStats();
+    _labelStats->setString(StringUtils::format(
+        "%s: %d of %d succeeded, %d failed\n"
+        "server accepted %d connections\n"
+        "client opened %u, reused %u, pipelined %u, retried %u",
+        _mode.c_str(), _succeededRequests, REQUEST_COUNT, _failedRequests, _acceptedConnections.load(),
+        stats.opened, stats.reused, stats.pipelined, stats.retried));
+}
+#endif
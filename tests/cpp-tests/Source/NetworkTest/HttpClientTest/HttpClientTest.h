@@ -80,4 +80,49 @@ private:
     ax::Label* _labelStatusCode;
 };
 
+#if !defined(__EMSCRIPTEN__)
+/**
+ * Sends requests to a loopback http server and shows how many connections the pool opened and reused.
+ */
+class HttpClientKeepAliveTest : public TestCase
+{
+public:
+    CREATE_FUNC(HttpClientKeepAliveTest);
+
+    static const int PORT          = 18099;
+    static const int REQUEST_COUNT = 20;
+
+    HttpClientKeepAliveTest();
+    virtual ~HttpClientKeepAliveTest();
+
+    // Menu Callbacks
+    void onMenuSequentialClicked(ax::Ref* sender);
+    void onMenuConcurrentClicked(ax::Ref* sender);
+    void onMenuPipelinedClicked(ax::Ref* sender);
+
+    virtual std::string title() const override { return "Http Keep-Alive Test"; }
+    virtual std::string subtitle() const override { return "requests to a loopback server share connections"; }
+
+private:
+    void startServer();
+    void handleServerEvent(yasio::io_event* event);
+
+    void sendRequest(bool chained);
+    void onHttpRequestCompleted(ax::network::HttpClient* sender, ax::network::HttpResponse* response);
+    void reset(std::string_view mode);
+    void updateStats();
+
+    yasio::io_service* _server = nullptr;
+    // only touched on the server thread
+    std::unordered_map<yasio::transport_handle_t, std::string> _serverInputs;
+    std::atomic<int> _acceptedConnections{0};
+
+    std::string _mode;
+    int _sentRequests      = 0;
+    int _succeededRequests = 0;
+    int _failedRequests    = 0;
+    ax::Label* _labelStats = nullptr;
+};
+#endif
+
 #endif  //__HTTPREQUESTHTTP_H
@@ -41,6 +41,10 @@ AudioEngineTests::AudioEngineTests()
     ADD_TEST_CASE(InvalidAudioFileTest);
     ADD_TEST_CASE(LargeAudioFileTest);
     ADD_TEST_CASE(AudioPerformanceTest);
+    ADD_TEST_CASE(AudioMixerTest);
+    ADD_TEST_CASE(AudioStreamingTest);
+    ADD_TEST_CASE(AudioCacheBudgetTest);
+    ADD_TEST_CASE(AudioPreloadBatchTest);
     ADD_TEST_CASE(AudioSmallFileTest);
     ADD_TEST_CASE(AudioSmallFile2Test);
     ADD_TEST_CASE(AudioSmallFile3Test);
@@ -872,6 +876,307 @@ std::string AudioIssue11143Test::subtitle() const
         ProfilingResetTimingBlock(String::createWithFormat("%08X - %s", __id__, __name__)->getCString()); \
     } while (0)
 
+bool AudioMixerTest::init()
+{
+    if (!AudioEngineTestDemo::init())
+        return false;
+
+    // the decoders are set up by the audio engine
+    AudioEngine::lazyInit();
+
+    auto fileUtils = FileUtils::getInstance();
+    for (int i = 81; i <= 90; ++i)
+    {
+        auto clip = AudioMixer::loadClip(
+            fileUtils->fullPathForFilename(StringUtils::format("audio/SoundEffectsFX009/FX0%d.mp3", i)));
+        if (clip)
+            _clips.emplace_back(std::move(clip));
+    }
+
+    auto& layerSize = this->getContentSize();
+
+    auto playItem = TextButton::create("Play 32 voices", [this](TextButton* button) {
+        auto mixer = AudioEngine::getMixer();
+        if (!mixer || _clips.empty())
+            return;
+        for (int i = 0; i < 32; ++i)
+        {
+            auto voice = mixer->play(_clips[i % _clips.size()], 0.2f, false, ax::random(0.5f, 1.5f),
+                                     ax::random(-1.0f, 1.0f));
+            if (i == 31)
+                mixer->setFinishCallback(voice,
+                                         [](AudioMixer::VOICE_ID voice) { AXLOG("mixer voice %d finished", voice); });
+        }
+    });
+    playItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.7f);
+    addChild(playItem);
+
+    auto benchItem = TextButton::create("Benchmark 64/128 voices offline", [this](TextButton* button) {
+        runBenchmark(64);
+        runBenchmark(AudioMixer::MAX_VOICES);
+    });
+    benchItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.55f);
+    addChild(benchItem);
+
+    _resultLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _resultLabel->setPosition(layerSize.width * 0.5f, layerSize.height * 0.35f);
+    addChild(_resultLabel);
+
+    return true;
+}
+
+void AudioMixerTest::runBenchmark(int voices)
+{
+    if (_clips.empty())
+        return;
+
+    // mix 10 seconds of looping, resampled voices into the null device as fast as possible
+    const uint64_t frames = 48000 * 10;
+    auto output           = new NullAudioMixerOutput();
+    AudioMixer mixer{std::unique_ptr<AudioMixerOutput>(output)};
+    for (int i = 0; i < voices; ++i)
+        mixer.play(_clips[i % _clips.size()], 0.05f, true, 0.5f + (i % 16) * 0.0625f, (i % 9) * 0.25f - 1.0f);
+
+    auto start = std::chrono::steady_clock::now();
+    mixer.renderOffline(frames);
+    auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    auto result = StringUtils::format("%d voices: %.1f ms for 10s, %.0fx realtime, peak %.2f", voices, ms,
+                                      10000.0 / std::max(ms, 0.001), output->getPeak());
+    AXLOG("AudioMixerTest: %s", result.c_str());
+    std::string text{_resultLabel->getString()};
+    _resultLabel->setString(voices == 64 ? result : text + "\n" + result);
+}
+
+void AudioMixerTest::onExit()
+{
+    if (auto mixer = AudioEngine::getMixer())
+        mixer->stopAll();
+    AudioEngineTestDemo::onExit();
+}
+
+std::string AudioMixerTest::title() const
+{
+    return "Software mixer";
+}
+
+std::string AudioMixerTest::subtitle() const
+{
+    return "Voices share one OpenAL source, see the benchmark result";
+}
+
+bool AudioStreamingTest::init()
+{
+    if (!AudioEngineTestDemo::init())
+        return false;
+
+    _largeBufferProfile.name              = "large stream buffers";
+    _largeBufferProfile.streamBufferTime  = 0.1f;
+    _largeBufferProfile.streamBufferCount = 8;
+
+    auto& layerSize = this->getContentSize();
+
+    auto playItem = TextButton::create("Play 4 streams, default buffers", [](TextButton* button) {
+        for (int i = 0; i < 4; ++i)
+            AudioEngine::play2d(i % 2 ? "audio/LuckyDay.mp3" : "background.mp3", false, 0.25f);
+    });
+    playItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.7f);
+    addChild(playItem);
+
+    auto playLargeItem = TextButton::create("Play 4 streams, 8 x 100ms buffers", [this](TextButton* button) {
+        for (int i = 0; i < 4; ++i)
+            AudioEngine::play2d(i % 2 ? "audio/LuckyDay.mp3" : "background.mp3", AudioPlayerSettings{false, 0.25f},
+                                &_largeBufferProfile);
+    });
+    playLargeItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.55f);
+    addChild(playLargeItem);
+
+    auto stopItem = TextButton::create("Stop all", [](TextButton* button) { AudioEngine::stopAll(); });
+    stopItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.4f);
+    addChild(stopItem);
+
+    _statsLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _statsLabel->setPosition(layerSize.width * 0.5f, layerSize.height * 0.25f);
+    addChild(_statsLabel);
+
+    schedule(
+        [this](float) {
+            auto stats = AudioEngine::getStreamStats();
+            _statsLabel->setString(StringUtils::format(
+                "streams: %u, wakeups: %llu, buffers: %llu\nunderruns: %u, max lateness: %.2f ms", stats.activeStreams,
+                static_cast<unsigned long long>(stats.wakeups), static_cast<unsigned long long>(stats.buffersQueued),
+                stats.underruns, stats.maxLatenessMs));
+        },
+        0.5f, "stats");
+
+    return true;
+}
+
+std::string AudioStreamingTest::title() const
+{
+    return "Streaming service";
+}
+
+std::string AudioStreamingTest::subtitle() const
+{
+    return "All streams are refilled by one thread, larger buffers mean fewer wakeups";
+}
+
+bool AudioCacheBudgetTest::init()
+{
+    if (!AudioEngineTestDemo::init())
+        return false;
+
+    auto& layerSize = this->getContentSize();
+
+    auto storageItem = TextButton::create("Storage: NATIVE", [](TextButton* button) {
+        static const char* names[] = {"NATIVE", "PCM16", "ADPCM"};
+        auto storage = static_cast<AudioCacheStorage>((static_cast<int>(AudioEngine::getCacheStorage()) + 1) % 3);
+        AudioEngine::uncacheAll();
+        AudioEngine::setCacheStorage(storage);
+        button->setString(StringUtils::format("Storage: %s", names[static_cast<int>(storage)]));
+    });
+    storageItem->setPosition(layerSize.width * 0.3f, layerSize.height * 0.75f);
+    addChild(storageItem);
+
+    auto budgetItem = TextButton::create("Budget: unlimited", [](TextButton* button) {
+        if (AudioEngine::getCacheBudget() == 0)
+        {
+            AudioEngine::setCacheBudget(512 * 1024);
+            button->setString("Budget: 512 KB");
+        }
+        else
+        {
+            AudioEngine::setCacheBudget(0);
+            button->setString("Budget: unlimited");
+        }
+    });
+    budgetItem->setPosition(layerSize.width * 0.7f, layerSize.height * 0.75f);
+    addChild(budgetItem);
+
+    auto diskItem = TextButton::create("Disk cache: off", [](TextButton* button) {
+        AudioEngine::uncacheAll();
+        AudioEngine::setDiskCacheEnabled(!AudioEngine::isDiskCacheEnabled());
+        button->setString(AudioEngine::isDiskCacheEnabled() ? "Disk cache: on" : "Disk cache: off");
+    });
+    diskItem->setPosition(layerSize.width * 0.3f, layerSize.height * 0.65f);
+    addChild(diskItem);
+
+    auto playItem = TextButton::create("Play effects", [](TextButton* button) {
+        static const char* effects[] = {"effect1.wav",
+                                        "effect2.ogg",
+                                        "effect2.mp3",
+                                        "pew-pew-lei.wav",
+                                        "audio/SmallFile.mp3",
+                                        "audio/SmallFile2.mp3",
+                                        "audio/SmallFile3.mp3",
+                                        "audio/EntireFramesTest.mp3"};
+        for (auto effect : effects)
+            AudioEngine::play2d(effect, false, 0.2f);
+    });
+    playItem->setPosition(layerSize.width * 0.7f, layerSize.height * 0.65f);
+    addChild(playItem);
+
+    _statsLabel = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _statsLabel->setAnchorPoint(Vec2(0.5f, 1.0f));
+    _statsLabel->setPosition(layerSize.width * 0.5f, layerSize.height * 0.57f);
+    addChild(_statsLabel);
+
+    schedule(
+        [this](float) {
+            std::string text = StringUtils::format("total: %.1f KB\n", AudioEngine::getCacheMemoryUsage() / 1024.0f);
+            for (auto&& info : AudioEngine::getCacheInfos())
+            {
+                text += StringUtils::format("%s: %.1f KB, %.2fs%s%s%s\n", info.filePath.c_str(),
+                                            info.memoryBytes / 1024.0f, info.duration,
+                                            info.streaming ? ", streaming" : "", info.inUse ? ", playing" : "",
+                                            info.fromDiskCache ? ", from disk" : "");
+            }
+            _statsLabel->setString(text);
+        },
+        0.25f, "stats");
+
+    return true;
+}
+
+void AudioCacheBudgetTest::onExit()
+{
+    AudioEngineTestDemo::onExit();
+
+    AudioEngine::setCacheBudget(0);
+    AudioEngine::setCacheStorage(AudioCacheStorage::NATIVE);
+    AudioEngine::setDiskCacheEnabled(false);
+}
+
+std::string AudioCacheBudgetTest::title() const
+{
+    return "Audio cache budget";
+}
+
+std::string AudioCacheBudgetTest::subtitle() const
+{
+    return "Compare the cache memory of each storage, idle caches are evicted over budget";
+}
+
+bool AudioPreloadBatchTest::init()
+{
+    if (!AudioEngineTestDemo::init())
+        return false;
+
+    auto& layerSize = this->getContentSize();
+
+    auto preloadItem = TextButton::create("Preload batch", [this](TextButton* button) {
+        if (_batchID != AudioEngine::INVALID_AUDIO_ID)
+            return;
+
+        std::vector<std::string> filePaths = {
+            "effect1.wav", "effect2.ogg", "effect2.mp3", "pew-pew-lei.wav", "background.mp3", "background.ogg",
+            "audio/SmallFile.mp3", "audio/SmallFile2.mp3", "audio/SmallFile3.mp3", "audio/LuckyDay.mp3",
+            "audio/Roll.mp3", "audio/Roll.wav", "audio/EntireFramesTest.mp3", "not-existing-file.mp3"};
+        AudioEngine::uncacheAll();
+
+        auto start = std::chrono::steady_clock::now();
+        _batchID   = AudioEngine::preloadBatch(filePaths, [this, start](const AudioPreloadProgress& progress) {
+            auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+            _progressLabel->setString(StringUtils::format("%u / %u loaded, %u failed%s\n%.1f ms", progress.loaded,
+                                                          progress.total, progress.failed,
+                                                          progress.cancelled ? ", cancelled" : "", elapsed));
+            if (progress.isFinished())
+                _batchID = AudioEngine::INVALID_AUDIO_ID;
+        });
+    });
+    preloadItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.7f);
+    addChild(preloadItem);
+
+    auto cancelItem = TextButton::create("Cancel", [this](TextButton* button) {
+        AudioEngine::cancelPreloadBatch(_batchID);
+    });
+    cancelItem->setPosition(layerSize.width * 0.5f, layerSize.height * 0.55f);
+    addChild(cancelItem);
+
+    _progressLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _progressLabel->setPosition(layerSize.width * 0.5f, layerSize.height * 0.35f);
+    addChild(_progressLabel);
+
+    return true;
+}
+
+void AudioPreloadBatchTest::onExit()
+{
+    AudioEngine::cancelPreloadBatch(_batchID);
+    AudioEngineTestDemo::onExit();
+}
+
+std::string AudioPreloadBatchTest::title() const
+{
+    return "Preload batch";
+}
+
+std::string AudioPreloadBatchTest::subtitle() const
+{
+    return "Files are decoded in parallel on the job system";
+}
+
 bool AudioPerformanceTest::init()
 {
     if (AudioEngineTestDemo::init())
@@ -33,6 +33,7 @@
 #    include "../BaseTest.h"
 
 #    include "audio/AudioEngine.h"
+#    include "audio/AudioMixer.h"
 
 DEFINE_TEST_SUITE(AudioEngineTests);
 
@@ -218,6 +219,70 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class AudioMixerTest : public AudioEngineTestDemo
+{
+public:
+    CREATE_FUNC(AudioMixerTest);
+
+    virtual bool init() override;
+    virtual void onExit() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    void runBenchmark(int voices);
+
+    std::vector<std::shared_ptr<ax::AudioMixerClip>> _clips;
+    ax::Label* _resultLabel = nullptr;
+};
+
+class AudioStreamingTest : public AudioEngineTestDemo
+{
+public:
+    CREATE_FUNC(AudioStreamingTest);
+
+    virtual bool init() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    ax::AudioProfile _largeBufferProfile;
+    ax::Label* _statsLabel = nullptr;
+};
+
+class AudioCacheBudgetTest : public AudioEngineTestDemo
+{
+public:
+    CREATE_FUNC(AudioCacheBudgetTest);
+
+    virtual bool init() override;
+    virtual void onExit() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    ax::Label* _statsLabel = nullptr;
+};
+
+class AudioPreloadBatchTest : public AudioEngineTestDemo
+{
+public:
+    CREATE_FUNC(AudioPreloadBatchTest);
+
+    virtual bool init() override;
+    virtual void onExit() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    int _batchID = ax::AudioEngine::INVALID_AUDIO_ID;
+    ax::Label* _progressLabel = nullptr;
+};
+
 class AudioSwitchStateTest : public AudioEngineTestDemo
 {
 public:
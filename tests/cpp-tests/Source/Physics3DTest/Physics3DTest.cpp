@@ -31,6 +31,9 @@
 #include "3d/Bundle3D.h"
 #include "physics3d/Physics3D.h"
 #include "extensions/Particle3D/PU/PUParticleSystem3D.h"
+#include "base/JobSystem.h"
+
+#include <chrono>
 USING_NS_AX_EXT;
 USING_NS_AX;
 
@@ -65,6 +68,7 @@ Physics3DTests::Physics3DTests()
     ADD_TEST_CASE(Physics3DCollisionCallbackDemo);
     ADD_TEST_CASE(Physics3DColliderDemo);
     ADD_TEST_CASE(Physics3DTerrainDemo);
+    ADD_TEST_CASE(Physics3DStepBenchmark);
 #endif
 };
 
@@ -882,4 +886,131 @@ bool Physics3DColliderDemo::init()
     return true;
 }
 
+std::string Physics3DStepBenchmark::title() const
+{
+    return "Physics3D Step Benchmark";
+}
+
+std::string Physics3DStepBenchmark::subtitle() const
+{
+    return "3200 boxes in 400 stacks, sequential vs parallel islands";
+}
+
+bool Physics3DStepBenchmark::init()
+{
+    if (!TestCase::init())
+        return false;
+
+    // 1, 2, 4... threads up to all workers and the calling thread
+    const int maxThreads = JobSystem::getInstance()->getThreadCount() + 1;
+    for (int threads = 1; threads < maxThreads; threads *= 2)
+        _threadCounts.emplace_back(threads);
+    _threadCounts.emplace_back(maxThreads);
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(VisibleRect::center());
+    addChild(_label);
+
+    // one world per frame, so the label shows the progress
+    scheduleUpdate();
+    return true;
+}
+
+void Physics3DStepBenchmark::onExit()
+{
+    JobSystem::getInstance()->setMaxParallelism(0);
+    TestCase::onExit();
+}
+
+bool Physics3DStepBenchmark::runWorld(bool multiThreaded, int threads, double& stepMs, double& checksum)
+{
+    const int STACKS      = 400;
+    const int STACK_BOXES = 8;
+    const int WARMUP      = 30;
+    const int STEPS       = 120;
+
+    JobSystem::getInstance()->setMaxParallelism(threads);
+
+    Physics3DWorldDes worldDes;
+    worldDes.multiThreaded = multiThreaded;
+    auto world             = Physics3DWorld::create(&worldDes);
+    if (multiThreaded && !world->isMultiThreaded())
+    {
+        world->release();
+        return false;
+    }
+
+    Physics3DRigidBodyDes groundDes;
+    groundDes.shape = Physics3DShape::createBox(Vec3(200.0f, 1.0f, 200.0f));
+    auto ground     = Physics3DRigidBody::create(&groundDes);
+    ground->getRigidBody()->getWorldTransform().setOrigin(btVector3(0.0f, -0.5f, 0.0f));
+    world->addPhysics3DObject(ground);
+
+    // the stacks are apart from each other, so each one is a simulation island
+    std::vector<Physics3DRigidBody*> boxes;
+    Physics3DRigidBodyDes boxDes;
+    boxDes.mass  = 1.0f;
+    boxDes.shape = Physics3DShape::createBox(Vec3(1.0f, 1.0f, 1.0f));
+    for (int i = 0; i < STACKS; ++i)
+    {
+        for (int j = 0; j < STACK_BOXES; ++j)
+        {
+            auto box = Physics3DRigidBody::create(&boxDes);
+            box->getRigidBody()->getWorldTransform().setOrigin(
+                btVector3((i % 20) * 4.0f - 40.0f + j * 0.05f, 0.5f + j * 1.01f, (i / 20) * 4.0f - 40.0f));
+            world->addPhysics3DObject(box);
+            boxes.emplace_back(box);
+        }
+    }
+
+    for (int i = 0; i < WARMUP; ++i)
+        world->stepSimulate(1.0f / 60.0f);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < STEPS; ++i)
+        world->stepSimulate(1.0f / 60.0f);
+    stepMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / STEPS;
+
+    checksum = 0.0;
+    for (auto&& box : boxes)
+    {
+        const auto& origin = box->getRigidBody()->getWorldTransform().getOrigin();
+        checksum += origin.x() + origin.y() + origin.z();
+    }
+
+    world->removeAllPhysics3DObjects();
+    world->release();
+    return true;
+}
+
+void Physics3DStepBenchmark::update(float /*delta*/)
+{
+    // the sequential world runs twice to show the fixed steps are reproducible
+    const size_t runs = 2 + _threadCounts.size();
+    if (_run >= runs)
+    {
+        unscheduleUpdate();
+        return;
+    }
+
+    double stepMs = 0.0, checksum = 0.0;
+    if (_run < 2)
+    {
+        runWorld(false, 0, stepMs, checksum);
+        _results += StringUtils::format("sequential: %.3f ms per step, checksum %.4f\n", stepMs, checksum);
+    }
+    else
+    {
+        const int threads = _threadCounts[_run - 2];
+        if (runWorld(true, threads, stepMs, checksum))
+            _results += StringUtils::format("parallel, %d threads: %.3f ms per step, checksum %.4f\n", threads, stepMs,
+                                            checksum);
+        else if (_run == 2)
+            _results += "parallel: bullet is built without BT_THREADSAFE\n";
+    }
+    ++_run;
+
+    _label->setString(_results);
+}
+
 #endif
@@ -158,6 +158,28 @@ public:
 private:
 };
 
+class Physics3DStepBenchmark : public TestCase
+{
+public:
+    CREATE_FUNC(Physics3DStepBenchmark);
+
+    virtual bool init() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    virtual void update(float delta) override;
+
+private:
+    // steps a fresh world, returns the milliseconds per step and a checksum of the final positions
+    bool runWorld(bool multiThreaded, int threads, double& stepMs, double& checksum);
+
+    ax::Label* _label = nullptr;
+    std::string _results;
+    std::vector<int> _threadCounts;
+    size_t _run = 0;
+};
+
 #endif
 
 #endif
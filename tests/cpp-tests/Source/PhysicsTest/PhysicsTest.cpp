@@ -27,6 +27,7 @@
 #if AX_USE_PHYSICS
 
 #    include <cmath>
+#    include <chrono>
 #    include "ui/CocosGUI.h"
 #    include "../testResource.h"
 
@@ -52,6 +53,10 @@ PhysicsTests::PhysicsTests()
     ADD_TEST_CASE(PhysicsTransformTest);
     ADD_TEST_CASE(PhysicsIssue9959);
     ADD_TEST_CASE(PhysicsIssue15932);
+    ADD_TEST_CASE(PhysicsSyncBenchmark);
+    ADD_TEST_CASE(PhysicsContactBatchTest);
+    ADD_TEST_CASE(PhysicsRayCastBatchBenchmark);
+    ADD_TEST_CASE(PhysicsQueryBatchTest);
 }
 
 namespace
@@ -1958,4 +1963,441 @@ std::string PhysicsIssue15932::subtitle() const
     return "addComponent()/removeComponent() should not crash";
 }
 
+void PhysicsSyncBenchmark::onEnter()
+{
+    PhysicsDemo::onEnter();
+
+    _physicsWorld->setAutoStep(false);
+
+    auto wall = Node::create();
+    wall->addComponent(
+        PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.5f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    // 20000 invisible decorative nodes the scene recursion has to walk through
+    auto decoration = Node::create();
+    decoration->setVisible(false);
+    addChild(decoration);
+    for (int i = 0; i < 200; ++i)
+    {
+        auto group = Node::create();
+        decoration->addChild(group);
+        for (int j = 0; j < 100; ++j)
+        {
+            auto node = Node::create();
+            node->setPosition(static_cast<float>(j), static_cast<float>(i));
+            group->addChild(node);
+        }
+    }
+
+    // 300 bodies, half of them in a moved and rotated layer
+    auto layer = Node::create();
+    layer->setPosition(VisibleRect::center());
+    layer->setRotation(10.0f);
+    addChild(layer);
+    for (int i = 0; i < 300; ++i)
+    {
+        Vec2 point(VisibleRect::left().x + 40.0f + (i % 30) * 13.0f, VisibleRect::bottom().y + 60.0f + (i / 30) * 20.0f);
+        auto ball = makeBall(point, 3.0f);
+        if (i % 2)
+        {
+            ball->setPosition(layer->convertToNodeSpace(point));
+            layer->addChild(ball);
+        }
+        else
+            addChild(ball);
+    }
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(VisibleRect::center().x, VisibleRect::top().y - 70);
+    addChild(_label);
+
+    MenuItemFont::setFontSize(18);
+    auto item = MenuItemFont::create("Change Mode", AX_CALLBACK_1(PhysicsSyncBenchmark::changeModeCallback, this));
+    auto menu = Menu::create(item, nullptr);
+    addChild(menu);
+    menu->setPosition(Vec2(VisibleRect::left().x + 100, VisibleRect::top().y - 10));
+
+    scheduleUpdate();
+}
+
+void PhysicsSyncBenchmark::changeModeCallback(Ref* /*sender*/)
+{
+    _physicsWorld->setSyncBodiesOnly(!_physicsWorld->isSyncBodiesOnly());
+    _stepMs = 0.0;
+    _steps  = 0;
+}
+
+void PhysicsSyncBenchmark::update(float delta)
+{
+    auto start = std::chrono::steady_clock::now();
+    _physicsWorld->step(1 / 60.0f);
+    _stepMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (++_steps == 60)
+    {
+        _label->setString(StringUtils::format("%s: %.3f ms per step",
+                                              _physicsWorld->isSyncBodiesOnly() ? "body list" : "scene recursion",
+                                              _stepMs / _steps));
+        _stepMs = 0.0;
+        _steps  = 0;
+    }
+}
+
+std::string PhysicsSyncBenchmark::title() const
+{
+    return "Physics Sync Benchmark";
+}
+
+std::string PhysicsSyncBenchmark::subtitle() const
+{
+    return "300 bodies, 20000 other nodes, body list vs scene recursion";
+}
+
+void PhysicsContactBatchTest::onEnter()
+{
+    PhysicsDemo::onEnter();
+
+    _physicsWorld->setAutoStep(false);
+
+    auto wall = Node::create();
+    wall->addComponent(
+        PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.5f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    // 800 balls piled up, the red ones are in category 0x2 and are the only ones the game cares about
+    for (int i = 0; i < 800; ++i)
+    {
+        Vec2 point(VisibleRect::left().x + 20.0f + (i % 40) * 11.0f, VisibleRect::bottom().y + 20.0f + (i / 40) * 11.0f);
+        auto ball  = makeBall(point, 2.5f);
+        auto shape = ball->getPhysicsBody()->getFirstShape();
+        shape->setContactTestBitmask(0xFFFFFFFF);
+        if (i % 20 == 0)
+        {
+            ball->setColor(Color3B::RED);
+            shape->setCategoryBitmask(0x2);
+        }
+        else
+            shape->setCategoryBitmask(0x1);
+        addChild(ball);
+    }
+
+    _listener                 = EventListenerPhysicsContact::create();
+    _listener->onContactBegin = [this](PhysicsContact& contact) {
+        if (((contact.getShapeA()->getCategoryBitmask() | contact.getShapeB()->getCategoryBitmask()) & 0x2) != 0)
+            ++_contacts;
+        return true;
+    };
+    _listener->retain();
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(VisibleRect::center().x, VisibleRect::top().y - 70);
+    addChild(_label);
+
+    MenuItemFont::setFontSize(18);
+    auto item = MenuItemFont::create("Change Mode", AX_CALLBACK_1(PhysicsContactBatchTest::changeModeCallback, this));
+    auto menu = Menu::create(item, nullptr);
+    addChild(menu);
+    menu->setPosition(Vec2(VisibleRect::left().x + 100, VisibleRect::top().y - 10));
+
+    _batched = false;
+    changeModeCallback(nullptr);
+    scheduleUpdate();
+}
+
+void PhysicsContactBatchTest::onExit()
+{
+    if (_batchHandler)
+        _physicsWorld->removeContactBatchHandler(_batchHandler);
+    AX_SAFE_RELEASE_NULL(_listener);
+    PhysicsDemo::onExit();
+}
+
+void PhysicsContactBatchTest::changeModeCallback(Ref* /*sender*/)
+{
+    _batched = !_batched;
+    if (_batched)
+    {
+        _eventDispatcher->removeEventListener(_listener);
+        _physicsWorld->setContactEventsEnabled(false);
+        _batchHandler = _physicsWorld->addContactBatchHandler(
+            [this](PhysicsWorld&, const PhysicsContactRecord* contacts, size_t count) {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (contacts[i].eventCode == PhysicsContact::EventCode::BEGIN)
+                        ++_contacts;
+                }
+            },
+            0x2);
+    }
+    else
+    {
+        if (_batchHandler)
+            _physicsWorld->removeContactBatchHandler(_batchHandler);
+        _batchHandler = 0;
+        _physicsWorld->setContactEventsEnabled(true);
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(_listener, this);
+    }
+    _contacts = 0;
+    _stepMs   = 0.0;
+    _steps    = 0;
+}
+
+void PhysicsContactBatchTest::update(float delta)
+{
+    auto start = std::chrono::steady_clock::now();
+    _physicsWorld->step(1 / 60.0f);
+    _stepMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (++_steps == 60)
+    {
+        _label->setString(StringUtils::format("%s: %.3f ms per step, %d red ball contacts per step",
+                                              _batched ? "batch handler" : "contact events", _stepMs / _steps,
+                                              _contacts / _steps));
+        _contacts = 0;
+        _stepMs   = 0.0;
+        _steps    = 0;
+    }
+}
+
+std::string PhysicsContactBatchTest::title() const
+{
+    return "Batched Contacts";
+}
+
+std::string PhysicsContactBatchTest::subtitle() const
+{
+    return "800 balls, only the red ones are listened to";
+}
+
+void PhysicsRayCastBatchBenchmark::onEnter()
+{
+    PhysicsDemo::onEnter();
+
+    auto wall = Node::create();
+    wall->addComponent(
+        PhysicsBody::createEdgeBox(VisibleRect::getVisibleRect().size, PhysicsMaterial(0.1f, 0.5f, 0.5f)));
+    wall->setPosition(VisibleRect::center());
+    addChild(wall);
+
+    // 200 static boxes as obstacles for the line of sight checks
+    for (int i = 0; i < 200; ++i)
+    {
+        Vec2 point(VisibleRect::left().x + 30.0f + (i % 20) * 21.0f, VisibleRect::bottom().y + 40.0f + (i / 20) * 24.0f);
+        auto box = makeBox(point, Size(8.0f, 8.0f), i % 4);
+        box->getPhysicsBody()->setDynamic(false);
+        addChild(box);
+    }
+
+    // 10000 rays from 100 agents to 100 targets
+    for (int i = 0; i < 100; ++i)
+    {
+        Vec2 agent(VisibleRect::left().x + 20.0f + (i % 10) * 44.0f, VisibleRect::bottom().y + 20.0f);
+        for (int j = 0; j < 100; ++j)
+        {
+            Vec2 target(VisibleRect::left().x + 20.0f + j * 4.4f, VisibleRect::top().y - 20.0f);
+            _rays.emplace_back(PhysicsRay{agent, target});
+        }
+    }
+    _results.resize(_rays.size());
+
+    _drawNode = DrawNode::create();
+    addChild(_drawNode);
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(VisibleRect::center().x, VisibleRect::top().y - 70);
+    addChild(_label);
+
+    MenuItemFont::setFontSize(18);
+    auto item =
+        MenuItemFont::create("Change Mode", AX_CALLBACK_1(PhysicsRayCastBatchBenchmark::changeModeCallback, this));
+    auto menu = Menu::create(item, nullptr);
+    addChild(menu);
+    menu->setPosition(Vec2(VisibleRect::left().x + 100, VisibleRect::top().y - 10));
+
+    scheduleUpdate();
+}
+
+void PhysicsRayCastBatchBenchmark::changeModeCallback(Ref* /*sender*/)
+{
+    _batched = !_batched;
+    _castMs  = 0.0;
+    _frames  = 0;
+}
+
+void PhysicsRayCastBatchBenchmark::update(float /*delta*/)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (_batched)
+    {
+        _physicsWorld->rayCastBatch(_rays.data(), _rays.size(), _results.data());
+    }
+    else
+    {
+        // the closest hit through the callback, as line of sight checks did before
+        auto func = [](PhysicsWorld& /*world*/, const PhysicsRayCastInfo& info, void* data) -> bool {
+            auto result = static_cast<PhysicsRayCastResult*>(data);
+            if (info.fraction < result->fraction)
+            {
+                result->shape    = info.shape;
+                result->contact  = info.contact;
+                result->normal   = info.normal;
+                result->fraction = info.fraction;
+            }
+            return true;
+        };
+        for (size_t i = 0; i < _rays.size(); ++i)
+        {
+            _results[i] = PhysicsRayCastResult{};
+            _physicsWorld->rayCast(func, _rays[i].start, _rays[i].end, &_results[i]);
+        }
+    }
+    _castMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // draw every 50th ray up to its hit
+    _drawNode->clear();
+    _hits = 0;
+    for (size_t i = 0; i < _results.size(); ++i)
+    {
+        auto& result = _results[i];
+        if (result.shape)
+            ++_hits;
+        if (i % 50 == 0)
+            _drawNode->drawLine(_rays[i].start, result.shape ? result.contact : _rays[i].end,
+                                result.shape ? Color4F::RED : Color4F::GREEN);
+    }
+
+    if (++_frames == 60)
+    {
+        _label->setString(StringUtils::format("%s: %.3f ms per 10000 rays, %d hits",
+                                              _batched ? "batched" : "one by one", _castMs / _frames, _hits));
+        _castMs = 0.0;
+        _frames = 0;
+    }
+}
+
+std::string PhysicsRayCastBatchBenchmark::title() const
+{
+    return "Ray Cast Batch Benchmark";
+}
+
+std::string PhysicsRayCastBatchBenchmark::subtitle() const
+{
+    return "10000 rays per frame, batched vs one by one";
+}
+
+void PhysicsQueryBatchTest::onEnter()
+{
+    PhysicsDemo::onEnter();
+
+    // static boxes of all sizes, some of them overlapping
+    for (int i = 0; i < 150; ++i)
+    {
+        Vec2 point(VisibleRect::left().x + 40.0f + (i % 15) * 27.0f, VisibleRect::bottom().y + 50.0f + (i / 15) * 21.0f);
+        auto box = makeBox(point, Size(6.0f + (i % 7) * 4.0f, 6.0f + (i % 5) * 4.0f), i % 4);
+        box->getPhysicsBody()->setDynamic(false);
+        addChild(box);
+    }
+
+    _label = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _label->setPosition(VisibleRect::center().x, VisibleRect::top().y - 70);
+    addChild(_label);
+
+    scheduleUpdate();
+}
+
+void PhysicsQueryBatchTest::update(float /*delta*/)
+{
+    // once, the queries add the bodies still waiting for the world to update
+    if (++_frames != 1)
+        return;
+
+    auto visible = VisibleRect::getVisibleRect();
+    std::vector<PhysicsRay> rays;
+    std::vector<Rect> rects;
+    std::vector<Vec2> points;
+    for (int i = 0; i < 1000; ++i)
+    {
+        Vec2 from(visible.getMinX() + (i % 37) * visible.size.width / 37.0f, visible.getMinY());
+        Vec2 to(visible.getMinX() + (i % 41) * visible.size.width / 41.0f, visible.getMaxY());
+        rays.emplace_back(PhysicsRay{from, to});
+        Vec2 point(visible.getMinX() + (i % 40) * visible.size.width / 40.0f,
+                   visible.getMinY() + (i / 40) * visible.size.height / 25.0f);
+        points.emplace_back(point);
+        rects.emplace_back(point.x, point.y, 5.0f + (i % 9) * 3.0f, 5.0f + (i % 4) * 6.0f);
+    }
+
+    std::vector<PhysicsRayCastResult> batched(rays.size());
+    _physicsWorld->rayCastBatch(rays.data(), rays.size(), batched.data());
+    std::vector<PhysicsShape*> rectShapes, pointShapes;
+    std::vector<uint32_t> rectOffsets, pointOffsets;
+    _physicsWorld->queryRectBatch(rects.data(), rects.size(), rectShapes, rectOffsets);
+    _physicsWorld->queryPointBatch(points.data(), points.size(), pointShapes, pointOffsets);
+
+    // the same queries one by one, the closest hit of a ray through the callback
+    auto rayFunc = [](PhysicsWorld& /*world*/, const PhysicsRayCastInfo& info, void* data) -> bool {
+        auto result = static_cast<PhysicsRayCastResult*>(data);
+        if (!info.shape->isSensor() && info.fraction < result->fraction)
+        {
+            result->shape    = info.shape;
+            result->contact  = info.contact;
+            result->normal   = info.normal;
+            result->fraction = info.fraction;
+        }
+        return true;
+    };
+    auto collect = [](PhysicsWorld& /*world*/, PhysicsShape& shape, void* data) -> bool {
+        static_cast<std::vector<PhysicsShape*>*>(data)->emplace_back(&shape);
+        return true;
+    };
+    // the order of the shapes found by one query isn't specified
+    auto sameShapes = [](std::vector<PhysicsShape*> found, const std::vector<PhysicsShape*>& shapes,
+                         const std::vector<uint32_t>& offsets, size_t i) {
+        std::vector<PhysicsShape*> batchFound(shapes.begin() + offsets[i], shapes.begin() + offsets[i + 1]);
+        std::sort(found.begin(), found.end());
+        std::sort(batchFound.begin(), batchFound.end());
+        return found == batchFound;
+    };
+
+    int mismatches = 0, hits = 0;
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        PhysicsRayCastResult single;
+        _physicsWorld->rayCast(rayFunc, rays[i].start, rays[i].end, &single);
+        // two shapes can be hit at the same fraction, either one is the closest
+        if (std::abs(single.fraction - batched[i].fraction) > 1e-5f ||
+            (single.shape != batched[i].shape && single.fraction == 1.0f))
+            ++mismatches;
+        if (single.shape)
+            ++hits;
+
+        std::vector<PhysicsShape*> found;
+        _physicsWorld->queryRect(collect, rects[i], &found);
+        if (!sameShapes(found, rectShapes, rectOffsets, i))
+            ++mismatches;
+
+        found.clear();
+        _physicsWorld->queryPoint(collect, points[i], &found);
+        if (!sameShapes(found, pointShapes, pointOffsets, i))
+            ++mismatches;
+    }
+
+    AXASSERT(mismatches == 0, "batched queries differ from the queries one by one");
+    _label->setString(StringUtils::format("%d rays (%d hits), %d rects, %d points: %s", static_cast<int>(rays.size()),
+                                          hits, static_cast<int>(rects.size()), static_cast<int>(points.size()),
+                                          mismatches == 0 ? "batched == one by one" : "MISMATCH"));
+}
+
+std::string PhysicsQueryBatchTest::title() const
+{
+    return "Query Batch Test";
+}
+
+std::string PhysicsQueryBatchTest::subtitle() const
+{
+    return "batched ray casts, rect and point queries match the ones one by one";
+}
+
 #endif
@@ -308,4 +308,83 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class PhysicsSyncBenchmark : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsSyncBenchmark);
+
+    void onEnter() override;
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void changeModeCallback(ax::Ref* sender);
+
+private:
+    ax::Label* _label = nullptr;
+    double _stepMs    = 0.0;
+    int _steps        = 0;
+};
+
+class PhysicsContactBatchTest : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsContactBatchTest);
+
+    void onEnter() override;
+    void onExit() override;
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void changeModeCallback(ax::Ref* sender);
+
+private:
+    ax::Label* _label                          = nullptr;
+    ax::EventListenerPhysicsContact* _listener = nullptr;
+    int _batchHandler                          = 0;
+    bool _batched                              = true;
+    int _contacts                              = 0;  // contacts of red balls seen by the handler
+    double _stepMs                             = 0.0;
+    int _steps                                 = 0;
+};
+
+class PhysicsRayCastBatchBenchmark : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsRayCastBatchBenchmark);
+
+    void onEnter() override;
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void changeModeCallback(ax::Ref* sender);
+
+private:
+    ax::Label* _label = nullptr;
+    ax::DrawNode* _drawNode = nullptr;
+    std::vector<ax::PhysicsRay> _rays;
+    std::vector<ax::PhysicsRayCastResult> _results;
+    bool _batched  = true;
+    int _hits      = 0;
+    double _castMs = 0.0;
+    int _frames    = 0;
+};
+
+class PhysicsQueryBatchTest : public PhysicsDemo
+{
+public:
+    CREATE_FUNC(PhysicsQueryBatchTest);
+
+    void onEnter() override;
+    virtual void update(float delta) override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    ax::Label* _label = nullptr;
+    int _frames       = 0;
+};
+
 #endif  // #if AX_USE_PHYSICS
\ No newline at end of file
@@ -31,6 +31,7 @@ TerrainTests::TerrainTests()
     ADD_TEST_CASE(TerrainSimple);
     ADD_TEST_CASE(TerrainWalkThru);
     ADD_TEST_CASE(TerrainWithLightMap);
+    ADD_TEST_CASE(TerrainTiledStreaming);
 }
 
 Vec3 camera_offset(0, 45, 60);
@@ -393,3 +394,69 @@ void TerrainWithLightMap::onTouchesMoved(const std::vector<ax::Touch*>& touches,
     cameraPos += cameraRightDir * newPos.x * 0.5 * delta;
     _camera->setPosition3D(cameraPos);
 }
+
+TerrainTiledStreaming::TerrainTiledStreaming()
+{
+    Size visibleSize = Director::getInstance()->getVisibleSize();
+
+    _camera = Camera::createPerspective(60, visibleSize.width / visibleSize.height, 0.1f, 2000);
+    _camera->setCameraFlag(CameraFlag::USER1);
+    _camera->setPosition3D(Vec3(100, 60, 100));
+    _camera->setRotation3D(Vec3(-20, -135, 0));
+    addChild(_camera);
+
+    // a 64 x 64 tiles world of 128 x 128 quads, generated on the workers, the heights only depend on the global
+    // position so the tile edges and their one quad border match the neighbor tiles
+    TiledTerrain::TiledTerrainData data("", "TerrainTest/Grass2.jpg", 64, 64, 128, 40.0f, 1.0f);
+    data._detailMapSize = 16.0f;
+    data._loadRadius    = 3;
+    const int tileSize  = data._tileSize;
+    _terrain            = TiledTerrain::create(data, [tileSize](int tileX, int tileZ, std::vector<float>& heights) {
+        const int side = tileSize + 3;
+        heights.resize(side * side);
+        for (int i = 0; i < side; ++i)
+        {
+            for (int j = 0; j < side; ++j)
+            {
+                float x = static_cast<float>(tileX * tileSize + j - 1);
+                float z = static_cast<float>(tileZ * tileSize + i - 1);
+                heights[i * side + j] =
+                    sinf(x * 0.011f) * cosf(z * 0.013f) * 16.0f + sinf(x * 0.057f + z * 0.031f) * 4.0f;
+            }
+        }
+        return true;
+    });
+    _terrain->setCameraMask(2);
+    addChild(_terrain);
+
+    _statsLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _statsLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _statsLabel->setPosition(Vec2(VisibleRect::left().x + 10, VisibleRect::top().y - 80));
+    addChild(_statsLabel);
+
+    scheduleUpdate();
+}
+
+std::string TerrainTiledStreaming::title() const
+{
+    return "Tiled terrain streaming";
+}
+
+std::string TerrainTiledStreaming::subtitle() const
+{
+    return "The camera flies over a 8192 x 8192 world";
+}
+
+void TerrainTiledStreaming::update(float dt)
+{
+    // fly diagonally, the tiles behind are dropped and the ones ahead are loaded in the background
+    Vec3 cameraPos = _camera->getPosition3D() + Vec3(60.0f, 0.0f, 60.0f) * dt;
+    if (cameraPos.x > 8000.0f)
+        cameraPos.set(100, 60, 100);
+    cameraPos.y = std::max(cameraPos.y, _terrain->getHeight(cameraPos.x, cameraPos.z) + 30.0f);
+    _camera->setPosition3D(cameraPos);
+
+    _statsLabel->setString(StringUtils::format("%d tiles loaded, %d loading, %d chunks drawn",
+                                               _terrain->getLoadedTileCount(), _terrain->getLoadingTileCount(),
+                                               _terrain->getDrawnChunkCount()));
+}
@@ -28,6 +28,7 @@
 
 #include "3d/MeshRenderer.h"
 #include "3d/Terrain.h"
+#include "3d/TiledTerrain.h"
 #include "2d/Camera.h"
 #include "2d/Action.h"
 
@@ -112,4 +113,19 @@ protected:
     ax::Camera* _camera;
 };
 
+class TerrainTiledStreaming : public TerrainTestDemo
+{
+public:
+    CREATE_FUNC(TerrainTiledStreaming);
+    TerrainTiledStreaming();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+protected:
+    ax::TiledTerrain* _terrain;
+    ax::Camera* _camera;
+    ax::Label* _statsLabel;
+};
+
 #endif  // !TERRAIN_TESH_H
@@ -29,6 +29,10 @@
 // local import
 #include "Texture2dTest.h"
 #include "../testResource.h"
+#include "base/ktx2.h"
+#include "base/etc2.h"
+#include "base/astc.h"
+#include <chrono>
 
 USING_NS_AX;
 
@@ -45,6 +49,8 @@ Texture2DTests::Texture2DTests()
 
     ADD_TEST_CASE(TextureETC1Alpha);
     ADD_TEST_CASE(TextureETC2);
+    ADD_TEST_CASE(TextureKTX2Transcode);
+    ADD_TEST_CASE(TextureSoftwareDecode);
     ADD_TEST_CASE(TextureBMP);
     ADD_TEST_CASE(TexturePNG);
     ADD_TEST_CASE(TextureJPEG);
@@ -323,6 +329,226 @@ std::string TextureETC2::subtitle() const
     return "";
 }
 
+//------------------------------------------------------------------
+//
+// TextureKTX2Transcode
+//
+//------------------------------------------------------------------
+
+// Repeats rows x rowSize bytes of compressed blocks to tilesPerRow x tilesPerRow
+static void tileBlocks(const uint8_t* blocks, size_t rowSize, size_t rows, int tilesPerRow, uint8_t* out)
+{
+    for (size_t y = 0; y < rows * tilesPerRow; ++y)
+    {
+        for (int x = 0; x < tilesPerRow; ++x, out += rowSize)
+            memcpy(out, blocks + (y % rows) * rowSize, rowSize);
+    }
+}
+
+// Wraps the blocks of a pkm file to a single level ktx2 file, tiled to tilesPerRow x tilesPerRow
+static std::vector<uint8_t> makeKTX2FromPKM(std::string_view path, int tilesPerRow)
+{
+    static const uint8_t identifier[12] = {0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A};
+
+    // pkm header: "PKM 20", format, encoded width and height, width and height, all big endian uint16
+    const ssize_t pkmHeaderSize = 16;
+    auto pkm                    = FileUtils::getInstance()->getDataFromFile(path);
+    if (pkm.getSize() <= pkmHeaderSize || memcmp(pkm.getBytes(), "PKM 20", 6) != 0)
+        return {};
+
+    auto readUint16 = [&pkm](int offset) { return (pkm.getBytes()[offset] << 8) | pkm.getBytes()[offset + 1]; };
+    const uint32_t width  = readUint16(12);
+    const uint32_t height = readUint16(14);
+    const bool alpha      = readUint16(6) == 3;  // ETC2_RGBA_NO_MIPMAPS
+    const size_t rowSize  = ((width + 3) / 4) * (alpha ? 16 : 8);
+    const size_t rows     = (height + 3) / 4;
+
+    KTX2Header header{};
+    memcpy(header.identifier, identifier, sizeof(identifier));
+    header.vkFormat    = alpha ? KTX2Header::VkFormat::ETC2_R8G8B8A8_UNORM_BLOCK
+                               : KTX2Header::VkFormat::ETC2_R8G8B8_UNORM_BLOCK;
+    header.typeSize    = 1;
+    header.pixelWidth  = width * tilesPerRow;
+    header.pixelHeight = height * tilesPerRow;
+    header.faceCount   = 1;
+    header.levelCount  = 1;
+
+    KTX2LevelIndex level{};
+    level.byteOffset             = KTX2_HEADER_SIZE + sizeof(KTX2LevelIndex);
+    level.byteLength             = rowSize * tilesPerRow * rows * tilesPerRow;
+    level.uncompressedByteLength = level.byteLength;
+
+    std::vector<uint8_t> ktx2(level.byteOffset + level.byteLength);
+    memcpy(ktx2.data(), &header, sizeof(header));
+    memcpy(ktx2.data() + KTX2_HEADER_SIZE, &level, sizeof(level));
+
+    tileBlocks(pkm.getBytes() + pkmHeaderSize, rowSize, rows, tilesPerRow, ktx2.data() + level.byteOffset);
+    return ktx2;
+}
+
+void TextureKTX2Transcode::onEnter()
+{
+    TextureDemo::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    // the image picks the transcode target by the device caps
+    auto ktx2  = makeKTX2FromPKM("Images/etc2_rgba.pkm", 1);
+    auto image = new Image();
+    if (!ktx2.empty() && image->initWithImageData(ktx2.data(), static_cast<ssize_t>(ktx2.size())))
+    {
+        auto texture = new Texture2D();
+        texture->initWithImage(image);
+        auto sprite = Sprite::createWithTexture(texture);
+        sprite->setPosition(Vec2(s.width / 2, s.height * 0.75f));
+        addChild(sprite);
+        texture->release();
+    }
+    image->release();
+
+    // benchmark the transcoding of a 2048x2048 texture by target and thread count
+    auto bench = makeKTX2FromPKM("Images/etc2_rgba.pkm", 32);
+    if (bench.empty())
+        return;
+
+    struct TargetCase
+    {
+        KTX2TranscodeTarget target;
+        const char* name;
+    };
+    const TargetCase targets[] = {{KTX2TranscodeTarget::ETC2, "ETC2"},
+                                  {KTX2TranscodeTarget::S3TC, "S3TC"},
+                                  {KTX2TranscodeTarget::RGBA8, "RGBA8"}};
+
+    auto jobSystem          = JobSystem::getInstance();
+    auto maxParallelism     = jobSystem->getMaxParallelism();
+    const int threadCases[] = {1, jobSystem->getThreadCount() + 1};
+
+    auto header = reinterpret_cast<const KTX2Header*>(bench.data());
+    float y     = s.height * 0.5f;
+    for (auto& targetCase : targets)
+    {
+        std::vector<uint8_t> output(ktx2_get_transcoded_size(header, 0, targetCase.target));
+        std::string result = StringUtils::format("%s:", targetCase.name);
+        for (auto threads : threadCases)
+        {
+            jobSystem->setMaxParallelism(threads);
+            auto start = std::chrono::steady_clock::now();
+            ktx2_transcode_level(bench.data(), bench.size(), 0, targetCase.target, output.data(), output.size());
+            auto elapsed =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            result += StringUtils::format("  %d thread(s) %.2fms", threads, elapsed / 1000.0f);
+        }
+
+        auto label = Label::createWithTTF(result, "fonts/arial.ttf", 15);
+        label->setPosition(Vec2(s.width / 2, y));
+        addChild(label);
+        y -= 30;
+    }
+    jobSystem->setMaxParallelism(maxParallelism);
+}
+
+std::string TextureKTX2Transcode::title() const
+{
+    return "Testing KTX2 transcoding";
+}
+
+std::string TextureKTX2Transcode::subtitle() const
+{
+    return "ETC2 blocks to the device format, 2048x2048 timings";
+}
+
+//------------------------------------------------------------------
+//
+// TextureSoftwareDecode
+//
+//------------------------------------------------------------------
+
+void TextureSoftwareDecode::onEnter()
+{
+    TextureDemo::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    // decode 2048x2048 textures without hardware support, tiled from the sample images
+    const int tilesPerRow = 32;
+    auto ktx2             = makeKTX2FromPKM("Images/etc2_rgba.pkm", tilesPerRow);
+    auto astc             = FileUtils::getInstance()->getDataFromFile("Images/ASTC_RGBA.astc");
+    if (ktx2.empty() || astc.getSize() <= ASTC_HEAD_SIZE)
+        return;
+
+    auto header          = reinterpret_cast<const KTX2Header*>(ktx2.data());
+    const uint32_t etc2W = header->pixelWidth, etc2H = header->pixelHeight;
+    auto etc2Blocks      = ktx2.data() + KTX2_HEADER_SIZE + sizeof(KTX2LevelIndex);
+
+    auto astcHeader       = reinterpret_cast<const astc_header*>(astc.getBytes());
+    const uint32_t blockX = astcHeader->block_x, blockY = astcHeader->block_y;
+    const uint32_t astcW  = astc_unpack_bytes(astcHeader->dim_x[0], astcHeader->dim_x[1], astcHeader->dim_x[2], 0);
+    const uint32_t astcH  = astc_unpack_bytes(astcHeader->dim_y[0], astcHeader->dim_y[1], astcHeader->dim_y[2], 0);
+    const size_t astcRow  = (astcW + blockX - 1) / blockX * 16;
+    const size_t astcRows = (astcH + blockY - 1) / blockY;
+    std::vector<uint8_t> astcBlocks(astcRow * astcRows * tilesPerRow * tilesPerRow);
+    tileBlocks(astc.getBytes() + ASTC_HEAD_SIZE, astcRow, astcRows, tilesPerRow, astcBlocks.data());
+    // whole blocks only, so the tiles line up
+    const uint32_t tiledW = static_cast<uint32_t>(astcRow / 16 * blockX * tilesPerRow);
+    const uint32_t tiledH = static_cast<uint32_t>(astcRows * blockY * tilesPerRow);
+
+    struct DecodeCase
+    {
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        std::function<void(uint8_t*)> decode;
+    };
+    const DecodeCase cases[] = {
+        {"ETC2_RGBA", etc2W, etc2H,
+         [=](uint8_t* out) { etc2_decode_image_parallel(ETC2_RGBA_NO_MIPMAPS, etc2Blocks, out, etc2W, etc2H); }},
+        {StringUtils::format("ASTC %ux%u", blockX, blockY), tiledW, tiledH,
+         [&, blockX, blockY](uint8_t* out) {
+             astc_decompress_image(astcBlocks.data(), static_cast<uint32_t>(astcBlocks.size()), out, tiledW, tiledH,
+                                   blockX, blockY);
+         }}};
+
+    auto jobSystem          = JobSystem::getInstance();
+    auto maxParallelism     = jobSystem->getMaxParallelism();
+    const int threadCases[] = {1, jobSystem->getThreadCount() + 1};
+
+    float y = s.height * 0.6f;
+    for (auto& decodeCase : cases)
+    {
+        std::vector<uint8_t> output(static_cast<size_t>(decodeCase.width) * decodeCase.height * 4);
+        std::string result = StringUtils::format("%s %ux%u:", decodeCase.name.c_str(), decodeCase.width,
+                                                 decodeCase.height);
+        for (auto threads : threadCases)
+        {
+            jobSystem->setMaxParallelism(threads);
+            auto start = std::chrono::steady_clock::now();
+            decodeCase.decode(output.data());
+            auto elapsed =
+                std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+            float mpixPerSecond = decodeCase.width * decodeCase.height / (float)(std::max)(elapsed, decltype(elapsed){1});
+            result += StringUtils::format("  %d thread(s) %.2fms (%.1f MPix/s)", threads, elapsed / 1000.0f,
+                                          mpixPerSecond);
+        }
+
+        auto label = Label::createWithTTF(result, "fonts/arial.ttf", 15);
+        label->setPosition(Vec2(s.width / 2, y));
+        addChild(label);
+        y -= 30;
+    }
+    jobSystem->setMaxParallelism(maxParallelism);
+}
+
+std::string TextureSoftwareDecode::title() const
+{
+    return "Testing ETC2/ASTC software decode";
+}
+
+std::string TextureSoftwareDecode::subtitle() const
+{
+    return "Single vs multi-threaded decode throughput";
+}
+
 //------------------------------------------------------------------
 //
 // TextureBMP
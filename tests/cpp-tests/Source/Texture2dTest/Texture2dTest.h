@@ -78,6 +78,24 @@ public:
     ax::Node* _background;
 };
 
+class TextureKTX2Transcode : public TextureDemo
+{
+public:
+    CREATE_FUNC(TextureKTX2Transcode);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+};
+
+class TextureSoftwareDecode : public TextureDemo
+{
+public:
+    CREATE_FUNC(TextureSoftwareDecode);
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onEnter() override;
+};
+
 class TextureBMP : public TextureDemo
 {
 public:
@@ -30,6 +30,9 @@ TextureCacheTests::TextureCacheTests()
 {
     ADD_TEST_CASE(TextureCacheTest);
     ADD_TEST_CASE(TextureCacheUnbindTest);
+    ADD_TEST_CASE(TextureCacheCopyStatsTest);
+    ADD_TEST_CASE(TextureCacheInPlaceConvertTest);
+    ADD_TEST_CASE(TextureCacheBudgetTest);
 }
 
 TextureCacheTest::TextureCacheTest() : _numberOfSprites(20), _numberOfLoadedSprites(0)
@@ -234,3 +237,176 @@ void TextureCacheUnbindTest::textureLoadedB(Texture2D* texture)
     s->setPosition(3 * size.width / 4, size.height / 2);
     this->addChild(s);
 }
+
+void TextureCacheCopyStatsTest::onEnter()
+{
+    TestCase::onEnter();
+
+    auto size  = Director::getInstance()->getWinSize();
+    auto cache = Director::getInstance()->getTextureCache();
+
+    struct LoadCase
+    {
+        const char* path;
+        backend::PixelFormat format;
+        const char* formatName;
+    };
+    const LoadCase cases[] = {{"Images/grossini.png", backend::PixelFormat::RGBA8, "RGBA8"},
+                              {"Images/grossini.png", backend::PixelFormat::RGB565, "RGB565"},
+                              {"Images/ETC1.pkm", backend::PixelFormat::NONE, "auto"},
+                              {"Images/grossini_pvr_rgba8888.pvr", backend::PixelFormat::NONE, "auto"}};
+
+    float y = size.height * 3 / 4;
+    for (auto& loadCase : cases)
+    {
+        cache->removeTextureForKey(loadCase.path);
+
+        Image::resetCopiedBytes();
+        auto texture = cache->addImage(loadCase.path, loadCase.format);
+
+        auto label = Label::createWithTTF(
+            StringUtils::format("%s (%s): %s, copied %u bytes", loadCase.path, loadCase.formatName,
+                                texture ? "loaded" : "failed", static_cast<unsigned int>(Image::getCopiedBytes())),
+            "fonts/arial.ttf", 15);
+        label->setPosition(size.width / 2, y);
+        this->addChild(label);
+        y -= 30;
+
+        cache->removeTextureForKey(loadCase.path);
+    }
+}
+
+std::string TextureCacheCopyStatsTest::title() const
+{
+    return "TextureCache: copied bytes per load";
+}
+
+std::string TextureCacheCopyStatsTest::subtitle() const
+{
+    return "Zero-copy loads keep it at 0";
+}
+
+void TextureCacheInPlaceConvertTest::onEnter()
+{
+    TestCase::onEnter();
+
+    auto size = Director::getInstance()->getWinSize();
+
+    struct ConvertCase
+    {
+        int width;
+        int height;
+        backend::PixelFormat format;
+        const char* formatName;
+        int bytesPerPixel;
+    };
+    // pixel counts which aren't a multiple of 8
+    const ConvertCase cases[] = {{5, 1, backend::PixelFormat::RGB565, "RGB565", 2},
+                                 {5, 1, backend::PixelFormat::RGB8, "RGB8", 3},
+                                 {3, 3, backend::PixelFormat::LA8, "LA8", 2},
+                                 {7, 3, backend::PixelFormat::A8, "A8", 1}};
+
+    float y = size.height * 3 / 4;
+    for (auto& convertCase : cases)
+    {
+        const int pixels = convertCase.width * convertCase.height;
+        std::vector<uint8_t> rgba(pixels * 4, 0xff);
+
+        auto image = new Image();
+        image->initWithRawData(rgba.data(), static_cast<ssize_t>(rgba.size()), convertCase.width, convertCase.height,
+                               8);
+        bool converted      = image->convertPixelFormatInPlace(convertCase.format);
+        const auto dataLen  = image->getDataLen();
+        const auto expected = static_cast<ssize_t>(pixels * convertCase.bytesPerPixel);
+
+        auto texture  = new Texture2D();
+        bool uploaded = converted && texture->initWithImage(image, convertCase.format);
+        texture->release();
+        image->release();
+
+        auto label = Label::createWithTTF(
+            StringUtils::format("%dx%d RGBA8 -> %s: %d bytes, expected %d, %s", convertCase.width, convertCase.height,
+                                convertCase.formatName, static_cast<int>(dataLen), static_cast<int>(expected),
+                                (uploaded && dataLen == expected) ? "OK" : "FAILED"),
+            "fonts/arial.ttf", 15);
+        label->setPosition(size.width / 2, y);
+        this->addChild(label);
+        y -= 30;
+    }
+}
+
+std::string TextureCacheInPlaceConvertTest::title() const
+{
+    return "Image: in place pixel format conversion";
+}
+
+std::string TextureCacheInPlaceConvertTest::subtitle() const
+{
+    return "Odd pixel counts keep the exact data length";
+}
+
+void TextureCacheBudgetTest::onEnter()
+{
+    TestCase::onEnter();
+
+    auto size  = Director::getInstance()->getWinSize();
+    auto cache = Director::getInstance()->getTextureCache();
+
+    // the sprite keeps its texture referenced, the other images are only cached
+    auto sprite = Sprite::create("Images/grossini.png");
+    sprite->setPosition(size.width / 4, size.height / 2);
+    this->addChild(sprite);
+
+    for (auto path : {"Images/background1.png", "Images/background2.png", "Images/background3.png",
+                      "Images/HelloWorld.png", "Images/texture1024x1024.png"})
+        cache->addImage(path);
+
+    cache->setMemoryBudget(2 * 1024 * 1024);
+    cache->setIdleDownscale(60);
+
+    _report = Label::createWithTTF("", "fonts/arial.ttf", 12);
+    _report->setAnchorPoint(Vec2::ANCHOR_MIDDLE_LEFT);
+    _report->setPosition(size.width / 2 - 40, size.height / 2);
+    this->addChild(_report);
+
+    updateReport(0);
+    schedule(AX_SCHEDULE_SELECTOR(TextureCacheBudgetTest::updateReport), 0.5f);
+}
+
+void TextureCacheBudgetTest::onExit()
+{
+    auto cache = Director::getInstance()->getTextureCache();
+    cache->setMemoryBudget(0);
+    cache->setIdleDownscale(0);
+
+    TestCase::onExit();
+}
+
+void TextureCacheBudgetTest::updateReport(float /*dt*/)
+{
+    auto cache  = Director::getInstance()->getTextureCache();
+    auto report = cache->getTextureMemoryReport();
+
+    std::string text = StringUtils::format("%u KB used, budget %u KB\n",
+                                           static_cast<unsigned int>(cache->getMemoryUsage() / 1024),
+                                           static_cast<unsigned int>(cache->getMemoryBudget() / 1024));
+    for (size_t i = 0; i < report.size() && i < 10; ++i)
+    {
+        auto& info = report[i];
+        auto name  = FileUtils::getInstance()->getFileShortName(info.key);
+        text += StringUtils::format("%s %dx%d level %d: %u KB, rc=%u, frame %u\n", name.c_str(), info.pixelsWide,
+                                    info.pixelsHigh, info.residentLevel, static_cast<unsigned int>(info.bytes / 1024),
+                                    info.referenceCount, info.lastUsedFrame);
+    }
+    _report->setString(text);
+}
+
+std::string TextureCacheBudgetTest::title() const
+{
+    return "TextureCache: memory budget";
+}
+
+std::string TextureCacheBudgetTest::subtitle() const
+{
+    return "Unreferenced textures are evicted over 2 MB, idle ones downscaled";
+}
@@ -66,4 +66,40 @@ private:
     void textureLoadedB(ax::Texture2D* texture);
 };
 
+class TextureCacheCopyStatsTest : public TestCase
+{
+public:
+    CREATE_FUNC(TextureCacheCopyStatsTest);
+
+    void onEnter() override;
+    std::string title() const override;
+    std::string subtitle() const override;
+};
+
+class TextureCacheInPlaceConvertTest : public TestCase
+{
+public:
+    CREATE_FUNC(TextureCacheInPlaceConvertTest);
+
+    void onEnter() override;
+    std::string title() const override;
+    std::string subtitle() const override;
+};
+
+class TextureCacheBudgetTest : public TestCase
+{
+public:
+    CREATE_FUNC(TextureCacheBudgetTest);
+
+    void onEnter() override;
+    void onExit() override;
+    std::string title() const override;
+    std::string subtitle() const override;
+
+private:
+    void updateReport(float dt);
+
+    ax::Label* _report = nullptr;
+};
+
 #endif  // _TEXTURECACHE_TEST_H_
@@ -68,6 +68,8 @@ FastTileMapTests::FastTileMapTests()
     ADD_TEST_CASE(TMXGIDObjectsTestNew);
     ADD_TEST_CASE(TileAnimTestNew);
     ADD_TEST_CASE(TileAnimTestNew2);
+    ADD_TEST_CASE(TMXChunkedLayerTestNew);
+    ADD_TEST_CASE(TMXBinaryMapTestNew);
 }
 
 TileDemoNew::TileDemoNew()
@@ -1431,3 +1433,131 @@ void TileAnimTestNew2::onTouchBegan(const std::vector<ax::Touch*>& touches, ax::
     _animStarted = !_animStarted;
     map->setTileAnimEnabled(_animStarted);
 }
+
+//------------------------------------------------------------------
+//
+// TMXChunkedLayerTestNew
+//
+//------------------------------------------------------------------
+static std::string generateLargeMapXML(int mapSize)
+{
+    std::vector<uint32_t> gids(mapSize * mapSize);
+    for (int y = 0; y < mapSize; ++y)
+    {
+        for (int x = 0; x < mapSize; ++x)
+        {
+            uint32_t gid = 1 + ((x / 6 + y / 4) % 3) * 18 + (x * 7 + y * 13) % 5;
+            if ((x / 32 + y / 32) % 2 && (x * 31 + y * 17) % 11 == 0)
+                gid = 0;
+            gids[y * mapSize + x] = gid;
+        }
+    }
+
+    auto xml = StringUtils::format(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+        "<map version=\"1.0\" orientation=\"orthogonal\" width=\"%d\" height=\"%d\" tilewidth=\"32\" "
+        "tileheight=\"32\">"
+        "<tileset firstgid=\"1\" name=\"tile 0\" tilewidth=\"32\" tileheight=\"32\" spacing=\"2\" margin=\"2\">"
+        "<image source=\"fixed-ortho-test2.png\" width=\"640\" height=\"400\"/>"
+        "</tileset>"
+        "<layer name=\"Layer 0\" width=\"%d\" height=\"%d\"><data encoding=\"base64\">",
+        mapSize, mapSize, mapSize, mapSize);
+    xml += utils::base64Encode(gids.data(), gids.size() * sizeof(uint32_t));
+    xml += "</data></layer></map>";
+    return xml;
+}
+
+TMXChunkedLayerTestNew::TMXChunkedLayerTestNew()
+{
+    // a 2000x2000 layer generated in memory, in the default mode it would keep quads for all of its 4M tiles
+    auto map = FastTMXTiledMap::createWithXML(generateLargeMapXML(2000), "TileMaps");
+    addChild(map, 0, kTagTileMap);
+
+    _layer = map->getLayer("Layer 0");
+    _layer->setChunked(true);
+
+    auto s = map->getContentSize();
+    map->runAction(RepeatForever::create(Sequence::create(MoveBy::create(30, Vec2(-s.width / 8, -s.height / 8)),
+                                                          MoveBy::create(30, Vec2(s.width / 8, s.height / 8)),
+                                                          nullptr)));
+
+    _statsLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _statsLabel->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    _statsLabel->setPosition(Vec2(VisibleRect::left().x + 10, VisibleRect::top().y - 80));
+    addChild(_statsLabel, 1);
+
+    scheduleUpdate();
+}
+
+std::string TMXChunkedLayerTestNew::title() const
+{
+    return "TMX chunked layer, 2000x2000 tiles";
+}
+
+std::string TMXChunkedLayerTestNew::subtitle() const
+{
+    return "Only the chunks around the screen are resident";
+}
+
+void TMXChunkedLayerTestNew::update(float dt)
+{
+    _statsLabel->setString(StringUtils::format("chunks resident: %d loading: %d drawn: %d",
+                                               _layer->getResidentChunkCount(), _layer->getLoadingChunkCount(),
+                                               _layer->getDrawnChunkCount()));
+}
+
+//------------------------------------------------------------------
+//
+// TMXBinaryMapTestNew
+//
+//------------------------------------------------------------------
+TMXBinaryMapTestNew::TMXBinaryMapTestNew()
+{
+    using clock = std::chrono::steady_clock;
+
+    auto xml       = generateLargeMapXML(2000);
+    auto startTime = clock::now();
+    auto xmlMap    = FastTMXTiledMap::createWithXML(xml, "TileMaps");
+    auto xmlTime   = std::chrono::duration<float, std::milli>(clock::now() - startTime).count();
+    xmlMap->retain();
+
+    // done offline by an asset step in a real project
+    auto binaryFile = FileUtils::getInstance()->getWritablePath() + "large-map-test.tmxb";
+    auto mapInfo    = TMXMapInfo::createWithXML(xml, "TileMaps");
+    if (!TMXBinaryCompiler::compile(mapInfo, "TileMaps/", binaryFile))
+    {
+        xmlMap->release();
+        return;
+    }
+
+    startTime       = clock::now();
+    auto map        = FastTMXTiledMap::createWithBinaryFile(binaryFile, "TileMaps");
+    auto binaryTime = std::chrono::duration<float, std::milli>(clock::now() - startTime).count();
+    addChild(map, 0, kTagTileMap);
+
+    auto layer = map->getLayer("Layer 0");
+    layer->setChunked(true);
+
+    // both maps must have the same tiles
+    auto xmlTiles  = xmlMap->getLayer("Layer 0")->getTiles();
+    auto tileCount = static_cast<size_t>(map->getMapSize().width * map->getMapSize().height);
+    bool sameTiles = memcmp(xmlTiles, layer->getTiles(), tileCount * sizeof(uint32_t)) == 0;
+    xmlMap->release();
+
+    auto label = Label::createWithTTF(StringUtils::format("TMX: %.1f ms, binary: %.1f ms, tiles %s", xmlTime,
+                                                          binaryTime, sameTiles ? "match" : "DIFFER"),
+                                      "fonts/arial.ttf", 14);
+    label->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    label->setPosition(Vec2(VisibleRect::left().x + 10, VisibleRect::top().y - 80));
+    addChild(label, 1);
+}
+
+std::string TMXBinaryMapTestNew::title() const
+{
+    return "TMX compiled to a binary map";
+}
+
+std::string TMXBinaryMapTestNew::subtitle() const
+{
+    return "Load time of the same 2000x2000 map";
+}
@@ -363,4 +363,27 @@ public:
     void onTouchBegan(const std::vector<ax::Touch*>& touches, ax::Event* event);
 };
 
+class TMXChunkedLayerTestNew : public TileDemoNew
+{
+public:
+    CREATE_FUNC(TMXChunkedLayerTestNew);
+    TMXChunkedLayerTestNew();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+private:
+    ax::FastTMXLayer* _layer = nullptr;
+    ax::Label* _statsLabel   = nullptr;
+};
+
+class TMXBinaryMapTestNew : public TileDemoNew
+{
+public:
+    CREATE_FUNC(TMXBinaryMapTestNew);
+    TMXBinaryMapTestNew();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif
@@ -28,6 +28,10 @@
 #include "network/Uri.h"
 #include "base/Utils.h"
 #include "yasio/byte_buffer.hpp"
+#include "3d/SkinningPaletteBuffer.h"
+#include "base/JobSystem.h"
+#include "3d/GLTFLoader.h"
+#include "physics3d/Physics3D.h"
 
 USING_NS_AX;
 using namespace ax::network;
@@ -79,6 +83,13 @@ UnitTests::UnitTests()
     ADD_TEST_CASE(ParseIntegerListTest);
     ADD_TEST_CASE(ParseUriTest);
     ADD_TEST_CASE(ResizableBufferAdapterTest);
+    ADD_TEST_CASE(SkinningPaletteBufferTest);
+    ADD_TEST_CASE(JobSystemTest);
+    ADD_TEST_CASE(GLTFLoaderTest);
+#if AX_USE_3D_PHYSICS && AX_ENABLE_BULLET_INTEGRATION
+    ADD_TEST_CASE(Physics3DWorldTest);
+    ADD_TEST_CASE(Physics3DQueryBatchTest);
+#endif
 #ifdef UNIT_TEST_FOR_OPTIMIZED_MATH_UTIL
     ADD_TEST_CASE(MathUtilTest);
 #endif
@@ -1724,3 +1735,355 @@ std::string ResizableBufferAdapterTest::subtitle() const
 {
     return "ResiziableBufferAdapter<yasio::byte_buffer> Test";
 }
+
+// SkinningPaletteBufferTest
+
+void SkinningPaletteBufferTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    using Buffer = SkinningPaletteBuffer;
+
+    // a standalone buffer only packs on the CPU, it doesn't need a device
+    Buffer buffer;
+    buffer.setMaxRows(4);
+
+    auto makePalette = [](int bones, float base) {
+        std::vector<Vec4> palette(bones * Buffer::TEXELS_PER_BONE);
+        for (size_t i = 0; i < palette.size(); ++i)
+            palette[i].set(base + i, base + i + 0.25f, base + i + 0.5f, base + i + 0.75f);
+        return palette;
+    };
+
+    auto first  = makePalette(60, 0.0f);
+    auto second = makePalette(Buffer::BONES_PER_ROW, 1000.0f);
+
+    EXPECT_EQ(buffer.pack(first.data(), 60), 0);
+    EXPECT_EQ(buffer.getRowCount(), 1);
+
+    // the second palette wraps to the next row, bones are never split across rows
+    EXPECT_EQ(buffer.pack(second.data(), Buffer::BONES_PER_ROW), 60);
+    EXPECT_EQ(buffer.getBoneCount(), 60 + Buffer::BONES_PER_ROW);
+    EXPECT_EQ(buffer.getRowCount(), 2);
+
+    int x, y;
+    Buffer::getTexelOf(Buffer::BONES_PER_ROW - 1, x, y);
+    EXPECT_EQ(x, (Buffer::BONES_PER_ROW - 1) * Buffer::TEXELS_PER_BONE);
+    EXPECT_EQ(y, 0);
+    Buffer::getTexelOf(Buffer::BONES_PER_ROW, x, y);
+    EXPECT_EQ(x, 0);
+    EXPECT_EQ(y, 1);
+
+    for (int bone = 0; bone < 60; ++bone)
+    {
+        for (int row = 0; row < Buffer::TEXELS_PER_BONE; ++row)
+            EXPECT_EQ(buffer.getBone(bone)[row], first[bone * Buffer::TEXELS_PER_BONE + row]);
+    }
+    for (int bone = 0; bone < Buffer::BONES_PER_ROW; ++bone)
+    {
+        for (int row = 0; row < Buffer::TEXELS_PER_BONE; ++row)
+            EXPECT_EQ(buffer.getBone(60 + bone)[row], second[bone * Buffer::TEXELS_PER_BONE + row]);
+    }
+
+    // packing fails once the rows allowed are used, and succeeds again after a reset
+    auto big = makePalette(Buffer::BONES_PER_ROW * 3, 0.0f);
+    EXPECT_EQ(buffer.pack(big.data(), Buffer::BONES_PER_ROW * 3), -1);
+    EXPECT_EQ(buffer.getBoneCount(), 60 + Buffer::BONES_PER_ROW);
+    EXPECT_EQ(buffer.pack(first.data(), 0), -1);
+
+    buffer.reset();
+    EXPECT_EQ(buffer.getBoneCount(), 0);
+    EXPECT_EQ(buffer.pack(big.data(), Buffer::BONES_PER_ROW * 3), 0);
+    EXPECT_EQ(buffer.getRowCount(), 3);
+    EXPECT_TRUE(buffer.getRowCapacity() <= buffer.getMaxRows());
+    EXPECT_EQ(buffer.getBone(Buffer::BONES_PER_ROW * 2)[2], big[Buffer::BONES_PER_ROW * 2 * 3 + 2]);
+}
+
+std::string SkinningPaletteBufferTest::subtitle() const
+{
+    return "SkinningPaletteBuffer packing Test";
+}
+
+// JobSystemTest
+
+void JobSystemTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // every item is visited exactly once, chunks never exceed the grain and stay inside the range
+    auto checkChunking = [](JobSystem& jobs, size_t first, size_t last, size_t grain) {
+        std::vector<std::atomic<int>> visits(last);
+        std::atomic<bool> chunksValid{true};
+        jobs.parallelFor(first, last, grain, [&](size_t begin, size_t end) {
+            if (begin >= end || end - begin > (std::max)(grain, size_t{1}) || begin < first || end > last)
+                chunksValid = false;
+            for (auto i = begin; i < end; ++i)
+                ++visits[i];
+        });
+        EXPECT_TRUE(chunksValid.load());
+        for (size_t i = 0; i < last; ++i)
+            EXPECT_EQ(visits[i].load(), i < first ? 0 : 1);
+    };
+
+    JobSystem jobs(3);
+    checkChunking(jobs, 0, 1, 16);
+    checkChunking(jobs, 0, 1000, 1);
+    checkChunking(jobs, 0, 1000, 7);
+    checkChunking(jobs, 13, 1000, 64);
+    checkChunking(jobs, 0, 64, 64);
+    checkChunking(jobs, 0, 100, 0);
+
+    // an empty range never calls func
+    bool called = false;
+    jobs.parallelFor(10, 10, 4, [&called](size_t, size_t) { called = true; });
+    EXPECT_FALSE(called);
+
+    // without helpers, the caller does all the work in one go
+    auto checkSingleCall = [](JobSystem& jobs) {
+        int calls = 0;
+        jobs.parallelFor(0, 1000, 10, [&calls](size_t begin, size_t end) {
+            EXPECT_EQ(begin, 0);
+            EXPECT_EQ(end, 1000);
+            ++calls;
+        });
+        EXPECT_EQ(calls, 1);
+    };
+
+    jobs.setMaxParallelism(1);
+    checkSingleCall(jobs);
+    jobs.setMaxParallelism(0);
+
+    // parallelFor from a job must not deadlock, the job takes part in its own loop
+    std::atomic<size_t> nestedSum{0};
+    std::atomic<bool> nestedDone{false};
+    jobs.enqueue([&jobs, &nestedSum, &nestedDone] {
+        jobs.parallelFor(0, 100, 3, [&nestedSum](size_t begin, size_t end) {
+            for (auto i = begin; i < end; ++i)
+                nestedSum += i;
+        });
+        nestedDone = true;
+    });
+    while (!nestedDone)
+        std::this_thread::yield();
+    EXPECT_EQ(nestedSum.load(), 99 * 100 / 2);
+
+    // a workerless job system runs everything on the caller
+    JobSystem inlineJobs(0);
+    checkSingleCall(inlineJobs);
+
+    // queued jobs are run, not dropped, when the job system is destroyed
+    std::atomic<int> ran{0};
+    {
+        JobSystem shortLived(2);
+        for (int i = 0; i < 100; ++i)
+            shortLived.enqueue([&ran] { ++ran; });
+    }
+    EXPECT_EQ(ran.load(), 100);
+}
+
+std::string JobSystemTest::subtitle() const
+{
+    return "JobSystem parallelFor chunking Test";
+}
+
+// GLTFLoaderTest
+
+void GLTFLoaderTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // each face of the box maps the whole texture, its top vertices have v = 0 in the file
+    auto fullPath = FileUtils::getInstance()->fullPathForFilename("MeshRendererTest/BoxTextured.gltf");
+    MeshDatas meshdatas;
+    MaterialDatas materialdatas;
+    NodeDatas nodedatas;
+    GLTFImportOptions options;
+    options.optimize = false;
+    options.quantize = false;
+    const bool loaded = GLTFLoader::load(fullPath, meshdatas, materialdatas, nodedatas, options);
+    EXPECT_TRUE(loaded);
+    EXPECT_EQ(meshdatas.meshDatas.size(), static_cast<size_t>(1));
+    if (!loaded || meshdatas.meshDatas.empty())
+        return;
+    auto meshdata = meshdatas.meshDatas[0];
+
+    int stride = 0, texCoordOffset = -1, positionOffset = -1;
+    for (const auto& attrib : meshdata->attribs)
+    {
+        if (attrib.vertexAttrib == shaderinfos::VertexKey::VERTEX_ATTRIB_TEX_COORD)
+            texCoordOffset = stride;
+        else if (attrib.vertexAttrib == shaderinfos::VertexKey::VERTEX_ATTRIB_POSITION)
+            positionOffset = stride;
+        stride += attrib.getAttribSizeBytes() / static_cast<int>(sizeof(float));
+    }
+    EXPECT_TRUE(texCoordOffset >= 0 && positionOffset >= 0);
+    EXPECT_EQ(meshdata->vertexSizeInFloat, stride * 24);
+
+    // the 3d shaders flip v, so the import stores them with the origin at the bottom left
+    const Vec2 expected[] = {Vec2(0, 1), Vec2(1, 1), Vec2(0, 0), Vec2(1, 0)};
+    for (int v = 0; v < 24; ++v)
+    {
+        const float* vertex = &meshdata->vertex[v * stride];
+        EXPECT_EQ(Vec2(vertex[texCoordOffset], vertex[texCoordOffset + 1]), expected[v % 4]);
+    }
+
+    // the top of the +Z face, where the top of the texture goes, is at y = 0.5
+    const float* top = &meshdata->vertex[16 * stride];
+    EXPECT_EQ(Vec3(top[positionOffset], top[positionOffset + 1], top[positionOffset + 2]), Vec3(-0.5f, 0.5f, 0.5f));
+}
+
+std::string GLTFLoaderTest::subtitle() const
+{
+    return "GLTFLoader texture coordinates Test";
+}
+
+// Physics3DWorldTest
+
+#if AX_USE_3D_PHYSICS && AX_ENABLE_BULLET_INTEGRATION
+void Physics3DWorldTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    Physics3DWorldDes des;
+    des.fixedTimeStep = 1.f / 64.f;  // exact in binary, so both runs accumulate the same time
+    des.maxSubSteps   = 4;
+    des.interpolate   = true;
+
+    auto addFallingBox = [](Physics3DWorld* world) {
+        Physics3DRigidBodyDes rbDes;
+        rbDes.mass         = 1.f;
+        rbDes.shape        = Physics3DShape::createBox(Vec3(1.f, 1.f, 1.f));
+        rbDes.disableSleep = true;
+        Mat4::createTranslation(0.f, 10.f, 0.f, &rbDes.originalTransform);
+        auto body = Physics3DRigidBody::create(&rbDes);
+        world->addPhysics3DObject(body);
+        return body;
+    };
+    auto getPosition = [](const Mat4& transform) { return Vec3(transform.m[12], transform.m[13], transform.m[14]); };
+
+    auto evenWorld   = Physics3DWorld::create(&des);
+    auto unevenWorld = Physics3DWorld::create(&des);
+    auto evenBody    = addFallingBox(evenWorld);
+    auto unevenBody  = addFallingBox(unevenWorld);
+
+    // 32 steps either way, 1 per frame or 1 and 3 in turns, the results only depend on the steps
+    for (int frame = 0; frame < 32; ++frame)
+        evenWorld->stepSimulate(1.f / 64.f);
+    for (int frame = 0; frame < 16; ++frame)
+        unevenWorld->stepSimulate(frame % 2 ? 5.f / 128.f : 3.f / 128.f);
+    EXPECT_EQ(getPosition(evenBody->getWorldTransform()), getPosition(unevenBody->getWorldTransform()));
+    EXPECT_EQ(evenWorld->getInterpolationAlpha(), 0.f);
+    EXPECT_EQ(unevenWorld->getInterpolationAlpha(), 0.f);
+
+    // half a step late, the body is drawn halfway between the last two steps
+    const auto before = getPosition(evenBody->getWorldTransform());
+    evenWorld->stepSimulate(1.f / 64.f + 1.f / 128.f);
+    const auto after = getPosition(evenBody->getWorldTransform());
+    EXPECT_EQ(evenWorld->getInterpolationAlpha(), 0.5f);
+    EXPECT_TRUE(after.y < before.y);
+    EXPECT_EQ(getPosition(evenBody->getInterpolatedWorldTransform(0.f)), before);
+    EXPECT_TRUE(getPosition(evenBody->getInterpolatedWorldTransform(0.5f)).distance((before + after) * 0.5f) < 1e-5f);
+
+    // a teleported body doesn't sweep from where it was
+    Mat4 teleport;
+    Mat4::createTranslation(5.f, 20.f, 0.f, &teleport);
+    evenBody->setWorldTransform(teleport);
+    EXPECT_EQ(getPosition(evenBody->getInterpolatedWorldTransform(0.f)), Vec3(5.f, 20.f, 0.f));
+    EXPECT_EQ(getPosition(evenBody->getInterpolatedWorldTransform(0.5f)), Vec3(5.f, 20.f, 0.f));
+}
+#else
+void Physics3DWorldTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+}
+#endif
+
+std::string Physics3DWorldTest::subtitle() const
+{
+    return "Physics3DWorld fixed step and interpolation Test";
+}
+
+// Physics3DQueryBatchTest
+
+#if AX_USE_3D_PHYSICS && AX_ENABLE_BULLET_INTEGRATION
+void Physics3DQueryBatchTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // 10 x 10 static unit boxes, 3 units apart
+    Physics3DWorldDes des;
+    auto world = Physics3DWorld::create(&des);
+    auto shape = Physics3DShape::createBox(Vec3(1.f, 1.f, 1.f));
+    std::vector<Physics3DObject*> boxes;
+    for (int i = 0; i < 100; ++i)
+    {
+        Physics3DRigidBodyDes rbDes;
+        rbDes.shape = shape;
+        Mat4::createTranslation((i % 10) * 3.f, 0.f, (i / 10) * 3.f, &rbDes.originalTransform);
+        auto body = Physics3DRigidBody::create(&rbDes);
+        world->addPhysics3DObject(body);
+        boxes.emplace_back(body);
+    }
+
+    // vertical rays and small boxes every 1.5 units, on a box or in the gap between two
+    std::vector<Vec3> starts, ends;
+    std::vector<AABB> queries;
+    for (int z = 0; z < 20; ++z)
+    {
+        for (int x = 0; x < 20; ++x)
+        {
+            Vec3 center(x * 1.5f, 0.f, z * 1.5f);
+            starts.emplace_back(center + Vec3(0.f, 10.f, 0.f));
+            ends.emplace_back(center - Vec3(0.f, 10.f, 0.f));
+            queries.emplace_back(center - Vec3(0.25f, 0.25f, 0.25f), center + Vec3(0.25f, 0.25f, 0.25f));
+        }
+    }
+    const size_t count = starts.size();
+
+    // one by one and batched, the results must be the same
+    std::vector<Physics3DWorld::HitResult> single(count), batched(count);
+    for (size_t i = 0; i < count; ++i)
+        world->rayCast(starts[i], ends[i], &single[i]);
+    world->rayCastBatch(starts.data(), ends.data(), count, batched.data());
+
+    std::vector<Physics3DObject*> objects, allObjects;
+    std::vector<uint32_t> offsets, allOffsets;
+    world->queryAABBBatch(queries.data(), count, allObjects, allOffsets);
+    EXPECT_EQ(allOffsets.size(), count + 1);
+
+    int hits = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const int x = static_cast<int>(i % 20), z = static_cast<int>(i / 20);
+        const bool onBox = x % 2 == 0 && z % 2 == 0;
+        Physics3DObject* box = onBox ? boxes[(z / 2) * 10 + x / 2] : nullptr;
+
+        EXPECT_EQ(single[i].hitObj, box);
+        EXPECT_EQ(batched[i].hitObj, single[i].hitObj);
+        if (box)
+        {
+            EXPECT_EQ(batched[i].hitPosition, single[i].hitPosition);
+            EXPECT_EQ(batched[i].hitNormal, single[i].hitNormal);
+            ++hits;
+        }
+
+        world->queryAABBBatch(&queries[i], 1, objects, offsets);
+        EXPECT_EQ(objects.size(), box ? static_cast<size_t>(1) : static_cast<size_t>(0));
+        EXPECT_EQ(allOffsets[i + 1] - allOffsets[i], static_cast<uint32_t>(objects.size()));
+        EXPECT_TRUE(std::equal(objects.begin(), objects.end(), allObjects.begin() + allOffsets[i]));
+        if (box)
+            EXPECT_EQ(objects[0], box);
+    }
+    EXPECT_EQ(hits, 100);
+}
+#else
+void Physics3DQueryBatchTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+}
+#endif
+
+std::string Physics3DQueryBatchTest::subtitle() const
+{
+    return "Physics3DWorld batched queries Test";
+}
@@ -112,4 +112,44 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class SkinningPaletteBufferTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(SkinningPaletteBufferTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class JobSystemTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(JobSystemTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class GLTFLoaderTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(GLTFLoaderTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class Physics3DWorldTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(Physics3DWorldTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class Physics3DQueryBatchTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(Physics3DQueryBatchTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
 #endif /* __UNIT_TEST__ */